@@ -123,6 +123,17 @@ if( LIBAKRYPT_HAVE_SYSMMAN )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_SYSMMAN_H" )
 endif()
 
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <sys/file.h>
+  int main( void ) {
+     return flock( 0, LOCK_UN );
+  }" LIBAKRYPT_HAVE_SYSFILE )
+
+if( LIBAKRYPT_HAVE_SYSFILE )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_SYSFILE_H" )
+endif()
+
 # -------------------------------------------------------------------------------------------------- #
 check_c_source_compiles("
   #include <sys/stat.h>
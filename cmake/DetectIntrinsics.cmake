@@ -34,3 +34,95 @@ check_c_source_compiles("
 if( LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64 )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_CLMULEPI64" )
 endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <immintrin.h>
+  __attribute__((target(\"ssse3\"))) static __m128i f128( __m128i a, __m128i b )
+   { return _mm_shuffle_epi8( a, b ); }
+  __attribute__((target(\"avx2\"))) static __m256i f256( __m256i a, __m256i b )
+   { return _mm256_shuffle_epi8( a, b ); }
+  int main( void ) {
+
+   __builtin_cpu_init();
+   if( __builtin_cpu_supports( \"avx2\" )) f256( _mm256_setzero_si256(), _mm256_setzero_si256());
+   if( __builtin_cpu_supports( \"ssse3\" )) f128( _mm_setzero_si128(), _mm_setzero_si128());
+
+  return 0;
+ }" LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8 )
+
+if( LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <immintrin.h>
+  __attribute__((target(\"avx512f,avx512bw,avx512vbmi,gfni\")))
+   static __m512i f512( __m512i a, __m512i b, __m512i c )
+   {
+     return _mm512_gf2p8affine_epi64_epi8( _mm512_mask_blend_epi8( _mm512_movepi8_mask( a ),
+                   _mm512_permutex2var_epi8( b, a, c ), _mm512_permutex2var_epi8( c, a, b )), b, 0 );
+   }
+  int main( void ) {
+
+   __builtin_cpu_init();
+   if( __builtin_cpu_supports( \"avx512vbmi\" ) && __builtin_cpu_supports( \"gfni\" ))
+     f512( _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512());
+
+  return 0;
+ }" LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE )
+
+if( LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <immintrin.h>
+  __attribute__((target(\"avx2\"))) static __m256i f256( const long long *t, __m256i a )
+   { return _mm256_i64gather_epi64( t, a, 8 ); }
+  __attribute__((target(\"avx512f\"))) static __m512i f512( const long long *t, __m512i a )
+   { return _mm512_i64gather_epi64( a, ( const void * )t, 8 ); }
+  int main( void ) {
+   long long t[8] = { 0 };
+
+   __builtin_cpu_init();
+   if( __builtin_cpu_supports( \"avx2\" )) f256( t, _mm256_setzero_si256());
+   if( __builtin_cpu_supports( \"avx512f\" )) f512( t, _mm512_setzero_si512());
+
+  return 0;
+ }" LIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64 )
+
+if( LIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  int main( void ) {
+   int state = 0;
+   __atomic_store_n( &state, 1, __ATOMIC_RELEASE );
+  return __atomic_load_n( &state, __ATOMIC_ACQUIRE ) - 1;
+ }" LIBAKRYPT_HAVE_BUILTIN_ATOMIC )
+
+if( LIBAKRYPT_HAVE_BUILTIN_ATOMIC )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_ATOMIC" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  static __thread int value = 0;
+  int main( void ) {
+   value = 1;
+  return value - 1;
+ }" LIBAKRYPT_HAVE_BUILTIN_THREAD_LOCAL )
+
+if( LIBAKRYPT_HAVE_BUILTIN_THREAD_LOCAL )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_THREAD_LOCAL" )
+endif()
@@ -0,0 +1,19 @@
+# -------------------------------------------------------------------------------------------------- #
+# выработка константных таблиц алгоритма Кузнечик на этапе сборки библиотеки
+# таблицы помещаются в заголовочный файл ak_kuznechik_tables.h, расположенный в каталоге сборки;
+# при кросс-компиляции программа выработки не может быть запущена, поэтому (а также при
+# выключенной опции LIBAKRYPT_GENERATE_TABLES) таблицы вычисляются при инициализации библиотеки
+# -------------------------------------------------------------------------------------------------- #
+if( CMAKE_CROSSCOMPILING OR NOT LIBAKRYPT_GENERATE_TABLES )
+  message("-- Kuznechik tables will be computed at library initialization" )
+else()
+  add_executable( ak_kuznechik_tables source/ak_kuznechik_tables.c )
+  add_custom_command( OUTPUT ${CMAKE_BINARY_DIR}/ak_kuznechik_tables.h
+                      COMMAND ak_kuznechik_tables ${CMAKE_BINARY_DIR}/ak_kuznechik_tables.h
+                      DEPENDS ak_kuznechik_tables
+                      COMMENT "Generating constant tables for Kuznechik block cipher" )
+  set( SOURCES      ${SOURCES} ${CMAKE_BINARY_DIR}/ak_kuznechik_tables.h )
+  include_directories( ${CMAKE_BINARY_DIR} )
+  add_compile_options( -DLIBAKRYPT_HAVE_KUZNECHIK_TABLES )
+  message("-- Kuznechik tables will be generated at build time" )
+endif()
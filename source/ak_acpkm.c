@@ -15,11 +15,55 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <ak_tools.h>
  #include <ak_bckey.h>
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Константа, используемая для выработки производного ключа (Р 1323565.1.017—2018, раздел 4.1). */
+ static const ak_uint8 ak_acpkm_constant[32] = {
+     0x9f, 0x9e, 0x9d, 0x9c, 0x9b, 0x9a, 0x99, 0x98, 0x97, 0x96, 0x95, 0x94, 0x93, 0x92, 0x91, 0x90,
+     0x8f, 0x8e, 0x8d, 0x8c, 0x8b, 0x8a, 0x89, 0x88, 0x87, 0x86, 0x85, 0x84, 0x83, 0x82, 0x81, 0x80 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция заменяет значение ключа производным ключом ACPKM и устанавливает его ресурс.
+    \details Функция предназначена для многократной смены ключа внутри режима CTR-ACPKM и
+    не выполняет проверок, уже выполненных вызывающей функцией (длины ключа и блока), а также
+    не обращается к опциям библиотеки: ресурс производного ключа передается в качестве аргумента.
+    Развертка раундовых ключей выполняется в ранее выделенной памяти.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования, длина ключа равна 32 октетам.
+    @param counter Ресурс производного ключа (количество блоков).
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_context_acpkm_switch_key( ak_bckey bkey, ssize_t counter )
+{
+  int error = ak_error_ok;
+  ak_uint8 new_key[32];
+
+ /* целостность ключа */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode,
+                                        __func__, "incorrect integrity code of secret key value" );
+ /* выработка нового значения: 32 октета константы зашифровываются за один вызов */
+  bkey->encrypt_blocks( &bkey->key, ( ak_pointer )ak_acpkm_constant, new_key, 32/bkey->bsize );
+
+ /* присваиваем ключу значение */
+  if(( error = ak_bckey_context_set_key( bkey, new_key, 32, ak_true )) != ak_error_ok )
+    ak_error_message( error, __func__ , "can't replace key by new using acpkm" );
+   else {
+           bkey->key.resource.type = key_using_resource;
+           bkey->key.resource.value.counter = counter;
+        }
+  ak_ptr_wipe( new_key, sizeof( new_key ), &bkey->key.generator, ak_true );
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \details Функция вычисляет новое значение секретного ключа в соответствии с соотношениями
     из раздела 4.1, см. Р 1323565.1.017—2018.
@@ -39,85 +83,254 @@
 {
   ssize_t counter = 0;
   int error = ak_error_ok;
-  ak_uint8 new_key[32], acpkm[32] = {
-     0x9f, 0x9e, 0x9d, 0x9c, 0x9b, 0x9a, 0x99, 0x98, 0x97, 0x96, 0x95, 0x94, 0x93, 0x92, 0x91, 0x90,
-     0x8f, 0x8e, 0x8d, 0x8c, 0x8b, 0x8a, 0x89, 0x88, 0x87, 0x86, 0x85, 0x84, 0x83, 0x82, 0x81, 0x80 };
 
  /* проверки */
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to block cipher key" );
   if( bkey->key.key.size != 32 ) return ak_error_message_fmt( ak_error_wrong_length, __func__,
                                  "using block cipher key with unexpected length %u", bkey->bsize );
- /* целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
-    return ak_error_message( ak_error_wrong_key_icode,
-                                        __func__, "incorrect integrity code of secret key value" );
- /* выработка нового значения */
+  if(( error = ak_libakrypt_self_test( ak_self_test_acpkm )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using acpkm after unsuccessful self test" );
    switch( bkey->bsize ) {
       case  8: /* шифр с длиной блока 64 бита */
-         bkey->encrypt( &bkey->key, acpkm, new_key );
-         bkey->encrypt( &bkey->key, acpkm +8, new_key +8 );
-         bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
-         bkey->encrypt( &bkey->key, acpkm +24, new_key +24 );
          counter = ak_libakrypt_get_option( "acpkm_section_magma_block_count" );
          break;
       case 16: /* шифр с длиной блока 128 бит */
-         bkey->encrypt( &bkey->key, acpkm, new_key );
-         bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
          counter = ak_libakrypt_get_option( "acpkm_section_kuznechik_block_count" );
          break;
       default: return ak_error_message( ak_error_wrong_block_cipher,
                                            __func__ , "incorrect block size of block cipher key" );
    }
 
- /* присваиваем ключу значение */
-  if(( error = ak_bckey_context_set_key( bkey, new_key, bkey->key.key.size, ak_true )) != ak_error_ok )
-    ak_error_message( error, __func__ , "can't replace key by new using acpkm" );
-   else {
-           bkey->key.resource.type = key_using_resource;
-           bkey->key.resource.value.counter = counter;
-        }
-  ak_ptr_wipe( new_key, sizeof( new_key ), &bkey->key.generator, ak_true );
- return error;
+ return ak_bckey_context_acpkm_switch_key( bkey, counter );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef LIBAKRYPT_LITTLE_ENDIAN
-  #define acpkm_block64 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
+  #define acpkm_next_ctr64 {\
               ctr[0] += 1;\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              outptr++; inptr++;\
            }
 
-  #define acpkm_block128 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
+  #define acpkm_next_ctr128 {\
               if(( ctr[0] += 1 ) == 0 ) ctr[1]++;\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              ((ak_uint64 *) outptr)[1] = yaout[1] ^ ((ak_uint64 *) inptr)[1];\
-              outptr += 2; inptr += 2;\
            }
 
 #else
-  #define acpkm_block64 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
+  #define acpkm_next_ctr64 {\
               ctr[0] = bswap_64( ctr[0] ); ctr[0] += 1; ctr[0] = bswap_64( ctr[0] );\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              outptr++; inptr++;\
            }
 
-  #define acpkm_block128 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
+  #define acpkm_next_ctr128 {\
               ctr[0] = bswap_64( ctr[0] ); ctr[0] += 1; ctr[0] = bswap_64( ctr[0] );\
               if( ctr[0] == 0 ) { \
                 ctr[1] = bswap_64( ctr[0] ); ctr[1] += 1; ctr[1] = bswap_64( ctr[0] );\
               }\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              ((ak_uint64 *) outptr)[1] = yaout[1] ^ ((ak_uint64 *) inptr)[1];\
-              outptr += 2; inptr += 2;\
            }
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) заданное количество блоков в режиме гаммирования.
+    \details Гамма вырабатывается сразу для нескольких последовательных значений счетчика
+    с помощью функции bckey.encrypt_blocks. Значение счетчика `ctr` изменяется.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования (ключ текущей секции).
+    @param ctr Текущее значение счетчика.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param blocks Количество обрабатываемых блоков.                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_context_acpkm_blocks( ak_bckey bkey, ak_uint64 *ctr,
+                                                   ak_uint64 *in, ak_uint64 *out, size_t blocks )
+{
+  size_t i, count, words = bkey->bsize >> 3, used = ak_min( blocks, ak_bckey_blocks_count );
+  ak_uint64 cv[2*ak_bckey_blocks_count], gamma[2*ak_bckey_blocks_count];
+
+  while( blocks > 0 ) {
+     count = ak_min( blocks, ak_bckey_blocks_count );
+     for( i = 0; i < count; i++ ) {
+        memcpy( cv + i*words, ctr, bkey->bsize );
+        if( words == 1 ) acpkm_next_ctr64 else acpkm_next_ctr128
+     }
+     bkey->encrypt_blocks( &bkey->key, cv, gamma, count );
+     for( i = 0; i < count*words; i++ ) out[i] = in[i] ^ gamma[i];
+     in += count*words; out += count*words;
+     blocks -= count;
+  }
+
+ /* очищаем значения счетчиков и гаммы */
+  if( used ) {
+    ak_ptr_wipe( cv, used*bkey->bsize, &bkey->key.generator, ak_true );
+    ak_ptr_wipe( gamma, used*bkey->bsize, &bkey->key.generator, ak_true );
+  }
+}
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция увеличивает значение счетчика режима ACPKM на заданную величину.
+
+    @param ctr Текущее значение счетчика.
+    @param words Длина счетчика в 64-х битных словах (1 или 2).
+    @param value Величина, на которую увеличивается счетчик.                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_context_acpkm_ctr_add( ak_uint64 *ctr, size_t words, ak_uint64 value )
+{
+ #ifdef LIBAKRYPT_LITTLE_ENDIAN
+  if((( ctr[0] += value ) < value ) && ( words > 1 )) ctr[1]++;
+ #else
+  ak_uint64 low = bswap_64( ctr[0] ) + value;
+  if(( low < value ) && ( words > 1 )) ctr[1] = bswap_64( bswap_64( ctr[1] ) + 1 );
+  ctr[0] = bswap_64( low );
+ #endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает заданное количество последовательных секций режима ACPKM.
+    \details Первая секция обрабатывается на ключе `bkey`, после обработки каждой секции
+    ключ заменяется производным. Если флаг `last` не установлен, то после обработки
+    последней секции производный ключ не вычисляется.
+
+    @param bkey Контекст ключа первой из обрабатываемых секций.
+    @param ctr Текущее значение счетчика (изменяется).
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param sections Количество обрабатываемых секций.
+    @param seclen Длина одной секции в блоках.
+    @param counter Ресурс производных ключей.
+    @param last Флаг необходимости вычисления ключа, следующего за последней секцией.
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_context_acpkm_sections( ak_bckey bkey, ak_uint64 *ctr, ak_uint64 *in,
+            ak_uint64 *out, size_t sections, size_t seclen, ssize_t counter, bool_t last )
+{
+  int error = ak_error_ok;
+  size_t words = bkey->bsize >> 3;
+
+  while( sections > 0 ) {
+     ak_bckey_context_acpkm_blocks( bkey, ctr, in, out, seclen );
+     in += seclen*words; out += seclen*words;
+     if(( --sections > 0 ) || last )
+       if(( error = ak_bckey_context_acpkm_switch_key( bkey, counter )) != ak_error_ok ) return error;
+  }
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Параметры одного потока, обрабатывающего последовательность секций режима ACPKM. */
+ struct bckey_acpkm_worker {
+  /*! \brief собственная копия ключа первой секции */
+   struct bckey key;
+  /*! \brief значение счетчика для первого блока первой секции */
+   ak_uint64 ctr[2];
+  /*! \brief указатель на входные данные */
+   ak_uint64 *in;
+  /*! \brief указатель на выходные данные */
+   ak_uint64 *out;
+  /*! \brief количество секций */
+   size_t sections;
+  /*! \brief длина секции в блоках */
+   size_t seclen;
+  /*! \brief ресурс производных ключей */
+   ssize_t counter;
+  /*! \brief код ошибки, возникшей при обработке */
+   int error;
+  /*! \brief идентификатор потока */
+   pthread_t thread;
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param arg указатель на структуру struct bckey_acpkm_worker
+    @return Функция всегда возвращает NULL.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_bckey_context_acpkm_worker( void *arg )
+{
+  struct bckey_acpkm_worker *worker = ( struct bckey_acpkm_worker *) arg;
+
+  worker->error = ak_bckey_context_acpkm_sections( &worker->key, worker->ctr,
+                               worker->in, worker->out, worker->sections, worker->seclen, worker->counter, ak_false );
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает заданное количество секций режима ACPKM с использованием
+    нескольких потоков.
+    \details Ключи секций вычисляются последовательно, поэтому вызывающий поток проходит
+    по цепочке производных ключей и, в начале каждой из `threads` - 1 групп последовательных секций,
+    передает копию текущего ключа новому потоку. Обработка данных группы и вычисление ключей
+    внутри нее выполняются потоком самостоятельно. Последняя группа обрабатывается вызывающим потоком.
+    По завершении работы ключ `bkey` соответствует секции, следующей за последней обработанной,
+    а значение счетчика `ctr` - блоку, следующему за последним обработанным,
+    т.е. результат совпадает с результатом последовательной обработки.
+
+    @param bkey Контекст ключа первой из обрабатываемых секций.
+    @param ctr Текущее значение счетчика (изменяется).
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param sections Количество обрабатываемых секций.
+    @param seclen Длина одной секции в блоках.
+    @param counter Ресурс производных ключей.
+    @param threads Количество используемых потоков.
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_context_acpkm_threads( ak_bckey bkey, ak_uint64 *ctr, ak_uint64 *in,
+          ak_uint64 *out, size_t sections, size_t seclen, ssize_t counter, size_t threads )
+{
+  int error = ak_error_ok;
+  size_t i, j, words = bkey->bsize >> 3, group = sections/threads;
+  struct bckey_acpkm_worker *workers = NULL;
+  bool_t *started = NULL;
+
+  if(( workers = calloc( threads, sizeof( struct bckey_acpkm_worker ))) == NULL ||
+     ( started = calloc( threads, sizeof( bool_t ))) == NULL ) {
+    if( workers != NULL ) free( workers );
+    return ak_bckey_context_acpkm_sections( bkey, ctr, in, out, sections, seclen, counter, ak_true );
+  }
+
+  for( i = 0; ( i < threads - 1 ) && ( error == ak_error_ok ); i++ ) {
+     workers[i].in = in; workers[i].out = out;
+     workers[i].sections = group; workers[i].seclen = seclen; workers[i].counter = counter;
+     memcpy( workers[i].ctr, ctr, bkey->bsize );
+     in += group*seclen*words; out += group*seclen*words;
+     ak_bckey_context_acpkm_ctr_add( ctr, words, group*seclen );
+
+     if( ak_bckey_context_create_and_set_bckey( &workers[i].key, bkey ) != ak_error_ok ) {
+      /* копию ключа создать не удалось, обрабатываем группу самостоятельно */
+       error = ak_bckey_context_acpkm_sections( bkey, workers[i].ctr,
+                             workers[i].in, workers[i].out, group, seclen, counter, ak_true );
+       continue;
+     }
+     if( pthread_create( &workers[i].thread, NULL,
+                                   ak_bckey_context_acpkm_worker, &workers[i] ) == 0 )
+       started[i] = ak_true;
+      else {
+        ak_bckey_context_acpkm_worker( &workers[i] );
+        ak_bckey_context_destroy( &workers[i].key );
+        if(( error = workers[i].error ) != ak_error_ok ) continue;
+      }
+    /* переходим к ключу первой секции следующей группы */
+     for( j = 0; ( j < group ) && ( error == ak_error_ok ); j++ )
+        error = ak_bckey_context_acpkm_switch_key( bkey, counter );
+  }
+
+ /* последняя группа секций обрабатывается вызывающим потоком */
+  if( error == ak_error_ok )
+    error = ak_bckey_context_acpkm_sections( bkey, ctr, in, out,
+                                    sections - ( threads - 1 )*group, seclen, counter, ak_true );
+
+  for( i = 0; i < threads - 1; i++ ) {
+     if( !started[i] ) continue;
+     pthread_join( workers[i].thread, NULL );
+     ak_bckey_context_destroy( &workers[i].key );
+     if( error == ak_error_ok ) error = workers[i].error;
+  }
+  free( workers );
+  free( started );
+
+ return error;
+}
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! В режиме ACPKM для шифрования используется операция гаммирования - операция сложения открытого
     (зашифровываемого) текста с гаммой, вырабатываемой шифром, по модулю два. Поэтому, для зашифрования
@@ -161,6 +374,9 @@
   ssize_t j = 0, sections = 0, tail = 0, seclen = 0, maxseclen = 0, mcount = 0;
   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, ctr[2] = { 0, 0 };
 
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_acpkm )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using acpkm after unsuccessful self test" );
  /* выполняем проверку размера входных данных */
   if( section_size%bkey->bsize != 0 ) return ak_error_message( ak_error_wrong_block_cipher_length,
                                __func__ , "the length of section is not divided by block length" );
@@ -182,7 +398,7 @@
        maxseclen = ak_libakrypt_get_option( "acpkm_section_magma_block_count" );
        mcount = ak_libakrypt_get_option( "magma_cipher_resource" )/maxseclen;
        #ifdef LIBAKRYPT_LITTLE_ENDIAN
-         ctr[0] = ((ak_uint64 *)iv)[0] << 32;
+         ctr[0] = (( ak_uint64 )((ak_uint32 *)iv)[0] ) << 32;
        #else
          ctr[0] = ((ak_uint32 *)iv)[0];
        #endif
@@ -220,16 +436,31 @@
  /* дальнейшие криптографические действия применяются к новому экземпляру ключа */
   sections = ( ssize_t )( size/section_size );
   tail = ( ssize_t )( size - ( size_t )( sections*seclen )*nkey.bsize );
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ /* большие объемы данных обрабатываются несколькими потоками */
+  if( sections > 1 ) {
+    size_t threads = ak_bckey_context_threads_count( bkey, ( size_t )sections*section_size );
+
+    if( threads > 1 ) {
+      if(( error = ak_bckey_context_acpkm_threads( &nkey, ctr, inptr, outptr, ( size_t )sections,
+              ( size_t )seclen, maxseclen, ak_min( threads, ( size_t )sections ))) != ak_error_ok ) {
+        ak_error_message( error, __func__, "incorrect multithreaded processing of sections" );
+        goto labex;
+      }
+      inptr += sections*seclen*(( ssize_t )nkey.bsize >> 3 );
+      outptr += sections*seclen*(( ssize_t )nkey.bsize >> 3 );
+      sections = 0;
+    }
+  }
+#endif
   if( sections > 0 ) {
     do{
-       switch( nkey.bsize ) { /* обрабатываем одну секцию */
-         case 8: for( j = 0; j < seclen; j++ ) acpkm_block64; break;
-         case 16: for( j = 0; j < seclen; j++ ) acpkm_block128; break;
-         default: ak_error_message( ak_error_wrong_block_cipher,
-                                           __func__ , "incorrect block size of block cipher key" );
-       }
+      /* обрабатываем одну секцию */
+       ak_bckey_context_acpkm_blocks( &nkey, ctr, inptr, outptr, ( size_t )seclen );
+       inptr += seclen*(( ssize_t )nkey.bsize >> 3 );
+       outptr += seclen*(( ssize_t )nkey.bsize >> 3 );
       /* вычисляем следующий ключ */
-       if(( error = ak_bckey_context_next_acpkm_key( &nkey )) != ak_error_ok ) {
+       if(( error = ak_bckey_context_acpkm_switch_key( &nkey, maxseclen )) != ak_error_ok ) {
          ak_error_message_fmt( error, __func__, "incorrect key generation after %u sections",
                                                                          (unsigned int) sections );
          goto labex;
@@ -239,12 +470,10 @@
 
   if( tail ) { /* теперь обрабатываем фрагмент данных, не кратный длине секции */
     if(( seclen = tail/(ssize_t)( nkey.bsize )) > 0 ) {
-       switch( nkey.bsize ) { /* обрабатываем данные, кратные длине блока */
-         case 8: for( j = 0; j < seclen; j++ ) acpkm_block64; break;
-         case 16: for( j = 0; j < seclen; j++ ) acpkm_block128; break;
-         default: ak_error_message( ak_error_wrong_block_cipher,
-                                            __func__ , "incorrect block size of block cipher key" );
-       }
+      /* обрабатываем данные, кратные длине блока */
+       ak_bckey_context_acpkm_blocks( &nkey, ctr, inptr, outptr, ( size_t )seclen );
+       inptr += seclen*(( ssize_t )nkey.bsize >> 3 );
+       outptr += seclen*(( ssize_t )nkey.bsize >> 3 );
     }
   /* остался последний фрагмент, длина которого меньше длины блока
                       в качестве гаммы мы используем старшие байты */
@@ -4,6 +4,13 @@
 /*  Файл ak_bckey.h                                                                                */
 /*  - содержит реализацию общих функций для алгоритмов блочного шифрования.                        */
 /* ----------------------------------------------------------------------------------------------- */
+/* это объявление нужно для использования функции sysconf() */
+#ifdef __linux__
+ #ifndef _POSIX_C_SOURCE
+   #define _POSIX_C_SOURCE 200112L
+ #endif
+#endif
+
 #ifdef LIBAKRYPT_HAVE_STDLIB_H
  #include <stdlib.h>
 #else
@@ -14,8 +21,15 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
+ #include <ak_tools.h>
  #include <ak_bckey.h>
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -25,6 +39,8 @@
 
     - bkey.encrypt -- алгоритм зашифрования одного блока
     - bkey.decrypt -- алгоритм расшифрования одного блока
+    - bkey.encrypt_blocks -- алгоритм зашифрования нескольких независимых блоков
+    - bkey.decrypt_blocks -- алгоритм расшифрования нескольких независимых блоков
     - bkey.shedule_keys -- алгоритм развертки ключа и генерации раундовых ключей
     - bkey.delete_keys -- функция удаления раундовых ключей
 
@@ -70,6 +86,8 @@
   bkey->bsize =    blocksize;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
@@ -105,6 +123,8 @@
   bkey->bsize =            0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
@@ -310,6 +330,8 @@
   bkey->bsize = rkey->bsize;
   bkey->encrypt = rkey->encrypt;
   bkey->decrypt = rkey->decrypt;
+  bkey->encrypt_blocks = rkey->encrypt_blocks;
+  bkey->decrypt_blocks = rkey->decrypt_blocks;
   bkey->schedule_keys = rkey->schedule_keys;
   bkey->delete_keys = rkey->delete_keys;
 
@@ -344,7 +366,6 @@
 {
   ak_int64 blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -352,7 +373,7 @@
                             __func__ , "the length of input data is not divided by block length" );
 
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_context_check_icode_policy( &bkey->key ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode,
                                         __func__, "incorrect integrity code of secret key value" );
  /* уменьшаем значение ресурса ключа */
@@ -365,22 +386,14 @@
  /* теперь приступаем к зашифрованию данных */
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->encrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
     case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->encrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
+      bkey->encrypt_blocks( &bkey->key, in, out, ( size_t )blocks );
     break;
     default: return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
   }
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_context_set_mask_policy( &bkey->key, size )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return ak_error_ok;
@@ -401,7 +414,6 @@
 {
   ak_int64 blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -409,7 +421,7 @@
                             __func__ , "the length of input data is not divided by block length" );
 
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_context_check_icode_policy( &bkey->key ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode,
                                         __func__, "incorrect integrity code of secret key value" );
  /* уменьшаем значение ресурса ключа */
@@ -422,27 +434,221 @@
  /* теперь приступаем к расшифрованию данных */
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->decrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
     case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->decrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
+      bkey->decrypt_blocks( &bkey->key, in, out, ( size_t )blocks );
     break;
     default: return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
   }
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_context_set_mask_policy( &bkey->key, size )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Количество потоков определяется опцией библиотеки `bckey_threads_count`; нулевое значение
+    опции означает количество доступных процессоров. Несколько потоков используются только
+    для данных, длина которых не меньше значения опции `bckey_threads_threshold`,
+    при этом на каждый поток приходится не менее `bckey_threads_threshold`/2 байт.
+    Если библиотека собрана без поддержки pthread, функция всегда возвращает единицу.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param size Размер обрабатываемых данных (в байтах).
+    @return Количество потоков, которое следует использовать для обработки данных.                 */
+/* ----------------------------------------------------------------------------------------------- */
+ size_t ak_bckey_context_threads_count( ak_bckey bkey, size_t size )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  size_t threads = 1, threshold = ( size_t )ak_libakrypt_get_option( "bckey_threads_threshold" );
+
+  if( bkey == NULL ) return 1;
+  if(( threshold == 0 ) || ( size < threshold )) return 1;
+  if(( threads = ( size_t )ak_libakrypt_get_option( "bckey_threads_count" )) == 0 ) {
+   #ifdef LIBAKRYPT_HAVE_UNISTD_H
+    long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+    threads = cpus > 0 ? ( size_t )cpus : 1;
+   #else
+    threads = 1;
+   #endif
+  }
+ /* не создаем потоков, которым достанется слишком мало данных */
+  return ak_max( 1, ak_min( threads, size/( ak_max( threshold >> 1, bkey->bsize ))));
+#else
+  (void)bkey; (void)size;
+ return 1;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция увеличивает значение счетчика режима гаммирования на заданную величину.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param ctr Указатель на значение счетчика (синхропосылку) длины bkey->bsize.
+    @param value Величина, на которую увеличивается счетчик.                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_context_ctr_add( ak_bckey bkey, ak_uint64 *ctr, ak_uint64 value )
+{
+  (void)bkey;
+ #ifdef LIBAKRYPT_LITTLE_ENDIAN
+  ctr[0] += value;
+ #else
+  ctr[0] = bswap_64( bswap_64( ctr[0] ) + value );
+ #endif                       /* как и в функции ak_bckey_context_ctr(), мы не учитываем знак
+                                 переноса, поскольку объем данных на одном ключе не может превышать
+                                                2^64 блоков (контролируется через ресурс ключа) */
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция очищает первые `count` блоков массива, в котором хранились гамма
+    или промежуточные значения открытого текста.
+
+    @param bkey Контекст ключа, генератор которого используется для очистки.
+    @param buf Указатель на массив.
+    @param count Количество использованных блоков массива.                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_bckey_context_wipe_blocks( ak_bckey bkey, ak_uint64 *buf, size_t count )
+{
+  if( count ) ak_ptr_wipe( buf, count*bkey->bsize, &bkey->key.generator, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) заданное количество блоков в режиме гаммирования.
+    \details Гамма вырабатывается сразу для нескольких последовательных значений счетчика
+    с помощью функции bckey.encrypt_blocks. Значение счетчика `ivector` изменяется.
+    Проверки целостности и ресурса ключа, а также перемаскирование не выполняются.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param ivector Текущее значение счетчика.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param blocks Количество обрабатываемых блоков.                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_context_ctr_blocks( ak_bckey bkey, ak_uint64 *ivector,
+                                                   ak_uint64 *in, ak_uint64 *out, size_t blocks )
+{
+  size_t i, count, words = bkey->bsize >> 3, used = ak_min( blocks, ak_bckey_blocks_count );
+  ak_uint64 ctr[2*ak_bckey_blocks_count], gamma[2*ak_bckey_blocks_count];
+
+  while( blocks > 0 ) {
+     count = ak_min( blocks, ak_bckey_blocks_count );
+     for( i = 0; i < count; i++ ) {
+        memcpy( ctr + i*words, ivector, bkey->bsize );
+        ak_bckey_context_ctr_add( bkey, ivector, 1 );
+     }
+     bkey->encrypt_blocks( &bkey->key, ctr, gamma, count );
+     for( i = 0; i < count*words; i++ ) out[i] = in[i] ^ gamma[i];
+     in += count*words; out += count*words;
+     blocks -= count;
+  }
+  ak_bckey_context_wipe_blocks( bkey, ctr, used );
+  ak_bckey_context_wipe_blocks( bkey, gamma, used );
+}
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Параметры одного потока, обрабатывающего фрагмент данных в режиме гаммирования. */
+ struct bckey_ctr_worker {
+  /*! \brief собственная копия ключа потока */
+   struct bckey key;
+  /*! \brief значение счетчика для первого блока фрагмента */
+   ak_uint64 ctr[2];
+  /*! \brief указатель на входные данные фрагмента */
+   ak_uint64 *in;
+  /*! \brief указатель на выходные данные фрагмента */
+   ak_uint64 *out;
+  /*! \brief количество блоков фрагмента */
+   size_t blocks;
+  /*! \brief идентификатор потока */
+   pthread_t thread;
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param arg указатель на структуру struct bckey_ctr_worker
+    @return Функция всегда возвращает NULL.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_bckey_context_ctr_worker( void *arg )
+{
+  struct bckey_ctr_worker *worker = ( struct bckey_ctr_worker *) arg;
+
+  ak_bckey_context_ctr_blocks( &worker->key, worker->ctr, worker->in, worker->out, worker->blocks );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) заданное количество блоков в режиме гаммирования
+    с использованием нескольких потоков.
+    \details Данные разбиваются на `threads` последовательных фрагментов, первый из которых
+    обрабатывается вызывающим потоком с ключом `bkey`, а остальные - отдельными потоками,
+    каждый из которых использует собственную копию ключа (контекст ключа не допускает одновременного
+    использования несколькими потоками). Значение счетчика для каждого фрагмента вычисляется
+    заранее, поэтому результат совпадает с результатом последовательной обработки.
+    Если создать копию ключа или поток не удалось, соответствующий фрагмент обрабатывается
+    вызывающим потоком. По завершении работы значение счетчика `bkey->ivector` увеличивается
+    на `blocks`.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param blocks Количество обрабатываемых блоков.
+    @param threads Количество используемых потоков.                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_context_ctr_threads( ak_bckey bkey, ak_uint64 *in, ak_uint64 *out,
+                                                                   size_t blocks, size_t threads )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  size_t i, chunk, offset, words = bkey->bsize >> 3;
+  struct bckey_ctr_worker *workers = NULL;
+  bool_t *started = NULL;
+
+  if(( workers = calloc( threads, sizeof( struct bckey_ctr_worker ))) == NULL ) goto lab_serial;
+  if(( started = calloc( threads, sizeof( bool_t ))) == NULL ) { free( workers ); goto lab_serial; }
+
+ /* фрагменты, кроме первого, передаются отдельным потокам */
+  chunk = blocks/threads;
+  for( i = 1; i < threads; i++ ) {
+     offset = i*chunk;
+     workers[i].blocks = ( i == threads - 1 ) ? blocks - offset : chunk;
+     workers[i].in = in + offset*words;
+     workers[i].out = out + offset*words;
+     memcpy( workers[i].ctr, bkey->ivector.data, bkey->bsize );
+     ak_bckey_context_ctr_add( bkey, workers[i].ctr, offset );
+     if( ak_bckey_context_create_and_set_bckey( &workers[i].key, bkey ) != ak_error_ok ) continue;
+     if( pthread_create( &workers[i].thread, NULL,
+                                    ak_bckey_context_ctr_worker, &workers[i] ) != 0 ) {
+       ak_bckey_context_destroy( &workers[i].key );
+       continue;
+     }
+     started[i] = ak_true;
+  }
+
+ /* первый фрагмент обрабатывается вызывающим потоком */
+  memcpy( workers[0].ctr, bkey->ivector.data, bkey->bsize );
+  ak_bckey_context_ctr_blocks( bkey, workers[0].ctr, in, out, chunk );
+
+ /* дожидаемся завершения потоков и обрабатываем фрагменты, для которых поток не был создан */
+  for( i = 1; i < threads; i++ ) {
+     if( started[i] ) {
+       pthread_join( workers[i].thread, NULL );
+       ak_bckey_context_destroy( &workers[i].key );
+     } else ak_bckey_context_ctr_blocks( bkey, workers[i].ctr,
+                                                workers[i].in, workers[i].out, workers[i].blocks );
+  }
+  ak_bckey_context_ctr_add( bkey, bkey->ivector.data, blocks );
+
+  free( workers );
+  free( started );
+ return;
+
+  lab_serial:
+#else
+  (void)threads;
+#endif
+  ak_bckey_context_ctr_blocks( bkey, bkey->ivector.data, in, out, blocks );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! В режиме гаммирования операцией шифрования является сложение открытого текста по модулю два
     с последовательностью, вырабатываемой блочным шифром, поэтому для зашифрования и расшифрования
@@ -499,7 +705,7 @@
   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_context_check_icode_policy( &bkey->key ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                    "incorrect integrity code of secret key value" );
  /* уменьшаем значение ресурса ключа */
@@ -537,46 +743,18 @@
      if( bkey->key.flags&bckey_flag_not_ctr ) bkey->key.flags ^= bckey_flag_not_ctr;
     }
 
- /* обработка основного массива данных (кратного длине блока) */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      while( blocks > 0 ) {
-        #ifndef LIBAKRYPT_LITTLE_ENDIAN
-          ak_uint64 tmp = bswap_64( ((ak_uint64 *)bkey->ivector.data)[0] );
-        #endif
-          bkey->encrypt( &bkey->key, bkey->ivector.data, yaout );
-          *outptr = *inptr ^ yaout[0];
-          outptr++; inptr++;
-        #ifdef LIBAKRYPT_LITTLE_ENDIAN
-          ((ak_uint64 *)bkey->ivector.data)[0]++;
-        #else
-          ((ak_uint64 *)bkey->ivector.data)[0] = bswap_64( ++tmp );
-        #endif
-        --blocks;
-      };
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит */
-      while( blocks > 0 ) {
-        #ifndef LIBAKRYPT_LITTLE_ENDIAN
-          ak_uint64 tmp = bswap_64( ((ak_uint64 *)bkey->ivector.data)[0] );
-        #endif
-          bkey->encrypt( &bkey->key, bkey->ivector.data, yaout );
-          *outptr = *inptr ^ yaout[0]; outptr++; inptr++;
-          *outptr = *inptr ^ yaout[1]; outptr++; inptr++;
-        #ifdef LIBAKRYPT_LITTLE_ENDIAN
-          ((ak_uint64 *)bkey->ivector.data)[0]++;
-        #else
-          ((ak_uint64 *)bkey->ivector.data)[0] = bswap_64( ++tmp );
-        #endif                                      /* здесь мы не учитываем знак переноса
-                                                     потому что объем данных на одном ключе не должен превышать
-                                                     2^64 блоков (контролируется через ресурс ключа) */
-        --blocks;
-      };
-    break;
-
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+ /* обработка основного массива данных (кратного длине блока):
+    гамма вырабатывается сразу для нескольких последовательных значений счетчика */
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
+  if( blocks > 0 ) {
+    size_t threads = ak_bckey_context_threads_count( bkey, ( size_t )blocks*bkey->bsize );
+
+    if( threads > 1 )
+      ak_bckey_context_ctr_threads( bkey, inptr, outptr, ( size_t )blocks, threads );
+     else ak_bckey_context_ctr_blocks( bkey, bkey->ivector.data, inptr, outptr, ( size_t )blocks );
+    inptr += blocks*( bkey->bsize >> 3 ); outptr += blocks*( bkey->bsize >> 3 );
   }
 
  /* обрабатываем хвост сообщения */
@@ -594,12 +772,372 @@
   }
 
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_context_set_mask_policy( &bkey->key, size )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                режимы простой замены с зацеплением, гаммирования с обратной связью             */
+/*                          по шифртексту и гаммирования с обратной связью по выходу               */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция устанавливает начальное значение регистра сдвига, используемого в режимах
+    CBC, CFB и OFB, либо проверяет, что ранее выработанное значение может быть использовано.
+
+    \details Регистр сдвига длины \f$ m = zn \f$ хранится в буффере `bkey.ivector` как
+    последовательность из \f$ z \f$ блоков; первым используется блок, расположенный
+    в начале буффера.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param iv Указатель на синхропосылку или NULL.
+    @param iv_size Длина синхропосылки в байтах.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль).
+    В противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_context_set_register( ak_bckey bkey, ak_pointer iv, size_t iv_size )
+{
+  int error = ak_error_ok;
+
+ /* проверяем целостность ключа */
+  if( ak_skey_context_check_icode_policy( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+
+  if(( iv == NULL ) || ( iv_size == 0 )) { /* запрос на использование внутреннего значения */
+    if(( ak_buffer_is_assigned( &bkey->ivector ) != ak_true ) ||
+       ( bkey->ivector.size == 0 ) || ( bkey->ivector.size%bkey->bsize != 0 ))
+      return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                  "first calling function with undefined value of initial vector" );
+    if( bkey->key.flags&bckey_flag_not_ctr )
+      return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                              "secondary calling function with undefined value of initial vector" );
+    return ak_error_ok;
+  }
+
+ /* длина синхропосылки должна быть кратна длине блока */
+  if(( iv_size < bkey->bsize ) || ( iv_size%bkey->bsize != 0 ))
+    return ak_error_message( ak_error_wrong_iv_length, __func__,
+                                                              "incorrect length of initial value" );
+ /* буффер не уменьшает свой размер, поэтому при изменении длины регистра память освобождается */
+  if( bkey->ivector.size != iv_size ) ak_buffer_set_size( &bkey->ivector, 0 );
+  if(( error = ak_buffer_set_size( &bkey->ivector, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect momory allocation for internal vector" );
+  memcpy( bkey->ivector.data, iv, iv_size );
+
+ /* снимаем значение флага */
+  if( bkey->key.flags&bckey_flag_not_ctr ) bkey->key.flags ^= bckey_flag_not_ctr;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция уменьшает ресурс ключа на заданное количество блоков. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_context_decrease_resource( ak_bckey bkey, ak_int64 blocks )
+{
+  if( bkey->key.resource.value.counter < blocks )
+    return ak_error_message( ak_error_low_key_resource,
+                                                    __func__ , "low resource of block cipher key" );
+  bkey->key.resource.value.counter -= blocks;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает в конец регистра сдвига `count` блоков, вытесняя из его начала
+    такое же количество блоков.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_bckey_context_shift_register( ak_bckey bkey,
+                                                             const ak_uint8 *blocks, size_t count )
+{
+  ak_uint8 *reg = ( ak_uint8 *)bkey->ivector.data;
+  size_t size = bkey->ivector.size, len = count*bkey->bsize;
+
+  if( len >= size ) memcpy( reg, blocks + len - size, size );
+   else {
+     memmove( reg, reg + len, size - len );
+     memcpy( reg + size - len, blocks, len );
+   }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция гаммирует неполный последний блок сообщения и запрещает дальнейшее
+    использование внутреннего значения регистра сдвига.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_context_register_tail( ak_bckey bkey,
+                                             const ak_uint8 *in, ak_uint8 *out, const size_t tail )
+{
+  size_t i;
+  ak_uint64 yaout[2];
+
+  bkey->encrypt( &bkey->key, bkey->ivector.data, yaout );
+  for( i = 0; i < tail; i++ ) /* используем старшие байты (most significant bytes) гаммы */
+     out[i] = in[i]^( (ak_uint8 *)yaout)[bkey->bsize-tail+i];
+  memset( bkey->ivector.data, 0, bkey->ivector.size );
+  bkey->key.flags |= bckey_flag_not_ctr;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция завершает вызов режима шифрования: перемаскирует ключ
+    в соответствии с установленной для него политикой.                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline int ak_bckey_context_remask( ak_bckey bkey, const size_t size )
+{
+  int error = ak_error_ok;
+  if(( error = ak_skey_context_set_mask_policy( &bkey->key, size )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим простой замены с зацеплением (CBC) из ГОСТ Р 34.13-2015, раздел 5.4.
+
+    Синхропосылка задает начальное значение регистра сдвига длины \f$ m = zn \f$, где
+    \f$ n \f$ -- длина блока. Зашифрование выполняется группами по \f$ z \f$ блоков,
+    поскольку блоки, отстоящие друг от друга менее чем на \f$ z \f$ позиций, зашифровываются
+    независимо. Значение регистра сдвига сохраняется в контексте ключа и может быть
+    использовано при повторном вызове функции (аналогично функции ak_bckey_context_ctr()).
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся входные (открытые) данные.
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер зашифровываемых данных (в байтах); должен быть кратен длине блока.
+    @param iv Указатель на синхропосылку или NULL для использования внутреннего значения.
+    @param iv_size Длина синхропосылки в байтах; должна быть кратна длине блока.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_encrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  int error = ak_error_ok;
+  size_t i, count, z, words, used = 0;
+  ak_int64 blocks = 0;
+  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *reg = NULL;
+  ak_uint64 buf[2*ak_bckey_blocks_count];
+
+  if(( error = ak_bckey_context_set_register( bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect initial value" );
+  if( size%bkey->bsize != 0 )
+    return ak_error_message( ak_error_wrong_block_cipher_length,
+                            __func__ , "the length of input data is not divided by block length" );
+  blocks = ( ak_int64 )( size/bkey->bsize );
+  if(( error = ak_bckey_context_decrease_resource( bkey, blocks )) != ak_error_ok )
+    return error;
+
+  z = bkey->ivector.size/bkey->bsize;
+  reg = ( ak_uint64 *)bkey->ivector.data;
+  while( blocks > 0 ) {
+     count = ( size_t )ak_min( blocks, ( ak_int64 )ak_min( z, ak_bckey_blocks_count ));
+     words = count*( bkey->bsize >> 3 );
+     for( i = 0; i < words; i++ ) buf[i] = inptr[i]^reg[i];
+     bkey->encrypt_blocks( &bkey->key, buf, outptr, count );
+     ak_bckey_context_shift_register( bkey, ( ak_uint8 *)outptr, count );
+     inptr += words; outptr += words;
+     blocks -= ( ak_int64 )count;
+     used = ak_max( used, count );
+  }
+  ak_bckey_context_wipe_blocks( bkey, buf, used );
+
+ return ak_bckey_context_remask( bkey, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует расшифрование в режиме простой замены с зацеплением (CBC)
+    из ГОСТ Р 34.13-2015, раздел 5.4.
+
+    Поскольку расшифрование каждого блока зависит только от шифртекста, блоки расшифровываются
+    группами по \ref ak_bckey_blocks_count с помощью функции bckey.decrypt_blocks.
+    Параметры функции аналогичны параметрам функции ak_bckey_context_encrypt_cbc().
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_decrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  int error = ak_error_ok;
+  size_t i, j, count, z, words, bwords, used = 0;
+  ak_int64 blocks = 0;
+  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *reg = NULL;
+  ak_uint64 buf[2*ak_bckey_blocks_count];
+
+  if(( error = ak_bckey_context_set_register( bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect initial value" );
+  if( size%bkey->bsize != 0 )
+    return ak_error_message( ak_error_wrong_block_cipher_length,
+                            __func__ , "the length of input data is not divided by block length" );
+  blocks = ( ak_int64 )( size/bkey->bsize );
+  if(( error = ak_bckey_context_decrease_resource( bkey, blocks )) != ak_error_ok )
+    return error;
+
+  z = bkey->ivector.size/bkey->bsize;
+  bwords = bkey->bsize >> 3;
+  reg = ( ak_uint64 *)bkey->ivector.data;
+  while( blocks > 0 ) {
+     count = ( size_t )ak_min( blocks, ak_bckey_blocks_count );
+     words = count*bwords;
+     bkey->decrypt_blocks( &bkey->key, inptr, buf, count );
+    /* блоки обрабатываются в обратном порядке, чтобы при совпадении in и out
+       шифртекст предыдущих блоков оставался доступным */
+     for( i = words; i > 0; i-- ) {
+        j = i - 1;
+        if( j < z*bwords ) buf[j] ^= reg[j];
+          else buf[j] ^= inptr[j - z*bwords];
+     }
+     ak_bckey_context_shift_register( bkey, ( ak_uint8 *)inptr, count );
+     memcpy( outptr, buf, words << 3 );
+     inptr += words; outptr += words;
+     blocks -= ( ak_int64 )count;
+     used = ak_max( used, count );
+  }
+  ak_bckey_context_wipe_blocks( bkey, buf, used );
+
+ return ak_bckey_context_remask( bkey, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует зашифрование в режиме гаммирования с обратной связью по шифртексту (CFB)
+    из ГОСТ Р 34.13-2015, раздел 5.5, для значения параметра \f$ s = n \f$.
+
+    Синхропосылка задает начальное значение регистра сдвига длины \f$ m = zn \f$;
+    блоки зашифровываются группами по \f$ z \f$. Последний блок сообщения может быть неполным,
+    в этом случае дальнейшее использование внутреннего значения регистра запрещается.
+    Параметры функции аналогичны параметрам функции ak_bckey_context_encrypt_cbc().
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_encrypt_cfb( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  int error = ak_error_ok;
+  size_t i, count, z, words, used = 0, tail = size%bkey->bsize;
+  ak_int64 blocks = 0;
+  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_uint64 gamma[2*ak_bckey_blocks_count];
+
+  if(( error = ak_bckey_context_set_register( bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect initial value" );
+  blocks = ( ak_int64 )( size/bkey->bsize );
+  if(( error = ak_bckey_context_decrease_resource( bkey, blocks + ( tail > 0 ))) != ak_error_ok )
+    return error;
+
+  z = bkey->ivector.size/bkey->bsize;
+  while( blocks > 0 ) {
+     count = ( size_t )ak_min( blocks, ( ak_int64 )ak_min( z, ak_bckey_blocks_count ));
+     words = count*( bkey->bsize >> 3 );
+     bkey->encrypt_blocks( &bkey->key, bkey->ivector.data, gamma, count );
+     for( i = 0; i < words; i++ ) outptr[i] = inptr[i]^gamma[i];
+     ak_bckey_context_shift_register( bkey, ( ak_uint8 *)outptr, count );
+     inptr += words; outptr += words;
+     blocks -= ( ak_int64 )count;
+     used = ak_max( used, count );
+  }
+  ak_bckey_context_wipe_blocks( bkey, gamma, used );
+  if( tail ) ak_bckey_context_register_tail( bkey, ( ak_uint8 *)inptr, ( ak_uint8 *)outptr, tail );
+
+ return ak_bckey_context_remask( bkey, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует расшифрование в режиме гаммирования с обратной связью по шифртексту (CFB)
+    из ГОСТ Р 34.13-2015, раздел 5.5, для значения параметра \f$ s = n \f$.
+
+    Гамма для каждого блока вырабатывается из известного шифртекста, поэтому блоки
+    обрабатываются группами по \ref ak_bckey_blocks_count.
+    Параметры функции аналогичны параметрам функции ak_bckey_context_encrypt_cbc().
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_decrypt_cfb( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  int error = ak_error_ok;
+  size_t i, count, z, words, rwords, used = 0, tail = size%bkey->bsize;
+  ak_int64 blocks = 0;
+  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_uint64 buf[2*ak_bckey_blocks_count], gamma[2*ak_bckey_blocks_count];
+
+  if(( error = ak_bckey_context_set_register( bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect initial value" );
+  blocks = ( ak_int64 )( size/bkey->bsize );
+  if(( error = ak_bckey_context_decrease_resource( bkey, blocks + ( tail > 0 ))) != ak_error_ok )
+    return error;
+
+  z = bkey->ivector.size/bkey->bsize;
+  while( blocks > 0 ) {
+     count = ( size_t )ak_min( blocks, ak_bckey_blocks_count );
+     words = count*( bkey->bsize >> 3 );
+    /* входом алгоритма шифрования служат содержимое регистра и предшествующий шифртекст */
+     rwords = ak_min( z, count )*( bkey->bsize >> 3 );
+     memcpy( buf, bkey->ivector.data, rwords << 3 );
+     if( words > rwords ) memcpy( buf + rwords, inptr, ( words - rwords ) << 3 );
+     ak_bckey_context_shift_register( bkey, ( ak_uint8 *)inptr, count );
+
+     bkey->encrypt_blocks( &bkey->key, buf, gamma, count );
+     for( i = 0; i < words; i++ ) outptr[i] = inptr[i]^gamma[i];
+     inptr += words; outptr += words;
+     blocks -= ( ak_int64 )count;
+     used = ak_max( used, count );
+  }
+  ak_bckey_context_wipe_blocks( bkey, buf, used );
+  ak_bckey_context_wipe_blocks( bkey, gamma, used );
+  if( tail ) ak_bckey_context_register_tail( bkey, ( ak_uint8 *)inptr, ( ak_uint8 *)outptr, tail );
+
+ return ak_bckey_context_remask( bkey, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим гаммирования с обратной связью по выходу (OFB)
+    из ГОСТ Р 34.13-2015, раздел 5.3, для значения параметра \f$ s = n \f$.
+
+    Зашифрование и расшифрование в данном режиме совпадают. Синхропосылка задает
+    начальное значение регистра сдвига длины \f$ m = zn \f$; гамма вырабатывается группами
+    по \f$ z \f$ блоков. Последний блок сообщения может быть неполным,
+    в этом случае дальнейшее использование внутреннего значения регистра запрещается.
+    Параметры функции аналогичны параметрам функции ak_bckey_context_encrypt_cbc().
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_ofb( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  int error = ak_error_ok;
+  size_t i, count, z, words, used = 0, tail = size%bkey->bsize;
+  ak_int64 blocks = 0;
+  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_uint64 gamma[2*ak_bckey_blocks_count];
+
+  if(( error = ak_bckey_context_set_register( bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect initial value" );
+  blocks = ( ak_int64 )( size/bkey->bsize );
+  if(( error = ak_bckey_context_decrease_resource( bkey, blocks + ( tail > 0 ))) != ak_error_ok )
+    return error;
+
+  z = bkey->ivector.size/bkey->bsize;
+  while( blocks > 0 ) {
+     count = ( size_t )ak_min( blocks, ( ak_int64 )ak_min( z, ak_bckey_blocks_count ));
+     words = count*( bkey->bsize >> 3 );
+     bkey->encrypt_blocks( &bkey->key, bkey->ivector.data, gamma, count );
+     ak_bckey_context_shift_register( bkey, ( ak_uint8 *)gamma, count );
+     for( i = 0; i < words; i++ ) outptr[i] = inptr[i]^gamma[i];
+     inptr += words; outptr += words;
+     blocks -= ( ak_int64 )count;
+     used = ak_max( used, count );
+  }
+  ak_bckey_context_wipe_blocks( bkey, gamma, used );
+  if( tail ) ak_bckey_context_register_tail( bkey, ( ak_uint8 *)inptr, ( ak_uint8 *)outptr, tail );
+
+ return ak_bckey_context_remask( bkey, size );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вычисляет имитовставку от заданной области памяти фиксированного размера.
 
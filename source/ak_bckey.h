@@ -22,9 +22,27 @@
  typedef int ( ak_function_bckey_create ) ( ak_bckey );
 /*! \brief Функция зашифрования/расширования одного блока информации. */
  typedef void ( ak_function_bckey )( ak_skey, ak_pointer, ak_pointer );
+/*! \brief Функция зашифрования/расшифрования нескольких последовательно расположенных в памяти
+    блоков информации. */
+ typedef void ( ak_function_bckey_blocks )( ak_skey, ak_pointer, ak_pointer, size_t );
 /*! \brief Функция, предназначенная для зашифрования/расшифрования области памяти заданного размера */
  typedef int ( ak_function_bckey_encrypt )( ak_bckey, ak_pointer, ak_pointer, size_t,
                                                                                 ak_pointer, size_t );
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, для которых режимы шифрования вырабатывают гамму за один вызов
+    функции bckey.encrypt_blocks. */
+ #define ak_bckey_blocks_count (64)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Фрагмент данных, используемый функциями, обрабатывающими данные,
+    расположенные в нескольких несмежных областях памяти. */
+ typedef struct segment {
+  /*! \brief Указатель на начало фрагмента. */
+   ak_pointer data;
+  /*! \brief Длина фрагмента (в байтах). */
+   size_t size;
+} *ak_segment;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Секретный ключ блочного алгоритма шифрования. */
  struct bckey {
@@ -39,6 +57,10 @@
    ak_function_bckey *encrypt;
   /*! \brief Функция расширования одного блока информации. */
    ak_function_bckey *decrypt;
+  /*! \brief Функция зашифрования нескольких независимых блоков информации. */
+   ak_function_bckey_blocks *encrypt_blocks;
+  /*! \brief Функция расшифрования нескольких независимых блоков информации. */
+   ak_function_bckey_blocks *decrypt_blocks;
   /*! \brief Функция развертки ключа. */
    ak_function_skey *schedule_keys;
   /*! \brief Функция уничтожения развернутых ключей. */
@@ -75,6 +97,8 @@
 /*! \brief Процедура вычисления производного ключа в соответствии с алгоритмом ACPKM
     из рекомендаций Р 1323565.1.012-2018. */
  int ak_bckey_context_next_acpkm_key( ak_bckey );
+/*! \brief Количество потоков, используемых для обработки данных заданного размера. */
+ size_t ak_bckey_context_threads_count( ak_bckey , size_t );
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Зашифрование данных в режиме простой замены. */
@@ -86,6 +110,19 @@
 /*! \brief Шифрование данных в режиме CTR-ACPKM из Р 1323565.1.017—2018. */
  int ak_bckey_context_ctr_acpkm( ak_bckey , ak_pointer , ak_pointer , size_t , size_t ,
                                                                            ak_pointer , size_t );
+/*! \brief Зашифрование данных в режиме простой замены с зацеплением из ГОСТ Р 34.13-2015. */
+ int ak_bckey_context_encrypt_cbc( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Расшифрование данных в режиме простой замены с зацеплением из ГОСТ Р 34.13-2015. */
+ int ak_bckey_context_decrypt_cbc( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Зашифрование данных в режиме гаммирования с обратной связью по шифртексту
+    из ГОСТ Р 34.13-2015. */
+ int ak_bckey_context_encrypt_cfb( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Расшифрование данных в режиме гаммирования с обратной связью по шифртексту
+    из ГОСТ Р 34.13-2015. */
+ int ak_bckey_context_decrypt_cfb( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Шифрование данных в режиме гаммирования с обратной связью по выходу
+    из ГОСТ Р 34.13-2015. */
+ int ak_bckey_context_ofb( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
 /*! \brief Вычисление имитовставки согласно ГОСТ Р 34.13-2015. */
  ak_buffer ak_bckey_context_omac( ak_bckey , ak_pointer , size_t , ak_pointer );
 
@@ -98,6 +135,16 @@
  bool_t ak_bckey_context_decrypt_mgm( ak_bckey , ak_bckey , const ak_pointer , const size_t ,
                    const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
                                                                           ak_pointer, const size_t );
+/*! \brief Зашифрование данных, расположенных в нескольких фрагментах, в режиме MGM
+    с одновременной выработкой имитовставки. */
+ ak_buffer ak_bckey_context_encrypt_mgm_segments( ak_bckey , ak_bckey , const ak_segment ,
+                   const size_t , const ak_segment , const size_t , ak_segment , const size_t ,
+                                   const ak_pointer , const size_t , ak_pointer , const size_t );
+/*! \brief Расшифрование данных, расположенных в нескольких фрагментах, в режиме MGM
+    с одновременной проверкой имитовставки. */
+ bool_t ak_bckey_context_decrypt_mgm_segments( ak_bckey , ak_bckey , const ak_segment ,
+                   const size_t , const ak_segment , const size_t , ak_segment , const size_t ,
+                                   const ak_pointer , const size_t , ak_pointer , const size_t );
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Инициализация внутренних структур данных, используемых при реализации алгоритма
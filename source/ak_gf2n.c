@@ -101,6 +101,49 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ \sum_{i=0}^{count-1} x_i y_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{64}}\f$ и прибавляет ее к значению `z`.
+    Массивы `x` и `y` содержат по `count` последовательно расположенных элементов поля.
+
+    @param z Элемент поля, к которому прибавляется сумма произведений
+    @param x Массив первых сомножителей
+    @param y Массив вторых сомножителей
+    @param count Количество пар сомножителей                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf64_mul_sum_uint64( ak_pointer z, ak_pointer x, ak_pointer y, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 t;
+
+  for( i = 0; i < count; i++ ) {
+     ak_gf64_mul_uint64( &t, (ak_uint64 *)x + i, (ak_uint64 *)y + i );
+     ((ak_uint64 *)z)[0] ^= t;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ \sum_{i=0}^{count-1} x_i y_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{128}}\f$ и прибавляет ее к значению `z`.
+    Массивы `x` и `y` содержат по `count` последовательно расположенных элементов поля.
+
+    @param z Элемент поля, к которому прибавляется сумма произведений
+    @param x Массив первых сомножителей
+    @param y Массив вторых сомножителей
+    @param count Количество пар сомножителей                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf128_mul_sum_uint64( ak_pointer z, ak_pointer x, ak_pointer y, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 t[2];
+
+  for( i = 0; i < count; i++ ) {
+     ak_gf128_mul_uint64( t, (ak_uint64 *)x + 2*i, (ak_uint64 *)y + 2*i );
+     ((ak_uint64 *)z)[0] ^= t[0];
+     ((ak_uint64 *)z)[1] ^= t[1];
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
 
@@ -195,6 +238,75 @@
 	 ((ak_uint64 *)z)[1] = cm[1];
 #endif
 }
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ \sum_{i=0}^{count-1} x_i y_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{64}}\f$ и прибавляет ее к значению `z`.
+
+    Произведения, вычисляемые командой PCLMULQDQ, складываются без приведения по модулю
+    (сумма 128-ми битных многочленов остается многочленом той же степени), а приведение
+    выполняется один раз для всей суммы.                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf64_mul_sum_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 c[2], t[2];
+  const __m128i gm = _mm_set_epi64x( 0, 0x1B );
+  __m128i xm, ym, cm = _mm_setzero_si128();
+
+ /* накапливаем произведения без приведения */
+  for( i = 0; i < count; i++ ) {
+     xm = _mm_loadl_epi64( (const __m128i *)((ak_uint64 *)x + i ));
+     ym = _mm_loadl_epi64( (const __m128i *)((ak_uint64 *)y + i ));
+     cm = _mm_xor_si128( cm, _mm_clmulepi64_si128( xm, ym, 0x00 ));
+  }
+
+ /* однократное приведение, аналогичное функции ak_gf64_mul_pcmulqdq() */
+  _mm_storeu_si128( (__m128i *)c, cm );
+  xm = _mm_clmulepi64_si128( _mm_set_epi64x( 0, c[1] ), gm, 0x00 );
+  _mm_storeu_si128( (__m128i *)t, xm );
+  xm = _mm_clmulepi64_si128( _mm_set_epi64x( 0, t[1]^c[1] ), gm, 0x00 );
+  _mm_storeu_si128( (__m128i *)t, xm );
+
+  ((ak_uint64 *)z)[0] ^= c[0]^t[0];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ \sum_{i=0}^{count-1} a_i b_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{128}}\f$ и прибавляет ее к значению `z`.
+
+    Для каждой пары сомножителей вычисляются четыре произведения 64-х битных половин,
+    которые накапливаются в трех 128-ми битных регистрах (младшая, старшая и средняя части
+    256-ти битного произведения). Приведение по модулю выполняется один раз для всей суммы,
+    что позволяет не выполнять его для каждого из `count` произведений.                            */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf128_mul_sum_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 c[2], d[2], e[2], x3, D;
+  __m128i am, bm, cm = _mm_setzero_si128(), dm = cm, em = cm;
+
+ /* накапливаем произведения без приведения */
+  for( i = 0; i < count; i++ ) {
+     am = _mm_loadu_si128( (const __m128i *)a + i );
+     bm = _mm_loadu_si128( (const __m128i *)b + i );
+     cm = _mm_xor_si128( cm, _mm_clmulepi64_si128( am, bm, 0x00 )); /* a0*b0 */
+     dm = _mm_xor_si128( dm, _mm_clmulepi64_si128( am, bm, 0x11 )); /* a1*b1 */
+     em = _mm_xor_si128( em, _mm_clmulepi64_si128( am, bm, 0x10 )); /* a0*b1 */
+     em = _mm_xor_si128( em, _mm_clmulepi64_si128( am, bm, 0x01 )); /* a1*b0 */
+  }
+  _mm_storeu_si128( (__m128i *)c, cm );
+  _mm_storeu_si128( (__m128i *)d, dm );
+  _mm_storeu_si128( (__m128i *)e, em );
+
+ /* однократное приведение, аналогичное функции ak_gf128_mul_pcmulqdq() */
+  x3 = d[1];
+  D = d[0] ^ e[1] ^ (x3 >> 63) ^ (x3 >> 62) ^ (x3 >> 57);
+
+  ((ak_uint64 *)z)[0] ^= c[0] ^ D ^ (D << 1) ^ (D << 2) ^ (D << 7);
+  ((ak_uint64 *)z)[1] ^= c[1] ^ e[0] ^ x3 ^ (x3 << 1) ^ (D >> 63) ^ (x3 << 2) ^ (D >> 62)
+                                                                       ^ (x3 << 7) ^ (D >> 57);
+}
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -393,6 +505,49 @@
  return ak_true;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Тестирование вычисления суммы попарных произведений с однократным приведением. */
+ static bool_t ak_gfn_multiplication_sum_test( void )
+{
+ size_t i = 0, count = 0;
+ ak_uint64 x[32], y[32], z[2], s[2], t[2];
+
+ for( i = 0; i < 32; i++ ) {
+    x[i] = 0x9e3779b97f4a7c15LL*( i+1 );
+    y[i] = 0xc2b2ae3d27d4eb4fLL^( x[i] >> 7 )^( x[i] << 13 );
+ }
+
+ for( count = 1; count <= 16; count++ ) {
+   /* сумма, вычисленная с приведением каждого произведения */
+    s[0] = s[1] = 0;
+    for( i = 0; i < count; i++ ) {
+       ak_gf128_mul_uint64( t, x + 2*i, y + 2*i );
+       s[0] ^= t[0]; s[1] ^= t[1];
+    }
+    z[0] = z[1] = 0;
+    ak_gf128_mul_sum( z, x, y, count );
+    if( !ak_ptr_is_equal( z, s, 16 )) {
+      ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                            "wrong sum of products in GF(2^128) for %u pairs", (unsigned int)count );
+      return ak_false;
+    }
+
+    s[0] = 0;
+    for( i = 0; i < count; i++ ) {
+       ak_gf64_mul_uint64( t, x + i, y + i );
+       s[0] ^= t[0];
+    }
+    z[0] = 0;
+    ak_gf64_mul_sum( z, x, y, count );
+    if( z[0] != s[0] ) {
+      ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                             "wrong sum of products in GF(2^64) for %u pairs", (unsigned int)count );
+      return ak_false;
+    }
+ }
+ return ak_true;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_gfn_multiplication_test( void )
 {
@@ -421,6 +576,13 @@
     if( audit >= ak_log_maximum )
       ak_error_message( ak_error_get_value(), __func__ , "multiplication test in GF(2^128) is OK");
 
+ if( ak_gfn_multiplication_sum_test( ) != ak_true ) {
+   ak_error_message( ak_error_get_value(), __func__ , "incorrect sum of products test");
+   return ak_false;
+ } else
+    if( audit >= ak_log_maximum )
+      ak_error_message( ak_error_get_value(), __func__ , "sum of products test is OK");
+
  if( audit >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__ ,
                                          "testing the Galois fileds arithmetic ended successfully");
@@ -35,6 +35,7 @@
                                                       "incorrect internal data memory allocation" );
   } else ctx->data = NULL;
 
+  ctx->dsize =   data_size;
   ctx->bsize =  block_size;
   ctx->hsize =           0;
   ctx->oid =          NULL;
@@ -61,6 +62,7 @@
   ctx->bsize =       0;
   ctx->hsize =       0;
   ctx->data =     NULL;
+  ctx->dsize =       0;
   ctx->oid =      NULL;
   ctx->clean =    NULL;
   ctx->update =   NULL;
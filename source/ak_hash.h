@@ -55,6 +55,8 @@
    size_t hsize;
   /*! \brief указатель на внутренние данные контекста */
    ak_pointer data;
+  /*! \brief размер внутренних данных контекста (в байтах) */
+   size_t dsize;
   /*! \brief OID алгоритма хеширования */
    ak_oid oid;
   /*! \brief функция очистки контекста */
@@ -85,6 +87,30 @@
  ak_buffer ak_hash_context_file( ak_hash , const char*, ak_pointer );
 
 /* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание на хеширование одного сообщения, используемое при одновременной обработке
+    большого количества независимых сообщений. */
+ typedef struct hash_job {
+  /*! \brief Контекст функции хеширования, состояние которого является начальным
+      (значение контекста не изменяется). */
+   ak_hash ctx;
+  /*! \brief Хешируемые данные. */
+   ak_pointer in;
+  /*! \brief Длина хешируемых данных (в байтах). */
+   size_t size;
+  /*! \brief Область памяти, в которую помещается хеш-код. */
+   ak_pointer out;
+} *ak_hash_job;
+
+/*! \brief Хеширование нескольких независимых сообщений. */
+ int ak_hash_context_ptr_jobs( ak_hash_job , const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выбор реализации функции сжатия Стрибог в зависимости от возможностей процессора. */
+ bool_t ak_hash_init_streebog_tables( void );
+/*! \brief Название выбранной реализации функции сжатия Стрибог. */
+ const char *ak_hash_get_streebog_implementation( void );
+/*! \brief Сравнение выбранной реализации функции сжатия Стрибог со скалярной реализацией. */
+ bool_t ak_hash_test_streebog_implementation( void );
 /*! \brief Проверка корректной работы функции хеширования Стрибог-256 */
  bool_t ak_hash_test_streebog256( void );
 /*! \brief Проверка корректной работы функции хеширования Стрибог-512 */
@@ -4,6 +4,13 @@
 /*  Файл ak_hmac.с                                                                                 */
 /*  - содержит реализацию семейства ключевых алгоритмов хеширования HMAC.                          */
 /* ----------------------------------------------------------------------------------------------- */
+/* это объявление нужно для использования функции sysconf() */
+#ifdef __linux__
+ #ifndef _POSIX_C_SOURCE
+   #define _POSIX_C_SOURCE 200112L
+ #endif
+#endif
+
 #ifdef LIBAKRYPT_HAVE_STDLIB_H
  #include <stdlib.h>
 #else
@@ -14,6 +21,12 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <ak_mac.h>
@@ -41,6 +54,9 @@
  /* проверяем, что OID от алгоритма, а не от параметров */
   if( oid->mode != algorithm )
     return ak_error_message( ak_error_oid_mode, __func__ , "using oid with wrong mode" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_hmac )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using hmac after unsuccessful self test" );
 
  /* получаем oid бесключевой функции хеширования */
   if(( hashoid = ak_oid_context_find_by_name( oid->name+5 )) == NULL )
@@ -62,6 +78,14 @@
     return ak_error_message( error, __func__, "wrong creation of secret key" );
   }
 
+ /* выделяем память под начальные состояния функции хеширования */
+  if(( hctx->states = malloc( 2*hctx->ctx.dsize )) == NULL ) {
+    ak_skey_context_destroy( &hctx->key );
+    ak_hash_context_destroy( &hctx->ctx );
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                          "incorrect memory allocation for hash function states" );
+  }
+
  /* доопределяем oid ключа */
   hctx->key.oid = oid;
 
@@ -98,6 +122,11 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to hmac context" );
+  if( hctx->states != NULL ) {
+    ak_ptr_wipe( hctx->states, 2*hctx->ctx.dsize, &hctx->key.generator, ak_true );
+    free( hctx->states );
+    hctx->states = NULL;
+  }
   if(( error = ak_hash_context_destroy( &hctx->ctx )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect destroying of hash context" );
   if((  error = ak_skey_context_destroy( &hctx->key )) != ak_error_ok )
@@ -162,6 +191,8 @@
       if(( error = ak_skey_context_set_key( &hctx->key, ptr, size, cflag )) != ak_error_ok )
         return ak_error_message( error, __func__ , "incorrect assigning a secret key value" );
   }
+ /* начальные состояния функции хеширования будут вычислены при первом использовании ключа */
+  hctx->key.flags &= ( 0xFFFFFFFFFFFFFFFFLL ^ hmac_flag_states_set );
 
  return ak_error_ok;
 }
@@ -185,6 +216,7 @@
                                                         "using null pointer to hmac context" );
   if(( error = ak_skey_context_set_key_random( &hctx->key, generator )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect assigning a secret key value" );
+  hctx->key.flags &= ( 0xFFFFFFFFFFFFFFFFLL ^ hmac_flag_states_set );
 
  return ak_error_ok;
 }
@@ -217,10 +249,59 @@
   if(( error = ak_skey_context_set_key_from_password( &hctx->key,
                                           pass, pass_size, salt, salt_size )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect assigning a secret key value" );
+  hctx->key.flags &= ( 0xFFFFFFFFFFFFFFFFLL ^ hmac_flag_states_set );
 
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет внутренние данные функции хеширования после обработки блока, равного
+    сумме ключа и константы ipad, а также блока, равного сумме ключа и константы opad.
+    Эти данные не зависят от обрабатываемого сообщения, поэтому вычисляются однократно
+    для каждого значения ключа и далее лишь копируются в контекст функции хеширования.
+
+    @param hctx Контекст алгоритма HMAC выработки имитовставки.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_context_set_states( ak_hmac hctx )
+{
+  int error = ak_error_ok;
+  size_t idx = 0, jdx = 0, len = 0;
+  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
+  const ak_uint8 pad[2] = { 0x36, 0x5C };
+
+  if( hctx->ctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
+                                            __func__, "using hash function with huge block size" );
+  len = ak_min( hctx->ctx.bsize, hctx->key.key.size );
+  for( jdx = 0; jdx < 2; jdx++ ) {
+    /* фомируем маскированное значение ключа */
+     for( idx = 0; idx < len; idx++ ) {
+        buffer[idx] = ((ak_uint8 *)hctx->key.key.data)[idx] ^ pad[jdx];
+        buffer[idx] ^= ((ak_uint8 *)hctx->key.mask.data)[idx];
+     }
+     for( ; idx < hctx->ctx.bsize; idx++ ) buffer[idx] = pad[jdx];
+
+    /* обрабатываем блок, начиная с начального состояния, и сохраняем результат */
+     if(( error = hctx->ctx.clean( &hctx->ctx )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "wrong cleaning of hash function context" );
+       break;
+     }
+     if(( error = hctx->ctx.update( &hctx->ctx, buffer, hctx->ctx.bsize )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
+       break;
+     }
+     memcpy( hctx->states + jdx*hctx->ctx.dsize, hctx->ctx.data, hctx->ctx.dsize );
+  }
+
+ /* очищаем буффер и перемаскируем ключ */
+  ak_ptr_wipe( buffer, sizeof( buffer ), &hctx->key.generator, ak_true );
+  hctx->key.set_mask( &hctx->key );
+  if( error == ak_error_ok ) hctx->key.flags |= hmac_flag_states_set;
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param ctx Контекст алгоритма HMAC выработки имитовставки.
     @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
@@ -229,9 +310,7 @@
  int ak_hmac_context_clean( ak_pointer ctx )
 {
   int error = ak_error_ok;
-  size_t idx = 0, len = 0;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
 
   if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                       "using a null pointer to hmac key context" );
@@ -242,30 +321,14 @@
   if( hctx->key.resource.value.counter <= 1 ) return ak_error_message( ak_error_low_key_resource,
                                             __func__, "using hmac key context with low resource" );
                       /* нам надо два раза использовать ключ => ресурс должен быть не менее двух */
-  if( hctx->ctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
-                                            __func__, "using hash function with huge block size" );
-
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->ctx.bsize, hctx->key.key.size );
-  for( idx = 0; idx < len; idx++ ) {
-     buffer[idx] = ((ak_uint8 *)hctx->key.key.data)[idx] ^ 0x36;
-     buffer[idx] ^= ((ak_uint8 *)hctx->key.mask.data)[idx];
-  }
-  for( ; idx < hctx->ctx.bsize; idx++ ) buffer[idx] = 0x36;
-
- /* инициализируем начальное состояние контекста хеширования */
-  if(( error = hctx->ctx.clean( &hctx->ctx )) != ak_error_ok )
-    return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-
- /* обновляем состояние контекста хеширования */
-  if(( error = hctx->ctx.update( &hctx->ctx, buffer, hctx->ctx.bsize )) != ak_error_ok )
-    ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
 
- /* очищаем буффер */
-  ak_ptr_wipe( buffer, sizeof( buffer ), &hctx->key.generator, ak_true );
+ /* при первом использовании ключа вычисляем начальные состояния функции хеширования */
+  if( !((hctx->key.flags)&hmac_flag_states_set ))
+    if(( error = ak_hmac_context_set_states( hctx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect calculation of hash function states" );
 
- /* перемаскируем ключ и меняем его ресурс */
-  hctx->key.set_mask( &hctx->key );
+ /* состояние после обработки ключа, сложенного с ipad */
+  memcpy( hctx->ctx.data, hctx->states, hctx->ctx.dsize );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  return error;
@@ -313,11 +376,9 @@
                                                                const size_t size, ak_pointer out )
 {
   int error = ak_error_ok;
-  size_t idx = 0, len = 0;
   ak_hmac hctx = ( ak_hmac ) ctx;
   ak_buffer result = NULL;
-  ak_uint8 temporary[128]; /* первый буффер для хранения промежуточных значений */
-  ak_uint8 keybuffer[128]; /* второй буффер для хранения промежуточных значений */
+  ak_uint8 temporary[128]; /* буффер для хранения промежуточных значений */
 
  /* выполняем проверки */
   if( hctx == NULL ) {
@@ -350,29 +411,15 @@
     return NULL;
   }
 
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->ctx.bsize, hctx->key.key.size );
-  for( idx = 0; idx < len; idx++ ) {
-     keybuffer[idx] = ((ak_uint8 *)hctx->key.key.data)[idx] ^ 0x5C;
-     keybuffer[idx] ^= ((ak_uint8 *)hctx->key.mask.data)[idx];
-  }
-  for( ; idx < hctx->ctx.bsize; idx++ ) keybuffer[idx] = 0x5C;
-
- /* возвращаем контекст хеширования в начальное состояние */
-  if(( error = hctx->ctx.clean( &hctx->ctx )) != ak_error_ok ) {
-    ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-    return NULL;
-  }
-
- /* обновляем состояние контекста хеширования */
-  if(( error = hctx->ctx.update( &hctx->ctx, keybuffer, hctx->ctx.bsize )) != ak_error_ok )
-    ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
-
- /* очищаем буффер */
-  ak_ptr_wipe( keybuffer, sizeof( keybuffer ), &hctx->key.generator, ak_true );
+ /* при первом использовании ключа вычисляем начальные состояния функции хеширования */
+  if( !((hctx->key.flags)&hmac_flag_states_set ))
+    if(( error = ak_hmac_context_set_states( hctx )) != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect calculation of hash function states" );
+      return NULL;
+    }
 
- /* ресурс ключа */
-  hctx->key.set_mask( &hctx->key );
+ /* состояние после обработки ключа, сложенного с opad */
+  memcpy( hctx->ctx.data, hctx->states + hctx->ctx.dsize, hctx->ctx.dsize );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  /* последний update/finalize и возврат результата */
@@ -482,13 +529,287 @@
  return result;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Данные, используемые для вычисления одного блока T_i алгоритма PBKDF2. */
+ struct pbkdf2_block {
+  /*! \brief контексты функции хеширования, состояния которых совпадают с состояниями
+      после обработки ключа, сложенного с ipad и opad, соответственно */
+   ak_hash ictx, octx;
+  /*! \brief строка S||INT(i), от которой вычисляется значение U_1 */
+   ak_uint8 *data;
+  /*! \brief длина строки S||INT(i) */
+   size_t size;
+  /*! \brief накапливаемое значение T_i */
+   ak_uint64 t[8];
+  /*! \brief текущее значение U_j */
+   ak_uint64 u[8];
+  /*! \brief результат внутреннего хеширования при вычислении U_j */
+   ak_uint64 v[8];
+  /*! \brief количество начальных байт T_i, не входящих в ключевой вектор */
+   size_t skip;
+  /*! \brief количество байт T_i, помещаемых в ключевой вектор */
+   size_t length;
+  /*! \brief указатель на область памяти, в которую помещается блок T_i */
+   ak_uint8 *out;
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет блоки T_i алгоритма PBKDF2, одновременно обрабатывая все блоки
+    с помощью функции ak_hash_context_ptr_jobs().
+
+    \details Каждая итерация алгоритма сводится к двум вызовам функции хеширования нескольких
+    независимых сообщений: вначале для всех блоков вычисляются внутренние хеш-коды от значений U_{j-1},
+    затем - внешние хеш-коды, являющиеся значениями U_j. Контексты функции хеширования, указанные
+    в блоках, при этом не изменяются, что позволяет вызывать функцию из нескольких потоков
+    для непересекающихся множеств блоков.
+
+    @param blocks Массив блоков.
+    @param count Количество блоков в массиве.
+    @param cnt Количество итераций алгоритма.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_pbkdf2_blocks( struct pbkdf2_block *blocks, const size_t count, const size_t cnt )
+{
+  size_t i, j, idx;
+  int error = ak_error_ok;
+  struct hash_job *jobs = NULL;
+
+  if( !count ) return ak_error_ok;
+  if(( jobs = malloc( 2*count*sizeof( struct hash_job ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                      "incorrect memory allocation for hash jobs" );
+ /* внутренние задания хешируют строки S||INT(i), внешние - результаты внутренних заданий */
+  for( i = 0; i < count; i++ ) {
+     jobs[i].ctx = blocks[i].ictx;
+     jobs[i].in = blocks[i].data;
+     jobs[i].size = blocks[i].size;
+     jobs[i].out = blocks[i].v;
+     jobs[count+i].ctx = blocks[i].octx;
+     jobs[count+i].in = blocks[i].v;
+     jobs[count+i].size = 64;
+     jobs[count+i].out = blocks[i].u;
+  }
+
+ /* вычисляем значения U_1 */
+  if((( error = ak_hash_context_ptr_jobs( jobs, count )) != ak_error_ok ) ||
+     (( error = ak_hash_context_ptr_jobs( jobs+count, count )) != ak_error_ok )) {
+    ak_error_message( error, __func__, "incorrect calculation of first pbkdf2 iteration" );
+    goto lab_exit;
+  }
+  for( i = 0; i < count; i++ ) {
+     memcpy( blocks[i].t, blocks[i].u, 64 );
+     jobs[i].in = blocks[i].u; /* далее внутренние задания хешируют значения U_{j-1} */
+     jobs[i].size = 64;
+  }
+
+ /* теперь основной цикл по значению аргумента c */
+  for( idx = 1; idx < cnt; idx++ ) {
+     if((( error = ak_hash_context_ptr_jobs( jobs, count )) != ak_error_ok ) ||
+        (( error = ak_hash_context_ptr_jobs( jobs+count, count )) != ak_error_ok )) {
+       ak_error_message( error, __func__, "incorrect calculation of pbkdf2 iteration" );
+       goto lab_exit;
+     }
+     for( i = 0; i < count; i++ )
+        for( j = 0; j < 8; j++ ) blocks[i].t[j] ^= blocks[i].u[j];
+  }
+  for( i = 0; i < count; i++ )
+     memcpy( blocks[i].out, (ak_uint8 *)blocks[i].t + blocks[i].skip, blocks[i].length );
+
+  lab_exit: free( jobs );
+ return error;
+}
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Параметры одного потока, вычисляющего часть блоков алгоритма PBKDF2. */
+ struct pbkdf2_worker {
+  /*! \brief указатель на первый блок, обрабатываемый потоком */
+   struct pbkdf2_block *blocks;
+  /*! \brief количество блоков, обрабатываемых потоком */
+   size_t count;
+  /*! \brief количество итераций алгоритма */
+   size_t cnt;
+  /*! \brief код ошибки, возникшей при обработке блоков */
+   int error;
+  /*! \brief идентификатор потока */
+   pthread_t thread;
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param arg указатель на структуру struct pbkdf2_worker
+    @return Функция всегда возвращает NULL.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_hmac_pbkdf2_worker( void *arg )
+{
+  struct pbkdf2_worker *worker = ( struct pbkdf2_worker *) arg;
+
+  worker->error = ak_hmac_pbkdf2_blocks( worker->blocks, worker->count, worker->cnt );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет блоки T_i алгоритма PBKDF2 с использованием нескольких потоков.
+
+    \details Блоки разбиваются на последовательные группы, первая из которых обрабатывается
+    вызывающим потоком, а остальные - отдельными потоками. Количество потоков определяется
+    опцией библиотеки `pbkdf2_threads_count`; нулевое значение опции означает количество
+    доступных процессоров. Если поток создать не удалось, соответствующая группа блоков
+    обрабатывается вызывающим потоком.
+
+    @param blocks Массив блоков.
+    @param count Количество блоков в массиве.
+    @param cnt Количество итераций алгоритма.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_pbkdf2_threads( struct pbkdf2_block *blocks, const size_t count,
+                                                                                const size_t cnt )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  int error = ak_error_ok;
+  struct pbkdf2_worker *workers = NULL;
+  bool_t *started = NULL;
+  size_t i, threads = ( size_t )ak_libakrypt_get_option( "pbkdf2_threads_count" );
+
+  if( threads == 0 ) {
+   #ifdef LIBAKRYPT_HAVE_UNISTD_H
+    long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+    threads = cpus > 0 ? ( size_t )cpus : 1;
+   #else
+    threads = 1;
+   #endif
+  }
+  if(( threads = ak_min( threads, count )) < 2 ) goto lab_serial;
+  if(( workers = calloc( threads, sizeof( struct pbkdf2_worker ))) == NULL ) goto lab_serial;
+  if(( started = calloc( threads, sizeof( bool_t ))) == NULL ) { free( workers ); goto lab_serial; }
+
+ /* группы блоков, кроме первой, передаются отдельным потокам */
+  for( i = 0; i < threads; i++ ) {
+     workers[i].blocks = blocks + i*count/threads;
+     workers[i].count = ( i+1 )*count/threads - i*count/threads;
+     workers[i].cnt = cnt;
+     if( i == 0 ) continue;
+     if( pthread_create( &workers[i].thread, NULL, ak_hmac_pbkdf2_worker, &workers[i] ) == 0 )
+       started[i] = ak_true;
+  }
+
+ /* первая группа обрабатывается вызывающим потоком */
+  error = ak_hmac_pbkdf2_blocks( workers[0].blocks, workers[0].count, cnt );
+
+ /* дожидаемся завершения потоков и обрабатываем группы, для которых поток не был создан */
+  for( i = 1; i < threads; i++ ) {
+     if( started[i] ) pthread_join( workers[i].thread, NULL );
+      else ak_hmac_pbkdf2_worker( &workers[i] );
+     if( workers[i].error != ak_error_ok ) error = workers[i].error;
+  }
+
+  free( workers );
+  free( started );
+ return error;
+
+  lab_serial:
+#endif
+ return ak_hmac_pbkdf2_blocks( blocks, count, cnt );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция подготавливает контексты функции хеширования, состояния которых совпадают
+    с состояниями после обработки ключа алгоритма HMAC, сложенного с ipad и opad.
+
+    \details Контексты `ictx` и `octx` являются копиями контекста функции хеширования
+    алгоритма HMAC, внутренние данные которых указывают на вычисленные для ключа состояния;
+    они не должны уничтожаться и могут использоваться, пока существует контекст `hctx`.
+    Ресурс ключа уменьшается на количество использований ключа при вычислении `uses`
+    значений алгоритма HMAC.
+
+    @param hctx Контекст алгоритма HMAC с установленным значением ключа.
+    @param uses Количество вычисляемых значений алгоритма HMAC.
+    @param ictx Контекст, в который помещается состояние, соответствующее ipad.
+    @param octx Контекст, в который помещается состояние, соответствующее opad.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_context_pbkdf2_states( ak_hmac hctx, const size_t uses,
+                                                                      ak_hash ictx, ak_hash octx )
+{
+  int error = ak_error_ok;
+
+  if(( hctx->key.resource.value.counter <= 0 ) ||
+                               (( size_t )hctx->key.resource.value.counter/2 < uses ))
+    return ak_error_message( ak_error_low_key_resource,
+                                            __func__, "using hmac key context with low resource" );
+  if( !((hctx->key.flags)&hmac_flag_states_set ))
+    if(( error = ak_hmac_context_set_states( hctx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect calculation of hash function states" );
+  hctx->key.resource.value.counter -= ( ssize_t )( 2*uses );
+
+  memcpy( ictx, &hctx->ctx, sizeof( struct hash ));
+  ictx->data = hctx->states;
+  memcpy( octx, &hctx->ctx, sizeof( struct hash ));
+  octx->data = hctx->states + hctx->ctx.dsize;
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция заполняет блоки T_1, ..., T_l, из которых составляется один ключевой вектор.
+
+    @param blocks Массив из l = ceil( dklen/64 ) блоков.
+    @param ictx Контекст функции хеширования, соответствующий ipad.
+    @param octx Контекст функции хеширования, соответствующий opad.
+    @param salt Инициализационный вектор.
+    @param salt_size Размер инициализационного вектора в байтах.
+    @param data Область памяти размером l*( salt_size + 4 ) байт для строк S||INT(i).
+    @param dklen Длина вырабатываемого ключевого вектора в байтах.
+    @param out Указатель на область памяти для ключевого вектора.                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hmac_pbkdf2_set_blocks( struct pbkdf2_block *blocks, ak_hash ictx, ak_hash octx,
+                        const ak_pointer salt, const size_t salt_size, ak_uint8 *data,
+                                                               const size_t dklen, ak_pointer out )
+{
+  size_t i, l = ( dklen + 63 ) >> 6;
+  ak_uint8 *ptr = out;
+
+  for( i = 0; i < l; i++ ) {
+     blocks[i].ictx = ictx;
+     blocks[i].octx = octx;
+     blocks[i].data = data + i*( salt_size + 4 );
+     blocks[i].size = salt_size + 4;
+     if( salt_size ) memcpy( blocks[i].data, salt, salt_size );
+    /* номер блока записывается в формате big-endian */
+     blocks[i].data[salt_size]   = ( ak_uint8 )(( i+1 ) >> 24 );
+     blocks[i].data[salt_size+1] = ( ak_uint8 )(( i+1 ) >> 16 );
+     blocks[i].data[salt_size+2] = ( ak_uint8 )(( i+1 ) >> 8 );
+     blocks[i].data[salt_size+3] = ( ak_uint8 )( i+1 );
+    /* при dklen <= 64 берутся последние байты T_1, иначе - первые dklen байт T_1||...||T_l */
+     if( l == 1 ) {
+       blocks[i].skip = 64 - dklen;
+       blocks[i].length = dklen;
+     } else {
+         blocks[i].skip = 0;
+         blocks[i].length = ( i+1 < l ) ? 64 : dklen - ( i << 6 );
+       }
+     blocks[i].out = ptr;
+     ptr += blocks[i].length;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вырабатывает ключевой вектор из заданного пользователем пароля и инициализационного
     вектора в соответствии с алгоритмом, описанным в отечественных рекомендациях Р 50.1.111-2016.
     При выработке используется алгоритм hmac-streebog512.
 
     Пароль должен представлять собой ненулевую строку символов в utf8
-    кодировке. Размер вырабатываемого ключевого вектора может колебаться от 32-х до 64-х байт.
+    кодировке. Размер вырабатываемого ключевого вектора должен быть не менее 32-х байт.
+
+    Если длина ключевого вектора не превосходит 64-х байт, то в качестве результата
+    используются последние dklen байт значения T_1. В противном случае вычисляются
+    l = ceil( dklen/64 ) независимых значений T_1, ..., T_l, а результатом, как и в
+    Р 50.1.111-2016 (RFC 9337), являются первые dklen байт строки T_1||...||T_l. Значения T_i вычисляются одновременно с помощью
+    функции хеширования нескольких независимых сообщений; при наличии нескольких процессоров
+    блоки распределяются между потоками (см. опцию библиотеки `pbkdf2_threads_count`).
 
     @param pass Пароль, строка символов в utf8 кодировке.
     @param pass_size Размер пароля в байтах, должен быть отличен от нуля.
@@ -498,8 +819,8 @@
     @param cnt Параметр, определяющий количество однотипных итераций для выработки ключа; данный
     параметр определяет время работы алгоритма; параметр не является секретным и может храниться или
     передаваться в открытом виде.
-    @param dklen Длина вырабатываемого ключевого вектора в байтах, величина должна принимать
-    значение от 32-х до 64-х.
+    @param dklen Длина вырабатываемого ключевого вектора в байтах, величина должна быть
+    не менее 32-х.
     @param out Указатель на массив, куда будет помещен результат; под данный массив должна быть
     заранее выделена память не менее, чем dklen байт.
 
@@ -510,11 +831,12 @@
          const size_t pass_size, const ak_pointer salt, const size_t salt_size, const size_t cnt,
                                                                const size_t dklen, ak_pointer out )
 {
-  struct mac ictx;
   struct hmac hctx;
-  ak_uint8 result[64];
+  struct hash ictx, octx;
+  ak_uint8 *data = NULL;
   int error = ak_error_ok;
-  size_t idx = 0, jdx = 0;
+  struct pbkdf2_block *blocks = NULL;
+  size_t l = ( dklen + 63 ) >> 6;
 
  /* в начале, многочисленные проверки входных параметров */
   if( pass == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
@@ -523,10 +845,13 @@
                                                                    "using a zero length password" );
   if( salt == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                                      "using null pointer to salt" );
-  if(( dklen < 32 ) || ( dklen > 64 )) return ak_error_message( ak_error_wrong_length,
+  if(( dklen < 32 ) || ( l > 0xFFFFFFFFLL )) return ak_error_message( ak_error_wrong_length,
                                        __func__ , "using a wrong length for resulting key vector" );
   if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                      "using null pointer to resulting key vector" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_pbkdf2 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using pbkdf2 after unsuccessful self test" );
  /* создаем контекст алгоритма hmac и определяем его ключ */
   if(( error = ak_hmac_context_create_streebog512( &hctx )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong creation of hmac-streebog512 key context" );
@@ -535,43 +860,144 @@
     goto lab_exit;
   }
 
- /* начальная инициализация промежуточного вектора */
-  memset( result, 0, 64 );
-  result[3] = 1;
-
-  if(( error = ak_mac_context_create_hmac( &ictx, &hctx )) != ak_error_ok ) {
-    ak_error_message( error, __func__, "wrong creation of mac key context" );
+ /* вычисляем начальные состояния и подготавливаем блоки T_1, ..., T_l */
+  if((( blocks = calloc( l, sizeof( struct pbkdf2_block ))) == NULL ) ||
+     (( data = malloc( l*( salt_size + 4 ))) == NULL )) {
+    ak_error_message( error = ak_error_out_of_memory, __func__,
+                                                     "incorrect memory allocation for pbkdf2 blocks" );
     goto lab_exit;
   }
-
- /* вычисляем значение первой строки U1  */
-  if(( error = ak_mac_context_clean( &ictx )) != ak_error_ok ) {
-    ak_mac_context_destroy( &ictx );
-    ak_error_message( error, __func__, "incorrect cleaning of internal mac context");
+  if(( error = ak_hmac_context_pbkdf2_states( &hctx,
+                                           l*ak_max( cnt, 1 ), &ictx, &octx )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect initialization of hmac-streebog512 states" );
     goto lab_exit;
   }
-  if(( error = ak_mac_context_update( &ictx, salt, salt_size )) != ak_error_ok ) {
-    ak_mac_context_destroy( &ictx );
-    ak_error_message( error, __func__, "incorrect updating of internal mac context");
-    goto lab_exit;
+  ak_hmac_pbkdf2_set_blocks( blocks, &ictx, &octx, salt, salt_size, data, dklen, out );
+  if(( error = ak_hmac_pbkdf2_threads( blocks, l, cnt )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect calculation of pbkdf2 blocks" );
+
+  lab_exit:
+   if( blocks != NULL ) {
+     ak_ptr_wipe( blocks, l*sizeof( struct pbkdf2_block ), &hctx.key.generator, ak_true );
+     free( blocks );
+   }
+   if( data != NULL ) free( data );
+   ak_hmac_context_destroy( &hctx );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает ключевые векторы для нескольких пар (пароль, инициализационный вектор)
+    в соответствии с алгоритмом, описанным в Р 50.1.111-2016. Результат для каждого задания
+    совпадает с результатом вызова функции ak_hmac_context_pbkdf2_streebog512() с теми же
+    значениями параметров `cnt` и `dklen`.
+
+    Значения T_i всех заданий вычисляются одновременно: каждая итерация алгоритма выполняется
+    для всех блоков двумя вызовами функции хеширования нескольких независимых сообщений,
+    а при наличии нескольких процессоров блоки распределяются между потоками
+    (см. опцию библиотеки `pbkdf2_threads_count`). Функция предназначена для массовой
+    выработки ключей, например, для повторной выработки ключей KEK или проверки большого количества
+    паролей.
+
+    @param jobs Массив заданий.
+    @param count Количество заданий в массиве.
+    @param cnt Количество итераций алгоритма, общее для всех заданий.
+    @param dklen Длина вырабатываемых ключевых векторов в байтах, величина должна быть
+    не менее 32-х.
+
+    @return В случае успешной обработки всех заданий функция возвращает \ref ak_error_ok (ноль).
+    В противном случае возвращается код последней из возникших ошибок; код ошибки для каждого
+    задания помещается в поле `error` задания.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hmac_context_pbkdf2_streebog512_jobs( ak_pbkdf2_job jobs, const size_t count,
+                                                              const size_t cnt, const size_t dklen )
+{
+  size_t i, n = 0, size = 0, l = ( dklen + 63 ) >> 6;
+  int error = ak_error_ok, status = ak_error_ok;
+  struct hmac *keys = NULL;
+  struct hash *states = NULL;
+  struct pbkdf2_block *blocks = NULL;
+  ak_uint8 *data = NULL, *ptr = NULL;
+
+  if( jobs == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                "using null pointer to pbkdf2 jobs" );
+  if(( dklen < 32 ) || ( l > 0xFFFFFFFFLL )) return ak_error_message( ak_error_wrong_length,
+                                       __func__ , "using a wrong length for resulting key vector" );
+  if( !count ) return ak_error_ok;
+  if(( error = ak_libakrypt_self_test( ak_self_test_pbkdf2 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using pbkdf2 after unsuccessful self test" );
+
+ /* проверяем параметры заданий и определяем объем памяти для строк S||INT(i) */
+  for( i = 0; i < count; i++ ) {
+     ak_pbkdf2_job job = jobs+i;
+     job->error = ak_error_ok;
+     if(( job->pass == NULL ) || ( job->salt == NULL ) || ( job->out == NULL ))
+       error = job->error = ak_error_message( ak_error_null_pointer, __func__ ,
+                                                               "using null pointer in pbkdf2 job" );
+      else if( !job->pass_size )
+        error = job->error = ak_error_message( ak_error_wrong_length, __func__ ,
+                                                                    "using a zero length password" );
+       else size += l*( job->salt_size + 4 );
   }
-  ak_mac_context_finalize( &ictx, result, 4, result );
-  if(( error = ak_error_get_value( )) != ak_error_ok ) {
-    ak_mac_context_destroy( &ictx );
-    ak_error_message( error, __func__, "incorrect finalizing of internal mac context");
+  if( !size ) return error;
+
+  if((( keys = calloc( count, sizeof( struct hmac ))) == NULL ) ||
+     (( states = calloc( 2*count, sizeof( struct hash ))) == NULL ) ||
+     (( blocks = calloc( count*l, sizeof( struct pbkdf2_block ))) == NULL ) ||
+     (( data = malloc( size )) == NULL )) {
+    ak_error_message( error = ak_error_out_of_memory, __func__,
+                                                     "incorrect memory allocation for pbkdf2 jobs" );
+    for( i = 0; i < count; i++ )
+       if( jobs[i].error == ak_error_ok ) jobs[i].error = error;
     goto lab_exit;
   }
-  ak_mac_context_destroy( &ictx );
-  memcpy( out, result+64-dklen, dklen );
 
- /* теперь основной цикл по значению аргумента c */
-  for( idx = 1; idx < cnt; idx++ ) {
-     ak_hmac_context_ptr( &hctx, result, 64, result );
-     for( jdx = 0; jdx < dklen; jdx++ ) ((ak_uint8 *)out)[jdx] ^= result[64-dklen+jdx];
+ /* для каждого задания создаем ключ и подготавливаем блоки T_1, ..., T_l */
+  for( i = 0, ptr = data; i < count; i++ ) {
+     ak_pbkdf2_job job = jobs+i;
+     if( job->error != ak_error_ok ) continue;
+     if(( job->error = ak_hmac_context_create_streebog512( keys+i )) != ak_error_ok ) {
+       error = ak_error_message( job->error, __func__,
+                                                 "wrong creation of hmac-streebog512 key context" );
+       continue;
+     }
+     if((( job->error = ak_hmac_context_set_key( keys+i,
+                                       job->pass, job->pass_size, ak_true )) != ak_error_ok ) ||
+        (( job->error = ak_hmac_context_pbkdf2_states( keys+i,
+                         l*ak_max( cnt, 1 ), states+2*i, states+2*i+1 )) != ak_error_ok )) {
+       error = ak_error_message( job->error, __func__,
+                                           "wrong initialization of hmac-streebog512 secret key" );
+       ak_hmac_context_destroy( keys+i );
+       continue;
+     }
+     ak_hmac_pbkdf2_set_blocks( blocks+n, states+2*i, states+2*i+1,
+                                                  job->salt, job->salt_size, ptr, dklen, job->out );
+     ptr += l*( job->salt_size + 4 );
+     n += l;
   }
-  memset( result, 0, 64 );
 
-  lab_exit: ak_hmac_context_destroy( &hctx );
+ /* вычисляем блоки всех заданий */
+  if(( status = ak_hmac_pbkdf2_threads( blocks, n, cnt )) != ak_error_ok ) {
+    error = ak_error_message( status, __func__, "incorrect calculation of pbkdf2 blocks" );
+    for( i = 0; i < count; i++ )
+       if( jobs[i].error == ak_error_ok ) jobs[i].error = error;
+  }
+ /* очищаем блоки с помощью генератора первого из созданных ключей и уничтожаем ключи
+    (память под состояния выделяется только при создании ключа) */
+  for( i = 0; i < count; i++ )
+     if( keys[i].states != NULL ) {
+       if( n ) {
+         ak_ptr_wipe( blocks, n*sizeof( struct pbkdf2_block ), &keys[i].key.generator, ak_true );
+         n = 0;
+       }
+       ak_hmac_context_destroy( keys+i );
+     }
+
+  lab_exit:
+   if( blocks != NULL ) free( blocks );
+   if( data != NULL ) free( data );
+   if( states != NULL ) free( states );
+   if( keys != NULL ) free( keys );
  return error;
 }
 
@@ -702,12 +1128,24 @@
    0x78, 0xcc, 0xb8, 0x79, 0xf6, 0x70, 0x68, 0xcd, 0xac, 0x19, 0x10, 0x74, 0x08, 0x44, 0xe8, 0x30
   };
 
+  ak_uint8 R5[100] = {
+   0xb2, 0xd8, 0xf1, 0x24, 0x5f, 0xc4, 0xd2, 0x92, 0x74, 0x80, 0x20, 0x57, 0xe4, 0xb5, 0x4e, 0x0a,
+   0x07, 0x53, 0xaa, 0x22, 0xfc, 0x53, 0x76, 0x0b, 0x30, 0x1c, 0xf0, 0x08, 0x67, 0x9e, 0x58, 0xfe,
+   0x4b, 0xee, 0x9a, 0xdd, 0xca, 0xe9, 0x9b, 0xa2, 0xb0, 0xb2, 0x0f, 0x43, 0x1a, 0x9c, 0x5e, 0x50,
+   0xf3, 0x95, 0xc8, 0x93, 0x87, 0xd0, 0x94, 0x5a, 0xed, 0xec, 0xa6, 0xeb, 0x40, 0x15, 0xdf, 0xc2,
+   0xbd, 0x24, 0x21, 0xee, 0x9b, 0xb7, 0x11, 0x83, 0xba, 0x88, 0x2c, 0xee, 0xbf, 0xef, 0x25, 0x9f,
+   0x33, 0xf9, 0xe2, 0x7d, 0xc6, 0x17, 0x8c, 0xb8, 0x9d, 0xc3, 0x74, 0x28, 0xcf, 0x9c, 0xc5, 0x2a,
+   0x2b, 0xaa, 0x2d, 0x3a
+  };
+
   ak_uint8 password_one[8] = "password",
            password_two[9] = { 'p', 'a', 's', 's', 0, 'w', 'o', 'r', 'd' },
            salt_one[4]     = "salt",
-           salt_two[5]     = { 's', 'a', 0, 'l', 't' };
+           salt_two[5]     = { 's', 'a', 0, 'l', 't' },
+           password_three[24] = "passwordPASSWORDpassword",
+           salt_three[36]  = "saltSALTsaltSALTsaltSALTsaltSALTsalt";
 
-  ak_uint8 out[64];
+  ak_uint8 out[100];
   char *str = NULL;
   int error = ak_error_ok;
   int audit = ak_log_get_level();
@@ -776,6 +1214,22 @@
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                                              "the 4th test for pbkdf2 from R 50.1.111-2016 is Ok" );
 
+ /* пятый тест из Р 50.1.111-2016 (ключевой вектор длины 100 байт) */
+  if(( error = ak_hmac_context_pbkdf2_streebog512( password_three, 24,
+                                               salt_three, 36, 4096, 100, out )) != ak_error_ok ) {
+    ak_error_message( error,__func__, "incorrect transformation password to key");
+    return ak_false;
+  }
+  if( !ak_ptr_is_equal( out, R5, 100 )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                                 "wrong 5th test for pbkdf2 from R 50.1.111-2016" );
+    ak_log_set_message( str = ak_ptr_to_hexstr( out, 100, ak_false )); free( str );
+    ak_log_set_message( str = ak_ptr_to_hexstr( R5, 100, ak_false )); free( str );
+    return ak_false;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
+                                             "the 5th test for pbkdf2 from R 50.1.111-2016 is Ok" );
+
  return ak_true;
 }
 
@@ -31,6 +31,10 @@
   struct skey key;
  /*! \brief контекст функции хеширования */
   struct hash ctx;
+ /*! \brief внутренние данные функции хеширования после обработки ключа, сложенного с ipad,
+     и (следом за ними) после обработки ключа, сложенного с opad; данные вычисляются однократно
+     для каждого значения ключа */
+  ak_uint8 *states;
 } *ak_hmac;
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -70,6 +74,28 @@
 /*! \brief Развертка ключевого вектора из пароля (согласно Р 50.1.111-2016, раздел 4) */
  int ak_hmac_context_pbkdf2_streebog512( const ak_pointer , const size_t ,
                    const ak_pointer , const size_t, const size_t , const size_t , ak_pointer );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание на выработку ключевого вектора из одной пары (пароль, соль), используемое
+    при пакетной выработке большого количества ключевых векторов. */
+ typedef struct pbkdf2_job {
+  /*! \brief Пароль. */
+   ak_pointer pass;
+  /*! \brief Длина пароля (в байтах). */
+   size_t pass_size;
+  /*! \brief Инициализационный вектор (соль). */
+   ak_pointer salt;
+  /*! \brief Длина инициализационного вектора (в байтах). */
+   size_t salt_size;
+  /*! \brief Область памяти, в которую помещается выработанный ключевой вектор. */
+   ak_pointer out;
+  /*! \brief Код ошибки, возникшей при обработке данного задания. */
+   int error;
+} *ak_pbkdf2_job;
+
+/*! \brief Пакетная развертка ключевых векторов из нескольких паролей. */
+ int ak_hmac_context_pbkdf2_streebog512_jobs( ak_pbkdf2_job , const size_t ,
+                                                                   const size_t , const size_t );
 /*! \brief Тестирование алгоритмов выработки имитовставки HMAC с отечественными
     функциями хеширования семейства Стрибог (ГОСТ Р 34.11-2012). */
  bool_t ak_hmac_test_streebog( void );
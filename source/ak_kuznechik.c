@@ -15,6 +15,9 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+ #include <immintrin.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <ak_tools.h>
@@ -22,10 +25,61 @@
  #include <ak_parameters.h>
 
 /* ---------------------------------------------------------------------------------------------- */
+#ifdef LIBAKRYPT_HAVE_KUZNECHIK_TABLES
+/* таблицы выработаны при сборке библиотеки и размещаются в сегменте констант */
+ #include <ak_kuznechik_tables.h>
+#else
 /*! \brief Таблицы, используемые для реализации алгоритма зашифрования одного блока. */
  static ak_uint64 ak_kuznechik_encryption_matrix[16][256][2];
 /*! \brief Таблицы, используемые для реализации алгоритма расшифрования одного блока. */
  static ak_uint64 ak_kuznechik_decryption_matrix[16][256][2];
+/*! \brief Итерационные константы процедуры развертки ключа \f$ C_i = L(i) \f$, \f$ 1 \leq i \leq 32\f$. */
+ static ak_uint64 ak_kuznechik_round_constants[32][2];
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+/*! \brief Коэффициенты линейного регистра сдвига, отличные от единицы (каждый, кроме последнего,
+    встречается в векторе коэффициентов дважды). */
+ static const ak_uint8 ak_kuznechik_vector_lvec[7] = { 0x94, 0x20, 0x85, 0x10, 0xC2, 0xC0, 0xFB };
+/*! \brief Таблицы умножения на коэффициенты линейного регистра сдвига,
+    используемые векторной реализацией.
+    \details Элемент `[c][0][n]` содержит произведение \f$ \ell_c \cdot n \f$,
+    элемент `[c][1][n]` -- произведение \f$ \ell_c \cdot 16n \f$, где \f$ 0 \leq n < 16 \f$. */
+ static ak_uint8 ak_kuznechik_vector_lmul[7][2][16];
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+/*! \brief Матрицы умножения на коэффициенты линейного регистра сдвига для инструкции
+    `gf2p8affineqb`: умножение на константу в поле \f$ \mathbb F_{2^8} \f$ является
+    линейным отображением над \f$ \mathbb F_2 \f$. */
+ static ak_uint64 ak_kuznechik_vector_lmat[7];
+#endif
+#endif
+#endif
+
+/*! \brief Функции зашифрования и расшифрования одного и нескольких блоков, выбранные при
+    инициализации библиотеки в зависимости от возможностей процессора. */
+ static ak_function_bckey_blocks *ak_kuznechik_encrypt_blocks = NULL;
+ static ak_function_bckey_blocks *ak_kuznechik_decrypt_blocks = NULL;
+ static ak_function_bckey *ak_kuznechik_encrypt = NULL;
+ static ak_function_bckey *ak_kuznechik_decrypt = NULL;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_encrypt_round( ak_uint64 * );
+ static void ak_kuznechik_encrypt_with_mask( ak_skey , ak_pointer , ak_pointer );
+ static void ak_kuznechik_decrypt_with_mask( ak_skey , ak_pointer , ak_pointer );
+ static void ak_kuznechik_encrypt_blocks_with_mask( ak_skey , ak_pointer , ak_pointer , size_t );
+ static void ak_kuznechik_decrypt_blocks_with_mask( ak_skey , ak_pointer , ak_pointer , size_t );
+#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+ static void ak_kuznechik_encrypt_ssse3( ak_skey , ak_pointer , ak_pointer );
+ static void ak_kuznechik_decrypt_ssse3( ak_skey , ak_pointer , ak_pointer );
+ static void ak_kuznechik_transform_ssse3( ak_uint64 * , ak_uint64 * , const bool_t );
+ static void ak_kuznechik_encrypt_blocks_ssse3( ak_skey , ak_pointer , ak_pointer , size_t );
+ static void ak_kuznechik_decrypt_blocks_ssse3( ak_skey , ak_pointer , ak_pointer , size_t );
+ static void ak_kuznechik_encrypt_blocks_avx2( ak_skey , ak_pointer , ak_pointer , size_t );
+ static void ak_kuznechik_decrypt_blocks_avx2( ak_skey , ak_pointer , ak_pointer , size_t );
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+ static void ak_kuznechik_encrypt_blocks_avx512( ak_skey , ak_pointer , ak_pointer , size_t );
+ static void ak_kuznechik_decrypt_blocks_avx512( ak_skey , ak_pointer , ak_pointer , size_t );
+#endif
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Развернутые раундовые ключи и маски алгоритма Кузнечик.
@@ -37,6 +91,7 @@
       - маски для раундовых ключей алгоритма расшифрования. */
  typedef ak_uint64 ak_kuznechik_expanded_keys[80];
 
+#ifndef LIBAKRYPT_HAVE_KUZNECHIK_TABLES
 /* ---------------------------------------------------------------------------------------------- */
 /*! \brief Функция умножает два элемента конечного поля \f$\mathbb F_{2^8}\f$, определенного
      согласно ГОСТ Р 34.12-2015.                                                                  */
@@ -52,9 +107,33 @@
  return z;
 }
 
+/* ---------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует линейное преобразование L согласно ГОСТ Р 34.12-2015
+    (шестнадцать тактов работы линейного регистра сдвига).                                        */
+/* ---------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_linear_steps( ak_uint8 *w  )
+{
+  int i = 0, j = 0;
+  const ak_uint8 kuz_lvec[16] = {
+    0x01, 0x94, 0x20, 0x85, 0x10, 0xC2, 0xC0, 0x01, 0xFB, 0x01, 0xC0, 0xC2, 0x10, 0x85, 0x20, 0x94
+  };
+
+  for( j = 0; j < 16; j++ ) {
+     ak_uint8 z = w[0];
+     for( i = 1; i < 16; i++ ) {
+        w[i-1] = w[i];
+        z ^= ak_kuznechik_mul_gf256( w[i], kuz_lvec[i] );
+     }
+     w[15] = z;
+  }
+}
+
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_bckey_init_kuznechik_tables( void )
 {
+#ifndef LIBAKRYPT_HAVE_KUZNECHIK_TABLES
   int i, j, l;
   for( i = 0; i < 16; i++ ) {
       for( j = 0; j < 256; j++ ) {
@@ -67,44 +146,104 @@
          memcpy( ak_kuznechik_decryption_matrix[i][j], ib, 16 );
       }
   }
-  if( ak_log_get_level() >= ak_log_maximum )
+
+ /* вычисляем итерационные константы процедуры развертки ключа */
+  for( i = 0; i < 32; i++ ) {
+    #ifdef LIBAKRYPT_LITTLE_ENDIAN
+     ak_kuznechik_round_constants[i][0] = ( ak_uint64 )( i+1 );
+    #else
+     ak_kuznechik_round_constants[i][0] = bswap_64( ( ak_uint64 )( i+1 ));
+    #endif
+     ak_kuznechik_round_constants[i][1] = 0;
+     ak_kuznechik_linear_steps(( ak_uint8 *)ak_kuznechik_round_constants[i] );
+  }
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+  for( i = 0; i < 7; i++ )
+     for( l = 0; l < 16; l++ ) {
+        ak_kuznechik_vector_lmul[i][0][l] =
+                        ak_kuznechik_mul_gf256( ak_kuznechik_vector_lvec[i], (ak_uint8) l );
+        ak_kuznechik_vector_lmul[i][1][l] =
+                        ak_kuznechik_mul_gf256( ak_kuznechik_vector_lvec[i], (ak_uint8)( l << 4 ));
+     }
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+ /* строка с номером 7-j матрицы задает входные биты, от которых зависит j-й бит произведения */
+  for( i = 0; i < 7; i++ ) {
+     ak_kuznechik_vector_lmat[i] = 0;
+     for( j = 0; j < 8; j++ )
+        for( l = 0; l < 8; l++ )
+           if(( ak_kuznechik_mul_gf256( ak_kuznechik_vector_lvec[i], (ak_uint8)( 1 << l )) >> j )&1 )
+             ak_kuznechik_vector_lmat[i] ^= (( ak_uint64 )1 ) << ( 8*( 7-j ) + l );
+  }
+#endif
+#endif
+#endif
+
+ /* выбираем реализацию; одиночные блоки обрабатываются векторной реализацией только
+    при ненулевом значении опции kuznechik_constant_time */
+  ak_kuznechik_encrypt = ak_kuznechik_encrypt_with_mask;
+  ak_kuznechik_decrypt = ak_kuznechik_decrypt_with_mask;
+  ak_kuznechik_encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask;
+  ak_kuznechik_decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask;
+#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports( "ssse3" )) {
+    if( ak_libakrypt_get_option( "kuznechik_constant_time" )) {
+      ak_kuznechik_encrypt = ak_kuznechik_encrypt_ssse3;
+      ak_kuznechik_decrypt = ak_kuznechik_decrypt_ssse3;
+    }
+    ak_kuznechik_encrypt_blocks = ak_kuznechik_encrypt_blocks_ssse3;
+    ak_kuznechik_decrypt_blocks = ak_kuznechik_decrypt_blocks_ssse3;
+  }
+  if( __builtin_cpu_supports( "avx2" )) {
+    ak_kuznechik_encrypt_blocks = ak_kuznechik_encrypt_blocks_avx2;
+    ak_kuznechik_decrypt_blocks = ak_kuznechik_decrypt_blocks_avx2;
+  }
+ #ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+  if( __builtin_cpu_supports( "avx512bw" ) && __builtin_cpu_supports( "avx512vbmi" ) &&
+                                                              __builtin_cpu_supports( "gfni" )) {
+    ak_kuznechik_encrypt_blocks = ak_kuznechik_encrypt_blocks_avx512;
+    ak_kuznechik_decrypt_blocks = ak_kuznechik_decrypt_blocks_avx512;
+  }
+ #endif
+#endif
+
+  if( ak_log_get_level() >= ak_log_maximum ) {
+   #ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+    if( ak_kuznechik_encrypt_blocks == ak_kuznechik_encrypt_blocks_avx512 )
+      ak_error_message( ak_error_ok, __func__ , "using avx512 implementation" );
+   #endif
+   #ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+    if( ak_kuznechik_encrypt_blocks == ak_kuznechik_encrypt_blocks_avx2 )
+      ak_error_message( ak_error_ok, __func__ , "using avx2 implementation" );
+    if( ak_kuznechik_encrypt_blocks == ak_kuznechik_encrypt_blocks_ssse3 )
+      ak_error_message( ak_error_ok, __func__ , "using ssse3 implementation" );
+    if( ak_kuznechik_encrypt == ak_kuznechik_encrypt_ssse3 )
+      ak_error_message( ak_error_ok, __func__ , "using ssse3 implementation for single blocks" );
+   #endif
     ak_error_message( ak_error_ok, __func__ , "initialization is Ok" );
+  }
 
  return ak_true;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция умножает вектор w на матрицу D, результат помещается в вектор x.                */
+/*! \brief Функция вычисляет значение обратного линейного преобразования \f$ L^{-1}(w) \f$,
+    результат помещается в вектор x.
+    \details Поскольку таблицы расшифрования реализуют композицию \f$ L^{-1}\pi^{-1} \f$,
+    для вычисления используются элементы таблиц с индексами \f$ \pi(w_i) \f$.                    */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_kuznechik_matrix_mul_vector( const ak_uint8 D[16][16], ak_uint8 *w, ak_uint8* x )
-{
-  int i = 0, j = 0;
-  for( i = 0; i < 16; i++ ) {
-    ak_uint8 z = ak_kuznechik_mul_gf256( D[i][0], w[0] );
-    for( j = 1; j < 16; j++ ) z ^= ak_kuznechik_mul_gf256( D[i][j], w[j] );
-    x[i] = z;
-  }
-}
-
-/* ---------------------------------------------------------------------------------------------- */
-/*! \brief Функция реализует линейное преобразование L согласно ГОСТ Р 34.12-2015
-    (шестнадцать тактов работы линейного регистра сдвига).                                        */
-/* ---------------------------------------------------------------------------------------------- */
- static void ak_kuznechik_linear_steps( ak_uint8 *w  )
+ static void ak_kuznechik_linear_inverse( ak_uint64 *w, ak_uint64 *x )
 {
-  int i = 0, j = 0;
-  const ak_uint8 kuz_lvec[16] = {
-    0x01, 0x94, 0x20, 0x85, 0x10, 0xC2, 0xC0, 0x01, 0xFB, 0x01, 0xC0, 0xC2, 0x10, 0x85, 0x20, 0x94
-  };
+  int i = 0;
+  ak_uint8 *b = ( ak_uint8 *)w;
+  ak_uint64 t = 0, s = 0;
 
-  for( j = 0; j < 16; j++ ) {
-     ak_uint8 z = w[0];
-     for( i = 1; i < 16; i++ ) {
-        w[i-1] = w[i];
-        z ^= ak_kuznechik_mul_gf256( w[i], kuz_lvec[i] );
-     }
-     w[15] = z;
+  for( i = 0; i < 16; i++ ) {
+     t ^= ak_kuznechik_decryption_matrix[i][gost_pi[b[i]]][0];
+     s ^= ak_kuznechik_decryption_matrix[i][gost_pi[b[i]]][1];
   }
+  x[0] = t; x[1] = s;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -134,6 +273,35 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет преобразование LS при развертке ключа; если выбрана векторная
+    реализация, то обращения к таблицам, зависящие от ключа, не выполняются.                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_schedule_round( ak_uint64 *x )
+{
+#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+  if( ak_kuznechik_encrypt == ak_kuznechik_encrypt_ssse3 ) {
+    ak_kuznechik_transform_ssse3( x, x, ak_false );
+    return;
+  }
+#endif
+  ak_kuznechik_encrypt_round( x );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет обратное линейное преобразование при развертке ключа.              */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_schedule_inverse( ak_uint64 *w, ak_uint64 *x )
+{
+#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+  if( ak_kuznechik_encrypt == ak_kuznechik_encrypt_ssse3 ) {
+    ak_kuznechik_transform_ssse3( w, x, ak_true );
+    return;
+  }
+#endif
+  ak_kuznechik_linear_inverse( w, x );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция реализует развертку ключей для алгоритма Кузнечик.
     \param skey Указатель на контекст секретного ключа, в который помещаются развернутые
@@ -143,8 +311,8 @@
 /* ----------------------------------------------------------------------------------------------- */
  static int ak_kuznechik_schedule_keys( ak_skey skey )
 {
-  int i = 0, j = 0, l = 0, kdx = 2;
-  ak_uint64 a0[2], a1[2], c[2], t[2], idx = 0;
+  int i = 0, j = 0, kdx = 2, idx = 0;
+  ak_uint64 a0[2], a1[2], t[2];
   ak_uint64 *ekey = NULL, *mkey = NULL, *dkey = NULL, *xkey = NULL;
 
  /* выполняем стандартные проверки */
@@ -153,12 +321,11 @@
  /* проверяем целостность ключа */
   if( skey->check_icode( skey ) != ak_true ) return ak_error_message( ak_error_wrong_key_icode,
                                                 __func__ , "using key with wrong integrity code" );
- /* удаляем былое */
-  if( skey->data != NULL ) ak_kuznechik_delete_keys( skey );
-
- /* далее, по-возможности, выделяем выравненную память */
-  if(( skey->data = ak_libakrypt_aligned_malloc( sizeof( ak_kuznechik_expanded_keys ))) == NULL )
-    return ak_error_message( ak_error_out_of_memory, __func__ ,
+ /* память под развернутые ключи выделяется только один раз, при повторной развертке
+    (например, при смене ключа в режиме ACPKM) ее содержимое полностью перезаписывается */
+  if( skey->data == NULL )
+    if(( skey->data = ak_libakrypt_aligned_malloc( sizeof( ak_kuznechik_expanded_keys ))) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__ ,
                                                              "wrong allocation of internal data" );
  /* получаем указатели на области памяти */
   ekey = ( ak_uint64 *)skey->data;                  /* 10 прямых раундовых ключей */
@@ -179,22 +346,16 @@
   dkey[0] = a1[0]^xkey[0]; dkey[1] = a1[1]^xkey[1];
 
   ekey[2] = a0[0]^mkey[2]; ekey[3] = a0[1]^mkey[3];
-  ak_kuznechik_matrix_mul_vector( Linv, (ak_uint8 *)a0, (ak_uint8 *)( dkey+2 ));
+  ak_kuznechik_schedule_inverse( a0, dkey+2 );
   dkey[2] ^= xkey[2]; dkey[3] ^= xkey[3];
 
+ /* преобразование LS в ячейке Фейстеля вычисляется с помощью таблиц зашифрования,
+                                     итерационные константы вычислены заранее */
   for( j = 0; j < 4; j++ ) {
-     for( i = 0; i < 8; i++ ) {
-      #ifdef LIBAKRYPT_LITTLE_ENDIAN
-        c[0] = ++idx; /* вычисляем константу алгоритма согласно ГОСТ Р 34.12-2015 */
-      #else
-        c[0] = bswap_64( ++idx );
-      #endif
-        c[1] = 0;
-        ak_kuznechik_linear_steps(( ak_uint8 *)c );
-
-        t[0] = a1[0] ^ c[0]; t[1] = a1[1] ^ c[1];
-        for( l = 0; l < 16; l++ ) ((ak_uint8 *)t)[l] = gost_pi[ ((ak_uint8 *)t)[l]];
-        ak_kuznechik_linear_steps(( ak_uint8 *)t );
+     for( i = 0; i < 8; i++, idx++ ) {
+        t[0] = a1[0] ^ ak_kuznechik_round_constants[idx][0];
+        t[1] = a1[1] ^ ak_kuznechik_round_constants[idx][1];
+        ak_kuznechik_schedule_round( t );
 
         t[0] ^= a0[0]; t[1] ^= a0[1];
         a0[0] = a1[0]; a0[1] = a1[1];
@@ -202,17 +363,63 @@
      }
      kdx += 2;
      ekey[kdx] = a1[0]^mkey[kdx]; ekey[kdx+1] = a1[1]^mkey[kdx+1];
-     ak_kuznechik_matrix_mul_vector( Linv, ( ak_uint8 *)a1, (ak_uint8 *)( dkey+kdx ));
+     ak_kuznechik_schedule_inverse( a1, dkey+kdx );
      dkey[kdx] ^= xkey[kdx]; dkey[kdx+1] ^= xkey[kdx+1];
 
      kdx += 2;
      ekey[kdx] = a0[0]^mkey[kdx]; ekey[kdx+1] = a0[1]^mkey[kdx+1];
-     ak_kuznechik_matrix_mul_vector( Linv, ( ak_uint8 *)a0, (ak_uint8 *)( dkey+kdx ));
+     ak_kuznechik_schedule_inverse( a0, dkey+kdx );
      dkey[kdx] ^= xkey[kdx]; dkey[kdx+1] ^= xkey[kdx+1];
   }
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует композицию нелинейного и линейного преобразований LS
+    для одного блока, к которому уже прибавлен раундовый ключ.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_encrypt_round( ak_uint64 *x )
+{
+  ak_uint64 s, t;
+  ak_uint8 *b = (ak_uint8 *)x;
+
+  t  = ak_kuznechik_encryption_matrix[ 0][b[ 0]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 1][b[ 1]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 2][b[ 2]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 3][b[ 3]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 4][b[ 4]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 5][b[ 5]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 6][b[ 6]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 7][b[ 7]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 8][b[ 8]][0];
+  t ^= ak_kuznechik_encryption_matrix[ 9][b[ 9]][0];
+  t ^= ak_kuznechik_encryption_matrix[10][b[10]][0];
+  t ^= ak_kuznechik_encryption_matrix[11][b[11]][0];
+  t ^= ak_kuznechik_encryption_matrix[12][b[12]][0];
+  t ^= ak_kuznechik_encryption_matrix[13][b[13]][0];
+  t ^= ak_kuznechik_encryption_matrix[14][b[14]][0];
+  t ^= ak_kuznechik_encryption_matrix[15][b[15]][0];
+
+  s  = ak_kuznechik_encryption_matrix[ 0][b[ 0]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 1][b[ 1]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 2][b[ 2]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 3][b[ 3]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 4][b[ 4]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 5][b[ 5]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 6][b[ 6]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 7][b[ 7]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 8][b[ 8]][1];
+  s ^= ak_kuznechik_encryption_matrix[ 9][b[ 9]][1];
+  s ^= ak_kuznechik_encryption_matrix[10][b[10]][1];
+  s ^= ak_kuznechik_encryption_matrix[11][b[11]][1];
+  s ^= ak_kuznechik_encryption_matrix[12][b[12]][1];
+  s ^= ak_kuznechik_encryption_matrix[13][b[13]][1];
+  s ^= ak_kuznechik_encryption_matrix[14][b[14]][1];
+  s ^= ak_kuznechik_encryption_matrix[15][b[15]][1];
+
+  x[0] = t; x[1] = s;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция реализует алгоритм зашифрования одного блока информации
     шифром Кузнечик (согласно ГОСТ Р 34.12-2015).                                                  */
@@ -224,55 +431,533 @@
   ak_uint64 *mkey = ( ak_uint64 *)skey->data + 40;
 
  /* чистая реализация для 64х битной архитектуры */
-  ak_uint64 s, t, x[2];
-  ak_uint8 *b = (ak_uint8 *)x;
+  ak_uint64 x[2];
 
   x[0] = (( ak_uint64 *) in)[0]; x[1] = (( ak_uint64 *) in)[1];
   while( i < 18 ) {
      x[0] ^= ekey[i]; x[0] ^= mkey[i];
      x[1] ^= ekey[++i]; x[1] ^= mkey[i++];
-
-     t  = ak_kuznechik_encryption_matrix[ 0][b[ 0]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 1][b[ 1]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 2][b[ 2]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 3][b[ 3]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 4][b[ 4]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 5][b[ 5]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 6][b[ 6]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 7][b[ 7]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 8][b[ 8]][0];
-     t ^= ak_kuznechik_encryption_matrix[ 9][b[ 9]][0];
-     t ^= ak_kuznechik_encryption_matrix[10][b[10]][0];
-     t ^= ak_kuznechik_encryption_matrix[11][b[11]][0];
-     t ^= ak_kuznechik_encryption_matrix[12][b[12]][0];
-     t ^= ak_kuznechik_encryption_matrix[13][b[13]][0];
-     t ^= ak_kuznechik_encryption_matrix[14][b[14]][0];
-     t ^= ak_kuznechik_encryption_matrix[15][b[15]][0];
-
-     s  = ak_kuznechik_encryption_matrix[ 0][b[ 0]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 1][b[ 1]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 2][b[ 2]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 3][b[ 3]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 4][b[ 4]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 5][b[ 5]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 6][b[ 6]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 7][b[ 7]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 8][b[ 8]][1];
-     s ^= ak_kuznechik_encryption_matrix[ 9][b[ 9]][1];
-     s ^= ak_kuznechik_encryption_matrix[10][b[10]][1];
-     s ^= ak_kuznechik_encryption_matrix[11][b[11]][1];
-     s ^= ak_kuznechik_encryption_matrix[12][b[12]][1];
-     s ^= ak_kuznechik_encryption_matrix[13][b[13]][1];
-     s ^= ak_kuznechik_encryption_matrix[14][b[14]][1];
-     s ^= ak_kuznechik_encryption_matrix[15][b[15]][1];
-
-     x[0] = t; x[1] = s;
+     ak_kuznechik_encrypt_round( x );
   }
   x[0] ^= ekey[18]; x[1] ^= ekey[19];
   ((ak_uint64 *)out)[0] = x[0] ^ mkey[18];
   ((ak_uint64 *)out)[1] = x[1] ^ mkey[19];
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм зашифрования нескольких независимых блоков информации
+    шифром Кузнечик (согласно ГОСТ Р 34.12-2015).
+
+    \details Блоки обрабатываются группами по четыре: на каждом раунде преобразования
+    выполняются сразу для всех блоков группы, поэтому обращения к таблицам для разных
+    блоков не зависят друг от друга и задержки чтения из памяти перекрываются.
+    Оставшиеся блоки зашифровываются по одному.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_encrypt_blocks_with_mask( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  int i = 0, k = 0;
+  ak_uint64 *ekey = ( ak_uint64 *)skey->data;
+  ak_uint64 *mkey = ( ak_uint64 *)skey->data + 40;
+  ak_uint64 x[4][2], *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+
+  for( ; blocks >= 4; blocks -= 4, inptr += 8, outptr += 8 ) {
+     for( k = 0; k < 4; k++ ) {
+        x[k][0] = inptr[2*k]; x[k][1] = inptr[2*k+1];
+     }
+     for( i = 0; i < 18; i += 2 ) {
+        for( k = 0; k < 4; k++ ) {
+           x[k][0] ^= ekey[i]; x[k][0] ^= mkey[i];
+           x[k][1] ^= ekey[i+1]; x[k][1] ^= mkey[i+1];
+           ak_kuznechik_encrypt_round( x[k] );
+        }
+     }
+     for( k = 0; k < 4; k++ ) {
+        x[k][0] ^= ekey[18]; x[k][1] ^= ekey[19];
+        outptr[2*k] = x[k][0] ^ mkey[18];
+        outptr[2*k+1] = x[k][1] ^ mkey[19];
+     }
+  }
+  for( ; blocks > 0; blocks--, inptr += 2, outptr += 2 )
+     ak_kuznechik_encrypt_with_mask( skey, inptr, outptr );
+}
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8
+/* ----------------------------------------------------------------------------------------------- */
+/*                   векторная реализация зашифрования и расшифрования                             */
+/* ----------------------------------------------------------------------------------------------- */
+/*  Блоки обрабатываются в транспонированном виде: i-й регистр содержит i-е байты всех блоков.
+    Нелинейное преобразование вычисляется при помощи 16 подстановок pshufb, каждая из которых
+    обрабатывает байты с фиксированной старшей тетрадой. Линейное преобразование вычисляется
+    как 16 тактов линейного регистра сдвига, при этом такт сводится к переименованию регистров
+    и семи умножениям на константы (по две подстановки pshufb на каждое умножение).
+    Такт обратного преобразования складывает с байтом регистра ту же сумму, что и прямой такт,
+    поэтому \f$ L^{-1} \f$ вычисляется теми же тактами, выполняемыми в обратном порядке.
+
+    Адреса всех обращений к памяти не зависят от обрабатываемых данных и ключа. Векторная
+    реализация обрабатывает одновременно 16 блоков, поэтому одиночные блоки и группы из менее
+    чем 16 блоков по умолчанию обрабатываются табличной реализацией: векторная обработка одного
+    блока выполняется примерно в двадцать раз медленнее, что сказывается на скорости режимов
+    с зацеплением (CBC, CFB, OFB, OMAC, MGM). При ненулевом значении опции
+    `kuznechik_constant_time` векторной реализацией выполняются все преобразования ключа:
+    зашифрование и расшифрование одного блока, неполные группы блоков, а также вычисление
+    преобразования LS при развертке ключа.                                                         */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение всех байт регистра на c-й коэффициент линейного регистра сдвига (SSSE3). */
+ __attribute__((target("ssse3")))
+ static inline __m128i ak_kuznechik_mul_ssse3( __m128i v, const int c )
+{
+  const __m128i c0f = _mm_set1_epi8( 0x0f );
+  return _mm_xor_si128(
+    _mm_shuffle_epi8( _mm_loadu_si128(( const __m128i *) ak_kuznechik_vector_lmul[c][0] ),
+                                                                    _mm_and_si128( v, c0f )),
+    _mm_shuffle_epi8( _mm_loadu_si128(( const __m128i *) ak_kuznechik_vector_lmul[c][1] ),
+                                                  _mm_and_si128( _mm_srli_epi16( v, 4 ), c0f )));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Подстановка всех байт регистра по таблице `table` (\f$ \pi \f$ или \f$ \pi^{-1} \f$). */
+ __attribute__((target("ssse3")))
+ static inline __m128i ak_kuznechik_sbox_ssse3( __m128i t, const ak_uint8 *table )
+{
+  int k = 0;
+  __m128i y = _mm_setzero_si128();
+  const __m128i c70 = _mm_set1_epi8( 0x70 ), c10 = _mm_set1_epi8( 0x10 );
+
+  for( k = 0; k < 16; k++ ) {
+     y = _mm_xor_si128( y, _mm_shuffle_epi8(
+            _mm_loadu_si128(( const __m128i *)( table + 16*k )), _mm_adds_epu8( t, c70 )));
+     t = _mm_sub_epi8( t, c10 );
+  }
+ return y;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Такт линейного регистра сдвига: к регистру x[k] прибавляется линейная комбинация
+    остальных байт регистра сдвига (SSSE3).                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("ssse3")))
+ static inline void ak_kuznechik_lstep_ssse3( __m128i *x, const int k )
+{
+  __m128i y = _mm_xor_si128( x[(k+7)&15], x[(k+9)&15] );
+  y = _mm_xor_si128( y, ak_kuznechik_mul_ssse3( _mm_xor_si128( x[(k+1)&15], x[(k+15)&15] ), 0 ));
+  y = _mm_xor_si128( y, ak_kuznechik_mul_ssse3( _mm_xor_si128( x[(k+2)&15], x[(k+14)&15] ), 1 ));
+  y = _mm_xor_si128( y, ak_kuznechik_mul_ssse3( _mm_xor_si128( x[(k+3)&15], x[(k+13)&15] ), 2 ));
+  y = _mm_xor_si128( y, ak_kuznechik_mul_ssse3( _mm_xor_si128( x[(k+4)&15], x[(k+12)&15] ), 3 ));
+  y = _mm_xor_si128( y, ak_kuznechik_mul_ssse3( _mm_xor_si128( x[(k+5)&15], x[(k+11)&15] ), 4 ));
+  y = _mm_xor_si128( y, ak_kuznechik_mul_ssse3( _mm_xor_si128( x[(k+6)&15], x[(k+10)&15] ), 5 ));
+  y = _mm_xor_si128( y, ak_kuznechik_mul_ssse3( x[(k+8)&15], 6 ));
+  x[k] = _mm_xor_si128( x[k], y );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразования S и L для 16 блоков (SSSE3).                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("ssse3")))
+ static inline void ak_kuznechik_ls_ssse3( __m128i *x )
+{
+  int k = 0;
+  for( k = 0; k < 16; k++ ) x[k] = ak_kuznechik_sbox_ssse3( x[k], gost_pi );
+#pragma GCC unroll 16
+  for( k = 0; k < 16; k++ ) ak_kuznechik_lstep_ssse3( x, k );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Прибавление раундового ключа, хранящегося вместе с маской (SSSE3).                    */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("ssse3")))
+ static inline void ak_kuznechik_add_key_ssse3( __m128i *x, const ak_uint8 *ekey,
+                                                                            const ak_uint8 *mkey )
+{
+  int i = 0;
+  for( i = 0; i < 16; i++ ) {
+     x[i] = _mm_xor_si128( x[i], _mm_set1_epi8(( char ) ekey[i] ));
+     x[i] = _mm_xor_si128( x[i], _mm_set1_epi8(( char ) mkey[i] ));
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) не более 16 блоков с использованием
+    инструкций SSSE3; недостающие блоки считаются нулевыми.                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("ssse3")))
+ static void ak_kuznechik_crypt16_ssse3( ak_skey skey, const ak_uint8 *in, ak_uint8 *out,
+                                                     const size_t blocks, const bool_t decrypt )
+{
+  size_t k = 0;
+  int i = 0, r = 0;
+  ak_uint8 buf[16][16];
+  ak_uint8 *ekey = ( ak_uint8 *)skey->data;
+  ak_uint8 *mkey = ( ak_uint8 *)skey->data + 320;
+  __m128i x[16];
+
+ /* транспонируем блоки, недостающие блоки считаем нулевыми */
+  memset( buf, 0, sizeof( buf ));
+  for( k = 0; k < blocks; k++ )
+     for( i = 0; i < 16; i++ ) buf[i][k] = in[16*k+i];
+  for( i = 0; i < 16; i++ ) x[i] = _mm_loadu_si128(( const __m128i *) buf[i] );
+
+  if( decrypt ) {
+    ak_kuznechik_add_key_ssse3( x, ekey + 144, mkey + 144 );
+    for( r = 8; r >= 0; r-- ) {
+      /* преобразование L^{-1}: такты в обратном порядке */
+#pragma GCC unroll 16
+       for( i = 15; i >= 0; i-- ) ak_kuznechik_lstep_ssse3( x, i );
+       for( i = 0; i < 16; i++ ) x[i] = ak_kuznechik_sbox_ssse3( x[i], gost_pinv );
+       ak_kuznechik_add_key_ssse3( x, ekey + 16*r, mkey + 16*r );
+    }
+  } else {
+      for( r = 0; r < 9; r++ ) {
+         ak_kuznechik_add_key_ssse3( x, ekey + 16*r, mkey + 16*r );
+         ak_kuznechik_ls_ssse3( x );
+      }
+      ak_kuznechik_add_key_ssse3( x, ekey + 144, mkey + 144 );
+    }
+  for( i = 0; i < 16; i++ ) _mm_storeu_si128(( __m128i *) buf[i], x[i] );
+
+ /* возвращаем блоки к исходному виду */
+  for( k = 0; k < blocks; k++ )
+     for( i = 0; i < 16; i++ ) out[16*k+i] = buf[i][k];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет преобразование LS одного блока (или, если `inverse` истинно,
+    преобразование \f$ L^{-1} \f$) с использованием инструкций SSSE3; используется при
+    развертке ключа.                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("ssse3")))
+ static void ak_kuznechik_transform_ssse3( ak_uint64 *w, ak_uint64 *out, const bool_t inverse )
+{
+  int i = 0;
+  __m128i x[16];
+  ak_uint8 *b = ( ak_uint8 *)w, *c = ( ak_uint8 *)out;
+
+  for( i = 0; i < 16; i++ ) x[i] = _mm_cvtsi32_si128( b[i] );
+  if( inverse ) {
+#pragma GCC unroll 16
+    for( i = 15; i >= 0; i-- ) ak_kuznechik_lstep_ssse3( x, i );
+  } else ak_kuznechik_ls_ssse3( x );
+  for( i = 0; i < 16; i++ ) c[i] = ( ak_uint8 )_mm_cvtsi128_si32( x[i] );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение всех байт регистра на c-й коэффициент линейного регистра сдвига (AVX2). */
+ __attribute__((target("avx2")))
+ static inline __m256i ak_kuznechik_mul_avx2( __m256i v, const int c )
+{
+  const __m256i c0f = _mm256_set1_epi8( 0x0f );
+  return _mm256_xor_si256(
+    _mm256_shuffle_epi8( _mm256_broadcastsi128_si256(
+                       _mm_loadu_si128(( const __m128i *) ak_kuznechik_vector_lmul[c][0] )),
+                                                                 _mm256_and_si256( v, c0f )),
+    _mm256_shuffle_epi8( _mm256_broadcastsi128_si256(
+                       _mm_loadu_si128(( const __m128i *) ak_kuznechik_vector_lmul[c][1] )),
+                                            _mm256_and_si256( _mm256_srli_epi16( v, 4 ), c0f )));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Подстановка всех байт регистра по таблице `table` (AVX2). */
+ __attribute__((target("avx2")))
+ static inline __m256i ak_kuznechik_sbox_avx2( __m256i t, const ak_uint8 *table )
+{
+  int k = 0;
+  __m256i y = _mm256_setzero_si256();
+  const __m256i c70 = _mm256_set1_epi8( 0x70 ), c10 = _mm256_set1_epi8( 0x10 );
+
+  for( k = 0; k < 16; k++ ) {
+     y = _mm256_xor_si256( y, _mm256_shuffle_epi8( _mm256_broadcastsi128_si256(
+                                _mm_loadu_si128(( const __m128i *)( table + 16*k ))),
+                                                                 _mm256_adds_epu8( t, c70 )));
+     t = _mm256_sub_epi8( t, c10 );
+  }
+ return y;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Такт линейного регистра сдвига (AVX2). */
+ __attribute__((target("avx2")))
+ static inline void ak_kuznechik_lstep_avx2( __m256i *x, const int k )
+{
+  __m256i y = _mm256_xor_si256( x[(k+7)&15], x[(k+9)&15] );
+  y = _mm256_xor_si256( y, ak_kuznechik_mul_avx2(
+                                        _mm256_xor_si256( x[(k+1)&15], x[(k+15)&15] ), 0 ));
+  y = _mm256_xor_si256( y, ak_kuznechik_mul_avx2(
+                                        _mm256_xor_si256( x[(k+2)&15], x[(k+14)&15] ), 1 ));
+  y = _mm256_xor_si256( y, ak_kuznechik_mul_avx2(
+                                        _mm256_xor_si256( x[(k+3)&15], x[(k+13)&15] ), 2 ));
+  y = _mm256_xor_si256( y, ak_kuznechik_mul_avx2(
+                                        _mm256_xor_si256( x[(k+4)&15], x[(k+12)&15] ), 3 ));
+  y = _mm256_xor_si256( y, ak_kuznechik_mul_avx2(
+                                        _mm256_xor_si256( x[(k+5)&15], x[(k+11)&15] ), 4 ));
+  y = _mm256_xor_si256( y, ak_kuznechik_mul_avx2(
+                                        _mm256_xor_si256( x[(k+6)&15], x[(k+10)&15] ), 5 ));
+  y = _mm256_xor_si256( y, ak_kuznechik_mul_avx2( x[(k+8)&15], 6 ));
+  x[k] = _mm256_xor_si256( x[k], y );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Прибавление раундового ключа, хранящегося вместе с маской (AVX2). */
+ __attribute__((target("avx2")))
+ static inline void ak_kuznechik_add_key_avx2( __m256i *x, const ak_uint8 *ekey,
+                                                                            const ak_uint8 *mkey )
+{
+  int i = 0;
+  for( i = 0; i < 16; i++ ) {
+     x[i] = _mm256_xor_si256( x[i], _mm256_set1_epi8(( char ) ekey[i] ));
+     x[i] = _mm256_xor_si256( x[i], _mm256_set1_epi8(( char ) mkey[i] ));
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) не более 32 блоков с использованием
+    инструкций AVX2.
+    \details Алгоритм совпадает с реализацией функции ak_kuznechik_crypt16_ssse3(),
+    при этом в каждом 256-битном регистре обрабатываются байты 32-х блоков.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx2")))
+ static void ak_kuznechik_crypt32_avx2( ak_skey skey, const ak_uint8 *in, ak_uint8 *out,
+                                                     const size_t blocks, const bool_t decrypt )
+{
+  size_t k = 0;
+  int i = 0, r = 0;
+  ak_uint8 buf[16][32];
+  ak_uint8 *ekey = ( ak_uint8 *)skey->data;
+  ak_uint8 *mkey = ( ak_uint8 *)skey->data + 320;
+  __m256i x[16];
+
+ /* транспонируем блоки, недостающие блоки считаем нулевыми */
+  memset( buf, 0, sizeof( buf ));
+  for( k = 0; k < blocks; k++ )
+     for( i = 0; i < 16; i++ ) buf[i][k] = in[16*k+i];
+  for( i = 0; i < 16; i++ ) x[i] = _mm256_loadu_si256(( const __m256i *) buf[i] );
+
+  if( decrypt ) {
+    ak_kuznechik_add_key_avx2( x, ekey + 144, mkey + 144 );
+    for( r = 8; r >= 0; r-- ) {
+#pragma GCC unroll 16
+       for( i = 15; i >= 0; i-- ) ak_kuznechik_lstep_avx2( x, i );
+       for( i = 0; i < 16; i++ ) x[i] = ak_kuznechik_sbox_avx2( x[i], gost_pinv );
+       ak_kuznechik_add_key_avx2( x, ekey + 16*r, mkey + 16*r );
+    }
+  } else {
+      for( r = 0; r < 9; r++ ) {
+         ak_kuznechik_add_key_avx2( x, ekey + 16*r, mkey + 16*r );
+         for( i = 0; i < 16; i++ ) x[i] = ak_kuznechik_sbox_avx2( x[i], gost_pi );
+#pragma GCC unroll 16
+         for( i = 0; i < 16; i++ ) ak_kuznechik_lstep_avx2( x, i );
+      }
+      ak_kuznechik_add_key_avx2( x, ekey + 144, mkey + 144 );
+    }
+  for( i = 0; i < 16; i++ ) _mm256_storeu_si256(( __m256i *) buf[i], x[i] );
+
+ /* возвращаем блоки к исходному виду */
+  for( k = 0; k < blocks; k++ )
+     for( i = 0; i < 16; i++ ) out[16*k+i] = buf[i][k];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования одного блока, использующая инструкции SSSE3.                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_encrypt_ssse3( ak_skey skey, ak_pointer in, ak_pointer out )
+{
+  ak_kuznechik_crypt16_ssse3( skey, in, out, 1, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования одного блока, использующая инструкции SSSE3.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_decrypt_ssse3( ak_skey skey, ak_pointer in, ak_pointer out )
+{
+  ak_kuznechik_crypt16_ssse3( skey, in, out, 1, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) менее 16 блоков, оставшихся после обработки
+    полных групп: векторной реализацией, если она выбрана для одиночных блоков,
+    и табличной в противном случае.                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_tail_ssse3( ak_skey skey, ak_uint8 *inptr, ak_uint8 *outptr,
+                                                           size_t blocks, const bool_t decrypt )
+{
+  if( ak_kuznechik_encrypt == ak_kuznechik_encrypt_ssse3 )
+    ak_kuznechik_crypt16_ssse3( skey, inptr, outptr, blocks, decrypt );
+   else {
+     if( decrypt ) ak_kuznechik_decrypt_blocks_with_mask( skey, inptr, outptr, blocks );
+      else ak_kuznechik_encrypt_blocks_with_mask( skey, inptr, outptr, blocks );
+   }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования (расшифрования) нескольких блоков, использующая инструкции SSSE3.
+    \details Блоки обрабатываются группами по 16, оставшиеся блоки -- функцией
+    ak_kuznechik_tail_ssse3().                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_blocks_ssse3( ak_skey skey, ak_uint8 *inptr, ak_uint8 *outptr,
+                                                           size_t blocks, const bool_t decrypt )
+{
+  for( ; blocks >= 16; blocks -= 16, inptr += 256, outptr += 256 )
+     ak_kuznechik_crypt16_ssse3( skey, inptr, outptr, 16, decrypt );
+  if( blocks ) ak_kuznechik_tail_ssse3( skey, inptr, outptr, blocks, decrypt );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_encrypt_blocks_ssse3( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_ssse3( skey, in, out, blocks, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_decrypt_blocks_ssse3( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_ssse3( skey, in, out, blocks, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования (расшифрования) нескольких блоков, использующая инструкции AVX2.
+    \details Блоки обрабатываются группами по 32; неполная группа из 16 и более блоков
+    обрабатывается той же функцией, оставшиеся (менее 16) блоки -- функцией
+    ak_kuznechik_tail_ssse3().                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_blocks_avx2( ak_skey skey, ak_uint8 *inptr, ak_uint8 *outptr,
+                                                           size_t blocks, const bool_t decrypt )
+{
+  for( ; blocks >= 32; blocks -= 32, inptr += 512, outptr += 512 )
+     ak_kuznechik_crypt32_avx2( skey, inptr, outptr, 32, decrypt );
+  if( blocks >= 16 ) ak_kuznechik_crypt32_avx2( skey, inptr, outptr, blocks, decrypt );
+   else if( blocks ) ak_kuznechik_tail_ssse3( skey, inptr, outptr, blocks, decrypt );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_encrypt_blocks_avx2( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_avx2( skey, in, out, blocks, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_decrypt_blocks_avx2( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_avx2( skey, in, out, blocks, ak_true );
+}
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) не более 64 блоков с использованием
+    инструкций AVX-512 и GFNI.
+    \details Блоки обрабатываются в транспонированном виде, как и в функции
+    ak_kuznechik_crypt16_ssse3(). Подстановка вычисляется двумя инструкциями `vpermi2b`
+    по половинам таблицы \f$ \pi \f$ (\f$ \pi^{-1} \f$), умножение на коэффициенты линейного
+    регистра сдвига -- одной инструкцией `gf2p8affineqb`.                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx512f,avx512bw,avx512vbmi,gfni")))
+ static void ak_kuznechik_crypt64_avx512( ak_skey skey, const ak_uint8 *in, ak_uint8 *out,
+                                                     const size_t blocks, const bool_t decrypt )
+{
+  size_t k = 0;
+  int i = 0, j = 0, r = 0;
+  ak_uint8 buf[16][64];
+  ak_uint8 *ekey = ( ak_uint8 *)skey->data;
+  ak_uint8 *mkey = ( ak_uint8 *)skey->data + 320;
+  const ak_uint8 *table = decrypt ? gost_pinv : gost_pi;
+  __m512i x[16], m[7], t, y;
+  const __m512i p0 = _mm512_loadu_si512( table ), p1 = _mm512_loadu_si512( table + 64 ),
+                p2 = _mm512_loadu_si512( table + 128 ), p3 = _mm512_loadu_si512( table + 192 );
+
+  for( i = 0; i < 7; i++ ) m[i] = _mm512_set1_epi64(( long long ) ak_kuznechik_vector_lmat[i] );
+
+ /* транспонируем блоки, недостающие блоки считаем нулевыми */
+  memset( buf, 0, sizeof( buf ));
+  for( k = 0; k < blocks; k++ )
+     for( i = 0; i < 16; i++ ) buf[i][k] = in[16*k+i];
+  for( i = 0; i < 16; i++ ) x[i] = _mm512_loadu_si512( buf[i] );
+
+ /* при расшифровании раундовые ключи используются в обратном порядке */
+  for( r = 0; r < 9; r++ ) {
+     const int kr = decrypt ? 9 - r : r;
+    /* прибавляем раундовый ключ и его маску */
+     for( i = 0; i < 16; i++ ) {
+        x[i] = _mm512_xor_si512( x[i], _mm512_set1_epi8(( char ) ekey[16*kr+i] ));
+        x[i] = _mm512_xor_si512( x[i], _mm512_set1_epi8(( char ) mkey[16*kr+i] ));
+     }
+    /* при расшифровании преобразование L^{-1} вычисляется до подстановки */
+     if( decrypt ) {
+#pragma GCC unroll 16
+       for( j = 15; j >= 0; j-- ) {
+          y = _mm512_xor_si512( x[(j+7)&15], x[(j+9)&15] );
+          for( i = 1; i < 7; i++ )
+             y = _mm512_xor_si512( y, _mm512_gf2p8affine_epi64_epi8(
+                           _mm512_xor_si512( x[(j+i)&15], x[(j+16-i)&15] ), m[i-1], 0 ));
+          x[j] = _mm512_xor_si512( x[j], y );
+          x[j] = _mm512_xor_si512( x[j], _mm512_gf2p8affine_epi64_epi8( x[(j+8)&15], m[6], 0 ));
+       }
+     }
+    /* подстановка */
+     for( i = 0; i < 16; i++ ) {
+        t = x[i];
+        x[i] = _mm512_mask_blend_epi8( _mm512_movepi8_mask( t ),
+                 _mm512_permutex2var_epi8( p0, t, p1 ), _mm512_permutex2var_epi8( p2, t, p3 ));
+     }
+    /* при зашифровании преобразование L вычисляется после подстановки;
+       на j-м такте байт w_i регистра сдвига хранится в x[(j+i)&15] */
+     if( !decrypt ) {
+#pragma GCC unroll 16
+       for( j = 0; j < 16; j++ ) {
+          y = _mm512_xor_si512( x[(j+7)&15], x[(j+9)&15] );
+          for( i = 1; i < 7; i++ )
+             y = _mm512_xor_si512( y, _mm512_gf2p8affine_epi64_epi8(
+                           _mm512_xor_si512( x[(j+i)&15], x[(j+16-i)&15] ), m[i-1], 0 ));
+          x[j] = _mm512_xor_si512( x[j], y );
+          x[j] = _mm512_xor_si512( x[j], _mm512_gf2p8affine_epi64_epi8( x[(j+8)&15], m[6], 0 ));
+       }
+     }
+  }
+  r = decrypt ? 0 : 9;
+  for( i = 0; i < 16; i++ ) {
+     x[i] = _mm512_xor_si512( x[i], _mm512_set1_epi8(( char ) ekey[16*r+i] ));
+     x[i] = _mm512_xor_si512( x[i], _mm512_set1_epi8(( char ) mkey[16*r+i] ));
+     _mm512_storeu_si512( buf[i], x[i] );
+  }
+
+ /* возвращаем блоки к исходному виду */
+  for( k = 0; k < blocks; k++ )
+     for( i = 0; i < 16; i++ ) out[16*k+i] = buf[i][k];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования (расшифрования) нескольких блоков, использующая инструкции
+    AVX-512 и GFNI.
+    \details Блоки обрабатываются группами по 64; неполная группа из 16 и более блоков
+    обрабатывается той же функцией, оставшиеся (менее 16) блоки -- функцией
+    ak_kuznechik_tail_ssse3().                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_blocks_avx512( ak_skey skey, ak_uint8 *inptr, ak_uint8 *outptr,
+                                                           size_t blocks, const bool_t decrypt )
+{
+  for( ; blocks >= 64; blocks -= 64, inptr += 1024, outptr += 1024 )
+     ak_kuznechik_crypt64_avx512( skey, inptr, outptr, 64, decrypt );
+  if( blocks >= 16 ) ak_kuznechik_crypt64_avx512( skey, inptr, outptr, blocks, decrypt );
+   else if( blocks ) ak_kuznechik_tail_ssse3( skey, inptr, outptr, blocks, decrypt );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_encrypt_blocks_avx512( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_avx512( skey, in, out, blocks, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_decrypt_blocks_avx512( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_avx512( skey, in, out, blocks, ak_true );
+}
+#endif
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция реализует алгоритм расшифрования одного блока информации
     шифром Кузнечик (согласно ГОСТ Р 34.12-2015).                                                  */
@@ -338,6 +1023,22 @@
   (( ak_uint64 *) out)[1] = x[1] ^ xkey[1];
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования нескольких независимых блоков информации.
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации (шифртекст).
+    @param out Последовательность блоков выходной информации (открытый текст).
+    @param blocks Количество блоков.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_decrypt_blocks_with_mask( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+  for( ; blocks > 0; blocks--, inptr += 2, outptr += 2 )
+     ak_kuznechik_decrypt_with_mask( skey, inptr, outptr );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! После инициализации устанавливаются обработчики (функции класса). Однако само значение
     ключу не присваивается - поле `bkey->key` остается неопределенным.
@@ -350,6 +1051,9 @@
   int error = ak_error_ok;
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_kuznechik )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using kuznechik after unsuccessful self test" );
 
  /* создаем ключ алгоритма шифрования и определяем его методы */
   if(( error = ak_bckey_context_create( bkey, 32, 16 )) != ak_error_ok )
@@ -371,8 +1075,17 @@
  /* устанавливаем методы */
   bkey->schedule_keys = ak_kuznechik_schedule_keys;
   bkey->delete_keys = ak_kuznechik_delete_keys;
-  bkey->encrypt = ak_kuznechik_encrypt_with_mask;
-  bkey->decrypt = ak_kuznechik_decrypt_with_mask;
+  if( ak_kuznechik_encrypt != NULL ) {
+    bkey->encrypt = ak_kuznechik_encrypt;
+    bkey->decrypt = ak_kuznechik_decrypt;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks;
+  } else {
+      bkey->encrypt = ak_kuznechik_encrypt_with_mask;
+      bkey->decrypt = ak_kuznechik_decrypt_with_mask;
+      bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask;
+      bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask;
+    }
 
  return error;
 }
@@ -383,6 +1096,7 @@
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_bckey_test_kuznechik( void )
 {
+  size_t i = 0;
   char *str = NULL;
   struct bckey bkey;
   bool_t result = ak_true;
@@ -433,6 +1147,43 @@
     0x30, 0xF6, 0x0A, 0xA9, 0xC0, 0x11, 0x77, 0xCE, 0xCD, 0xE9, 0x40, 0x9A, 0x4B, 0x46, 0x1C, 0x64,
     0xF6, 0xCA, 0xF7, 0xC6, 0x90, 0x18, 0x65 };
 
+ /* синхропосылка для режимов с обратной связью из ГОСТ Р 34.13-2015, приложение А.1 */
+  ak_uint8 ivlong[32] = {
+    0x12, 0x01, 0xf0, 0xe5, 0xd4, 0xc3, 0xb2, 0xa1, 0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12,
+    0x19, 0x18, 0x17, 0x16, 0x15, 0x14, 0x13, 0x12, 0x90, 0x89, 0x78, 0x67, 0x56, 0x45, 0x34, 0x23 };
+
+ /* результаты зашифрования в режимах простой замены с зацеплением,
+    гаммирования с обратной связью по шифртексту и по выходу */
+  ak_uint8 outcbc[64] = {
+    0x27, 0xcc, 0x7d, 0x6d, 0x3d, 0x2e, 0xe5, 0x90, 0x4d, 0xfa, 0x85, 0xa0, 0xd4, 0x72, 0x99, 0x68,
+    0xac, 0xa5, 0x5e, 0x8d, 0x44, 0x8e, 0x1e, 0xaf, 0xa6, 0xec, 0x78, 0xb4, 0x61, 0xe6, 0x26, 0x28,
+    0xd0, 0x90, 0x9d, 0xf4, 0xb0, 0xe8, 0x40, 0x56, 0xe8, 0x99, 0x19, 0xe9, 0xf1, 0xab, 0x7b, 0xfe,
+    0x70, 0x39, 0xb6, 0x60, 0x15, 0x9a, 0x2d, 0x1a, 0x63, 0x5c, 0x89, 0x5a, 0x06, 0x88, 0x76, 0x16 };
+
+  ak_uint8 outcfb[64] = {
+    0x95, 0xbd, 0x7a, 0x89, 0x5e, 0x79, 0x1f, 0xff, 0x24, 0x2b, 0x84, 0xb1, 0x59, 0x0a, 0x80, 0x81,
+    0xbf, 0x26, 0x93, 0x9d, 0x36, 0x21, 0xb5, 0x8f, 0xb4, 0xfa, 0x8c, 0x04, 0xa7, 0x47, 0x5b, 0xed,
+    0xb5, 0x38, 0xa2, 0x97, 0x4e, 0x26, 0x2d, 0x84, 0x38, 0x8d, 0xc6, 0x5c, 0xeb, 0xa8, 0xf2, 0x79,
+    0xd1, 0xf4, 0xfb, 0x44, 0xdd, 0xd9, 0x5b, 0xc7, 0xe6, 0x2d, 0x92, 0x4e, 0xcd, 0xbe, 0xfe, 0x4f };
+
+  ak_uint8 outofb[64] = {
+    0x95, 0xbd, 0x7a, 0x89, 0x5e, 0x79, 0x1f, 0xff, 0x24, 0x2b, 0x84, 0xb1, 0x59, 0x0a, 0x80, 0x81,
+    0xbf, 0x26, 0x93, 0x9d, 0x36, 0x21, 0xb5, 0x8f, 0xb4, 0xfa, 0x8c, 0x04, 0xa7, 0x47, 0x5b, 0xed,
+    0x13, 0x8a, 0x28, 0x10, 0xfc, 0xe7, 0x0f, 0xc8, 0xb1, 0xb8, 0xa0, 0x3c, 0xac, 0x57, 0xa2, 0x66,
+    0x50, 0x31, 0x90, 0xf6, 0x43, 0x22, 0x29, 0xa0, 0x60, 0x86, 0x13, 0x66, 0xc0, 0xbb, 0x3e, 0x20 };
+
+ /* перечень проверяемых режимов */
+  struct {
+    ak_function_bckey_encrypt *encrypt, *decrypt;
+    ak_uint8 *iv, *out;
+    size_t iv_size;
+    const char *name;
+  } modes[3] = {
+    { ak_bckey_context_encrypt_cbc, ak_bckey_context_decrypt_cbc, ivlong, outcbc, 32, "cbc" },
+    { ak_bckey_context_encrypt_cfb, ak_bckey_context_decrypt_cfb, ivlong, outcfb, 32, "cfb" },
+    { ak_bckey_context_ofb, ak_bckey_context_ofb, ivlong, outofb, 32, "ofb" }
+  };
+
  /* значение имитовставки согласно ГОСТ Р 34.13-2015 (раздел А.1.6) */
   ak_uint8 imito[16] = {
      0x67, 0x9C, 0x74, 0x37, 0x5B, 0xB3, 0xDE, 0x4D, 0xE3, 0xFB, 0x59, 0x60, 0x29, 0x4D, 0x6F, 0x33 };
@@ -570,7 +1321,43 @@
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                                "the counter mode encryption/decryption test for 23 octets is Ok" );
 
- /* 6. Тестируем режим выработки имитовставки (плоская реализация). */
+ /* 6. Тестируем режимы простой замены с зацеплением, гаммирования с обратной связью
+       по шифртексту и гаммирования с обратной связью по выходу согласно ГОСТ Р34.13-2015 */
+  for( i = 0; i < 3; i++ ) {
+    if(( error = modes[i].encrypt( &bkey, inlong, myout, 64,
+                                          modes[i].iv, modes[i].iv_size )) != ak_error_ok ) {
+      ak_error_message_fmt( error, __func__ , "wrong %s mode encryption", modes[i].name );
+      result = ak_false;
+      goto exit;
+    }
+    if( !ak_ptr_is_equal( myout, modes[i].out, 64 )) {
+      ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                     "the %s mode encryption test from GOST R 34.13-2015 is wrong", modes[i].name );
+      ak_log_set_message( str = ak_ptr_to_hexstr( myout, 64, ak_true )); free( str );
+      ak_log_set_message( str = ak_ptr_to_hexstr( modes[i].out, 64, ak_true )); free( str );
+      result = ak_false;
+      goto exit;
+    }
+
+    if(( error = modes[i].decrypt( &bkey, modes[i].out, myout, 64,
+                                          modes[i].iv, modes[i].iv_size )) != ak_error_ok ) {
+      ak_error_message_fmt( error, __func__ , "wrong %s mode decryption", modes[i].name );
+      result = ak_false;
+      goto exit;
+    }
+    if( !ak_ptr_is_equal( myout, inlong, 64 )) {
+      ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                     "the %s mode decryption test from GOST R 34.13-2015 is wrong", modes[i].name );
+      ak_log_set_message( str = ak_ptr_to_hexstr( myout, 64, ak_true )); free( str );
+      ak_log_set_message( str = ak_ptr_to_hexstr( inlong, 64, ak_true )); free( str );
+      result = ak_false;
+      goto exit;
+    }
+    if( audit >= ak_log_maximum ) ak_error_message_fmt( ak_error_ok, __func__ ,
+           "the %s mode encryption/decryption test from GOST R 34.13-2015 is Ok", modes[i].name );
+  }
+
+ /* 7. Тестируем режим выработки имитовставки (плоская реализация). */
   ak_bckey_context_omac( &bkey, inlong, sizeof( inlong ), myout );
   if(( error = ak_error_get_value()) != ak_error_ok ) {
     ak_error_message( error, __func__ , "wrong omac calculation" );
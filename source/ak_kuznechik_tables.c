@@ -0,0 +1,201 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2014 - 2019 by Axel Kenzo, axelkenzo@mail.ru                                     */
+/*                                                                                                 */
+/*  Файл ak_kuznechik_tables.c                                                                     */
+/*  - содержит программу, вырабатывающую на этапе сборки константные таблицы алгоритма             */
+/*    блочного шифрования Кузнечик (ГОСТ Р 34.12-2015).                                            */
+/*                                                                                                 */
+/*  Программа не входит в состав библиотеки: она собирается и запускается системой сборки,         */
+/*  а результат ее работы -- заголовочный файл ak_kuznechik_tables.h -- включается в ak_kuznechik.c */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef LIBAKRYPT_HAVE_STDIO_H
+ #include <stdio.h>
+#else
+ #error Library cannot be compiled without stdio.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_STDLIB_H
+ #include <stdlib.h>
+#else
+ #error Library cannot be compiled without stdlib.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_STRING_H
+ #include <string.h>
+#else
+ #error Library cannot be compiled without string.h header
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ #include <ak_parameters.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint64 encryption_matrix[16][256][2];
+ static ak_uint64 decryption_matrix[16][256][2];
+ static ak_uint64 round_constants[32][2];
+ static const ak_uint8 vector_lvec[7] = { 0x94, 0x20, 0x85, 0x10, 0xC2, 0xC0, 0xFB };
+ static ak_uint8 vector_lmul[7][2][16];
+ static ak_uint64 vector_lmat[7];
+
+/* ---------------------------------------------------------------------------------------------- */
+/*! \brief Функция умножает два элемента конечного поля \f$\mathbb F_{2^8}\f$, определенного
+     согласно ГОСТ Р 34.12-2015.                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+ static ak_uint8 mul_gf256( ak_uint8 x, ak_uint8 y )
+{
+  ak_uint8 z = 0;
+  while( y ) {
+    if( y&0x1 ) z ^= x;
+    x = ((ak_uint8)(x << 1)) ^ ( x & 0x80 ? 0xC3 : 0x00 );
+    y >>= 1;
+  }
+ return z;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует линейное преобразование L согласно ГОСТ Р 34.12-2015.                */
+/* ---------------------------------------------------------------------------------------------- */
+ static void linear_steps( ak_uint8 *w  )
+{
+  int i = 0, j = 0;
+  const ak_uint8 kuz_lvec[16] = {
+    0x01, 0x94, 0x20, 0x85, 0x10, 0xC2, 0xC0, 0x01, 0xFB, 0x01, 0xC0, 0xC2, 0x10, 0x85, 0x20, 0x94
+  };
+
+  for( j = 0; j < 16; j++ ) {
+     ak_uint8 z = w[0];
+     for( i = 1; i < 16; i++ ) {
+        w[i-1] = w[i];
+        z ^= mul_gf256( w[i], kuz_lvec[i] );
+     }
+     w[15] = z;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет значения всех таблиц так же, как это делалось при инициализации
+    библиотеки; поэтому порядок байт в 64-х битных словах совпадает с порядком,
+    используемым на платформе сборки.                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static void create_tables( void )
+{
+  int i, j, l;
+
+  for( i = 0; i < 16; i++ ) {
+      for( j = 0; j < 256; j++ ) {
+         ak_uint8 b[16], ib[16];
+         for( l = 0; l < 16; l++ ) {
+             b[l] = mul_gf256( L[l][i], gost_pi[j] );
+            ib[l] = mul_gf256( Linv[l][i], gost_pinv[j] );
+         }
+         memcpy( encryption_matrix[i][j], b, 16 );
+         memcpy( decryption_matrix[i][j], ib, 16 );
+      }
+  }
+
+  for( i = 0; i < 32; i++ ) {
+     memset( round_constants[i], 0, 16 );
+     (( ak_uint8 *)round_constants[i] )[0] = ( ak_uint8 )( i+1 );
+     linear_steps(( ak_uint8 *)round_constants[i] );
+  }
+
+  for( i = 0; i < 7; i++ )
+     for( l = 0; l < 16; l++ ) {
+        vector_lmul[i][0][l] = mul_gf256( vector_lvec[i], (ak_uint8) l );
+        vector_lmul[i][1][l] = mul_gf256( vector_lvec[i], (ak_uint8)( l << 4 ));
+     }
+
+  for( i = 0; i < 7; i++ ) {
+     vector_lmat[i] = 0;
+     for( j = 0; j < 8; j++ )
+        for( l = 0; l < 8; l++ )
+           if(( mul_gf256( vector_lvec[i], (ak_uint8)( 1 << l )) >> j )&1 )
+             vector_lmat[i] ^= (( ak_uint64 )1 ) << ( 8*( 7-j ) + l );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выводит последовательность пар 64-х битных слов (по две пары в строке). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void print_pairs( FILE *fp, const ak_uint64 *words, size_t pairs )
+{
+  size_t i;
+
+  for( i = 0; i < pairs; i++ )
+     fprintf( fp, "%s{ 0x%016llx, 0x%016llx }%s", ( i%2 ) ? " " : "\n  ",
+                             ( unsigned long long )words[2*i], ( unsigned long long )words[2*i+1],
+                                                                      ( i + 1 < pairs ) ? "," : "" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выводит таблицу из 16 матриц, каждая из которых содержит 256 пар слов. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void print_matrix( FILE *fp, const char *name, ak_uint64 matrix[16][256][2] )
+{
+  size_t i;
+
+  fprintf( fp, " static const ak_uint64 %s[16][256][2] = {", name );
+  for( i = 0; i < 16; i++ ) {
+     fprintf( fp, "\n {" );
+     print_pairs( fp, matrix[i][0], 256 );
+     fprintf( fp, "\n }%s", ( i < 15 ) ? "," : "\n};\n\n" );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( int argc, char *argv[] )
+{
+  size_t i, j, l;
+  FILE *fp = NULL;
+
+  if( argc != 2 ) {
+    fprintf( stderr, "usage: %s <output header>\n", argv[0] );
+    return EXIT_FAILURE;
+  }
+  if(( fp = fopen( argv[1], "w" )) == NULL ) {
+    fprintf( stderr, "%s: can't create %s\n", argv[0], argv[1] );
+    return EXIT_FAILURE;
+  }
+  create_tables();
+
+  fprintf( fp, "/* Файл ak_kuznechik_tables.h вырабатывается при сборке библиотеки программой\n"
+               "   ak_kuznechik_tables.c; изменения, внесенные в него вручную, будут потеряны. */\n"
+               "#ifndef __AK_KUZNECHIK_TABLES_H__\n#define __AK_KUZNECHIK_TABLES_H__\n\n" );
+
+  fprintf( fp, "/*! \\brief Таблицы, используемые для реализации алгоритма зашифрования одного блока. */\n" );
+  print_matrix( fp, "ak_kuznechik_encryption_matrix", encryption_matrix );
+  fprintf( fp, "/*! \\brief Таблицы, используемые для реализации алгоритма расшифрования одного блока. */\n" );
+  print_matrix( fp, "ak_kuznechik_decryption_matrix", decryption_matrix );
+  fprintf( fp, "/*! \\brief Итерационные константы процедуры развертки ключа. */\n"
+               " static const ak_uint64 ak_kuznechik_round_constants[32][2] = {" );
+  print_pairs( fp, round_constants[0], 32 );
+  fprintf( fp, "\n};\n\n" );
+
+  fprintf( fp, "#ifdef LIBAKRYPT_HAVE_BUILTIN_SHUFFLE_EPI8\n"
+               "/*! \\brief Таблицы умножения на коэффициенты линейного регистра сдвига,\n"
+               "    используемые векторной реализацией. */\n"
+               " static const ak_uint8 ak_kuznechik_vector_lmul[7][2][16] = {" );
+  for( i = 0; i < 7; i++ )
+     for( j = 0; j < 2; j++ ) {
+        fprintf( fp, "%s{", j ? " " : "\n {" );
+        for( l = 0; l < 16; l++ )
+           fprintf( fp, " 0x%02x%s", vector_lmul[i][j][l], ( l < 15 ) ? "," : " }" );
+        fprintf( fp, "%s", j ? (( i < 6 ) ? " }," : " }\n};\n" ) : "," );
+     }
+  fprintf( fp, "#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE\n"
+               "/*! \\brief Матрицы умножения на коэффициенты линейного регистра сдвига\n"
+               "    для инструкции `gf2p8affineqb`. */\n"
+               " static const ak_uint64 ak_kuznechik_vector_lmat[7] = {" );
+  for( i = 0; i < 7; i++ )
+     fprintf( fp, "%s0x%016llx%s", ( i%4 ) ? " " : "\n  ",
+                               ( unsigned long long )vector_lmat[i], ( i < 6 ) ? "," : "\n};\n" );
+  fprintf( fp, "#endif\n#endif\n\n#endif\n" );
+
+  if( fclose( fp ) != 0 ) {
+    fprintf( stderr, "%s: can't write %s\n", argv[0], argv[1] );
+    return EXIT_FAILURE;
+  }
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                         ak_kuznechik_tables.c  */
+/* ----------------------------------------------------------------------------------------------- */
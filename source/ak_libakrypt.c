@@ -24,6 +24,9 @@
  #include <ak_sign.h>
  #include <ak_context_manager.h>
 #endif
+#ifdef LIBAKRYPT_PKCS_15_CONTAINER
+ #include <pkcs_15_cryptographic_token/ak_pkcs_15_token_manager.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
  const char *ak_libakrypt_version( void )
@@ -232,6 +235,191 @@
 
  return ak_true;
 }
+/* ----------------------------------------------------------------------------------------------- */
+/*                        однократное тестирование алгоритмов при первом использовании             */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef LIBAKRYPT_HAVE_BUILTIN_ATOMIC
+ #define ak_self_test_load( x )      __atomic_load_n( &(x), __ATOMIC_ACQUIRE )
+ #define ak_self_test_store( x, v )  __atomic_store_n( &(x), (v), __ATOMIC_RELEASE )
+#else
+ #define ak_self_test_load( x )      (x)
+ #define ak_self_test_store( x, v )  ((x) = (v))
+#endif
+
+/*! \brief Контрольный пример еще не выполнялся. */
+ #define ak_self_test_state_none      (0)
+/*! \brief Контрольный пример выполняется. */
+ #define ak_self_test_state_running   (1)
+/*! \brief Контрольный пример выполнен успешно. */
+ #define ak_self_test_state_passed    (2)
+/*! \brief Контрольный пример не выполнен. */
+ #define ak_self_test_state_failed    (3)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция тестирует операции с эллиптическими кривыми и алгоритмы электронной подписи. */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_signature( void )
+{
+  if( ak_wcurve_test() != ak_true ) return ak_false;
+ return ak_signkey_test();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Структура, описывающая однократно выполняемый контрольный пример. */
+ static struct self_test {
+  /*! \brief Функция, реализующая контрольный пример. */
+   bool_t ( *test )( void );
+  /*! \brief Название группы алгоритмов. */
+   const char *name;
+  /*! \brief Состояние тестирования: изменяется однократно и читается без блокировки. */
+   volatile int state;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  /*! \brief Блокировка, под которой выполняется контрольный пример. */
+   pthread_mutex_t mutex;
+  /*! \brief Поток, выполняющий контрольный пример. */
+   pthread_t owner;
+#endif
+ } ak_self_tests[ak_self_test_count] = {
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #define ak_self_test_entry( f, n ) { f, n, ak_self_test_state_none, PTHREAD_MUTEX_INITIALIZER }
+#else
+ #define ak_self_test_entry( f, n ) { f, n, ak_self_test_state_none }
+#endif
+   ak_self_test_entry( ak_hash_test_streebog256, "streebog256" ),
+   ak_self_test_entry( ak_hash_test_streebog512, "streebog512" ),
+   ak_self_test_entry( ak_bckey_test_magma, "magma" ),
+   ak_self_test_entry( ak_bckey_test_kuznechik, "kuznechik" ),
+   ak_self_test_entry( ak_hmac_test_streebog, "hmac" ),
+   ak_self_test_entry( ak_bckey_test_mgm, "mgm" ),
+   ak_self_test_entry( ak_hmac_test_pbkdf2, "pbkdf2" ),
+   ak_self_test_entry( ak_bckey_test_acpkm, "acpkm" ),
+   ak_self_test_entry( ak_mac_test_omac_functions, "omac" ),
+   ak_self_test_entry( ak_libakrypt_test_signature, "signature" )
+ #undef ak_self_test_entry
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается конструкторами контекстов алгоритмов и выполняет контрольный пример для
+    заданной группы алгоритмов не более одного раза за время жизни процесса. Повторные вызовы
+    сводятся к чтению флага состояния; если контрольный пример выполняется в другом потоке,
+    вызывающий поток дожидается его завершения. Вызовы из самого контрольного примера
+    (он, как правило, создает контексты тестируемого алгоритма) завершаются успешно.
+
+    Если контрольный пример не выполнен, то все последующие вызовы функции для данной
+    группы алгоритмов возвращают ошибку, и алгоритм не может быть использован.
+
+    Поведение функции определяется опцией `self_test_mode`; при нулевом значении
+    контрольные примеры не выполняются.
+
+    @param id Группа тестируемых алгоритмов.
+    @return Функция возвращает \ref ak_error_ok, если алгоритм может быть использован.
+    В противном случае возвращается код ошибки \ref ak_error_self_test.                          */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_self_test( const ak_self_test_t id )
+{
+  int state, error = ak_error_ok;
+  struct self_test *st = NULL;
+
+  if(( id < 0 ) || ( id >= ak_self_test_count ))
+    return ak_error_message( ak_error_undefined_value, __func__,
+                                                         "using undefined group of algorithms" );
+  st = ak_self_tests + id;
+  if(( state = ak_self_test_load( st->state )) == ak_self_test_state_passed ) return ak_error_ok;
+  if( state == ak_self_test_state_none )
+    if( ak_libakrypt_get_option( "self_test_mode" ) == 0 ) return ak_error_ok;
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ /* вызов из выполняемого данным потоком контрольного примера */
+  if(( state == ak_self_test_state_running ) && pthread_equal( st->owner, pthread_self( )))
+    return ak_error_ok;
+  pthread_mutex_lock( &st->mutex );
+#else
+  if( state == ak_self_test_state_running ) return ak_error_ok;
+#endif
+
+  if(( state = st->state ) == ak_self_test_state_none ) {
+   #ifdef LIBAKRYPT_HAVE_PTHREAD
+    st->owner = pthread_self();
+   #endif
+    ak_self_test_store( st->state, ak_self_test_state_running );
+   /* контрольные примеры анализируют значение кода ошибки, поэтому ранее установленное
+      значение сбрасывается и восстанавливается после успешного выполнения примера */
+    error = ak_error_get_value();
+    ak_error_set_value( ak_error_ok );
+    state = ( st->test() == ak_true ) ? ak_self_test_state_passed : ak_self_test_state_failed;
+    ak_self_test_store( st->state, state );
+    if( state == ak_self_test_state_passed ) ak_error_set_value( error );
+
+    if( state == ak_self_test_state_passed ) {
+      if( ak_log_get_level() >= ak_log_maximum )
+        ak_error_message_fmt( ak_error_ok, __func__, "self test for %s is Ok", st->name );
+    } else ak_error_message_fmt( ak_error_self_test, __func__,
+                                                           "self test for %s is wrong", st->name );
+  }
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_unlock( &st->mutex );
+#endif
+  if( state == ak_self_test_state_passed ) return ak_error_ok;
+ return ak_error_message_fmt( ak_error_self_test, __func__,
+                                        "using %s algorithms after unsuccessful self test", st->name );
+}
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Поток, выполняющий контрольные примеры при инициализации библиотеки. */
+ static pthread_t ak_self_test_thread;
+/*! \brief Флаг того, что поток был запущен. */
+ static bool_t ak_self_test_thread_started = ak_false;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: контрольные примеры выполняются последовательно, один за другим.
+
+    \details Каждый пример сохраняет, сбрасывает и восстанавливает код ошибки потока. Код ошибки
+    хранится в локальной памяти потока, поэтому ошибки, возникающие в других потоках, не влияют
+    на результат примеров; при отсутствии такой поддержки одновременное выполнение нескольких
+    примеров недопустимо.                                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_libakrypt_self_test_worker( void *arg )
+{
+  size_t id = 0;
+
+  (void)arg;
+  for( id = 0; id < ak_self_test_count; id++ )
+     ak_libakrypt_self_test(( ak_self_test_t ) id );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция запускает выполнение всех контрольных примеров в фоновом потоке
+    (при значении опции `self_test_mode`, равном 2).
+
+    \details Обращение к алгоритму, контрольный пример для которого еще выполняется,
+    приостанавливает вызывающий поток до завершения примера. При отсутствии поддержки потоков,
+    а также при неудачном создании потока, контрольные примеры выполняются при первом
+    использовании алгоритмов.                                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_self_test_start( void )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if( ak_libakrypt_get_option( "self_test_mode" ) != 2 ) return;
+  if( ak_self_test_thread_started ) return;
+  if( pthread_create( &ak_self_test_thread, NULL, ak_libakrypt_self_test_worker, NULL ) == 0 )
+    ak_self_test_thread_started = ak_true;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция дожидается завершения потока, выполняющего контрольные примеры. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_self_test_stop( void )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if( ak_self_test_thread_started ) pthread_join( ak_self_test_thread, NULL );
+  ak_self_test_thread_started = ak_false;
+#endif
+}
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -389,6 +577,19 @@
     return ak_false;
   }
 
+ /* выбираем реализацию функции сжатия алгоритма Стрибог */
+  if( ak_hash_init_streebog_tables()  != ak_true ) {
+    ak_error_message( ak_error_get_value(), __func__ ,
+                                  "incorrect initialization of streebog predefined tables" );
+    return ak_false;
+  }
+
+#ifdef LIBAKRYPT_CRYPTO_FUNCTIONS
+ /* контрольные примеры выполняются при первом использовании алгоритмов,
+    либо (в зависимости от значения опции self_test_mode) запускаются в фоновом потоке */
+  ak_libakrypt_self_test_start();
+#endif
+
  /* процедура полного тестирования всех криптографических алгоритмов
     занимает крайне много времени, особенно на встраиваемых платформах,
     поэтому ее запуск должен производиться в соответствии с неким (внешним) регламентом ....
@@ -414,6 +615,16 @@
   if( error != ak_error_ok )
     ak_error_message( error, __func__ , "before destroing library holds an error" );
 
+#ifdef LIBAKRYPT_CRYPTO_FUNCTIONS
+ /* дожидаемся завершения фонового тестирования алгоритмов */
+  ak_libakrypt_self_test_stop();
+#endif
+
+#ifdef LIBAKRYPT_PKCS_15_CONTAINER
+ /* уничтожаем ключи, сохраненные в кэше ключей KEK контейнеров PKCS#15 */
+  pkcs_15_kek_cache_purge();
+#endif
+
  /* уничтожаем структуру управления контекстами */
   if( ak_libakrypt_destroy_context_manager() != ak_error_ok ) {
     ak_error_message( ak_error_get_value(), __func__, "destroying of context manager is wrong" );
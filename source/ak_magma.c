@@ -497,6 +497,231 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                     битслайсовая реализация для нескольких блоков                               */
+/* ----------------------------------------------------------------------------------------------- */
+/*  Блоки обрабатываются группами по 64: j-е слово массива из 64-х 64-битных слов содержит
+    j-е биты всех блоков группы (младшие 32 слова -- половину n3, старшие -- половину n4).
+    Сложение с раундовым ключом выполняется как сложение с переносом, подстановки вычисляются
+    по их алгебраической нормальной форме, циклический сдвиг сводится к перенумерации слов.
+    Раундовый ключ не освобождается от маски: к половине блока прибавляется маскированный ключ,
+    после чего из суммы вычитается маска, так что значение ключа не появляется в памяти в явном
+    виде. Реализация не содержит обращений к памяти, зависящих от данных или ключа, поэтому
+    случайная траектория, используемая при зашифровании одного блока, здесь не применяется.      */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Порядок использования раундовых ключей при зашифровании. */
+ static const ak_uint8 ak_magma_encrypt_order[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7 };
+/*! \brief Порядок использования раундовых ключей при расшифровании. */
+ static const ak_uint8 ak_magma_decrypt_order[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция транспонирует битовую матрицу размера 64x64: i-й бит j-го слова
+    становится j-м битом i-го слова.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_bitsliced_transpose( ak_uint64 *s )
+{
+  int j = 32, k = 0;
+  ak_uint64 t, m = 0x00000000FFFFFFFFLL;
+
+  for( ; j != 0; j >>= 1, m ^= m << j )
+     for( k = 0; k < 64; k = (( k|j ) + 1 )&~j ) {
+        t = (( s[k] >> j )^s[k|j] )&m;
+        s[k|j] ^= t;
+        s[k] ^= t << j;
+     }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует один такт шифрующего преобразования для 64-х блоков одновременно:
+    к половине b прибавляется результат преобразования половины a на раундовом ключе,
+    заданном маскированным значением k и маской m (ключ равен k - m по модулю 2^32).
+    Массив x из 32-х слов используется для хранения промежуточных значений.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_bitsliced_round( const ak_uint64 *a, ak_uint64 *b, ak_uint64 *x,
+                                                              const ak_uint32 k, const ak_uint32 m )
+{
+  int j = 0;
+  ak_uint64 c = 0, t, km;
+  ak_uint64 x0, x1, x2, x3, x01, x02, x03, x12, x13, x23, x012, x013, x023, x123;
+
+ /* сложение с маскированным раундовым ключом по модулю 2^32 */
+  for( j = 0; j < 32; j++ ) {
+     km = ( ak_uint64 )0 - (( k >> j )&1 );
+     t = a[j]^c;
+     x[j] = t^km;
+     c = ( a[j]&c )|( km&t );
+  }
+ /* вычитание маски, т.е. сложение с ее дополнением и единицей */
+  for( j = 0, c = ~( ak_uint64 )0; j < 32; j++ ) {
+     km = (( ak_uint64 )(( m >> j )&1 )) - 1;
+     t = x[j]^c;
+     c = ( x[j]&c )|( km&t );
+     x[j] = t^km;
+  }
+
+ /* подстановки и циклический сдвиг на 11 разрядов влево */
+  /* подстановка pi_0 */
+  x0 = x[0]; x1 = x[1]; x2 = x[2]; x3 = x[3];
+  x01 = x0&x1; x02 = x0&x2; x03 = x0&x3; x12 = x1&x2; x13 = x1&x3; x23 = x2&x3;
+  x012 = x01&x2; x013 = x01&x3; x023 = x02&x3; x123 = x12&x3;
+  b[11] ^= x02^x12^x012^x13^x123;
+  b[12] ^= x1^x2^x02^x12^x3^x03^x023^x123;
+  b[13] ^= ~( x01^x2^x02^x03^x123 );
+  b[14] ^= ~( x0^x1^x01^x12^x03^x13^x23 );
+  /* подстановка pi_1 */
+  x0 = x[4]; x1 = x[5]; x2 = x[6]; x3 = x[7];
+  x01 = x0&x1; x02 = x0&x2; x03 = x0&x3; x12 = x1&x2; x13 = x1&x3; x23 = x2&x3;
+  x012 = x01&x2; x013 = x01&x3; x023 = x02&x3; x123 = x12&x3;
+  b[15] ^= x01^x2^x02^x012^x3^x03^x13^x013^x23;
+  b[16] ^= ~( x0^x01^x2^x3^x013^x123 );
+  b[17] ^= ~( x0^x1^x01^x2^x02^x012^x3^x23^x023^x123 );
+  b[18] ^= x0^x01^x2^x02^x12;
+  /* подстановка pi_2 */
+  x0 = x[8]; x1 = x[9]; x2 = x[10]; x3 = x[11];
+  x01 = x0&x1; x02 = x0&x2; x03 = x0&x3; x12 = x1&x2; x13 = x1&x3; x23 = x2&x3;
+  x012 = x01&x2; x013 = x01&x3; x023 = x02&x3; x123 = x12&x3;
+  b[19] ^= ~( x01^x2^x02^x012^x3^x03^x13^x013^x23^x023^x123 );
+  b[20] ^= ~( x1^x12^x012^x03^x13^x23^x023 );
+  b[21] ^= x1^x01^x02^x12^x012^x3^x03^x13^x023^x123;
+  b[22] ^= ~( x0^x1^x2^x012^x013^x23^x023 );
+  /* подстановка pi_3 */
+  x0 = x[12]; x1 = x[13]; x2 = x[14]; x3 = x[15];
+  x01 = x0&x1; x02 = x0&x2; x03 = x0&x3; x12 = x1&x2; x13 = x1&x3; x23 = x2&x3;
+  x012 = x01&x2; x013 = x01&x3; x023 = x02&x3; x123 = x12&x3;
+  b[23] ^= x01^x2^x02^x012^x3^x03^x13^x013^x23^x023^x123;
+  b[24] ^= x1^x01^x012^x3^x03^x13^x013^x023^x123;
+  b[25] ^= ~( x0^x1^x01^x02^x12^x012^x013^x23^x023 );
+  b[26] ^= ~( x1^x02^x12^x3^x013^x123 );
+  /* подстановка pi_4 */
+  x0 = x[16]; x1 = x[17]; x2 = x[18]; x3 = x[19];
+  x01 = x0&x1; x02 = x0&x2; x03 = x0&x3; x12 = x1&x2; x13 = x1&x3; x23 = x2&x3;
+  x012 = x01&x2; x013 = x01&x3; x023 = x02&x3; x123 = x12&x3;
+  b[27] ^= ~( x01^x2^x02^x012^x3^x03^x13^x013^x023 );
+  b[28] ^= ~( x1^x01^x2^x3^x013^x023^x123 );
+  b[29] ^= ~( x01^x2^x12^x012^x3^x23^x023^x123 );
+  b[30] ^= x0^x2^x12;
+  /* подстановка pi_5 */
+  x0 = x[20]; x1 = x[21]; x2 = x[22]; x3 = x[23];
+  x01 = x0&x1; x02 = x0&x2; x03 = x0&x3; x12 = x1&x2; x13 = x1&x3; x23 = x2&x3;
+  x012 = x01&x2; x013 = x01&x3; x023 = x02&x3; x123 = x12&x3;
+  b[31] ^= ~( x01^x02^x12^x13^x23 );
+  b[0] ^= x1^x02^x12^x3^x23^x123;
+  b[1] ^= ~( x2^x12^x012^x3^x03^x013^x123 );
+  b[2] ^= x0^x1^x2^x12^x012^x3^x13^x023;
+  /* подстановка pi_6 */
+  x0 = x[24]; x1 = x[25]; x2 = x[26]; x3 = x[27];
+  x01 = x0&x1; x02 = x0&x2; x03 = x0&x3; x12 = x1&x2; x13 = x1&x3; x23 = x2&x3;
+  x012 = x01&x2; x013 = x01&x3; x023 = x02&x3; x123 = x12&x3;
+  b[3] ^= x01^x02^x12^x012^x3^x03^x013^x023^x123;
+  b[4] ^= x0^x1^x2^x012^x3^x13^x123;
+  b[5] ^= x0^x2^x12^x3^x03^x13^x23^x023^x123;
+  b[6] ^= ~( x1^x2^x02^x12^x03^x13^x23 );
+  /* подстановка pi_7 */
+  x0 = x[28]; x1 = x[29]; x2 = x[30]; x3 = x[31];
+  x01 = x0&x1; x02 = x0&x2; x03 = x0&x3; x12 = x1&x2; x13 = x1&x3; x23 = x2&x3;
+  x012 = x01&x2; x013 = x01&x3; x023 = x02&x3; x123 = x12&x3;
+  b[7] ^= ~( x1^x01^x2^x02^x12^x012^x3^x03^x13^x023^x123 );
+  b[8] ^= x0^x1^x02^x12^x012^x013^x123;
+  b[9] ^= x0^x1^x01^x12^x3^x03^x23^x023;
+  b[10] ^= x1^x012^x03^x23^x023^x123;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) не более 64-х блоков.
+    \details Недостающие до 64-х блоки считаются нулевыми, результат их преобразования
+    не сохраняется.
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации.
+    @param out Последовательность блоков выходной информации.
+    @param blocks Количество блоков (не более 64-х).
+    @param order Порядок использования раундовых ключей.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_bitsliced_blocks( ak_skey skey, const ak_uint8 *in, ak_uint8 *out,
+                                                       const size_t blocks, const ak_uint8 *order )
+{
+  int r = 0;
+  ak_uint64 s[64], x[32], *a = s, *b = s + 32, *t = NULL;
+  ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
+  ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
+
+  memset( s, 0, sizeof( s ));
+  memcpy( s, in, blocks << 3 );
+#ifndef LIBAKRYPT_LITTLE_ENDIAN
+  for( r = 0; r < ( int )blocks; r++ ) s[r] = bswap_64( s[r] );
+#endif
+  ak_magma_bitsliced_transpose( s );
+
+ /* раундовый ключ используется только в маскированном виде */
+  for( r = 0; r < 32; r++ ) {
+     ak_magma_bitsliced_round( a, b, x, kp[0][order[r]], mp[0][order[r]] );
+     t = a; a = b; b = t;
+  }
+
+ /* после последнего такта половины блоков меняются местами */
+  for( r = 0; r < 32; r++ ) {
+     ak_uint64 v = s[r]; s[r] = s[r+32]; s[r+32] = v;
+  }
+  ak_magma_bitsliced_transpose( s );
+#ifndef LIBAKRYPT_LITTLE_ENDIAN
+  for( r = 0; r < ( int )blocks; r++ ) s[r] = bswap_64( s[r] );
+#endif
+  memcpy( out, s, blocks << 3 );
+
+ /* очищаем промежуточные значения */
+  ak_ptr_wipe( x, sizeof( x ), &skey->generator, ak_true );
+  ak_ptr_wipe( s, sizeof( s ), &skey->generator, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования нескольких независимых блоков информации
+    алгоритмом ГОСТ 34.12-2015 (Магма).
+    \details Блоки обрабатываются битслайсовой реализацией группами по 64; неполная группа
+    из 32 и более блоков дополняется нулевыми блоками, оставшиеся блоки зашифровываются
+    по одному функцией ak_magma_encrypt_with_random_walk().
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации (открытый текст).
+    @param out Последовательность блоков выходной информации (шифртекст).
+    @param blocks Количество блоков.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_bitsliced( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_uint8 *inptr = ( ak_uint8 *)in, *outptr = ( ak_uint8 *)out;
+
+  for( ; blocks >= 64; blocks -= 64, inptr += 512, outptr += 512 )
+     ak_magma_bitsliced_blocks( skey, inptr, outptr, 64, ak_magma_encrypt_order );
+  if( blocks >= 32 ) ak_magma_bitsliced_blocks( skey, inptr, outptr, blocks, ak_magma_encrypt_order );
+   else for( ; blocks > 0; blocks--, inptr += 8, outptr += 8 )
+          ak_magma_encrypt_with_random_walk( skey, inptr, outptr );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования нескольких независимых блоков информации
+    алгоритмом ГОСТ 34.12-2015 (Магма).
+    \details Функция аналогична функции ak_magma_encrypt_blocks_bitsliced(); раундовые ключи
+    используются в обратном порядке.
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации (шифртекст).
+    @param out Последовательность блоков выходной информации (открытый текст).
+    @param blocks Количество блоков.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_bitsliced( ak_skey skey,
+                                                   ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_uint8 *inptr = ( ak_uint8 *)in, *outptr = ( ak_uint8 *)out;
+
+  for( ; blocks >= 64; blocks -= 64, inptr += 512, outptr += 512 )
+     ak_magma_bitsliced_blocks( skey, inptr, outptr, 64, ak_magma_decrypt_order );
+  if( blocks >= 32 ) ak_magma_bitsliced_blocks( skey, inptr, outptr, blocks, ak_magma_decrypt_order );
+   else for( ; blocks > 0; blocks--, inptr += 8, outptr += 8 )
+          ak_magma_decrypt_with_random_walk( skey, inptr, outptr );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция уничтожения развернутых ключей для маскированной магмы
 
@@ -539,22 +764,21 @@
  /* проверяем целостность ключа */
   if( skey->check_icode( skey ) != ak_true ) return ak_error_message( ak_error_wrong_key_icode,
                                                 __func__ , "using key with wrong integrity code" );
- /* удаляем былое */
-  if( skey->data != NULL ) ak_magma_context_delete_keys( skey );
-
-  if(( data = ak_libakrypt_aligned_malloc( sizeof( struct magma_encrypted_keys ))) == NULL )
-    return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
-
- /* выставляем флаги того, что память выделена */
-  memset( data, 0, sizeof( struct magma_encrypted_keys ));
-  skey->data = ( ak_pointer )data;
-  skey->flags |= skey_flag_data_not_free;
+ /* память выделяется только один раз, при повторной развертке
+    (например, при смене ключа в режиме ACPKM) ее содержимое полностью перезаписывается */
+  if(( data = ( struct magma_encrypted_keys * )skey->data ) == NULL ) {
+    if(( data = ak_libakrypt_aligned_malloc( sizeof( struct magma_encrypted_keys ))) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+
+   /* выставляем флаги того, что память выделена */
+    memset( data, 0, sizeof( struct magma_encrypted_keys ));
+    skey->data = ( ak_pointer )data;
+    skey->flags |= skey_flag_data_not_free;
+  }
 
- /* размещаем данные */
-  if(( error = ak_random_context_random( &skey->generator, data->inmask[0], 32 )) != ak_error_ok )
-    return ak_error_message( error, __func__, "incorrect generation first secret key mask" );
-  if(( error = ak_random_context_random( &skey->generator, data->inmask[1], 32 )) != ak_error_ok )
-    return ak_error_message( error, __func__, "incorrect generation second secret key mask" );
+ /* размещаем данные: маски для прямого и инвертированного ключей вырабатываются за один вызов */
+  if(( error = ak_random_context_random( &skey->generator, data->inmask, 64 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect generation of secret key masks" );
 
   for( idx = 0; idx < 8; idx++ ) {
      data->inkey[0][idx] = ((ak_uint32 *) skey->key.data )[idx];          /* скопировали */
@@ -832,6 +1056,9 @@ int ak_bckey_context_create_magma( ak_bckey bkey )
   int error = ak_error_ok;
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_magma )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using magma after unsuccessful self test" );
 
  /* создаем ключ алгоритма шифрования и определяем его методы */
   if(( error = ak_bckey_context_create( bkey, 32, 8 )) != ak_error_ok )
@@ -860,6 +1087,8 @@ int ak_bckey_context_create_magma( ak_bckey bkey )
   bkey->delete_keys = ak_magma_context_delete_keys;
   bkey->encrypt = ak_magma_encrypt_with_random_walk;
   bkey->decrypt = ak_magma_decrypt_with_random_walk;
+  bkey->encrypt_blocks = ak_magma_encrypt_blocks_bitsliced;
+  bkey->decrypt_blocks = ak_magma_decrypt_blocks_bitsliced;
 
   return error;
 }
@@ -869,6 +1098,7 @@ int ak_bckey_context_create_magma( ak_bckey bkey )
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_bckey_test_magma( void )
 {
+  size_t i = 0;
   char *str = NULL;
   ak_uint8 out[32];
   struct bckey bkey; /* контекст используемого для тестов ключа */
@@ -908,6 +1138,37 @@ int ak_bckey_context_create_magma( ak_bckey bkey )
   ak_uint8 xout1[13] = {
     0x7C, 0xC9, 0x83, 0x3D, 0x5D, 0x1B, 0x9E, 0x81, 0x07, 0x94, 0x9F, 0x58, 0x15 };
 
+ /* синхропосылки для режимов с обратной связью из ГОСТ Р 34.13-2015, приложение А.2 */
+  ak_uint8 iv2[16] = {
+     0xef, 0xcd, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12, 0xf1, 0xde, 0xbc, 0x0a, 0x89, 0x67, 0x45, 0x23 };
+  ak_uint8 iv3[24] = {
+     0xef, 0xcd, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12, 0xf1, 0xde, 0xbc, 0x0a, 0x89, 0x67, 0x45, 0x23,
+     0x12, 0xef, 0xcd, 0xab, 0x90, 0x78, 0x56, 0x34 };
+
+ /* результаты зашифрования в режимах простой замены с зацеплением,
+    гаммирования с обратной связью по шифртексту и по выходу */
+  ak_uint8 out_3413_2015_cbc_text[32] = {
+     0x19, 0x39, 0x68, 0xea, 0x5e, 0xb0, 0xd1, 0x96, 0xb9, 0x37, 0xb9, 0xab, 0x29, 0x61, 0xf7, 0xaf,
+     0x19, 0x00, 0xbc, 0xc4, 0xa1, 0xb4, 0x58, 0x50, 0x67, 0xe6, 0xd7, 0x7c, 0x1a, 0x8b, 0xb7, 0x20 };
+  ak_uint8 out_3413_2015_cfb_text[32] = {
+     0x83, 0x3c, 0x90, 0x66, 0xe2, 0xe0, 0x37, 0xdb, 0x9c, 0x08, 0x9a, 0x1f, 0x4c, 0x64, 0x46, 0x0d,
+     0x8b, 0xd3, 0x15, 0x53, 0x03, 0xd2, 0xbd, 0x24, 0x05, 0x55, 0x07, 0x21, 0x14, 0x32, 0xc0, 0xbc };
+  ak_uint8 out_3413_2015_ofb_text[32] = {
+     0x83, 0x3c, 0x90, 0x66, 0xe2, 0xe0, 0x37, 0xdb, 0x9c, 0x08, 0x9a, 0x1f, 0x4c, 0x64, 0x46, 0x0d,
+     0x7e, 0x32, 0x0e, 0x43, 0x62, 0x30, 0xf8, 0xa0, 0x05, 0xdb, 0x4f, 0xbd, 0xb8, 0xef, 0x24, 0xc8 };
+
+ /* перечень проверяемых режимов */
+  struct {
+    ak_function_bckey_encrypt *encrypt, *decrypt;
+    ak_uint8 *iv, *out;
+    size_t iv_size;
+    const char *name;
+  } modes[3] = {
+    { ak_bckey_context_encrypt_cbc, ak_bckey_context_decrypt_cbc, iv3, out_3413_2015_cbc_text, 24, "cbc" },
+    { ak_bckey_context_encrypt_cfb, ak_bckey_context_decrypt_cfb, iv2, out_3413_2015_cfb_text, 16, "cfb" },
+    { ak_bckey_context_ofb, ak_bckey_context_ofb, iv2, out_3413_2015_ofb_text, 16, "ofb" }
+  };
+
  /* тестовое значение имитовставки */
   ak_uint8 imito[8] = { 0xBB, 0xC5, 0x30, 0x20, 0x10, 0x72, 0x4E, 0x15 };
 
@@ -1039,7 +1300,43 @@ int ak_bckey_context_create_magma( ak_bckey bkey )
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                                   "the counter mode encryption/decryption test for 13 octets is Ok" );
 
- /* 7. Тестируем режим выработки имитовставки (плоская реализация). */
+ /* 7. Тестируем режимы простой замены с зацеплением, гаммирования с обратной связью
+       по шифртексту и гаммирования с обратной связью по выходу согласно ГОСТ Р34.13-2015 */
+  for( i = 0; i < 3; i++ ) {
+    if(( error = modes[i].encrypt( &bkey, in_3413_2015_text, out, 32,
+                                          modes[i].iv, modes[i].iv_size )) != ak_error_ok ) {
+      ak_error_message_fmt( error, __func__ , "wrong %s mode encryption", modes[i].name );
+      result = ak_false;
+      goto exit;
+    }
+    if( !ak_ptr_is_equal( out, modes[i].out, 32 )) {
+      ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                     "the %s mode encryption test from GOST R 34.13-2015 is wrong", modes[i].name );
+      ak_log_set_message( str = ak_ptr_to_hexstr( out, 32, ak_true )); free( str );
+      ak_log_set_message( str = ak_ptr_to_hexstr( modes[i].out, 32, ak_true )); free( str );
+      result = ak_false;
+      goto exit;
+    }
+
+    if(( error = modes[i].decrypt( &bkey, modes[i].out, out, 32,
+                                          modes[i].iv, modes[i].iv_size )) != ak_error_ok ) {
+      ak_error_message_fmt( error, __func__ , "wrong %s mode decryption", modes[i].name );
+      result = ak_false;
+      goto exit;
+    }
+    if( !ak_ptr_is_equal( out, in_3413_2015_text, 32 )) {
+      ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                     "the %s mode decryption test from GOST R 34.13-2015 is wrong", modes[i].name );
+      ak_log_set_message( str = ak_ptr_to_hexstr( out, 32, ak_true )); free( str );
+      ak_log_set_message( str = ak_ptr_to_hexstr( in_3413_2015_text, 32, ak_true )); free( str );
+      result = ak_false;
+      goto exit;
+    }
+    if( audit >= ak_log_maximum ) ak_error_message_fmt( ak_error_ok, __func__ ,
+           "the %s mode encryption/decryption test from GOST R 34.13-2015 is Ok", modes[i].name );
+  }
+
+ /* 8. Тестируем режим выработки имитовставки (плоская реализация). */
   ak_bckey_context_omac( &bkey, in_3413_2015_text, sizeof( in_3413_2015_text ), out );
   if(( error = ak_error_get_value()) != ak_error_ok ) {
     ak_error_message( error, __func__ , "wrong omac calculation" );
@@ -18,6 +18,7 @@
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <ak_mgm.h>
+ #include <ak_tools.h>
 
 /* ----------------------------------------------------------------------------------------------- */
  #define ak_mgm_assosiated_data_bit  (0x1)
@@ -75,6 +76,7 @@
   memset( ctx->sum.b, 0, 16 );
   memset( ctx->sum.b, 0, 16 );
 
+  memset( ivector, 0, 16 );
   memcpy( ivector, iv, iv_size ); /* копируем нужное количество байт */
  /* принудительно устанавливаем старший бит в 1 */
   ivector[authenticationKey->bsize-1] = ( ivector[authenticationKey->bsize-1]&0x7F ) ^ 0x80;
@@ -116,6 +118,63 @@
 
 #endif
 
+#ifdef LIBAKRYPT_LITTLE_ENDIAN
+ #define znext64  ctx->zcount.w[1]++;
+ #define znext128 ctx->zcount.q[1]++;
+
+#else
+ #define znext64  ctx->zcount.w[1] = bswap_32( ctx->zcount.w[1] ); \
+                  ctx->zcount.w[1]++; \
+                  ctx->zcount.w[1] = bswap_32( ctx->zcount.w[1] );
+
+ #define znext128 ctx->zcount.q[1] = bswap_64( ctx->zcount.q[1] ); \
+                  ctx->zcount.q[1]++; \
+                  ctx->zcount.q[1] = bswap_64( ctx->zcount.q[1] );
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает заданное количество последовательных блоков данных
+    в ходе выработки имитовставки.
+    \details Значения счетчика \f$ Z_i \f$ записываются в один массив и зашифровываются
+    за один вызов функции bckey.encrypt_blocks, после чего сумма произведений
+    \f$ \sum H_i\cdot A_i \f$ вычисляется с однократным приведением по модулю
+    (функции ak_gf64_mul_sum() и ak_gf128_mul_sum()) и прибавляется к текущему значению
+    имитовставки. Счетчик, хранящийся в контексте, увеличивается на `count`.
+
+    @param ctx Контекст внутреннего состояния алгоритма
+    @param authenticationKey Ключ, используемый для шифрования счетчика
+    @param data Указатель на обрабатываемые блоки данных
+    @param count Количество блоков, не превосходящее \ref ak_bckey_blocks_count                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_context_hsum( ak_mgm_ctx ctx, ak_bckey authenticationKey,
+                                                         const ak_pointer data, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 cv[2*ak_bckey_blocks_count], hv[2*ak_bckey_blocks_count];
+
+  if( authenticationKey->bsize&0x10 ) {
+    for( i = 0; i < count; i++ ) {
+       cv[2*i] = ctx->zcount.q[0]; cv[2*i+1] = ctx->zcount.q[1];
+       znext128;
+    }
+    authenticationKey->encrypt_blocks( &authenticationKey->key, cv, hv, count );
+    ak_gf128_mul_sum( ctx->sum.q, hv, data, count );
+  } else {
+      for( i = 0; i < count; i++ ) {
+         cv[i] = ctx->zcount.q[0];
+         znext64;
+      }
+      authenticationKey->encrypt_blocks( &authenticationKey->key, cv, hv, count );
+      ak_gf64_mul_sum( ctx->sum.q, hv, data, count );
+    }
+
+ /* очищаем использованные значения счетчиков и множителей */
+  if( count ) {
+    ak_ptr_wipe( cv, count*authenticationKey->bsize, &authenticationKey->key.generator, ak_true );
+    ak_ptr_wipe( hv, count*authenticationKey->bsize, &authenticationKey->key.generator, ak_true );
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция обрабатывает очередной блок дополнительных данных и
     обновляет внутреннее состояние переменных алгоритма MGM, участвующих в алгоритме
@@ -141,7 +200,7 @@
   ak_uint128 h;
   ak_uint8 temp[16], *aptr = (ak_uint8 *)adata;
   ssize_t absize = ( ssize_t ) authenticationKey->bsize;
-  ssize_t resource = 0,
+  ssize_t resource = 0, count = 0,
           tail = ( ssize_t ) adata_size%absize,
           blocks = ( ssize_t ) adata_size/absize;
 
@@ -161,7 +220,10 @@
  if( absize == 16 ) { /* обработка 128-битным шифром */
 
    ctx->abitlen += ( blocks  << 7 );
-   for( ; blocks > 0; blocks--, aptr += 16 ) { astep128( aptr ); }
+   for( ; blocks > 0; blocks -= count, aptr += 16*count ) {
+      count = ak_min( blocks, ak_bckey_blocks_count );
+      ak_mgm_context_hsum( ctx, authenticationKey, aptr, (size_t) count );
+   }
    if( tail ) {
     memset( temp, 0, 16 );
     memcpy( temp+absize-tail, aptr, (size_t)tail );
@@ -173,7 +235,10 @@
  } else { /* обработка 64-битным шифром */
 
    ctx->abitlen += ( blocks << 6 );
-   for( ; blocks > 0; blocks--, aptr += 8 ) { astep64( aptr ); }
+   for( ; blocks > 0; blocks -= count, aptr += 8*count ) {
+      count = ak_min( blocks, ak_bckey_blocks_count );
+      ak_mgm_context_hsum( ctx, authenticationKey, aptr, (size_t) count );
+   }
    if( tail ) {
     memset( temp, 0, 8 );
     memcpy( temp+absize-tail, aptr, (size_t)tail );
@@ -324,30 +389,130 @@
 
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef LIBAKRYPT_LITTLE_ENDIAN
- #define estep64  encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  ctx->ycount.w[0]++;
-
- #define estep128 encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  outp[1] = inp[1] ^ e.q[1]; \
-                  ctx->ycount.q[0]++;
+ #define ynext64  ctx->ycount.w[0]++;
+ #define ynext128 ctx->ycount.q[0]++;
 
 #else
- #define estep64  encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  ctx->ycount.w[0] = bswap_32( ctx->ycount.w[0] ); \
+ #define ynext64  ctx->ycount.w[0] = bswap_32( ctx->ycount.w[0] ); \
                   ctx->ycount.w[0]++; \
                   ctx->ycount.w[0] = bswap_32( ctx->ycount.w[0] );
 
- #define estep128 encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  outp[1] = inp[1] ^ e.q[1]; \
-                  ctx->ycount.q[0] = bswap_64( ctx->ycount.q[0] ); \
+ #define ynext128 ctx->ycount.q[0] = bswap_64( ctx->ycount.q[0] ); \
                   ctx->ycount.q[0]++; \
                   ctx->ycount.q[0] = bswap_64( ctx->ycount.q[0] );
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) заданное количество последовательных блоков
+    данных с одновременным обновлением имитовставки.
+
+    \details Обработка выполняется пакетами, содержащими не более \ref ak_bckey_blocks_count
+    блоков. Для каждого пакета значения счетчиков \f$ Y_i \f$ и \f$ Z_i \f$ вырабатываются
+    в одном цикле и зашифровываются двумя вызовами функции bckey.encrypt_blocks
+    (на ключе шифрования и ключе имитозащиты соответственно), после чего гамма накладывается
+    на данные, а сумма произведений \f$ \sum H_i\cdot C_i \f$ вычисляется с однократным
+    приведением по модулю. При расшифровании имитовставка вычисляется для входных данных до
+    наложения гаммы, поэтому допускается совпадение указателей `in` и `out`.
+
+    @param ctx Контекст внутреннего состояния алгоритма
+    @param encryptionKey Ключ, используемый для шифрования счетчика \f$ Y_i \f$
+    @param authenticationKey Ключ, используемый для шифрования счетчика \f$ Z_i \f$;
+    если указатель равен NULL, то имитовставка не вычисляется
+    @param in Указатель на входные данные
+    @param out Указатель на область памяти, в которую помещается результат
+    @param blocks Количество обрабатываемых блоков
+    @param encrypt Флаг, равный \ref ak_true при зашифровании и \ref ak_false при расшифровании */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mgm_context_blocks( ak_mgm_ctx ctx, ak_bckey encryptionKey,
+              ak_bckey authenticationKey, const ak_uint64 *inp, ak_uint64 *outp, size_t blocks,
+                                                                            const bool_t encrypt )
+{
+  size_t i = 0, count = 0, words = 0, wsize = encryptionKey->bsize >> 3,
+         used = ak_min( blocks, ak_bckey_blocks_count )*encryptionKey->bsize;
+  ak_uint64 ycv[2*ak_bckey_blocks_count], zcv[2*ak_bckey_blocks_count];
+  ak_uint64 gamma[2*ak_bckey_blocks_count], hv[2*ak_bckey_blocks_count];
+
+  for( ; blocks > 0; blocks -= count, inp += words, outp += words ) {
+     count = ak_min( blocks, ak_bckey_blocks_count );
+     words = count*wsize;
+
+    /* вырабатываем значения обоих счетчиков за один проход */
+     if( wsize == 2 ) {
+       for( i = 0; i < count; i++ ) {
+          ycv[2*i] = ctx->ycount.q[0]; ycv[2*i+1] = ctx->ycount.q[1];
+          ynext128;
+          if( authenticationKey == NULL ) continue;
+          zcv[2*i] = ctx->zcount.q[0]; zcv[2*i+1] = ctx->zcount.q[1];
+          znext128;
+       }
+     } else {
+         for( i = 0; i < count; i++ ) {
+            ycv[i] = ctx->ycount.q[0];
+            ynext64;
+            if( authenticationKey == NULL ) continue;
+            zcv[i] = ctx->zcount.q[0];
+            znext64;
+         }
+       }
+
+    /* многоблочное шифрование счетчиков */
+     encryptionKey->encrypt_blocks( &encryptionKey->key, ycv, gamma, count );
+     if( authenticationKey == NULL ) {
+       for( i = 0; i < words; i++ ) outp[i] = inp[i] ^ gamma[i];
+       continue;
+     }
+     authenticationKey->encrypt_blocks( &authenticationKey->key, zcv, hv, count );
+
+    /* наложение гаммы и обновление имитовставки */
+     if( !encrypt ) {
+       if( wsize == 2 ) ak_gf128_mul_sum( ctx->sum.q, hv, (ak_pointer) inp, count );
+         else ak_gf64_mul_sum( ctx->sum.q, hv, (ak_pointer) inp, count );
+     }
+     for( i = 0; i < words; i++ ) outp[i] = inp[i] ^ gamma[i];
+     if( encrypt ) {
+       if( wsize == 2 ) ak_gf128_mul_sum( ctx->sum.q, hv, outp, count );
+         else ak_gf64_mul_sum( ctx->sum.q, hv, outp, count );
+     }
+  }
+
+ /* очищаем использованные значения гаммы, множителей и счетчиков */
+  if( used == 0 ) return;
+  ak_ptr_wipe( gamma, used, &encryptionKey->key.generator, ak_true );
+  ak_ptr_wipe( ycv, used, &encryptionKey->key.generator, ak_true );
+  if( authenticationKey != NULL ) {
+    ak_ptr_wipe( hv, used, &authenticationKey->key.generator, ak_true );
+    ak_ptr_wipe( zcv, used, &authenticationKey->key.generator, ak_true );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает последний, неполный блок данных и закрывает контекст
+    для добавления шифруемых данных.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mgm_context_tail( ak_mgm_ctx ctx, ak_bckey encryptionKey,
+                     ak_bckey authenticationKey, const ak_uint8 *inp, ak_uint8 *outp,
+                                                         const size_t tail, const bool_t encrypt )
+{
+  ak_uint128 e, h;
+  ak_uint8 temp[16];
+  size_t i = 0, absize = encryptionKey->bsize;
+
+  memset( temp, 0, 16 );
+  if(( authenticationKey != NULL ) && !encrypt ) memcpy( temp+absize-tail, inp, tail );
+  encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
+  for( i = 0; i < tail; i++ ) outp[i] = inp[i] ^ e.b[absize-tail+i];
+
+  if( authenticationKey != NULL ) {
+    if( encrypt ) memcpy( temp+absize-tail, outp, tail );
+    if( absize&0x10 ) { astep128( temp ); }
+      else { astep64( temp ); }
+  }
+
+ /* закрываем добавление шифруемых данных */
+  ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
+  ctx->pbitlen += ( tail << 3 );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция зашифровывает очередной фрагмент данных и
     обновляет внутреннее состояние переменных алгоритма MGM, участвующих в алгоритме
@@ -369,10 +534,7 @@
  int ak_mgm_context_encryption_update( ak_mgm_ctx ctx, ak_bckey encryptionKey,
          ak_bckey authenticationKey, const ak_pointer in, ak_pointer out, const size_t size )
 {
-  ak_uint128 e, h;
-  ak_uint8 temp[16];
-  size_t i = 0, absize = encryptionKey->bsize;
-  ak_uint64 *inp = (ak_uint64 *)in, *outp = (ak_uint64 *)out;
+  size_t absize = encryptionKey->bsize;
   size_t resource = 0,
          tail = size%absize,
          blocks = size/absize;
@@ -401,85 +563,12 @@
                                                    "using encryption key with low key resource");
   else encryptionKey->key.resource.value.counter -= resource;
 
- /* теперь обработка данных */
-  memset( &e, 0, 16 );
+ /* теперь обработка данных: сначала полные блоки, потом хвост */
   ctx->pbitlen += ( absize*blocks << 3 );
-  if( authenticationKey == NULL ) { /* только шифрование (без вычисления имитовставки) */
-
-    if( absize&0x10 ) { /* режим работы для 128-битного шифра */
-     /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
-      }
-      /* хвост */
-      if( tail ) {
-        encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
-        for( i = 0; i < tail; i++ )
-           ((ak_uint8 *)outp)[i] = ((ak_uint8 *)inp)[i] ^ e.b[16-tail+i];
-       /* закрываем добавление шифруемых данных */
-        ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
-        ctx->pbitlen += ( tail << 3 );
-      }
-
-    } else { /* режим работы для 64-битного шифра */
-       /* основная часть */
-        for( ; blocks > 0; blocks--, inp++, outp++ ) {
-           estep64;
-        }
-       /* хвост */
-        if( tail ) {
-          encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
-          for( i = 0; i < tail; i++ )
-             ((ak_uint8 *)outp)[i] = ((ak_uint8 *)inp)[i] ^ e.b[8-tail+i];
-         /* закрываем добавление шифруемых данных */
-          ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
-          ctx->pbitlen += ( tail << 3 );
-        }
-      } /* конец шифрования без аутентификации для 64-битного шифра */
-
-  } else { /* основной режим работы => шифрование с одновременной выработкой имитовставки */
-
-     if( absize&0x10 ) { /* режим работы для 128-битного шифра */
-      /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
-         astep128( outp );
-      }
-      /* хвост */
-      if( tail ) {
-        memset( temp, 0, 16 );
-        encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
-        for( i = 0; i < tail; i++ )
-           ((ak_uint8 *)outp)[i] = ((ak_uint8 *)inp)[i] ^ e.b[16-tail+i];
-        memcpy( temp+16-tail, outp, (size_t)tail );
-        astep128( temp );
-
-       /* закрываем добавление шифруемых данных */
-        ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
-        ctx->pbitlen += ( tail << 3 );
-      }
-
-    } else { /* режим работы для 64-битного шифра */
-      /* основная часть */
-       for( ; blocks > 0; blocks--, inp++, outp++ ) {
-          estep64;
-          astep64( outp );
-       }
-       /* хвост */
-       if( tail ) {
-         memset( temp, 0, 8 );
-         encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
-         for( i = 0; i < tail; i++ )
-            ((ak_uint8 *)outp)[i] = ((ak_uint8 *)inp)[i] ^ e.b[8-tail+i];
-         memcpy( temp+8-tail, outp, (size_t)tail );
-         astep64( temp );
-
-        /* закрываем добавление шифруемых данных */
-         ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
-         ctx->pbitlen += ( tail << 3 );
-       }
-     } /* конец 64-битного шифра */
-  }
+  ak_mgm_context_blocks( ctx, encryptionKey, authenticationKey,
+                                                         in, out, blocks, ak_true );
+  if( tail ) ak_mgm_context_tail( ctx, encryptionKey, authenticationKey,
+                     (ak_uint8 *)in + absize*blocks, (ak_uint8 *)out + absize*blocks, tail, ak_true );
 
  return ak_error_ok;
 }
@@ -505,10 +594,7 @@
  int ak_mgm_context_decryption_update( ak_mgm_ctx ctx, ak_bckey encryptionKey,
          ak_bckey authenticationKey, const ak_pointer in, ak_pointer out, const size_t size )
 {
-  ak_uint8 temp[16];
-  ak_uint128 e, h;
-  size_t i = 0, absize = encryptionKey->bsize;
-  ak_uint64 *inp = (ak_uint64 *)in, *outp = (ak_uint64 *)out;
+  size_t absize = encryptionKey->bsize;
   size_t resource = 0,
          tail = size%absize,
          blocks = size/absize;
@@ -537,85 +623,12 @@
                                                    "using encryption key with low key resource");
   else encryptionKey->key.resource.value.counter -= resource;
 
- /* теперь обработка данных */
-  memset( &e, 0, 16 );
+ /* теперь обработка данных: сначала полные блоки, потом хвост */
   ctx->pbitlen += ( absize*blocks << 3 );
-  if( authenticationKey == NULL ) { /* только шифрование (без вычисления имитовставки) */
-                                    /* это полная копия кода, содержащегося в функции .. _encryption_ ... */
-    if( absize&0x10 ) { /* режим работы для 128-битного шифра */
-     /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
-      }
-      /* хвост */
-      if( tail ) {
-        encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
-        for( i = 0; i < tail; i++ )
-           ((ak_uint8 *)outp)[i] = ((ak_uint8 *)inp)[i] ^ e.b[16-tail+i];
-       /* закрываем добавление шифруемых данных */
-        ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
-        ctx->pbitlen += ( tail << 3 );
-      }
-
-    } else { /* режим работы для 64-битного шифра */
-       /* основная часть */
-        for( ; blocks > 0; blocks--, inp++, outp++ ) {
-           estep64;
-        }
-       /* хвост */
-        if( tail ) {
-          encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
-          for( i = 0; i < tail; i++ )
-             ((ak_uint8 *)outp)[i] = ((ak_uint8 *)inp)[i] ^ e.b[8-tail+i];
-         /* закрываем добавление шифруемых данных */
-          ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
-          ctx->pbitlen += ( tail << 3 );
-        }
-      } /* конец шифрования без аутентификации для 64-битного шифра */
-
-  } else { /* основной режим работы => шифрование с одновременной выработкой имитовставки */
-
-     if( absize&0x10 ) { /* режим работы для 128-битного шифра */
-      /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         astep128( inp );
-         estep128;
-      }
-      /* хвост */
-      if( tail ) {
-        memset( temp, 0, 16 );
-        memcpy( temp+16-tail, inp, (size_t)tail );
-        astep128( temp );
-        encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
-        for( i = 0; i < tail; i++ )
-           ((ak_uint8 *)outp)[i] = ((ak_uint8 *)inp)[i] ^ e.b[16-tail+i];
-
-       /* закрываем добавление шифруемых данных */
-        ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
-        ctx->pbitlen += ( tail << 3 );
-      }
-
-    } else { /* режим работы для 64-битного шифра */
-      /* основная часть */
-       for( ; blocks > 0; blocks--, inp++, outp++ ) {
-          astep64( inp );
-          estep64;
-       }
-       /* хвост */
-       if( tail ) {
-         memset( temp, 0, 8 );
-         memcpy( temp+8-tail, inp, (size_t)tail );
-         astep64( temp );
-         encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
-         for( i = 0; i < tail; i++ )
-            ((ak_uint8 *)outp)[i] = ((ak_uint8 *)inp)[i] ^ e.b[8-tail+i];
-
-        /* закрываем добавление шифруемых данных */
-         ak_mgm_set_bit( ctx->flags, ak_mgm_encrypted_data_bit );
-         ctx->pbitlen += ( tail << 3 );
-       }
-     } /* конец 64-битного шифра */
-  }
+  ak_mgm_context_blocks( ctx, encryptionKey, authenticationKey,
+                                                         in, out, blocks, ak_false );
+  if( tail ) ak_mgm_context_tail( ctx, encryptionKey, authenticationKey,
+                    (ak_uint8 *)in + absize*blocks, (ak_uint8 *)out + absize*blocks, tail, ak_false );
 
  return ak_error_ok;
 }
@@ -908,6 +921,567 @@
  return result;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                   функции для обработки данных, расположенных в нескольких фрагментах           */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Текущее положение в последовательности фрагментов данных. */
+ typedef struct segment_cursor {
+  /*! \brief Массив фрагментов. */
+   ak_segment seg;
+  /*! \brief Количество фрагментов в массиве. */
+   size_t count;
+  /*! \brief Номер текущего фрагмента. */
+   size_t idx;
+  /*! \brief Смещение относительно начала текущего фрагмента. */
+   size_t offset;
+} *ak_segment_cursor;
+
+/*! \brief Указатель на данные, расположенные в текущем положении. */
+ #define ak_segment_cursor_ptr( cur ) ((ak_uint8 *)(cur)->seg[(cur)->idx].data + (cur)->offset)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает количество байт, непрерывно расположенных в памяти
+    начиная с текущего положения (пустые фрагменты пропускаются).                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_segment_cursor_span( ak_segment_cursor cur )
+{
+  while(( cur->idx < cur->count ) && ( cur->offset >= cur->seg[cur->idx].size )) {
+    cur->idx++;
+    cur->offset = 0;
+  }
+  if( cur->idx >= cur->count ) return 0;
+ return cur->seg[cur->idx].size - cur->offset;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция копирует `len` байт из последовательности фрагментов в буффер `buf`
+    (при `gather` равном \ref ak_true) или из буффера в последовательность фрагментов
+    (при `gather` равном \ref ak_false). Длина фрагментов должна быть проверена заранее.            */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_segment_cursor_copy( ak_segment_cursor cur, ak_uint8 *buf,
+                                                              size_t len, const bool_t gather )
+{
+  size_t n = 0;
+
+  while( len > 0 ) {
+    n = ak_min( len, ak_segment_cursor_span( cur ));
+    if( gather ) memcpy( buf, ak_segment_cursor_ptr( cur ), n );
+      else memcpy( ak_segment_cursor_ptr( cur ), buf, n );
+    buf += n; len -= n; cur->offset += n;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет корректность массива фрагментов и вычисляет их суммарную длину. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_segments_size( const ak_segment seg, const size_t count, size_t *size )
+{
+  size_t i = 0, total = 0;
+
+  *size = 0;
+  if( count == 0 ) return ak_error_ok;
+  if( seg == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to array of segments" );
+  for( i = 0; i < count; i++ ) {
+     if( seg[i].size == 0 ) continue;
+     if( seg[i].data == NULL ) return ak_error_message_fmt( ak_error_null_pointer, __func__,
+                                   "using null pointer to data of segment %u", (unsigned int) i );
+     if( total + seg[i].size < total ) return ak_error_message( ak_error_wrong_length, __func__,
+                                                            "total length of segments is very huge");
+     total += seg[i].size;
+  }
+  *size = total;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает ассоциированные и шифруемые данные, расположенные в нескольких
+    фрагментах, и оставляет контекст готовым к выработке имитовставки.
+
+    \details Фрагменты обрабатываются непосредственно, без объединения в одну область памяти:
+    функциям ak_mgm_context_authentication_update() и ak_mgm_context_encryption_update()
+    передаются максимальные участки, содержащие целое число блоков и расположенные одновременно
+    в одном входном и одном выходном фрагменте. Копируется только блок, который пересекает
+    границу фрагментов (не более одного блока за раз).                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_context_segments( ak_mgm_ctx mgm, ak_bckey encryptionKey,
+            ak_bckey authenticationKey, const ak_segment adata, const size_t acount,
+                   const ak_segment in, const size_t icount, ak_segment out, const size_t ocount,
+                                const ak_pointer iv, const size_t iv_size, const bool_t encrypt )
+{
+  ak_uint8 block[16];
+  int error = ak_error_ok;
+  struct segment_cursor ac, ic, oc;
+  size_t bs = 0, n = 0, asize = 0, psize = 0, osize = 0;
+
+ /* проверки ключей */
+  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ ,
+                               "using null pointers both to encryption and authentication keys" );
+  if(( encryptionKey != NULL ) && ( authenticationKey ) != NULL ) {
+    if( encryptionKey->bsize != authenticationKey->bsize )
+      return ak_error_message( ak_error_not_equal_data, __func__,
+                                                             "different block sizes for given keys");
+  }
+  if( encryptionKey != NULL ) bs = encryptionKey->bsize;
+    else bs = authenticationKey->bsize;
+
+ /* проверяем фрагменты и размер входных данных */
+  if(( error = ak_segments_size( adata, acount, &asize )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect segments of associated data" );
+  if(( error = ak_segments_size( in, icount, &psize )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect segments of input data" );
+  if(( error = ak_segments_size( out, ocount, &osize )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect segments of output data" );
+  if(( encryptionKey != NULL ) && ( osize < psize ))
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                "output segments are shorter than input segments" );
+  if(( error = ak_bckey_check_mgm_length( asize, psize, bs )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect length of input data");
+
+ /* подготавливаем память */
+  memset( mgm, 0, sizeof( struct mgm_ctx ));
+
+ /* в начале обрабатываем ассоциированные данные */
+  if( authenticationKey != NULL ) {
+    if(( error =
+         ak_mgm_context_authentication_clean( mgm, authenticationKey, iv, iv_size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect initialization of internal mgm context" );
+
+    ac.seg = adata; ac.count = acount; ac.idx = 0; ac.offset = 0;
+    for( ; asize > 0; asize -= n ) {
+       if(( n = ak_segment_cursor_span( &ac )) >= bs ) {
+         n -= n%bs;
+         error = ak_mgm_context_authentication_update( mgm, authenticationKey,
+                                                                ak_segment_cursor_ptr( &ac ), n );
+         ac.offset += n;
+       } else { /* блок пересекает границу фрагментов */
+           n = ak_min( bs, asize );
+           ak_segment_cursor_copy( &ac, block, n, ak_true );
+           error = ak_mgm_context_authentication_update( mgm, authenticationKey, block, n );
+         }
+       if( error != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+    }
+  }
+
+ /* потом зашифровываем (расшифровываем) данные */
+  if( encryptionKey != NULL ) {
+    if(( error =
+         ak_mgm_context_encryption_clean( mgm, encryptionKey, iv, iv_size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect initialization of internal mgm context" );
+
+    ic.seg = in; ic.count = icount; ic.idx = 0; ic.offset = 0;
+    oc.seg = out; oc.count = ocount; oc.idx = 0; oc.offset = 0;
+    for( ; psize > 0; psize -= n ) {
+       n = ak_segment_cursor_span( &ic );
+       if(( n = ak_min( n, ak_segment_cursor_span( &oc ))) >= bs ) {
+         n -= n%bs;
+         if( encrypt ) error = ak_mgm_context_encryption_update( mgm, encryptionKey,
+             authenticationKey, ak_segment_cursor_ptr( &ic ), ak_segment_cursor_ptr( &oc ), n );
+           else error = ak_mgm_context_decryption_update( mgm, encryptionKey,
+             authenticationKey, ak_segment_cursor_ptr( &ic ), ak_segment_cursor_ptr( &oc ), n );
+         ic.offset += n; oc.offset += n;
+       } else { /* блок пересекает границу входного или выходного фрагмента */
+           n = ak_min( bs, psize );
+           ak_segment_cursor_copy( &ic, block, n, ak_true );
+           if( encrypt ) error = ak_mgm_context_encryption_update( mgm, encryptionKey,
+                                                            authenticationKey, block, block, n );
+             else error = ak_mgm_context_decryption_update( mgm, encryptionKey,
+                                                            authenticationKey, block, block, n );
+           ak_segment_cursor_copy( &oc, block, n, ak_false );
+         }
+       if( error != ak_error_ok ) {
+         ak_ptr_wipe( block, sizeof( block ), &encryptionKey->key.generator, ak_true );
+         return ak_error_message( error, __func__, "incorrect encryption of plain data" );
+       }
+    }
+    ak_ptr_wipe( block, sizeof( block ), &encryptionKey->key.generator, ak_true );
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция аналогична функции ak_bckey_context_encrypt_mgm(), однако ассоциированные,
+    зашифровываемые и зашифрованные данные могут располагаться в нескольких несмежных областях
+    памяти (фрагментах) произвольной длины. Границы входных и выходных фрагментов могут не
+    совпадать; суммарная длина выходных фрагментов должна быть не меньше суммарной длины входных.
+    Объединение фрагментов в одну область памяти не производится.
+
+    @param encryptionKey ключ шифрования, может принимать значение NULL;
+    @param authenticationKey ключ выработки имитовставки, может принимать значение NULL;
+    @param adata массив фрагментов ассоциированных данных;
+    @param acount количество фрагментов ассоциированных данных;
+    @param in массив фрагментов зашифровываемых данных;
+    @param icount количество фрагментов зашифровываемых данных;
+    @param out массив фрагментов, в которые помещаются зашифрованные данные;
+    @param ocount количество выходных фрагментов;
+    @param iv указатель на синхропосылку;
+    @param iv_size длина синхропосылки в байтах;
+    @param icode указатель на область памяти, куда будет помещено значение имитовставки;
+    @param icode_size ожидаемый размер имитовставки в байтах.
+
+    @return Функция возвращает NULL, если указатель icode не есть NULL, в противном случае
+            возвращается указатель на буффер, содержащий результат вычислений. В случае
+            возникновения ошибки возвращается NULL, при этом код ошибки может быть получен с
+            помощью вызова функции ak_error_get_value().                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_buffer ak_bckey_context_encrypt_mgm_segments( ak_bckey encryptionKey,
+            ak_bckey authenticationKey, const ak_segment adata, const size_t acount,
+                   const ak_segment in, const size_t icount, ak_segment out, const size_t ocount,
+       const ak_pointer iv, const size_t iv_size, ak_pointer icode, const size_t icode_size )
+{
+  ak_buffer result = NULL;
+  int error = ak_error_ok;
+  struct mgm_ctx mgm; /* контекст структуры, в которой хранятся промежуточные данные */
+  ak_bckey wkey = ( authenticationKey != NULL ) ? authenticationKey : encryptionKey;
+
+  if(( error = ak_mgm_context_segments( &mgm, encryptionKey, authenticationKey, adata, acount,
+                                     in, icount, out, ocount, iv, iv_size, ak_true )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect processing of data segments" );
+   else
+    if( authenticationKey != NULL ) { /* в конце - вырабатываем имитовставку */
+      ak_error_set_value( ak_error_ok );
+      result = ak_mgm_context_authentication_finalize( &mgm, authenticationKey, icode, icode_size );
+      if(( error = ak_error_get_value()) != ak_error_ok ) {
+        if( result != NULL ) result = ak_buffer_delete( result );
+        ak_error_message( error, __func__, "incorrect finanlize of integrity code" );
+      }
+    }
+
+  if( wkey != NULL ) ak_ptr_wipe( &mgm, sizeof( struct mgm_ctx ), &wkey->key.generator, ak_true );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция аналогична функции ak_bckey_context_decrypt_mgm(), однако ассоциированные,
+    расшифровываемые и расшифрованные данные могут располагаться в нескольких несмежных областях
+    памяти (фрагментах) произвольной длины. Требования к фрагментам совпадают с требованиями
+    функции ak_bckey_context_encrypt_mgm_segments(); выходные фрагменты могут совпадать с входными.
+
+    @return Функция возвращает истину (\ref ak_true), если значение имитовтсавки совпало с
+            вычисленным в ходе выполнения функции значением; если значения не совпадают,
+            или в ходе выполнения функции возникла ошибка, то возвращается ложь (\ref ak_false).
+            При этом код ошибки может быть получен с
+            помощью вызова функции ak_error_get_value().                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_bckey_context_decrypt_mgm_segments( ak_bckey encryptionKey,
+            ak_bckey authenticationKey, const ak_segment adata, const size_t acount,
+                   const ak_segment in, const size_t icount, ak_segment out, const size_t ocount,
+       const ak_pointer iv, const size_t iv_size, ak_pointer icode, const size_t icode_size )
+{
+  bool_t result = ak_false;
+  int error = ak_error_ok;
+  struct mgm_ctx mgm; /* контекст структуры, в которой хранятся промежуточные данные */
+  ak_bckey wkey = ( authenticationKey != NULL ) ? authenticationKey : encryptionKey;
+
+  if(( error = ak_mgm_context_segments( &mgm, encryptionKey, authenticationKey, adata, acount,
+                                    in, icount, out, ocount, iv, iv_size, ak_false )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect processing of data segments" );
+   else {
+    if( authenticationKey != NULL ) { /* в конце - проверяем имитовставку */
+      ak_uint8 icode2[16];
+      memset( icode2, 0, 16 );
+
+      ak_error_set_value( ak_error_ok );
+      ak_mgm_context_authentication_finalize( &mgm, authenticationKey, icode2, icode_size );
+      if(( error = ak_error_get_value()) != ak_error_ok )
+        ak_error_message( error, __func__, "incorrect finalize of integrity code" );
+       else {
+          if( ak_ptr_is_equal( icode, icode2, icode_size )) result = ak_true;
+       }
+    } else result = ak_true; /* мы ни чего не проверяли => все хорошо */
+   }
+
+  if( wkey != NULL ) ak_ptr_wipe( &mgm, sizeof( struct mgm_ctx ), &wkey->key.generator, ak_true );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                      пакетная обработка большого количества коротких сообщений                  */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество блоков, зашифровываемых при обработке одной группы заданий. */
+ #define ak_mgm_jobs_blocks (4*ak_bckey_blocks_count)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет значение счетчика, увеличенное на `k`.
+    \details Для счетчика \f$ Y \f$ (параметр `half` равен 0) увеличивается младшая половина
+    блока, для счетчика \f$ Z \f$ (параметр `half` равен 1) -- старшая, так же как это делают
+    функции ak_mgm_context_encryption_update() и ak_mgm_context_authentication_update().          */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_counter( ak_uint64 *dst, const ak_uint64 *src,
+                                              const size_t bsize, const int half, const size_t k )
+{
+  if( bsize == 16 ) {
+    dst[0] = src[0]; dst[1] = src[1];
+   #ifdef LIBAKRYPT_LITTLE_ENDIAN
+    dst[half] += ( ak_uint64 )k;
+   #else
+    dst[half] = bswap_64( bswap_64( dst[half] ) + ( ak_uint64 )k );
+   #endif
+  } else {
+      ak_uint32 w[2];
+      memcpy( w, src, 8 );
+     #ifdef LIBAKRYPT_LITTLE_ENDIAN
+      w[half] += ( ak_uint32 )k;
+     #else
+      w[half] = bswap_32( bswap_32( w[half] ) + ( ak_uint32 )k );
+     #endif
+      memcpy( dst, w, 8 );
+    }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает последовательность блоков порциями,
+    не превосходящими \ref ak_bckey_blocks_count блоков.                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_encrypt_blocks( ak_bckey bkey,
+                                                    ak_uint64 *in, ak_uint64 *out, size_t blocks )
+{
+  size_t count = 0, words = bkey->bsize >> 3;
+
+  for( ; blocks > 0; blocks -= count, in += count*words, out += count*words ) {
+     count = ak_min( blocks, ak_bckey_blocks_count );
+     bkey->encrypt_blocks( &bkey->key, in, out, count );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет корректность задания и уменьшает ресурс ключей.
+    \return Количество блоков, зашифровываемых на ключе имитозащиты (в параметре `zblocks`)
+    и на ключе шифрования (в параметре `yblocks`), а также код ошибки.                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_job_check( ak_mgm_job job, size_t *zblocks, size_t *yblocks )
+{
+  int error = ak_error_ok;
+  size_t bs = 0, ablocks = 0, pblocks = 0;
+
+  if(( job->encryptionKey == NULL ) || ( job->authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to secret key" );
+  if(( bs = job->encryptionKey->bsize ) != job->authenticationKey->bsize )
+    return ak_error_message( ak_error_not_equal_data, __func__,
+                                                             "different block sizes for given keys");
+  if( bs > 16 ) return ak_error_message( ak_error_wrong_length, __func__,
+                                                               "using key with large block size" );
+  if((( job->encryptionKey->key.flags&skey_flag_set_key ) == 0 ) ||
+     (( job->authenticationKey->key.flags&skey_flag_set_key ) == 0 ))
+    return ak_error_message( ak_error_key_value, __func__,
+                                         "using block cipher key context with undefined key value");
+  if( job->iv == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                            "using null pointer to initial vector");
+  if(( job->iv_size == 0 ) || ( job->iv_size > bs ))
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                     "using initial vector with unexpected length");
+  if(( job->icode == NULL ) || ( job->icode_size == 0 ) || ( job->icode_size > bs ))
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                        "unexpected length of integrity code" );
+  if((( job->adata == NULL ) && ( job->adata_size > 0 )) ||
+     ((( job->in == NULL ) || ( job->out == NULL )) && ( job->size > 0 )))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to data" );
+  if(( error = ak_bckey_check_mgm_length( job->adata_size, job->size, bs )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect length of input data");
+
+ /* количество блоков и ресурс ключей (с учетом выработки начальных значений счетчиков) */
+  ablocks = ( job->adata_size + bs - 1 )/bs;
+  pblocks = ( job->size + bs - 1 )/bs;
+  *zblocks = ablocks + pblocks + 1;
+  *yblocks = pblocks;
+
+  if(( job->authenticationKey->key.resource.value.counter <= ( ssize_t )( *zblocks + 1 )) ||
+     ( job->encryptionKey->key.resource.value.counter <= ( ssize_t )( *yblocks + 1 )))
+    return ak_error_message( ak_error_low_key_resource, __func__,
+                                                                "using key with low key resource");
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция добавляет к имитовставке произведения множителей на `size` байт данных;
+    неполный последний блок дополняется нулями в младших байтах.                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_job_hash( ak_uint64 *sum, ak_uint64 *hv,
+                                          const ak_uint8 *data, const size_t size, const size_t bs )
+{
+  ak_uint64 temp[2];
+  size_t blocks = size/bs, tail = size%bs;
+
+  if( blocks ) {
+    if( bs == 16 ) ak_gf128_mul_sum( sum, hv, (ak_pointer) data, blocks );
+      else ak_gf64_mul_sum( sum, hv, (ak_pointer) data, blocks );
+  }
+  if( tail ) {
+    memset( temp, 0, sizeof( temp ));
+    memcpy( (ak_uint8 *)temp + bs - tail, data + blocks*bs, tail );
+    if( bs == 16 ) ak_gf128_mul_sum( sum, hv + 2*blocks, temp, 1 );
+      else ak_gf64_mul_sum( sum, hv + blocks, temp, 1 );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает группу заданий, использующих одни и те же ключи.
+    \details Начальные значения счетчиков всех сообщений группы, затем все значения
+    счетчиков \f$ Z_i \f$ и \f$ Y_i \f$ и, наконец, все имитовставки зашифровываются
+    многоблочными вызовами функции bckey.encrypt_blocks, что позволяет эффективно использовать
+    многоблочные реализации алгоритмов даже для очень коротких сообщений.                          */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mgm_jobs_group( ak_mgm_job *lanes, const size_t count,
+                                                       const size_t *zblocks, const size_t *yblocks )
+{
+  size_t i = 0, k = 0, zoff = 0, yoff = 0, tail = 0, bs = lanes[0]->encryptionKey->bsize;
+  ak_bckey ekey = lanes[0]->encryptionKey, akey = lanes[0]->authenticationKey;
+  size_t words = bs >> 3;
+  ak_uint64 zc[2*ak_mgm_jobs_blocks], hv[2*ak_mgm_jobs_blocks];
+  ak_uint64 yc[2*ak_mgm_jobs_blocks], gamma[2*ak_mgm_jobs_blocks];
+  ak_uint64 ziv[2*ak_bckey_blocks_count], yiv[2*ak_bckey_blocks_count];
+  ak_uint64 sum[2*ak_bckey_blocks_count];
+
+ /* 1. начальные значения счетчиков для всех сообщений */
+  for( i = 0; i < count; i++ ) {
+     ak_uint8 *z = (ak_uint8 *)( ziv + i*words ), *y = (ak_uint8 *)( yiv + i*words );
+     memset( z, 0, bs ); memcpy( z, lanes[i]->iv, lanes[i]->iv_size );
+     z[bs-1] = ( z[bs-1]&0x7F ) ^ 0x80;
+     memset( y, 0, bs ); memcpy( y, lanes[i]->iv, lanes[i]->iv_size );
+     y[lanes[i]->iv_size-1] &= 0x7F;
+  }
+  ak_mgm_encrypt_blocks( akey, ziv, ziv, count );
+  ak_mgm_encrypt_blocks( ekey, yiv, yiv, count );
+
+ /* 2. все значения счетчиков Z и Y */
+  for( i = 0; i < count; i++ ) {
+     for( k = 0; k < zblocks[i]; k++, zoff += words )
+        ak_mgm_counter( zc + zoff, ziv + i*words, bs, 1, k );
+     for( k = 0; k < yblocks[i]; k++, yoff += words )
+        ak_mgm_counter( yc + yoff, yiv + i*words, bs, 0, k );
+  }
+  ak_mgm_encrypt_blocks( akey, zc, hv, zoff/words );
+  ak_mgm_encrypt_blocks( ekey, yc, gamma, yoff/words );
+
+ /* 3. наложение гаммы и вычисление сумм произведений для каждого сообщения */
+  for( i = 0, zoff = 0, yoff = 0; i < count; i++ ) {
+     ak_mgm_job job = lanes[i];
+     ak_uint8 *inp = job->in, *outp = job->out, *gp = (ak_uint8 *)( gamma + yoff );
+     size_t full = ( job->size/bs )*bs;
+     ak_uint64 len[2];
+
+     for( k = 0; k < full; k++ ) outp[k] = inp[k] ^ gp[k];
+     if(( tail = job->size - full ) > 0 )
+       for( k = 0; k < tail; k++ ) outp[full+k] = inp[full+k] ^ gp[full+bs-tail+k];
+
+     sum[i*words] = 0; if( words == 2 ) sum[i*words+1] = 0;
+     ak_mgm_job_hash( sum + i*words, hv + zoff, job->adata, job->adata_size, bs );
+     zoff += (( job->adata_size + bs - 1 )/bs )*words;
+     ak_mgm_job_hash( sum + i*words, hv + zoff, job->out, job->size, bs );
+     zoff += (( job->size + bs - 1 )/bs )*words;
+
+    /* последний блок содержит длины данных в битах */
+     if( bs == 16 ) {
+      #ifdef LIBAKRYPT_LITTLE_ENDIAN
+       len[0] = ( ak_uint64 )job->size << 3; len[1] = ( ak_uint64 )job->adata_size << 3;
+      #else
+       len[0] = bswap_64(( ak_uint64 )job->size << 3 );
+       len[1] = bswap_64(( ak_uint64 )job->adata_size << 3 );
+      #endif
+       ak_gf128_mul_sum( sum + i*words, hv + zoff, len, 1 );
+     } else {
+        ak_uint32 w[2];
+       #ifdef LIBAKRYPT_LITTLE_ENDIAN
+        w[0] = ( ak_uint32 )( job->size << 3 ); w[1] = ( ak_uint32 )( job->adata_size << 3 );
+       #else
+        w[0] = bswap_32(( ak_uint32 )( job->size << 3 ));
+        w[1] = bswap_32(( ak_uint32 )( job->adata_size << 3 ));
+       #endif
+        memcpy( len, w, 8 );
+        ak_gf64_mul_sum( sum + i*words, hv + zoff, len, 1 );
+       }
+     zoff += words;
+     yoff += yblocks[i]*words;
+  }
+
+ /* 4. зашифрование всех имитовставок */
+  ak_mgm_encrypt_blocks( akey, sum, sum, count );
+  for( i = 0; i < count; i++ )
+     memcpy( lanes[i]->icode,
+          (ak_uint8 *)( sum + i*words ) + bs - lanes[i]->icode_size, lanes[i]->icode_size );
+
+ /* очищаем значения гаммы, множителей и счетчиков */
+  ak_ptr_wipe( gamma, sizeof( gamma ), &ekey->key.generator, ak_true );
+  ak_ptr_wipe( yc, sizeof( yc ), &ekey->key.generator, ak_true );
+  ak_ptr_wipe( yiv, sizeof( yiv ), &ekey->key.generator, ak_true );
+  ak_ptr_wipe( hv, sizeof( hv ), &akey->key.generator, ak_true );
+  ak_ptr_wipe( zc, sizeof( zc ), &akey->key.generator, ak_true );
+  ak_ptr_wipe( ziv, sizeof( ziv ), &akey->key.generator, ak_true );
+  ak_ptr_wipe( sum, sizeof( sum ), &akey->key.generator, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает в режиме MGM несколько независимых сообщений, каждое из которых
+    имеет собственные синхропосылку, ассоциированные данные и имитовставку. Результат
+    совпадает с результатом последовательных вызовов функции ak_bckey_context_encrypt_mgm()
+    для каждого из заданий.
+
+    Последовательные задания, использующие одни и те же ключи, объединяются в группы;
+    для каждой группы значения счетчиков всех сообщений зашифровываются многоблочными вызовами
+    функции bckey.encrypt_blocks (а не последовательностью вызовов для одного блока),
+    после чего для каждого сообщения выполняется наложение гаммы и вычисление имитовставки
+    с однократным приведением по модулю. Сообщения, не помещающиеся в группу,
+    обрабатываются функцией ak_bckey_context_encrypt_mgm().
+
+    @param jobs Массив заданий; для каждого задания должны быть определены оба ключа
+    @param count Количество заданий в массиве
+
+    @return В случае успешной обработки всех заданий функция возвращает \ref ak_error_ok (ноль).
+    В противном случае возвращается код последней из возникших ошибок; код ошибки для каждого
+    задания помещается в поле `error` задания.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_encrypt_mgm_jobs( ak_mgm_job jobs, const size_t count )
+{
+  int error = ak_error_ok;
+  size_t i = 0, lanes = 0, ztotal = 0, ytotal = 0, zb = 0, yb = 0;
+  ak_mgm_job group[ak_bckey_blocks_count];
+  size_t zblocks[ak_bckey_blocks_count], yblocks[ak_bckey_blocks_count];
+
+  if( jobs == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                 "using null pointer to jobs array" );
+  for( i = 0; i <= count; i++ ) {
+     ak_mgm_job job = ( i < count ) ? jobs + i : NULL;
+
+     if( job != NULL ) {
+       if(( job->error = ak_mgm_job_check( job, &zb, &yb )) != ak_error_ok ) {
+         error = job->error;
+         continue;
+       }
+      /* длинные сообщения обрабатываются обычным образом */
+       if(( zb > ak_mgm_jobs_blocks ) || ( yb > ak_mgm_jobs_blocks )) {
+         ak_error_set_value( ak_error_ok );
+         ak_bckey_context_encrypt_mgm( job->encryptionKey, job->authenticationKey,
+                              job->adata, job->adata_size, job->in, job->out, job->size,
+                                        job->iv, job->iv_size, job->icode, job->icode_size );
+         if(( job->error = ak_error_get_value()) != ak_error_ok ) error = job->error;
+         continue;
+       }
+     }
+
+    /* обрабатываем накопленную группу, если очередное задание в нее не помещается */
+     if(( lanes > 0 ) && (( job == NULL ) || ( lanes == ak_bckey_blocks_count ) ||
+        ( job->encryptionKey != group[0]->encryptionKey ) ||
+        ( job->authenticationKey != group[0]->authenticationKey ) ||
+        ( ztotal + zb > ak_mgm_jobs_blocks ) || ( ytotal + yb > ak_mgm_jobs_blocks ))) {
+       ak_mgm_jobs_group( group, lanes, zblocks, yblocks );
+       lanes = ztotal = ytotal = 0;
+     }
+     if( job == NULL ) break;
+
+    /* добавляем задание в группу и уменьшаем ресурс ключей */
+     job->encryptionKey->key.resource.value.counter -= ( ssize_t )( yb + 1 );
+     job->authenticationKey->key.resource.value.counter -= ( ssize_t )( zb + 1 );
+     group[lanes] = job; zblocks[lanes] = zb; yblocks[lanes] = yb; lanes++;
+     ztotal += zb; ytotal += yb;
+  }
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                    реализация функций для выработки имитовставки (класс mgm)                    */
 /* ----------------------------------------------------------------------------------------------- */
@@ -929,6 +1503,9 @@
  /* проверяем, что OID от правильного алгоритма выработки имитовставки */
   if( oid->engine != mgm_function )
     return ak_error_message( ak_error_oid_engine, __func__ , "using oid with wrong engine" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_mgm )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using mgm after unsuccessful self test" );
  /* проверяем, что OID от алгоритма, а не от параметров */
   if( oid->mode != algorithm )
     return ak_error_message( ak_error_oid_mode, __func__ , "using oid with wrong mode" );
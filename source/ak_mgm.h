@@ -60,6 +60,39 @@
  ak_buffer ak_mgm_context_authentication_finalize( ak_mgm_ctx ,
                                                               ak_bckey , ak_pointer, const size_t );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание на зашифрование одного сообщения в режиме MGM, используемое при пакетной
+    обработке большого количества независимых сообщений. */
+ typedef struct mgm_job {
+  /*! \brief Ключ шифрования. */
+   ak_bckey encryptionKey;
+  /*! \brief Ключ выработки имитовставки. */
+   ak_bckey authenticationKey;
+  /*! \brief Синхропосылка. */
+   ak_pointer iv;
+  /*! \brief Длина синхропосылки (в байтах). */
+   size_t iv_size;
+  /*! \brief Ассоциированные (незашифровываемые) данные. */
+   ak_pointer adata;
+  /*! \brief Длина ассоциированных данных (в байтах). */
+   size_t adata_size;
+  /*! \brief Зашифровываемые данные. */
+   ak_pointer in;
+  /*! \brief Область памяти, в которую помещаются зашифрованные данные. */
+   ak_pointer out;
+  /*! \brief Длина зашифровываемых данных (в байтах). */
+   size_t size;
+  /*! \brief Область памяти, в которую помещается имитовставка. */
+   ak_pointer icode;
+  /*! \brief Длина имитовставки (в байтах). */
+   size_t icode_size;
+  /*! \brief Код ошибки, возникшей при обработке данного задания. */
+   int error;
+} *ak_mgm_job;
+
+/*! \brief Зашифрование в режиме MGM нескольких независимых сообщений. */
+ int ak_bckey_context_encrypt_mgm_jobs( ak_mgm_job , const size_t );
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Инициализация контекста алгоритма выработки имитовставки MGM
      на основе блочного шифра Магма. */
@@ -17,6 +17,7 @@
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <ak_mac.h>
+ #include <ak_tools.h>
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param gkey Контекст алгоритма выработки имитовставки.
@@ -37,6 +38,9 @@
  /* проверяем, что OID от правильного алгоритма выработки имитовставки */
   if( oid->engine != omac_function )
     return ak_error_message( ak_error_oid_engine, __func__ , "using oid with wrong engine" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_omac )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using omac after unsuccessful self test" );
  /* проверяем, что OID от алгоритма, а не от параметров */
   if( oid->mode != algorithm )
     return ak_error_message( ak_error_oid_mode, __func__ , "using oid with wrong mode" );
@@ -329,10 +329,17 @@
                                                                     "use a null pointer to data" );
   if( size <= 0 ) return ak_error_message( ak_error_wrong_length, __func__ ,
                                                            "use a data vector with wrong length" );
- /* сначала заполняем блоками по 8 байт */
-  for( i = 0; i < blocks; i++ ) {
-     arr[i] = (( ak_random_xorshift32 )rnd->data)->value;
-     rnd->next( rnd );
+ /* сначала заполняем блоками по 4 байта; внутреннее состояние изменяется в локальной переменной,
+    что позволяет обойтись без вызова функции rnd->next() для каждого блока */
+  if( blocks > 0 ) {
+    ak_uint32 x = (( ak_random_xorshift32 )rnd->data)->value;
+    for( i = 0; i < blocks; i++ ) {
+       arr[i] = x;
+       x ^= x << 13;
+       x ^= x >> 17;
+       x ^= x << 5;
+    }
+    (( ak_random_xorshift32 )rnd->data)->value = x;
   }
  /* потом остаток из младших разрядов */
   if( tail > 0 ) {
@@ -17,6 +17,7 @@
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <ak_sign.h>
+ #include <ak_tools.h>
  #include <ak_parameters.h>
  #include <ak_context_manager.h>
 
@@ -198,6 +199,9 @@
                                     "using null pointer to digital signature secret key context" );
    if( wc == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                   "using null pointer to elliptic curve context" );
+  /* однократно выполняем контрольный пример */
+   if(( error = ak_libakrypt_self_test( ak_self_test_signature )) != ak_error_ok )
+     return ak_error_message( error, __func__, "using signature after unsuccessful self test" );
    if( wc->size != ak_mpzn256_size ) return ak_error_message( ak_error_curve_not_supported,
                                     __func__ , "elliptic curve not supported for this algorithm" );
   /* первичная инициализация */
@@ -253,6 +257,9 @@
                                     "using null pointer to digital signature secret key context" );
    if( wc == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                   "using null pointer to elliptic curve context" );
+  /* однократно выполняем контрольный пример */
+   if(( error = ak_libakrypt_self_test( ak_self_test_signature )) != ak_error_ok )
+     return ak_error_message( error, __func__, "using signature after unsuccessful self test" );
    if( wc->size != ak_mpzn512_size ) return ak_error_message( ak_error_curve_not_supported,
                                     __func__ , "elliptic curve not supported for this algorithm" );
   /* первичная инициализация */
@@ -760,6 +767,9 @@
                                      "using null pointer to digital signature public key context" );
   if( key == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                      "using a null pointer to digital signature secret key value" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_signature )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using signature after unsuccessful self test" );
   if(( size != 64 ) && ( size != 128 )) return ak_error_message( ak_error_wrong_key_length,
                                                  __func__, "using a secret key with wrong length" );
   if(( wc->size != ak_mpzn256_size ) && ( wc->size != ak_mpzn512_size ))
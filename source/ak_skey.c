@@ -72,6 +72,9 @@
   }
   skey->data = NULL;
   memset( &(skey->resource), 0, sizeof( struct resource )); /* ресурс ключа не определен */
+ /* по-умолчанию целостность ключа проверяется, а маска сменяется при каждом использовании */
+  memset( &(skey->policy), 0, sizeof( struct skey_policy ));
+  skey->policy.type = skey_policy_every_call;
 
  /* инициализируем генератор масок */
   if(( error = ak_random_context_create_xorshift32( &skey->generator )) != ak_error_ok ) {
@@ -447,6 +450,118 @@
 }
 
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! По-умолчанию проверка целостности ключа выполняется в начале, а смена маски - в конце
+    каждого вызова функции, использующей ключ (политика \ref skey_policy_every_call).
+    Для интенсивного использования ключа на небольших фрагментах данных эти операции
+    могут выполняться реже:
+
+     - \ref skey_policy_calls -- один раз на `limit` вызовов,
+     - \ref skey_policy_bytes -- после обработки не менее `limit` октетов: маска сменяется
+       в конце вызова, в ходе которого количество обработанных октетов достигло `limit`,
+       а целостность проверяется в начале первого вызова после смены маски,
+     - \ref skey_policy_timer -- не реже одного раза в `limit` секунд.
+
+    Снижение частоты перемаскирования увеличивает время, в течение которого значение ключа
+    в памяти остается неизменным, поэтому пороговые значения следует выбирать исходя из
+    модели нарушителя.
+
+    \param skey Контекст секретного ключа.
+    \param type Тип политики.
+    \param limit Пороговое значение; для политики \ref skey_policy_every_call не используется,
+    для остальных политик должно быть отлично от нуля.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае,
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_context_set_policy( ak_skey skey, skey_policy_t type, ak_uint64 limit )
+{
+  if( skey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                            "using a null pointer to secret key" );
+  switch( type ) {
+    case skey_policy_every_call:
+      break;
+    case skey_policy_calls:
+    case skey_policy_bytes:
+    case skey_policy_timer:
+      if( limit == 0 ) return ak_error_message( ak_error_zero_length, __func__ ,
+                                                          "using a zero limit for secret key policy" );
+      break;
+    default: return ak_error_message( ak_error_undefined_value, __func__ ,
+                                                         "using undefined type of secret key policy" );
+  }
+
+  skey->policy.type = type;
+  skey->policy.limit = limit;
+  skey->policy.count = 0;
+  skey->policy.last = ( ak_uint64 )time( NULL );
+  skey->policy.due = ak_false;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция определяет, должны ли при текущем использовании ключа выполняться проверка
+    целостности и смена маски. Если должны, то вычисляется и проверяется контрольная сумма,
+    а решение запоминается до вызова функции ak_skey_context_set_mask_policy().
+    Для политики \ref skey_policy_bytes объем обрабатываемых данных заранее неизвестен, поэтому
+    целостность проверяется в начале первого вызова после смены маски, а необходимость смены
+    маски определяется функцией ak_skey_context_set_mask_policy().
+    Функция вызывается в начале обработки данных вместо метода skey.check_icode.
+
+    @param skey Указатель на контекст секретного ключа.
+    @return В случае совпадения контрольной суммы ключа, или если проверка не требуется,
+    функция возвращает истину (\ref ak_true). В противном случае, возвращается ложь (\ref ak_false). */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_skey_context_check_icode_policy( ak_skey skey )
+{
+  switch( skey->policy.type ) {
+    case skey_policy_calls:
+      skey->policy.due = ( skey->policy.count + 1 >= skey->policy.limit );
+      break;
+    case skey_policy_bytes:
+      skey->policy.due = ( skey->policy.count == 0 );
+      break;
+    case skey_policy_timer:
+      skey->policy.due = (( ak_uint64 )time( NULL ) >= skey->policy.last + skey->policy.limit );
+      break;
+    default:
+      skey->policy.due = ak_true;
+  }
+  if( !skey->policy.due ) return ak_true;
+
+ return skey->check_icode( skey );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция учитывает очередное использование ключа для обработки `size` октетов и,
+    если это предусмотрено политикой, сменяет маску ключа.
+    Функция вызывается в конце обработки данных вместо метода skey.set_mask.
+
+    @param skey Указатель на контекст секретного ключа.
+    @param size Количество обработанных октетов.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае,
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_context_set_mask_policy( ak_skey skey, size_t size )
+{
+  if( skey->policy.type == skey_policy_bytes ) {
+   /* маска сменяется в том вызове, в котором достигнуто пороговое значение */
+    if(( skey->policy.count += size ) < skey->policy.limit ) {
+      skey->policy.due = ak_false;
+      return ak_error_ok;
+    }
+  } else {
+      skey->policy.count++;
+      if(( skey->policy.type != skey_policy_every_call ) && !skey->policy.due ) return ak_error_ok;
+    }
+
+  skey->policy.count = 0;
+  skey->policy.due = ak_false;
+  if( skey->policy.type == skey_policy_timer ) skey->policy.last = ( ak_uint64 )time( NULL );
+
+ return skey->set_mask( skey );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \param skey Контекст секретного ключа.
     \param type Тип присваиваемого ресурса.
@@ -501,6 +616,10 @@
  /* копируем ресурс ключа */
   skey->resource.type = rkey->resource.type;
   skey->resource.value.counter = rkey->resource.value.counter;
+ /* копируем политику перемаскирования (накопленные значения счетчиков не копируются) */
+  skey->policy.type = rkey->policy.type;
+  skey->policy.limit = rkey->policy.limit;
+  skey->policy.last = ( ak_uint64 )time( NULL );
 
  /* поскольку на уровне класса skey определить размер skey->data не представляется возможным,
         копирование внутренних данных должно реализовываться функциями классов - наследников */
@@ -587,6 +706,10 @@
 
   if(( error = skey->set_icode( skey )) != ak_error_ok ) return ak_error_message( error,
                                                 __func__ , "wrong calculation of integrity code" );
+ /* начинаем отсчет использований ключа заново */
+  skey->policy.count = 0;
+  skey->policy.due = ak_false;
+  skey->policy.last = ( ak_uint64 )time( NULL );
 
  /* устанавливаем флаг того, что ключевое значение определено.
     теперь ключ можно использовать в криптографических алгоритмах */
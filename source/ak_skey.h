@@ -47,6 +47,36 @@
    } value;
  } *ak_resource;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Перечисление определяет возможные политики проверки целостности и перемаскирования ключа. */
+ typedef enum {
+  /*! \brief Проверка целостности и перемаскирование при каждом использовании ключа
+      (значение по-умолчанию). */
+    skey_policy_every_call,
+  /*! \brief Проверка целостности и перемаскирование после заданного количества использований ключа. */
+    skey_policy_calls,
+  /*! \brief Проверка целостности и перемаскирование после обработки заданного количества октетов. */
+    skey_policy_bytes,
+  /*! \brief Проверка целостности и перемаскирование по истечении заданного интервала времени. */
+    skey_policy_timer
+} skey_policy_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Структура для хранения политики проверки целостности и перемаскирования ключа. */
+ typedef struct skey_policy {
+  /*! \brief Тип политики */
+   skey_policy_t type;
+  /*! \brief Пороговое значение: количество использований, октетов или секунд */
+   ak_uint64 limit;
+  /*! \brief Количество использований (октетов), накопленное после последнего перемаскирования */
+   ak_uint64 count;
+  /*! \brief Время последнего перемаскирования (в секундах) */
+   ak_uint64 last;
+  /*! \brief Флаг того, что при текущем использовании ключа должны быть выполнены проверка
+      целостности и (для всех политик, кроме \ref skey_policy_bytes) перемаскирование */
+   bool_t due;
+ } *ak_skey_policy;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Перечисление, определяющее флаги хранения и обработки секретных ключей. */
  typedef enum {
@@ -67,10 +97,14 @@
              0 - очистка производится, 1 - очистка памяти не производится */
    skey_flag_data_not_free = 0x08LL,
 
- /*! \brief Флаг, который запрещает использование функции ctr без указания синхропосылки. */
+ /*! \brief Флаг, который запрещает использование функции ctr (а также функций режимов
+     с регистром сдвига) без указания синхропосылки. */
    bckey_flag_not_ctr = 0x0100LL,
  /*! \brief Флаг, который определяет, можно ли использовать значение внутреннего буффера в режиме omac. */
-   omac_flag_buffer_used = 0x0200LL
+   omac_flag_buffer_used = 0x0200LL,
+ /*! \brief Флаг, который определяет, вычислены ли для текущего значения ключа
+     начальные состояния функции хеширования в алгоритме hmac. */
+   hmac_flag_states_set = 0x0400LL
 
 } key_flags_t;
 
@@ -89,6 +123,8 @@
    struct random generator;
   /*! \brief ресурс использования ключа */
    struct resource resource;
+  /*! \brief политика проверки целостности и перемаскирования ключа */
+   struct skey_policy policy;
   /*! \brief указатель на внутренние данные ключа */
    ak_pointer data;
   /*! \brief OID алгоритма для которого предназначен секретный ключ */
@@ -134,6 +170,12 @@
  int ak_skey_context_set_icode_xor( ak_skey );
 /*! \brief Проверка значения контрольной суммы ключа. */
  bool_t ak_skey_context_check_icode_xor( ak_skey );
+/*! \brief Установка политики проверки целостности и перемаскирования ключа. */
+ int ak_skey_context_set_policy( ak_skey , skey_policy_t , ak_uint64 );
+/*! \brief Проверка значения контрольной суммы ключа в соответствии с установленной политикой. */
+ bool_t ak_skey_context_check_icode_policy( ak_skey );
+/*! \brief Перемаскирование ключа в соответствии с установленной политикой. */
+ int ak_skey_context_set_mask_policy( ak_skey , size_t );
 /*! \brief Обновление контекста алгоритма итеративного сжатия значением секретного ключа. */
  int ak_skey_context_mac_context_update( ak_skey, struct mac * );
 
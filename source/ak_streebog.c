@@ -14,9 +14,13 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64
+ #include <immintrin.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <ak_hash.h>
+ #include <ak_tools.h>
  #include <ak_parameters.h>
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -30,6 +34,44 @@
   ak_uint64 SIGMA[8];
 };
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция, реализующая преобразование G (функцию сжатия) */
+ typedef void ( ak_function_streebog_g )( struct streebog *, const ak_uint64 *, const ak_uint64 * );
+/*! \brief Функция, реализующая прибавление к контрольной сумме вектора по модулю \f$ 2^{512} \f$ */
+ typedef void ( ak_function_streebog_sadd )( struct streebog *, const ak_uint64 * );
+/*! \brief Количество независимых состояний, обрабатываемых одновременно. */
+ #define ak_streebog_lanes  (4)
+/*! \brief Функция, реализующая преобразование G для \ref ak_streebog_lanes независимых состояний */
+ typedef void ( ak_function_streebog_g_lanes )( struct streebog **,
+                                                           const ak_uint64 **, const ak_uint64 ** );
+
+ static void streebog_g( struct streebog * , const ak_uint64 * , const ak_uint64 * );
+ static void streebog_sadd( struct streebog * , const ak_uint64 * );
+ static void streebog_g_lanes( struct streebog ** , const ak_uint64 ** , const ak_uint64 ** );
+
+/*! \brief Функция сжатия, выбранная при инициализации библиотеки
+    в зависимости от возможностей процессора. */
+ static ak_function_streebog_g *ak_streebog_g = streebog_g;
+/*! \brief Функция сложения по модулю \f$ 2^{512} \f$, выбранная при инициализации библиотеки
+    в зависимости от возможностей процессора. */
+ static ak_function_streebog_sadd *ak_streebog_sadd = streebog_sadd;
+/*! \brief Функция одновременного вычисления нескольких преобразований G, выбранная
+    при инициализации библиотеки в зависимости от возможностей процессора. */
+ static ak_function_streebog_g_lanes *ak_streebog_g_lanes = streebog_g_lanes;
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64
+/*! \brief Таблицы преобразования LPS, объединенные с нелинейной подстановкой:
+    элемент `[j][x]` равен `streebog_Areverse_expand[j][gost_pi[x]]`. */
+ static ak_uint64 streebog_lps_table[8][256];
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+/*! \brief Блоки матрицы линейного преобразования для инструкции `gf2p8affineqb`:
+    элемент `[j][i]` отображает байт j-го слова в i-й байт результата. */
+ static ak_uint64 streebog_lps_lmat[8][8];
+/*! \brief Перестановка байт, транспонирующая матрицу 8x8 байт. */
+ static ak_uint8 streebog_lps_transpose[64];
+#endif
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Преобразование LPS (\b важно: мы предполагаем, что данные содержат 64 байта)                   */
  static inline void streebog_lps( ak_uint64 *result, const ak_uint64 *data )
@@ -62,7 +104,7 @@
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Преобразование G (\b важно: мы предполагаем, что массивы n и m содержат по 64 байта)                     */
- static inline void streebog_g( struct streebog *ctx, ak_uint64 *n, const ak_uint64 *m )
+ static void streebog_g( struct streebog *ctx, const ak_uint64 *n, const ak_uint64 *m )
 {
    int idx = 0;
    ak_uint64 K[8], T[8], B[8];
@@ -110,7 +152,7 @@
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Преобразование SAdd (Прибавление к массиву S вектора по модулю \f$ 2^{512} \f$)                */
- static inline void streebog_sadd( struct streebog *ctx,  const ak_uint64 *data )
+ static void streebog_sadd( struct streebog *ctx,  const ak_uint64 *data )
 {
    int i = 0;
    ak_uint64 carry = 0;
@@ -137,6 +179,456 @@
    }
 }
 
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование LPS, вычисляющее все восемь 64-х битных слов результата одновременно.
+    \details Вектор `lo` содержит слова с номерами 0-3, вектор `hi` -- слова с номерами 4-7;
+    j-е слово результата, как и в функции streebog_lps(), равно сумме элементов таблиц,
+    индексами которых служат j-е байты слов аргумента.                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx2")))
+ static inline void streebog_lps_avx2( __m256i *lo, __m256i *hi )
+{
+  int j = 0;
+  ak_uint32 w[16];
+  __m256i rl = _mm256_setzero_si256(), rh = _mm256_setzero_si256();
+
+  _mm256_storeu_si256(( __m256i *) w, *lo );
+  _mm256_storeu_si256(( __m256i *)( w+8 ), *hi );
+  for( j = 0; j < 8; j++ ) {
+     rl = _mm256_xor_si256( rl, _mm256_i64gather_epi64(( const long long *)streebog_lps_table[j],
+                                     _mm256_cvtepu8_epi64( _mm_cvtsi32_si128(( int )w[2*j] )), 8 ));
+     rh = _mm256_xor_si256( rh, _mm256_i64gather_epi64(( const long long *)streebog_lps_table[j],
+                                   _mm256_cvtepu8_epi64( _mm_cvtsi32_si128(( int )w[2*j+1] )), 8 ));
+  }
+  *lo = rl; *hi = rh;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование G, использующее 256-ти битные регистры и инструкции `vpgatherqq`.       */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx2")))
+ static void streebog_g_avx2( struct streebog *ctx, const ak_uint64 *n, const ak_uint64 *m )
+{
+  int idx = 0;
+  __m256i hl = _mm256_loadu_si256(( const __m256i *) ctx->H ),
+          hh = _mm256_loadu_si256(( const __m256i *)( ctx->H+4 )),
+          ml = _mm256_loadu_si256(( const __m256i *) m ),
+          mh = _mm256_loadu_si256(( const __m256i *)( m+4 )),
+          kl = hl, kh = hh, tl, th, bl, bh;
+
+  if( n != NULL ) {
+    kl = _mm256_xor_si256( kl, _mm256_loadu_si256(( const __m256i *) n ));
+    kh = _mm256_xor_si256( kh, _mm256_loadu_si256(( const __m256i *)( n+4 )));
+  }
+  streebog_lps_avx2( &kl, &kh );
+
+  tl = ml; th = mh;
+  for( idx = 0; idx < 12; idx++ ) {
+     tl = _mm256_xor_si256( tl, kl ); th = _mm256_xor_si256( th, kh );
+     streebog_lps_avx2( &tl, &th ); /* преобразуем текст */
+
+     bl = _mm256_loadu_si256(( const __m256i *) streebog_c[idx] );
+     bh = _mm256_loadu_si256(( const __m256i *)( streebog_c[idx]+4 ));
+     kl = _mm256_xor_si256( kl, bl ); kh = _mm256_xor_si256( kh, bh );
+     streebog_lps_avx2( &kl, &kh ); /* новый ключ */
+  }
+ /* изменяем значение переменной h */
+  hl = _mm256_xor_si256( hl, _mm256_xor_si256( tl, _mm256_xor_si256( kl, ml )));
+  hh = _mm256_xor_si256( hh, _mm256_xor_si256( th, _mm256_xor_si256( kh, mh )));
+  _mm256_storeu_si256(( __m256i *) ctx->H, hl );
+  _mm256_storeu_si256(( __m256i *)( ctx->H+4 ), hh );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование LPS, использующее 512-ти битный регистр.                                */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx512f")))
+ static inline __m512i streebog_lps_avx512( __m512i x )
+{
+  int j = 0;
+  __m128i w;
+  __m512i r = _mm512_setzero_si512();
+
+  for( j = 0; j < 8; j++ ) {
+    /* j-е слово аргумента помещается в младшие байты, каждый байт -- в свою ячейку */
+     w = _mm512_castsi512_si128( _mm512_permutexvar_epi64( _mm512_set1_epi64( j ), x ));
+     r = _mm512_xor_si512( r, _mm512_i64gather_epi64( _mm512_cvtepu8_epi64( w ),
+                                                 ( const void *) streebog_lps_table[j], 8 ));
+  }
+ return r;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование G, использующее 512-ти битные регистры.                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx512f")))
+ static void streebog_g_avx512( struct streebog *ctx, const ak_uint64 *n, const ak_uint64 *m )
+{
+  int idx = 0;
+  __m512i h = _mm512_loadu_si512( ctx->H ), mm = _mm512_loadu_si512( m ), k, t;
+
+  if( n != NULL ) k = streebog_lps_avx512( _mm512_xor_si512( h, _mm512_loadu_si512( n )));
+    else k = streebog_lps_avx512( h );
+
+  t = mm;
+  for( idx = 0; idx < 12; idx++ ) {
+     t = streebog_lps_avx512( _mm512_xor_si512( t, k ));
+     k = streebog_lps_avx512( _mm512_xor_si512( k, _mm512_loadu_si512( streebog_c[idx] )));
+  }
+  _mm512_storeu_si512( ctx->H,
+                 _mm512_xor_si512( h, _mm512_xor_si512( t, _mm512_xor_si512( k, mm ))));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет маску слов, к которым должен быть прибавлен перенос.
+    \details Бит `g` равен единице, если при сложении соответствующих слов возникло переполнение,
+    бит `p` -- если сумма слов состоит из одних единиц (такое слово передает перенос дальше).
+    Переносы всех слов вычисляются одним сложением, аналогично сумматору с ускоренным переносом. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline unsigned int streebog_carry_mask( unsigned int g, unsigned int p )
+{
+ return ((( g << 1 ) + p ) ^ p )&0xFF;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование SAdd, использующее 256-ти битные регистры.                              */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx2")))
+ static void streebog_sadd_avx2( struct streebog *ctx, const ak_uint64 *data )
+{
+  unsigned int g, p, c;
+  const __m256i sign = _mm256_set1_epi64x( (long long) 0x8000000000000000LL ),
+                ones = _mm256_set1_epi64x( -1 ), bits = _mm256_set_epi64x( 8, 4, 2, 1 );
+  __m256i dl = _mm256_loadu_si256(( const __m256i *) data ),
+          dh = _mm256_loadu_si256(( const __m256i *)( data+4 )),
+          sl = _mm256_add_epi64( _mm256_loadu_si256(( const __m256i *) ctx->SIGMA ), dl ),
+          sh = _mm256_add_epi64( _mm256_loadu_si256(( const __m256i *)( ctx->SIGMA+4 )), dh );
+
+ /* переполнение возникает, если сумма (как беззнаковое число) меньше слагаемого */
+  g = ( unsigned int ) _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpgt_epi64(
+                       _mm256_xor_si256( dl, sign ), _mm256_xor_si256( sl, sign ))))
+    | ( unsigned int ) _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpgt_epi64(
+                       _mm256_xor_si256( dh, sign ), _mm256_xor_si256( sh, sign )))) << 4;
+  p = ( unsigned int ) _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( sl, ones )))
+    | ( unsigned int ) _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( sh, ones ))) << 4;
+
+  if(( c = streebog_carry_mask( g, p )) != 0 ) {
+   /* прибавляем единицу (вычитаем -1) к словам, получившим перенос */
+    sl = _mm256_sub_epi64( sl, _mm256_cmpeq_epi64(
+                      _mm256_and_si256( _mm256_set1_epi64x(( long long )( c&0xF )), bits ), bits ));
+    sh = _mm256_sub_epi64( sh, _mm256_cmpeq_epi64(
+                      _mm256_and_si256( _mm256_set1_epi64x(( long long )( c >> 4 )), bits ), bits ));
+  }
+  _mm256_storeu_si256(( __m256i *) ctx->SIGMA, sl );
+  _mm256_storeu_si256(( __m256i *)( ctx->SIGMA+4 ), sh );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование SAdd, использующее 512-ти битный регистр и маски сравнения.             */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx512f")))
+ static void streebog_sadd_avx512( struct streebog *ctx, const ak_uint64 *data )
+{
+  const __m512i ones = _mm512_set1_epi64( -1 );
+  __m512i d = _mm512_loadu_si512( data ),
+          s = _mm512_add_epi64( _mm512_loadu_si512( ctx->SIGMA ), d );
+  __mmask8 c = ( __mmask8 ) streebog_carry_mask( _mm512_cmplt_epu64_mask( s, d ),
+                                                             _mm512_cmpeq_epi64_mask( s, ones ));
+
+  _mm512_storeu_si512( ctx->SIGMA, _mm512_mask_sub_epi64( s, c, s, ones ));
+}
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обнуляет временные переменные, размещенные в стеке.
+    \details Запись выполняется через указатель с квалификатором `volatile`, поэтому компилятор
+    не может исключить ее как запись в переменные, которые далее не используются. Выработка
+    псевдослучайных данных функцией ak_ptr_wipe() для каждого вызова преобразования G
+    была бы слишком дорогой.                                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void streebog_scratch_wipe( void *ptr, const size_t size )
+{
+  size_t idx = 0;
+  volatile ak_uint64 *v = ( volatile ak_uint64 *) ptr;
+  for( idx = 0; idx < ( size >> 3 ); idx++ ) v[idx] = 0;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование LPS, не использующее обращений к таблицам.
+    \details Подстановка \f$ \pi \f$ вычисляется для всех 64 байт одновременно двумя инструкциями
+    `vpermi2b` по половинам таблицы. Далее j-е слово размножается на весь регистр, и инструкция
+    `gf2p8affineqb` умножает его байты на 8x8 битовые блоки матрицы A: i-я ячейка регистра `m[j]`
+    содержит блок, отображающий байт j-го слова в i-й байт результата. В сумме получается
+    транспонированный результат, который возвращается к исходному виду инструкцией `vpermb`.      */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx512f,avx512bw,avx512vbmi,gfni")))
+ static inline __m512i streebog_lps_gfni( __m512i x, const __m512i *p, const __m512i *m,
+                                                                                  const __m512i tr )
+{
+  int j = 0;
+  __m512i r = _mm512_setzero_si512(),
+          s = _mm512_mask_blend_epi8( _mm512_movepi8_mask( x ),
+                 _mm512_permutex2var_epi8( p[0], x, p[1] ), _mm512_permutex2var_epi8( p[2], x, p[3] ));
+
+  for( j = 0; j < 8; j++ )
+     r = _mm512_xor_si512( r, _mm512_gf2p8affine_epi64_epi8(
+                                _mm512_permutexvar_epi64( _mm512_set1_epi64( j ), s ), m[j], 0 ));
+ return _mm512_permutexvar_epi8( tr, r );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование G, использующее инструкции AVX-512 и GFNI.                             */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx512f,avx512bw,avx512vbmi,gfni")))
+ static void streebog_g_gfni( struct streebog *ctx, const ak_uint64 *n, const ak_uint64 *m )
+{
+  int idx = 0;
+  __m512i p[4], a[8], tr = _mm512_loadu_si512( streebog_lps_transpose ),
+          h = _mm512_loadu_si512( ctx->H ), mm = _mm512_loadu_si512( m ), k, t;
+
+  for( idx = 0; idx < 4; idx++ ) p[idx] = _mm512_loadu_si512( gost_pi + 64*idx );
+  for( idx = 0; idx < 8; idx++ ) a[idx] = _mm512_loadu_si512( streebog_lps_lmat[idx] );
+
+  if( n != NULL ) k = streebog_lps_gfni( _mm512_xor_si512( h, _mm512_loadu_si512( n )), p, a, tr );
+    else k = streebog_lps_gfni( h, p, a, tr );
+
+  t = mm;
+  for( idx = 0; idx < 12; idx++ ) {
+     t = streebog_lps_gfni( _mm512_xor_si512( t, k ), p, a, tr );
+     k = streebog_lps_gfni( _mm512_xor_si512( k, _mm512_loadu_si512( streebog_c[idx] )), p, a, tr );
+  }
+  _mm512_storeu_si512( ctx->H,
+                 _mm512_xor_si512( h, _mm512_xor_si512( t, _mm512_xor_si512( k, mm ))));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование G, вычисляемое одновременно для \ref ak_streebog_lanes независимых
+    состояний с использованием инструкций AVX-512 и GFNI.
+    \details Преобразования LPS различных состояний выполняются вперемешку, что позволяет
+    процессору совмещать их выполнение. Слова после подстановки сохраняются в памяти и
+    размножаются на весь регистр инструкцией загрузки `vpbroadcastq`.                            */
+/* ----------------------------------------------------------------------------------------------- */
+ __attribute__((target("avx512f,avx512bw,avx512vbmi,gfni")))
+ static void streebog_g_lanes_gfni( struct streebog **ctx, const ak_uint64 **n,
+                                                                           const ak_uint64 **m )
+{
+  int idx = 0, j = 0, l = 0;
+  struct streebog dummy;
+  ak_uint64 s[2*ak_streebog_lanes][8];
+  __m512i p[4], a[8], tr = _mm512_loadu_si512( streebog_lps_transpose ), x[2*ak_streebog_lanes],
+          r[2*ak_streebog_lanes], h[ak_streebog_lanes], mm[ak_streebog_lanes];
+
+  for( idx = 0; idx < 4; idx++ ) p[idx] = _mm512_loadu_si512( gost_pi + 64*idx );
+  for( idx = 0; idx < 8; idx++ ) a[idx] = _mm512_loadu_si512( streebog_lps_lmat[idx] );
+  memset( &dummy, 0, sizeof( struct streebog ));
+
+ /* ячейки x[2l] содержат текст, ячейки x[2l+1] -- ключ l-го состояния */
+  for( l = 0; l < ak_streebog_lanes; l++ ) {
+     h[l] = _mm512_loadu_si512( ctx[l] == NULL ? dummy.H : ctx[l]->H );
+     mm[l] = _mm512_loadu_si512( m[l] == NULL ? dummy.N : m[l] );
+     x[2*l] = mm[l];
+     x[2*l+1] = n[l] == NULL ? h[l] : _mm512_xor_si512( h[l], _mm512_loadu_si512( n[l] ));
+  }
+
+  for( idx = 0; idx <= 12; idx++ ) {
+    /* подстановка */
+     for( l = 0; l < 2*ak_streebog_lanes; l++ ) {
+        if(( idx == 0 ) && !( l&1 )) continue;
+        _mm512_storeu_si512( s[l], _mm512_mask_blend_epi8( _mm512_movepi8_mask( x[l] ),
+          _mm512_permutex2var_epi8( p[0], x[l], p[1] ), _mm512_permutex2var_epi8( p[2], x[l], p[3] )));
+        r[l] = _mm512_setzero_si512();
+     }
+    /* линейное преобразование */
+     for( j = 0; j < 8; j++ )
+        for( l = 0; l < 2*ak_streebog_lanes; l++ ) {
+           if(( idx == 0 ) && !( l&1 )) continue;
+           r[l] = _mm512_xor_si512( r[l], _mm512_gf2p8affine_epi64_epi8(
+                                             _mm512_set1_epi64(( long long ) s[l][j] ), a[j], 0 ));
+        }
+     for( l = 0; l < 2*ak_streebog_lanes; l++ ) {
+        if(( idx == 0 ) && !( l&1 )) continue;
+        x[l] = _mm512_permutexvar_epi8( tr, r[l] );
+     }
+     if( idx == 12 ) break;
+    /* сложение текста с ключом и ключа с итерационной константой */
+     for( l = 0; l < ak_streebog_lanes; l++ ) {
+        x[2*l] = _mm512_xor_si512( x[2*l], x[2*l+1] );
+        x[2*l+1] = _mm512_xor_si512( x[2*l+1], _mm512_loadu_si512( streebog_c[idx] ));
+     }
+  }
+ /* изменяем значения переменных h, пропуская незанятые ячейки */
+  for( l = 0; l < ak_streebog_lanes; l++ ) {
+     if( ctx[l] == NULL ) continue;
+     _mm512_storeu_si512( ctx[l]->H, _mm512_xor_si512( h[l],
+                                  _mm512_xor_si512( x[2*l], _mm512_xor_si512( x[2*l+1], mm[l] ))));
+  }
+ /* очищаем промежуточные значения состояний */
+  streebog_scratch_wipe( s, sizeof( s ));
+  streebog_scratch_wipe( x, sizeof( x ));
+  streebog_scratch_wipe( r, sizeof( r ));
+}
+#endif
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция выбирает реализацию преобразований G и SAdd. Из реализаций, поддерживаемых
+    процессором, выбирается наиболее быстрая, номер которой не превосходит значения опции
+    `streebog_implementation` (1 - скалярная, 2 - AVX2, 3 - AVX-512, 4 - AVX-512 и GFNI;
+    нулевое значение снимает ограничение). Функция может быть вызвана повторно после
+    изменения значения опции.
+
+    @return Функция возвращает \ref ak_true.                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_hash_init_streebog_tables( void )
+{
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64
+  size_t i, j;
+  ak_int64 limit = ak_libakrypt_get_option( "streebog_implementation" );
+#endif
+
+  ak_streebog_g = streebog_g;
+  ak_streebog_sadd = streebog_sadd;
+  ak_streebog_g_lanes = streebog_g_lanes;
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64
+ /* векторные реализации предполагают обратный порядок байт в 64-х битных словах */
+ #ifdef LIBAKRYPT_LITTLE_ENDIAN
+  if( limit <= 0 ) limit = 4;
+  for( i = 0; i < 8; i++ )
+     for( j = 0; j < 256; j++ )
+        streebog_lps_table[i][j] = streebog_Areverse_expand[i][gost_pi[j]];
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+ /* строка с номером 7-t блока задает входные биты, от которых зависит t-й бит результата */
+  for( i = 0; i < 8; i++ )
+     for( j = 0; j < 8; j++ ) {
+        size_t t, b;
+        streebog_lps_lmat[i][j] = 0;
+        for( t = 0; t < 8; t++ )
+           for( b = 0; b < 8; b++ )
+              if(( streebog_Areverse_expand[i][1 << b] >> ( 8*j + t ))&1 )
+                streebog_lps_lmat[i][j] ^= (( ak_uint64 )1 ) << ( 8*( 7-t ) + b );
+     }
+  for( i = 0; i < 64; i++ ) streebog_lps_transpose[i] = ( ak_uint8 )( 8*( i%8 ) + i/8 );
+#endif
+
+  __builtin_cpu_init();
+  if(( limit >= 2 ) && __builtin_cpu_supports( "avx2" )) {
+    ak_streebog_g = streebog_g_avx2;
+    ak_streebog_sadd = streebog_sadd_avx2;
+  }
+  if(( limit >= 3 ) && __builtin_cpu_supports( "avx512f" )) {
+    ak_streebog_g = streebog_g_avx512;
+    ak_streebog_sadd = streebog_sadd_avx512;
+  }
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+  if(( limit >= 4 ) && __builtin_cpu_supports( "avx512f" ) &&
+      __builtin_cpu_supports( "avx512bw" ) && __builtin_cpu_supports( "avx512vbmi" ) &&
+                                                                __builtin_cpu_supports( "gfni" )) {
+    ak_streebog_g = streebog_g_gfni;
+    ak_streebog_g_lanes = streebog_g_lanes_gfni;
+  }
+#endif
+ #endif
+#endif
+
+  if( ak_log_get_level() >= ak_log_maximum )
+    ak_error_message_fmt( ak_error_ok, __func__ , "using %s implementation of streebog",
+                                                         ak_hash_get_streebog_implementation( ));
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @return Функция возвращает строку с названием реализации преобразования G, выбранной
+    функцией ak_hash_init_streebog_tables().                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ const char *ak_hash_get_streebog_implementation( void )
+{
+#ifdef LIBAKRYPT_HAVE_BUILTIN_GATHER_EPI64
+ #ifdef LIBAKRYPT_HAVE_BUILTIN_GF2P8AFFINE
+  if( ak_streebog_g == streebog_g_gfni ) return "avx512 and gfni";
+ #endif
+  if( ak_streebog_g == streebog_g_avx512 ) return "avx512";
+  if( ak_streebog_g == streebog_g_avx2 ) return "avx2";
+#endif
+ return "scalar";
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция сравнивает результаты выбранных реализаций преобразований G и SAdd с результатами
+    скалярных функций streebog_g() и streebog_sadd(). Слова контрольной суммы и складываемых
+    векторов выбираются из значений 0, 1, \f$ 2^{63} \f$, \f$ 2^{64}-2 \f$, \f$ 2^{64}-1 \f$
+    и т.п., поэтому перенос проходит через произвольные цепочки слов, в том числе через все
+    восемь слов. Преобразование G для нескольких состояний проверяется с незанятыми ячейками
+    и с нулевыми указателями `n`.
+
+    @return Функция возвращает \ref ak_true, если результаты совпадают. В противном случае
+    возвращается \ref ak_false.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_hash_test_streebog_implementation( void )
+{
+  size_t i, j, l;
+  ak_uint64 state = 0x9e3779b97f4a7c15LL, data[ak_streebog_lanes][8];
+  struct streebog sx[ak_streebog_lanes], check[ak_streebog_lanes], *ctx[ak_streebog_lanes];
+  const ak_uint64 *n[ak_streebog_lanes], *m[ak_streebog_lanes];
+  const ak_uint64 words[6] = { 0, 1, 2, 0x8000000000000000LL,
+                                                       ( ak_uint64 )-2, ( ak_uint64 )-1 };
+
+  for( i = 0; i < 512; i++ ) {
+    /* формируем состояния и данные */
+     for( l = 0; l < ak_streebog_lanes; l++ )
+        for( j = 0; j < 8; j++ ) {
+           state = state*6364136223846793005LL + 1442695040888963407LL;
+           sx[l].H[j] = state;
+           sx[l].N[j] = state*0xd1342543de82ef95LL;
+           sx[l].SIGMA[j] = ( state >> 61 ) < 6 ? words[state >> 61] : state ^ ( state >> 17 );
+           data[l][j] = (( state >> 58 )&7 ) < 6 ? words[( state >> 58 )&7] : state ^ ( state << 9 );
+        }
+     if( i == 0 ) { /* перенос через все слова контрольной суммы */
+       for( j = 0; j < 8; j++ ) { sx[0].SIGMA[j] = ( ak_uint64 )-1; data[0][j] = 0; }
+       data[0][0] = 1;
+     }
+     memcpy( check, sx, sizeof( sx ));
+
+    /* преобразование SAdd */
+     for( l = 0; l < ak_streebog_lanes; l++ ) {
+        ak_streebog_sadd( sx+l, data[l] );
+        streebog_sadd( check+l, data[l] );
+     }
+     if( memcmp( sx, check, sizeof( sx )) != 0 ) {
+       ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+              "wrong %s implementation of sadd transformation", ak_hash_get_streebog_implementation( ));
+       return ak_false;
+     }
+
+    /* преобразование G */
+     for( l = 0; l < ak_streebog_lanes; l++ ) {
+        ak_streebog_g( sx+l, l&1 ? NULL : sx[l].N, data[l] );
+        streebog_g( check+l, l&1 ? NULL : check[l].N, data[l] );
+     }
+     if( memcmp( sx, check, sizeof( sx )) != 0 ) {
+       ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                 "wrong %s implementation of g transformation", ak_hash_get_streebog_implementation( ));
+       return ak_false;
+     }
+
+    /* преобразование G для нескольких состояний */
+     for( l = 0; l < ak_streebog_lanes; l++ ) {
+        ctx[l] = (( l == i%ak_streebog_lanes ) && ( i&4 )) ? NULL : sx+l;
+        n[l] = ( l == 1 ) ? NULL : sx[l].N;
+        m[l] = ( ctx[l] == NULL ) ? NULL : data[l];
+        if( ctx[l] != NULL ) streebog_g( check+l, n[l], m[l] );
+     }
+     ak_streebog_g_lanes( ctx, n, m );
+     if( memcmp( sx, check, sizeof( sx )) != 0 ) {
+       ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+           "wrong %s implementation of g lanes transformation", ak_hash_get_streebog_implementation( ));
+       return ak_false;
+     }
+  }
+ return ak_true;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция очистки контекста.
     @param ctx указатель на контекст структуры struct hash                                         */
@@ -174,9 +666,9 @@
   dt = ( ak_uint64 *) in;
   sx = ( struct streebog * ) (( ak_hash ) ctx )->data;
   do{
-      streebog_g( sx, sx->N, dt );
+      ak_streebog_g( sx, sx->N, dt );
       streebog_add( sx, 512 );
-      streebog_sadd( sx, dt );
+      ak_streebog_sadd( sx, dt );
       quot--; dt += 8;
   } while( quot > 0 );
 
@@ -211,11 +703,11 @@
 
   /* при финализации мы изменяем копию существующей структуры */
   memcpy( &sx, ( struct streebog * ) (( ak_hash ) ctx )->data, sizeof( struct streebog ));
-  streebog_g( &sx, sx.N, m );
+  ak_streebog_g( &sx, sx.N, m );
   streebog_add( &sx, size << 3 );
-  streebog_sadd( &sx, m );
-  streebog_g( &sx, NULL, sx.N );
-  streebog_g( &sx, NULL, sx.SIGMA );
+  ak_streebog_sadd( &sx, m );
+  ak_streebog_g( &sx, NULL, sx.N );
+  ak_streebog_g( &sx, NULL, sx.SIGMA );
 
  /* определяем указатель на область памяти, в которую будет помещен результат вычислений */
   if( out != NULL ) pout = out;
@@ -234,6 +726,152 @@
  return result;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование G для нескольких независимых состояний, вычисляемое последовательно.
+    \details Незанятые ячейки (для которых `ctx[l]` равен NULL) пропускаются.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void streebog_g_lanes( struct streebog **ctx, const ak_uint64 **n, const ak_uint64 **m )
+{
+  int l = 0;
+  for( l = 0; l < ak_streebog_lanes; l++ )
+     if( ctx[l] != NULL ) ak_streebog_g( ctx[l], n[l], m[l] );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Ячейка, в которой обрабатывается одно из заданий функции ak_hash_context_ptr_jobs(). */
+ struct streebog_lane {
+ /*! \brief Текущее состояние функции хеширования. */
+  struct streebog sx;
+ /*! \brief Обрабатываемое задание (NULL, если ячейка свободна). */
+  ak_hash_job job;
+ /*! \brief Количество полных блоков сообщения. */
+  size_t blocks;
+ /*! \brief Номер следующего вызова преобразования G. */
+  size_t step;
+ /*! \brief Последний (дополненный) блок сообщения. */
+  ak_uint64 tail[8];
+};
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет хеш-коды нескольких независимых сообщений. Вычисления для различных сообщений
+    выполняются в \ref ak_streebog_lanes ячейках; если процессор поддерживает инструкции AVX-512
+    и GFNI, то преобразования G всех ячеек вычисляются одновременно. Освободившаяся ячейка сразу
+    занимается следующим заданием, поэтому сообщения могут иметь произвольные различные длины.
+
+    Для каждого задания вычисления начинаются с текущего состояния контекста `job->ctx`, которое
+    при этом не изменяется (так же, как при вызове функции finalize). Таким образом, задания могут
+    ссылаться на один и тот же контекст; для получения хеш-кода сообщения, как при вызове
+    функции ak_hash_context_ptr(), контекст должен находиться в начальном состоянии.
+    Перед возвратом состояния и последние блоки сообщений во всех внутренних ячейках
+    уничтожаются функцией ak_ptr_wipe().
+
+    @param jobs Массив заданий; поддерживаются только контексты функций хеширования Стрибог.
+    Результат каждого задания помещается в область памяти `out`, размер которой должен быть
+    не менее `ctx->hsize` байт.
+    @param count Количество заданий.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки; в этом случае ни одно задание не выполняется.                         */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_ptr_jobs( ak_hash_job jobs, const size_t count )
+{
+  size_t idx = 0, next = 0, active = 0;
+  struct streebog_lane lanes[ak_streebog_lanes];
+  struct streebog *ctx[ak_streebog_lanes];
+  const ak_uint64 *n[ak_streebog_lanes], *m[ak_streebog_lanes];
+  struct random generator;
+  int l = 0, error = ak_error_ok;
+
+  if( jobs == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                             "using null pointer to hash jobs" );
+  for( idx = 0; idx < count; idx++ ) {
+     if( jobs[idx].ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                       "using null pointer to hash context" );
+     if( jobs[idx].ctx->update != ak_hash_streebog_update )
+       return ak_error_message( ak_error_undefined_function, __func__ ,
+                                           "using hash jobs with non streebog hash context" );
+     if(( jobs[idx].in == NULL ) && ( jobs[idx].size != 0 ))
+       return ak_error_message( ak_error_null_pointer, __func__ , "using null pointer to data" );
+     if( jobs[idx].out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                               "using null pointer to result" );
+  }
+
+  if( count == 0 ) return ak_error_ok;
+ /* генератор, используемый для очистки состояний, отличен от генератора масок ключей */
+  if(( error = ak_random_context_create_lcg( &generator )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect creation of random generator context" );
+
+  for( l = 0; l < ak_streebog_lanes; l++ ) lanes[l].job = NULL;
+  do{
+     /* занимаем свободные ячейки */
+      for( l = 0; l < ak_streebog_lanes; l++ ) {
+         struct streebog_lane *lane = lanes+l;
+         if(( lane->job != NULL ) || ( next == count )) continue;
+         lane->job = jobs + next++;
+         lane->blocks = lane->job->size >> 6;
+         lane->step = 0;
+         memcpy( &lane->sx, lane->job->ctx->data, sizeof( struct streebog ));
+         active++;
+      }
+      if( !active ) break;
+
+     /* определяем аргументы преобразования G для каждой ячейки */
+      for( l = 0; l < ak_streebog_lanes; l++ ) {
+         struct streebog_lane *lane = lanes+l;
+         ctx[l] = NULL; n[l] = NULL; m[l] = NULL;
+         if( lane->job == NULL ) continue;
+
+         ctx[l] = &lane->sx;
+         if( lane->step < lane->blocks ) {
+           n[l] = lane->sx.N;
+           m[l] = ( const ak_uint64 *)(( const ak_uint8 *)lane->job->in + ( lane->step << 6 ));
+         } else
+            if( lane->step == lane->blocks ) {
+             /* формируем дополненный последний блок, как в функции finalize */
+              size_t tail = lane->job->size - ( lane->blocks << 6 );
+              memset( lane->tail, 0, 64 );
+              if( tail ) memcpy( lane->tail,
+                                  ( const ak_uint8 *)lane->job->in + ( lane->blocks << 6 ), tail );
+              (( ak_uint8 *)lane->tail )[tail] = 1;
+              n[l] = lane->sx.N;
+              m[l] = lane->tail;
+            } else m[l] = ( lane->step == lane->blocks+1 ) ? lane->sx.N : lane->sx.SIGMA;
+      }
+
+     /* когда в работе осталось одно сообщение, одновременная обработка не нужна */
+      if(( active == 1 ) && ( next == count )) streebog_g_lanes( ctx, n, m );
+        else ak_streebog_g_lanes( ctx, n, m );
+
+     /* завершаем шаг в каждой ячейке */
+      for( l = 0; l < ak_streebog_lanes; l++ ) {
+         struct streebog_lane *lane = lanes+l;
+         if( lane->job == NULL ) continue;
+
+         if( lane->step < lane->blocks ) {
+           streebog_add( &lane->sx, 512 );
+           ak_streebog_sadd( &lane->sx, m[l] );
+         } else
+            if( lane->step == lane->blocks ) {
+              streebog_add( &lane->sx, ( lane->job->size - ( lane->blocks << 6 )) << 3 );
+              ak_streebog_sadd( &lane->sx, lane->tail );
+            } else
+               if( lane->step == lane->blocks+2 ) {
+                 if( lane->job->ctx->hsize == 64 ) memcpy( lane->job->out, lane->sx.H, 64 );
+                   else memcpy( lane->job->out, lane->sx.H+4, 32 );
+                 lane->job = NULL;
+                 active--;
+                 continue;
+               }
+         lane->step++;
+      }
+  } while( active || ( next < count ));
+
+ /* уничтожаем состояния и последние блоки сообщений во всех ячейках */
+  ak_ptr_wipe( lanes, sizeof( lanes ), &generator, ak_true );
+  ak_random_context_destroy( &generator );
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция инициализирует контекст алгоритма бесключевого хеширования, регламентируемого стандартом
     ГОСТ Р 34.11-2012, с длиной хэшкода, равной 256 бит (функция Стрибог256).
@@ -248,6 +886,9 @@
  /* выполняем проверку */
   if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                      "using null pointer to hash context" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_streebog256 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using streebog256 after unsuccessful self test" );
  /* инициализируем контекст */
   if(( error = ak_hash_context_create( ctx, sizeof( struct streebog ), 64 )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect streebog context creation" );
@@ -281,6 +922,9 @@
  /* выполняем проверку */
   if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                      "using null pointer to hash context" );
+ /* однократно выполняем контрольный пример */
+  if(( error = ak_libakrypt_self_test( ak_self_test_streebog512 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using streebog512 after unsuccessful self test" );
  /* инициализируем контекст */
   if(( error = ak_hash_context_create( ctx, sizeof( struct streebog ), 64 )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect streebog context creation" );
@@ -78,8 +78,16 @@
  #include <ak_tools.h>
 
 /* ----------------------------------------------------------------------------------------------- */
-/*!  Переменная, содержащая в себе код последней ошибки                                            */
+/*!  Переменная, содержащая в себе код последней ошибки. При поддержке компилятором локальной
+     памяти потоков каждый поток имеет собственный код ошибки; в частности, контрольные примеры,
+     выполняемые в фоновом потоке, не изменяют код ошибки, установленный другими потоками.        */
+#if defined( LIBAKRYPT_HAVE_BUILTIN_THREAD_LOCAL )
+ static __thread int ak_errno = ak_error_ok;
+#elif defined( _MSC_VER )
+ static __declspec( thread ) int ak_errno = ak_error_ok;
+#else
  static int ak_errno = ak_error_ok;
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Внутренний указатель на функцию аудита                                                         */
@@ -118,6 +126,41 @@
      { "acpkm_section_magma_block_count", 128 },
      { "acpkm_section_kuznechik_block_count", 512 },
 
+  /* количество потоков, используемых при шифровании больших объемов данных в режимах гаммирования;
+                                    нулевое значение означает количество доступных процессоров */
+     { "bckey_threads_count", 0 },
+
+  /* минимальный объем данных (в байтах), начиная с которого шифрование в режимах гаммирования
+                          выполняется несколькими потоками; нулевое значение отключает потоки */
+     { "bckey_threads_threshold", 1048576 },
+
+  /* количество потоков, используемых алгоритмом PBKDF2 для вычисления независимых блоков;
+                                    нулевое значение означает количество доступных процессоров */
+     { "pbkdf2_threads_count", 0 },
+
+  /* количество потоков, используемых при обработке объектов контейнера PKCS#15;
+                                    нулевое значение означает количество доступных процессоров */
+     { "pkcs_15_threads_count", 0 },
+
+  /* время жизни (в секундах) ключей KEK, выработанных из пароля и сохраненных в кэше
+                                          при разборе контейнеров PKCS#15; нулевое значение отключает кэш */
+     { "pkcs_15_kek_cache_ttl", 0 },
+
+  /* режим выполнения контрольных примеров: 0 - контрольные примеры не выполняются,
+     1 - каждый алгоритм тестируется однократно при первом использовании,
+     2 - тестирование всех алгоритмов запускается в фоновых потоках при инициализации библиотеки */
+     { "self_test_mode", 1 },
+
+  /* ненулевое значение означает, что все преобразования алгоритма Кузнечик, включая зашифрование
+     одного блока, выполняются векторной реализацией без обращений к таблицам, зависящих
+     от данных; по умолчанию одиночные блоки обрабатываются более быстрой табличной реализацией */
+     { "kuznechik_constant_time", 0 },
+
+  /* наибольший номер реализации функции сжатия Стрибог, которая может быть выбрана при наличии
+     поддержки процессором: 1 - скалярная, 2 - AVX2, 3 - AVX-512, 4 - AVX-512 и GFNI;
+     нулевое значение означает выбор наиболее быстрой реализации */
+     { "streebog_implementation", 0 },
+
      { NULL, 0 } /* завершающая константа, должна всегда принимать нулевые значения */
  };
 
@@ -405,6 +448,59 @@
           ak_libakrypt_set_option( "kuznechik_cipher_resource", value );
         }
 
+       /* устанавливаем количество потоков для шифрования в режимах гаммирования */
+        if( ak_libakrypt_load_one_option( localbuffer, "bckey_threads_count = ", &value )) {
+          if( value < 0 ) value = 0;
+          if( value > 256 ) value = 256;
+          ak_libakrypt_set_option( "bckey_threads_count", value );
+        }
+
+       /* устанавливаем объем данных, начиная с которого используются несколько потоков */
+        if( ak_libakrypt_load_one_option( localbuffer, "bckey_threads_threshold = ", &value )) {
+          if( value < 0 ) value = 0;
+          if( value > 2147483647 ) value = 2147483647;
+          ak_libakrypt_set_option( "bckey_threads_threshold", value );
+        }
+
+       /* устанавливаем количество потоков для выработки ключей по алгоритму PBKDF2 */
+        if( ak_libakrypt_load_one_option( localbuffer, "pbkdf2_threads_count = ", &value )) {
+          if( value < 0 ) value = 0;
+          if( value > 256 ) value = 256;
+          ak_libakrypt_set_option( "pbkdf2_threads_count", value );
+        }
+
+       /* устанавливаем количество потоков для обработки объектов контейнера PKCS#15 */
+        if( ak_libakrypt_load_one_option( localbuffer, "pkcs_15_threads_count = ", &value )) {
+          if( value < 0 ) value = 0;
+          if( value > 256 ) value = 256;
+          ak_libakrypt_set_option( "pkcs_15_threads_count", value );
+        }
+
+       /* устанавливаем время жизни ключей KEK в кэше контейнеров PKCS#15 */
+        if( ak_libakrypt_load_one_option( localbuffer, "pkcs_15_kek_cache_ttl = ", &value )) {
+          if( value < 0 ) value = 0;
+          if( value > 86400 ) value = 86400;
+          ak_libakrypt_set_option( "pkcs_15_kek_cache_ttl", value );
+        }
+
+       /* устанавливаем режим выполнения контрольных примеров */
+        if( ak_libakrypt_load_one_option( localbuffer, "self_test_mode = ", &value )) {
+          if(( value < 0 ) || ( value > 2 )) value = 1;
+          ak_libakrypt_set_option( "self_test_mode", value );
+        }
+
+       /* устанавливаем реализацию зашифрования одиночных блоков алгоритмом Кузнечик */
+        if( ak_libakrypt_load_one_option( localbuffer, "kuznechik_constant_time = ", &value )) {
+          if( value != 0 ) value = 1;
+          ak_libakrypt_set_option( "kuznechik_constant_time", value );
+        }
+
+       /* устанавливаем ограничение на реализацию функции сжатия Стрибог */
+        if( ak_libakrypt_load_one_option( localbuffer, "streebog_implementation = ", &value )) {
+          if(( value < 0 ) || ( value > 4 )) value = 0;
+          ak_libakrypt_set_option( "streebog_implementation", value );
+        }
+
       } /* далее мы очищаем строку независимо от ее содержимого */
       off = 0;
       memset( localbuffer, 0, 1024 );
@@ -772,8 +868,9 @@
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \b Внимание. Функция экспортируется.
-    \return Функция возвращает текущее значение кода ошибки. Данное значение не является
-    защищенным от возможности изменения различными потоками выполнения программы.                  */
+    \return Функция возвращает текущее значение кода ошибки, установленное вызывающим потоком.
+    При отсутствии поддержки локальной памяти потоков код ошибки является общим для всех потоков
+    и не защищен от возможности изменения различными потоками выполнения программы.                */
 /* ----------------------------------------------------------------------------------------------- */
  int ak_error_get_value( void )
 {
@@ -51,6 +51,37 @@
 /*! \brief Вывод в логгер текущих значений опций библиотеки. */
  void ak_libakrypt_log_options( void );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Перечисление определяет группы алгоритмов, контрольные примеры для которых
+    выполняются однократно, при первом использовании алгоритма. */
+ typedef enum {
+  /*! \brief Функция хеширования Стрибог256 (ГОСТ Р 34.11-2012). */
+   ak_self_test_streebog256,
+  /*! \brief Функция хеширования Стрибог512 (ГОСТ Р 34.11-2012). */
+   ak_self_test_streebog512,
+  /*! \brief Блочный шифр Магма (ГОСТ Р 34.12-2015). */
+   ak_self_test_magma,
+  /*! \brief Блочный шифр Кузнечик (ГОСТ Р 34.12-2015). */
+   ak_self_test_kuznechik,
+  /*! \brief Алгоритм выработки имитовставки HMAC (Р 50.1.113-2016). */
+   ak_self_test_hmac,
+  /*! \brief Режим аутентифицированного шифрования MGM. */
+   ak_self_test_mgm,
+  /*! \brief Алгоритм выработки ключа из пароля PBKDF2 (Р 50.1.111-2016). */
+   ak_self_test_pbkdf2,
+  /*! \brief Режим шифрования CTR-ACPKM (Р 1323565.1.017-2018). */
+   ak_self_test_acpkm,
+  /*! \brief Алгоритм выработки имитовставки OMAC (ГОСТ Р 34.13-2015). */
+   ak_self_test_omac,
+  /*! \brief Операции с эллиптическими кривыми и электронная подпись (ГОСТ Р 34.10-2012). */
+   ak_self_test_signature,
+  /*! \brief Количество групп алгоритмов. */
+   ak_self_test_count
+} ak_self_test_t;
+
+/*! \brief Функция однократно выполняет контрольный пример для заданной группы алгоритмов. */
+ int ak_libakrypt_self_test( const ak_self_test_t );
+
 /* ----------------------------------------------------------------------------------------------- */
 #ifndef LIBAKRYPT_CONST_CRYPTO_PARAMS
 /*! \brief Функция считывает настройки (параметры) библиотеки из файла libakrypt.conf */
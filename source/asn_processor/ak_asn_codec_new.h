@@ -9,6 +9,7 @@
 
 #include <libakrypt.h>
 #include <pkcs_15_cryptographic_token/ak_pointer_server.h>
+#include <asn_processor/ak_asn_core.h>
 
 
 /*! \brief флаги, определяющие класс данных ASN.1. */
@@ -171,7 +172,7 @@ int ak_asn_add_nested_elem(ak_asn_tlv p_tlv_parent, ak_asn_tlv p_tlv_child);
 int new_asn_get_tag(ak_byte** pp_data, tag *p_tag);
 
 /*! \brief Декодирование длины данных из DER последовательности. */
-int new_asn_get_len(ak_byte** pp_data, size_t *p_len);
+int new_asn_get_len(ak_byte** pp_data, const ak_byte *p_end, size_t *p_len);
 
 /*! \brief Декодирование целого числа из DER последовательности. */
 int new_asn_get_int(ak_byte *p_buff, ak_uint32 len, integer *p_val);
@@ -0,0 +1,472 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Файл ak_asn_core.c                                                                             */
+/*  - содержит реализацию базовых функций кодирования и декодирования заголовков (тег и длина)    */
+/*    и значений стандартных типов ASN.1, на которые опираются обе реализации кодека              */
+/*    (ak_asn_read.c/ak_asn_write.c и ak_asn_read_new.c/ak_asn_write_new.c).                       */
+/* ----------------------------------------------------------------------------------------------- */
+
+#ifdef LIBAKRYPT_HAVE_STDLIB_H
+#include <stdlib.h>
+#else
+#error Library cannot be compiled without stdlib.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_STRING_H
+#include <string.h>
+#else
+#error Library cannot be compiled without string.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_STDIO_H
+#include <stdio.h>
+#else
+#error Library cannot be compiled without stdio.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_CTYPE_H
+#include <ctype.h>
+#else
+#error Library cannot be compiled without ctype.h header
+#endif
+
+#include "ak_asn_core.h"
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция разбирает тег (на данный момент поддерживаются только теги, представленные одним
+    байтом) и длину блока данных за один проход. Короткая форма длины, которая встречается
+    в подавляющем большинстве случаев, обрабатывается без циклов и дополнительных вызовов.
+
+    Если указатель p_end отличен от NULL, то дополнительно проверяется, что заголовок и
+    данные целиком лежат в области памяти [p_buff, p_end). Таким образом, после успешного
+    выполнения функции повторная проверка границ блока не требуется.
+
+    @param p_buff указатель на тег
+    @param p_end указатель на первый байт после доступной области памяти (может быть равен NULL)
+    @param p_tag указатель на переменную, в которую помещается тег
+    @param p_len указатель на переменную, в которую помещается длина данных
+    @param p_header_len указатель на переменную, в которую помещается длина заголовка
+           (тег и закодированная длина)
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int ak_asn_core_get_header(const ak_byte *p_buff, const ak_byte *p_end,
+                           ak_byte *p_tag, size_t *p_len, size_t *p_header_len)
+{
+    int error;
+    size_t len;            /* Длина данных */
+    ak_uint8 len_byte_cnt; /* Кол-во байтов, которыми закодирована длина */
+
+    if(!p_buff || !p_tag || !p_len || !p_header_len)
+        return ak_error_null_pointer;
+
+    if(p_end && (p_end <= p_buff + 1))
+        return ak_error_wrong_length;
+
+    if(!(p_buff[1] & 0x80u))
+    {
+        /* Короткая форма длины */
+        len = p_buff[1];
+        len_byte_cnt = 1;
+        if(p_end && (size_t)(p_end - p_buff) - 2 < len)
+            return ak_error_wrong_length;
+    }
+    else if((error = ak_asn_core_get_len(p_buff + 1, p_end, &len, &len_byte_cnt)) != ak_error_ok)
+        return error;
+
+    *p_tag = p_buff[0];
+    *p_len = len;
+    *p_header_len = 1 + (size_t)len_byte_cnt;
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! На данный момент определяется длинна, представленная не более, чем в 4 байтах.
+    Если указатель p_end отличен от NULL, то дополнительно проверяется, что закодированная
+    длина и следующие за ней данные целиком лежат в области памяти [p_buff, p_end).
+
+    @param p_buff указатель на длину данных
+    @param p_end указатель на первый байт после доступной области памяти (может быть равен NULL)
+    @param p_len указатель переменную, содержащую длинну блока данных
+    @param p_len_byte_cnt указатель переменную, содержащую кол-во памяти (в байтах),
+           необходимое для хранения длины блока данных в DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int ak_asn_core_get_len(const ak_byte *p_buff, const ak_byte *p_end, size_t *p_len, ak_uint8 *p_len_byte_cnt)
+{
+    size_t len, avail;
+    ak_uint8 len_byte_cnt, i;
+
+    if(!p_buff || !p_len || !p_len_byte_cnt)
+        return ak_error_null_pointer;
+
+    avail = p_end ? (size_t)(p_end - p_buff) : (size_t)-1;
+    if(p_end && p_end <= p_buff)
+        return ak_error_wrong_length;
+
+    if(!(p_buff[0] & 0x80u))
+    {
+        len = p_buff[0];
+        len_byte_cnt = 1;
+    }
+    else
+    {
+        len_byte_cnt = (ak_uint8)(p_buff[0] & 0x7Fu);
+        if(!len_byte_cnt || len_byte_cnt > AK_ASN_MAX_LEN_BYTE_CNT || avail <= len_byte_cnt)
+            return ak_error_wrong_length;
+
+        for(i = 1, len = 0; i <= len_byte_cnt; i++)
+            len = (len << 8u) | p_buff[i];
+        len_byte_cnt++;
+    }
+
+    if(p_end && (avail - len_byte_cnt) < len)
+        return ak_error_wrong_length;
+
+    *p_len = len;
+    *p_len_byte_cnt = len_byte_cnt;
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param tag тег
+    @param len длина данных
+    @param p_buff указатель на область памяти, в которую записывается заголовок
+    @param p_header_len указатель на переменную, в которую помещается длина заголовка
+           (может быть равен NULL)
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int ak_asn_core_put_header(ak_byte tag, size_t len, ak_byte *p_buff, size_t *p_header_len)
+{
+    int error;
+    ak_uint8 len_byte_cnt;
+
+    if(!p_buff)
+        return ak_error_null_pointer;
+
+    if(!(len_byte_cnt = ak_asn_core_len_byte_cnt(len)))
+        return ak_error_wrong_length;
+
+    p_buff[0] = tag;
+    if(len_byte_cnt == 1)
+        p_buff[1] = (ak_byte)len;
+    else if((error = ak_asn_core_put_len(len, len_byte_cnt, p_buff + 1)) != ak_error_ok)
+        return error;
+
+    if(p_header_len)
+        *p_header_len = 1 + (size_t)len_byte_cnt;
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param len длина данных
+    @param len_byte_cnt кол-во байтов, которыми кодируется длина (значение, возвращаемое
+           функцией ak_asn_core_len_byte_cnt())
+    @param p_buff указатель на область памяти, в которую записывается результат кодирования
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int ak_asn_core_put_len(size_t len, ak_uint8 len_byte_cnt, ak_byte *p_buff)
+{
+    if(!p_buff)
+        return ak_error_null_pointer;
+
+    if(!len_byte_cnt || len_byte_cnt > AK_ASN_MAX_LEN_BYTE_CNT + 1)
+        return ak_error_wrong_length;
+
+    if(len_byte_cnt == 1)
+    {
+        *p_buff = (ak_byte)len;
+        return ak_error_ok;
+    }
+
+    *(p_buff++) = (ak_byte)(0x80u ^ (ak_uint8)(--len_byte_cnt));
+    do
+    {
+        *(p_buff++) = (ak_byte)((len >> (8u * --len_byte_cnt)) & 0xFFu);
+    } while(len_byte_cnt != 0);
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param len длина данных
+    @return Кол-во байтов, необходимое для хранения закодированной длины. В случае, если
+    длина не может быть закодирована, возвращается ноль.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ak_uint8 ak_asn_core_len_byte_cnt(size_t len)
+{
+    if(len < 0x80u)
+        return 1;
+    if(len <= 0xFFu)
+        return 2;
+    if(len <= 0xFFFFu)
+        return 3;
+    if(len <= 0xFFFFFFu)
+        return 4;
+    if(len <= 0xFFFFFFFFu)
+        return 5;
+    return 0;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! На данный момент разбираются только идентификаторы, у который первое число 1 или 2,
+    а второе не превосходит 32. Память под строку выделяется функцией и должна быть
+    освобождена вызывающей стороной.
+
+    @param p_buff указатель на закодированный идентификатор объекта
+    @param len длинна блока данных
+    @param pp_objid указатель на переменную, в которую помещается указатель на строку
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int ak_asn_core_get_objid(const ak_byte *p_buff, size_t len, char **pp_objid)
+{
+    size_t i;
+    size_t size;      /* Размер строки */
+    size_t curr_size; /* Кол-во записанных в строку символов */
+    ak_uint32 value;
+    char *p_objid;
+
+    if(!p_buff || !pp_objid)
+        return ak_error_null_pointer;
+
+    if(!len || ((p_buff[0] / 40) > 2) || ((p_buff[0] % 40) > 32))
+        return ak_error_wrong_asn1_decode;
+
+    /* Каждый байт кодирует не более 4 символов строки (точка и три цифры),
+       первый байт - не более 5 символов */
+    size = 4 * len + 8;
+    if((p_objid = (char *)malloc(size)) == NULL)
+        return ak_error_out_of_memory;
+
+    curr_size = (size_t)snprintf(p_objid, size, "%d.%d", p_buff[0] / 40, p_buff[0] % 40);
+    for(i = 1; i < len; i++)
+    {
+        value = 0u;
+        while(p_buff[i] & 0x80u)
+        {
+            value = (value | (p_buff[i] & 0x7Fu)) << 7u;
+            if(++i == len)
+            {
+                free(p_objid);
+                return ak_error_wrong_asn1_decode;
+            }
+        }
+        value |= p_buff[i] & 0x7Fu;
+
+        curr_size += (size_t)snprintf(p_objid + curr_size, size - curr_size, ".%u", value);
+        if(curr_size >= size)
+        {
+            free(p_objid);
+            return ak_error_wrong_asn1_decode;
+        }
+    }
+
+    *pp_objid = p_objid;
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Размер памяти, на которую указывает p_buff, должен быть не меньше значения, возвращаемого
+    функцией ak_asn_core_objid_byte_cnt().
+
+    @param p_objid входная строка, содержая идентификатор в виде чисел, разделенных точками
+    @param p_buff указатель на область памяти, в которую записывается результат кодирования
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int ak_asn_core_put_objid(const char *p_objid, ak_byte *p_buff)
+{
+    unsigned long num;
+    char *p_objid_end;
+    ak_int8 i;
+
+    if(!p_objid || !p_buff)
+        return ak_error_null_pointer;
+
+    num = strtoul(p_objid, &p_objid_end, 10);
+    if(*p_objid_end != '.')
+        return ak_error_wrong_asn1_encode;
+    p_objid = p_objid_end + 1;
+    num = num * 40 + strtoul(p_objid, &p_objid_end, 10);
+    if(num > 0xFFu)
+        return ak_error_wrong_asn1_encode;
+    *(p_buff++) = (ak_byte)num;
+
+    while(*p_objid_end != '\0')
+    {
+        p_objid = p_objid_end + 1;
+        num = strtoul(p_objid, &p_objid_end, 10);
+        if(num > 0x0FFFFFFFu)
+            return ak_error_wrong_asn1_encode;
+
+        /* Определяем старшую значащую группу из семи битов */
+        for(i = 3; i > 0 && !((num >> (7u * (ak_uint8)i)) & 0x7Fu); i--);
+        for(; i > 0; i--)
+            *(p_buff++) = (ak_byte)(0x80u ^ ((num >> (7u * (ak_uint8)i)) & 0x7Fu));
+        *(p_buff++) = (ak_byte)(num & 0x7Fu);
+    }
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_objid строка, содержая идентификатор в виде чисел, разделенных точками
+    @return Кол-во байтов, необходимое для хранения закодированного идентификатора.
+    В случае ошибки возвращается ноль.                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ak_uint8 ak_asn_core_objid_byte_cnt(const char *p_objid)
+{
+    size_t byte_cnt;
+    unsigned long num;
+    char *p_end;
+
+    if(!p_objid)
+        return 0;
+
+    /* Первые 2 числа кодируются одним байтом */
+    byte_cnt = 1;
+    strtoul(p_objid, &p_end, 10);
+    if(*p_end != '.')
+        return 0;
+    strtoul(p_end + 1, &p_end, 10);
+
+    while(*p_end != '\0')
+    {
+        num = strtoul(p_end + 1, &p_end, 10);
+        if(num <= 0x7Fu)             /*                               0111 1111 -  7 бит */
+            byte_cnt += 1;
+        else if(num <= 0x3FFFu)      /*                     0011 1111 1111 1111 - 14 бит */
+            byte_cnt += 2;
+        else if(num <= 0x1FFFFFu)    /*           0001 1111 1111 1111 1111 1111 - 21 бит */
+            byte_cnt += 3;
+        else if(num <= 0x0FFFFFFFu)  /* 0000 1111 1111 1111 1111 1111 1111 1111 - 28 бит */
+            byte_cnt += 4;
+        else
+            return 0;
+    }
+
+    return byte_cnt > 0xFFu ? 0 : (ak_uint8)byte_cnt;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Память под строку выделяется функцией и должна быть освобождена вызывающей стороной.
+
+    @param p_buff указатель на закодированное время
+    @param len длинна блока данных
+    @param pp_time указатель на переменную, в которую помещается указатель на строку
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int ak_asn_core_get_gentime(const ak_byte *p_buff, size_t len, char **pp_time)
+{
+    char *p_time;
+
+    if(!p_buff || !pp_time)
+        return ak_error_null_pointer;
+
+    *pp_time = NULL;
+    if(len < 15 || toupper(p_buff[len - 1]) != 'Z')
+        return ak_error_wrong_asn1_decode;
+
+    /* Дополнительные 9 байтов для символов пробела, тире и т.д. */
+    if((p_time = (char *)malloc(len + 9)) == NULL)
+        return ak_error_out_of_memory;
+
+    /* YYYY-MM-DD HH:MM: */
+    memcpy(p_time, p_buff, 4);          p_time[4] = '-';
+    memcpy(p_time + 5, p_buff + 4, 2);  p_time[7] = '-';
+    memcpy(p_time + 8, p_buff + 6, 2);  p_time[10] = ' ';
+    memcpy(p_time + 11, p_buff + 8, 2); p_time[13] = ':';
+    memcpy(p_time + 14, p_buff + 10, 2); p_time[16] = ':';
+
+    /* SS.mmm (13 = YYYY + MM + DD + HH + MM + 'Z') */
+    memcpy(p_time + 17, p_buff + 12, len - 13);
+    memcpy(p_time + 17 + len - 13, " UTC", 5);
+
+    *pp_time = p_time;
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_time строка в формате "YYYY-MM-DD HH:MM:SS.[ms] UTC"
+    @param p_buff указатель на область памяти, в которую записывается результат кодирования
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int ak_asn_core_put_gentime(const char *p_time, ak_byte *p_buff)
+{
+    /* Кол-во цифр в каждом поле и разделитель, следующий за полем */
+    static const ak_uint8 digits[6] = { 4, 2, 2, 2, 2, 2 };
+    ak_uint8 field, i;
+
+    if(!p_time || !p_buff)
+        return ak_error_null_pointer;
+
+    if(ak_asn_core_gentime_byte_cnt(p_time) < 15)
+        return ak_error_wrong_asn1_encode;
+
+    /* YYYY MM DD HH MM SS */
+    for(field = 0; field < 6; field++)
+    {
+        for(i = 0; i < digits[field]; i++)
+        {
+            if(!isdigit((unsigned char)*p_time))
+                return ak_error_wrong_asn1_encode;
+            *(p_buff++) = (ak_byte) *(p_time++);
+        }
+        if(field < 5)
+            p_time++;
+    }
+
+    /* .mmm */
+    if(*p_time == '.')
+    {
+        const char *p_space = strchr(p_time, ' ');
+        size_t ms_cnt;
+
+        if(!p_space || (ms_cnt = (size_t)(p_space - p_time) - 1) == 0)
+            return ak_error_wrong_asn1_encode;
+
+        /* Доли секунды не могут заканчиваться нулем */
+        if(p_time[ms_cnt] == '0')
+            return ak_error_wrong_asn1_encode;
+
+        *(p_buff++) = (ak_byte) *(p_time++);
+        for(i = 0; i < ms_cnt; i++)
+        {
+            if(!isdigit((unsigned char)*p_time))
+                return ak_error_wrong_asn1_encode;
+            *(p_buff++) = (ak_byte) *(p_time++);
+        }
+    }
+
+    *p_buff = 'Z';
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_time строка, содержая время в формате "YYYY-MM-DD HH:MM:SS.[ms] UTC"
+    @return Кол-во байтов, необходимое для хранения закодированного времени.                       */
+/* ----------------------------------------------------------------------------------------------- */
+ak_uint8 ak_asn_core_gentime_byte_cnt(const char *p_time)
+{
+    size_t len;
+
+    if(!p_time || (len = strlen(p_time)) < 8)
+        return 0;
+    /*
+     * 8 имеет след. смысл:
+     * - из строки "YYYY-MM-DD HH:MM:SS.[ms] UTC" удалить символы "-- :: UTC"
+     * - добавить символ "Z"
+     * Примечание: эл-ов ms может быть неограниченное кол-во.
+    */
+    return (ak_uint8)(len - 8);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                 ak_asn_core.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -0,0 +1,44 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Файл ak_asn_core.h                                                                             */
+/*  - содержит описание базовых функций кодирования и декодирования заголовков (тег и длина)      */
+/*    и значений стандартных типов ASN.1, общих для всех реализаций кодека;                        */
+/*  - функции не зависят от представления типов ASN.1 в конкретном кодеке и работают              */
+/*    непосредственно с массивами байтов.                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+
+#ifndef __AK_ASN_CORE_H__
+#define __AK_ASN_CORE_H__
+
+#include <libakrypt.h>
+
+/*! \brief Максимальное кол-во байтов, которыми может быть закодирована длина в длинной форме
+ *         (без учета первого байта, содержащего кол-во байтов длины). */
+#define AK_ASN_MAX_LEN_BYTE_CNT 4
+
+/*! \brief Декодирование заголовка (тега и длины) блока данных ASN.1. */
+int ak_asn_core_get_header(const ak_byte *p_buff, const ak_byte *p_end,
+                           ak_byte *p_tag, size_t *p_len, size_t *p_header_len);
+/*! \brief Декодирование длины данных с проверкой выхода за границы блока. */
+int ak_asn_core_get_len(const ak_byte *p_buff, const ak_byte *p_end, size_t *p_len, ak_uint8 *p_len_byte_cnt);
+/*! \brief Кодирование заголовка (тега и длины) блока данных ASN.1. */
+int ak_asn_core_put_header(ak_byte tag, size_t len, ak_byte *p_buff, size_t *p_header_len);
+/*! \brief Кодирование длины данных заданным количеством байтов. */
+int ak_asn_core_put_len(size_t len, ak_uint8 len_byte_cnt, ak_byte *p_buff);
+/*! \brief Получение кол-ва байтов, необходимых для кодирования длины данных. */
+ak_uint8 ak_asn_core_len_byte_cnt(size_t len);
+
+/*! \brief Декодирование идентификатора объекта в строку вида "1.2.643...". */
+int ak_asn_core_get_objid(const ak_byte *p_buff, size_t len, char **pp_objid);
+/*! \brief Кодирование идентификатора объекта, представленного строкой. */
+int ak_asn_core_put_objid(const char *p_objid, ak_byte *p_buff);
+/*! \brief Получение кол-ва байтов, необходимых для кодирования идентификатора объекта. */
+ak_uint8 ak_asn_core_objid_byte_cnt(const char *p_objid);
+
+/*! \brief Декодирование времени в строку вида "YYYY-MM-DD HH:MM:SS.[ms] UTC". */
+int ak_asn_core_get_gentime(const ak_byte *p_buff, size_t len, char **pp_time);
+/*! \brief Кодирование времени, представленного строкой вида "YYYY-MM-DD HH:MM:SS.[ms] UTC". */
+int ak_asn_core_put_gentime(const char *p_time, ak_byte *p_buff);
+/*! \brief Получение кол-ва байтов, необходимых для кодирования времени. */
+ak_uint8 ak_asn_core_gentime_byte_cnt(const char *p_time);
+
+#endif /* __AK_ASN_CORE_H__ */
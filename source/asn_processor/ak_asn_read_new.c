@@ -25,47 +25,50 @@
 
 int ak_asn_decode(ak_pointer p_asn_data, size_t size, ak_asn_tlv p_tlv)
 {
-    ak_byte* p_begin;  /* Указатель на начало tlv */ //FIXME можно обойтись без него
-    ak_byte* p_curr;   /* Указатель на текущую позицию */
-    ak_byte* p_end;    /* Указатель на конец tlv */
-    tag      data_tag; /* Тег данных */
-    size_t   data_len; /* Длина данных */
-    int error;         /* Код ошибки */
+    ak_byte* p_curr;     /* Указатель на текущую позицию */
+    ak_byte* p_end;      /* Указатель на конец tlv */
+    tag      data_tag;   /* Тег данных */
+    size_t   data_len;   /* Длина данных */
+    size_t   header_len; /* Длина заголовка (тег и длина данных) */
+    int error;           /* Код ошибки */
 
     if(!p_asn_data || !size || !p_tlv)
         return ak_error_null_pointer;
 
-    p_begin = p_curr = p_asn_data;
-    p_end = p_begin + size;
+    p_curr = p_asn_data;
+
+    /* Заголовок разбирается один раз, вместе с проверкой выхода за границы данных */
+    if((error = ak_asn_core_get_header(p_curr, p_curr + size, &data_tag, &data_len, &header_len)) != ak_error_ok)
+        return ak_error_message(error, __func__, "wrong tag or data length");
+
+    p_curr += header_len;
+    p_end = p_curr + data_len;
 
-    new_asn_get_tag(&p_curr, &data_tag);
     if(data_tag & CONSTRUCTED)
     {
         ak_asn_tlv p_nested_tlv;
-        if (ak_asn_create_constructed_tlv(p_tlv, data_tag, ak_false) != ak_error_ok)
-            return -1;
-
-        new_asn_get_len(&p_curr, &data_len);
+        if((error = ak_asn_create_constructed_tlv(p_tlv, data_tag, ak_false)) != ak_error_ok)
+            return ak_error_message(error, __func__, "can not create constructed tlv");
 
-        while(p_tlv->m_data_len < data_len)
+        while(p_curr < p_end)
         {
             p_nested_tlv = malloc(sizeof(s_asn_tlv_t));
             if (!p_nested_tlv)
                 return ak_error_out_of_memory;
-            ak_asn_decode(p_curr, data_len, p_nested_tlv);
 
-            ak_asn_add_nested_elem(p_tlv, p_nested_tlv);
-            p_curr += 1 + p_nested_tlv->m_len_byte_cnt + p_nested_tlv->m_data_len;
+            if((error = ak_asn_decode(p_curr, (size_t)(p_end - p_curr), p_nested_tlv)) != ak_error_ok)
+            {
+                free(p_nested_tlv);
+                return error;
+            }
+
+            if((error = ak_asn_add_nested_elem(p_tlv, p_nested_tlv)) != ak_error_ok)
+                return ak_error_message(error, __func__, "can not add nested tlv");
+            p_curr += TAG_LEN + p_nested_tlv->m_len_byte_cnt + p_nested_tlv->m_data_len;
         }
-//        p_tlv->m_data.m_constructed_data->m_arr_of_data[0] = p_nested_tlv;
-//        p_tlv->m_data.m_constructed_data->m_curr_size++;
     }
     else
     {
-        new_asn_get_len(&p_curr, &data_len);
-        if(p_curr + data_len > p_end)
-            return ak_error_message(ak_error_wrong_length, __func__, "wrong data length");
-
         if((error = ak_asn_create_primitive_tlv(p_tlv, data_tag, data_len, p_curr,ak_false)) != ak_error_ok)
             return ak_error_message(error, __func__, "can not create primitive tlv");
     }
@@ -100,39 +103,24 @@ int new_asn_get_tag(ak_byte** pp_data, tag *p_tag)
     чем в 4 байтах.
 
     @param pp_data указатель на длину данных
+    @param p_end указатель на первый байт после блока данных, содержащего длину
     @param p_len указатель переменную, содержащую длинну блока данных
-    @param p_len_byte_cnt указатель переменную, содержащую кол-во памяти (в байтах),
-           необходимое для хранения длины блока данных в DER последовательности
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int new_asn_get_len(ak_byte** pp_data, size_t *p_len)
+int new_asn_get_len(ak_byte** pp_data, const ak_byte *p_end, size_t *p_len)
 {
+    int error;
     ak_uint8 len_byte_cnt; /* Кол-во байтов, которыми представлена длина */
-    if (!pp_data || !p_len)
-        return ak_error_null_pointer;
 
-    *p_len = 0;
-
-    if (**pp_data & 0x80u)
-    {
-        len_byte_cnt = (uint8_t) ((**pp_data) & 0x7Fu);
-        (*pp_data)++;
+    if (!pp_data || !p_end || !p_len)
+        return ak_error_null_pointer;
 
-        if (len_byte_cnt > 4)
-            return ak_error_wrong_length;
+    if ((error = ak_asn_core_get_len(*pp_data, p_end, p_len, &len_byte_cnt)) != ak_error_ok)
+        return error;
 
-        for (uint8_t i = 0; i < len_byte_cnt; i++)
-        {
-            *p_len = (*p_len << 8u) | (**pp_data);
-            (*pp_data)++;
-        }
-    }
-    else
-    {
-        *p_len = **pp_data;
-        (*pp_data)++;
-    }
+    /* Смещаем указатель на данные */
+    (*pp_data) += len_byte_cnt;
 
     return ak_error_ok;
 }
@@ -298,45 +286,10 @@ int new_asn_get_vsblstr(ak_byte *p_buff, size_t len, visible_string *p_str) {
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int new_asn_get_objid(ak_byte *p_buff, size_t len, object_identifier *p_objid) {
-    uint32_t value;
-    size_t curr_size;
-    object_identifier obj_id;
-
     if (!p_buff || !p_objid)
         return ak_error_null_pointer;
 
-    if (((p_buff[0] / 40) > 2) || ((p_buff[0] % 40) > 32))
-        return ak_error_wrong_asn1_decode;
-
-    obj_id = (object_identifier) malloc(50);
-    if (!obj_id)
-        return ak_error_out_of_memory;
-
-    sprintf(obj_id, "%d.%d", p_buff[0] / 40, p_buff[0] % 40);
-
-    for (int i = 1; i < len; i++)
-    {
-        value = 0u;
-        while (p_buff[i] & 0x80u)
-        {
-            value ^= p_buff[i] & 0x7Fu;
-            value = value << 7u;
-            i++;
-        }
-
-        value += p_buff[i] & 0x7Fu;
-
-        if ((curr_size = strlen(obj_id)) >= 50)
-        {
-            free(obj_id);
-            return ak_error_wrong_asn1_decode;
-        }
-
-        sprintf(obj_id + curr_size, ".%u", value);
-    }
-
-    *p_objid = obj_id;
-    return ak_error_ok;
+    return ak_asn_core_get_objid(p_buff, len, p_objid);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -400,52 +353,10 @@ int new_asn_get_bool(ak_byte *p_buff, size_t len, boolean *p_value) {
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int new_asn_get_generalized_time(ak_byte *p_buff, size_t len, generalized_time *p_time) {
-    generalized_time date_time;
-
     if (!p_buff || !p_time)
         return ak_error_null_pointer;
 
-    if (len < 15 || toupper(p_buff[len - 1]) != 'Z')
-    {
-        *p_time = NULL;
-        return ak_error_wrong_asn1_decode;
-    }
-
-    /* Дополнительные 9 байтов для символов пробела, тире и т.д. */
-    date_time = (generalized_time) malloc(len + 9);
-    date_time[0] = '\0';
-
-    /* YYYY */
-    strncat(date_time, (char *) p_buff, 4);
-    strcat(date_time, "-");
-    p_buff += 4;
-
-    /* MM */
-    strncat(date_time, (char *) p_buff, 2);
-    strcat(date_time, "-");
-    p_buff += 2;
-
-    /* DD */
-    strncat(date_time, (char *) p_buff, 2);
-    strcat(date_time, " ");
-    p_buff += 2;
-
-    /* HH */
-    strncat(date_time, (char *) p_buff, 2);
-    strcat(date_time, ":");
-    p_buff += 2;
-
-    /* MM */
-    strncat(date_time, (char *) p_buff, 2);
-    strcat(date_time, ":");
-    p_buff += 2;
-
-    /* SS.mmm */
-    strncat(date_time, (char *) p_buff, len - 13); /* 13 = YYYY + MM + DD + HH + MM + 'Z' */
-    strcat(date_time, " UTC");
-
-    *p_time = date_time;
-    return ak_error_ok;
+    return ak_asn_core_get_gentime(p_buff, len, p_time);
 }
 
 ///* ----------------------------------------------------------------------------------------------- */
@@ -468,7 +379,7 @@ int new_asn_get_generalized_time(ak_byte *p_buff, size_t len, generalized_time *
 //    int error;
 //    tag real_tag;
 //    size_t value_len;
-//    uint8_t len_byte_cnt;
+//    ak_uint8 len_byte_cnt;
 //
 //    if (!expected_tag || !p_curr_ps || !p_result)
 //        return ak_error_null_pointer;
@@ -543,10 +454,10 @@ int new_asn_get_generalized_time(ak_byte *p_buff, size_t len, generalized_time *
 //    @return В случае успеха функция возввращает ak_error_ok (ноль).
 //    В противном случае, возвращается код ошибки.                                                   */
 ///* ----------------------------------------------------------------------------------------------- */
-//int new_asn_get_num_of_elems_in_constructed_obj(s_ptr_server *p_data, uint8_t *p_num_of_elems) {
+//int new_asn_get_num_of_elems_in_constructed_obj(s_ptr_server *p_data, ak_uint8 *p_num_of_elems) {
 //    int error;
 //    size_t value_len;
-//    uint8_t len_byte_cnt;
+//    ak_uint8 len_byte_cnt;
 //    s_ptr_server data_copy;
 //    value_len = 0;
 //    len_byte_cnt = 0;
@@ -123,21 +123,23 @@ int ak_asn_add_nested_elem(ak_asn_tlv p_tlv_parent, ak_asn_tlv p_tlv_child)
         ak_asn_tlv* pp_new_mem;
         ak_uint32  new_size;
 
+        if(p_tlv_parent->m_data.m_constructed_data->m_curr_size == 255)
+            return ak_error_message(ak_error_out_of_memory, __func__, "change type for storing number of nested elements");
 
-        new_size = p_tlv_parent->m_data.m_constructed_data->m_curr_size + 10;
+        /* Увеличиваем массив вдвое, чтобы разбор больших составных объектов не приводил
+           к квадратичному числу копирований */
+        new_size = 2 * (ak_uint32)p_tlv_parent->m_data.m_constructed_data->m_alloc_size;
+        if(new_size < 10)
+            new_size = 10;
         if(new_size > 255)
-            return ak_error_message(ak_error_out_of_memory, __func__, "change type for storing number of nested elements");
+            new_size = 255;
 
-        pp_new_mem = malloc(new_size * sizeof(ak_asn_tlv));
+        pp_new_mem = realloc(p_tlv_parent->m_data.m_constructed_data->m_arr_of_data, new_size * sizeof(ak_asn_tlv));
         if(!pp_new_mem)
             return ak_error_out_of_memory;
 
-        memcpy(pp_new_mem, p_tlv_parent->m_data.m_constructed_data->m_arr_of_data, p_tlv_parent->m_data.m_constructed_data->m_curr_size);
-
         p_tlv_parent->m_data.m_constructed_data->m_alloc_size = (ak_uint8)new_size;
 
-        free(p_tlv_parent->m_data.m_constructed_data->m_arr_of_data);
-
         p_tlv_parent->m_data.m_constructed_data->m_arr_of_data = pp_new_mem;
     }
 
@@ -404,7 +406,7 @@ void ak_asn_print_tree(ak_asn_tlv p_tree)
 
         /* Отрезаем от префикса лишнее (поднимаемся на уровень выше) */
         uiLevel--;
-        uint32_t curr_lvl = uiLevel;
+        ak_uint32 curr_lvl = uiLevel;
         char* tmp = prefix;
         while(curr_lvl > 0)
         {
@@ -171,28 +171,15 @@ int new_asn_put_tag(tag tag, ak_byte** pp_buff)
 /* ----------------------------------------------------------------------------------------------- */
 int new_asn_put_len(size_t len, ak_uint32 len_byte_cnt, ak_byte** pp_buff)
 {
-//    if (!pp_buff)
-//        return ak_error_message(ak_error_null_pointer, __func__, "bad pointer to buffer");
-//
-//    if (!len_byte_cnt)
-//        return ak_error_message(ak_error_null_pointer, __func__, "wrong length");
+    int error;
 
-    if (len_byte_cnt == 1)
-    {
-        (**pp_buff) = (ak_byte) len;
-        (*pp_buff)++;
-    }
-    else
-    {
-        (**pp_buff) = (ak_byte) (0x80u ^ (uint8_t) (--len_byte_cnt));
-        (*pp_buff)++;
+    if (!pp_buff)
+        return ak_error_null_pointer;
 
-        do
-        {
-            (**pp_buff) = (ak_byte) ((len >> (8u * --len_byte_cnt)) & 0xFFu);
-            (*pp_buff)++;
-        }while (len_byte_cnt != 0);
-    }
+    if ((error = ak_asn_core_put_len(len, (ak_uint8)len_byte_cnt, *pp_buff)) != ak_error_ok)
+        return error;
+
+    (*pp_buff) += len_byte_cnt;
 
     return ak_error_ok;
 }
@@ -360,14 +347,13 @@ int new_asn_put_vsblstr(visible_string str, ak_byte** pp_buff, ak_uint32* p_size
 /* ----------------------------------------------------------------------------------------------- */
 int new_asn_put_objid(object_identifier obj_id, ak_byte** pp_buff, ak_uint32* p_size)
 {
-    // FIXME: Реализовать кодирования произовльного идентификатора
-    ak_uint64 num;
-    object_identifier p_objid_end;
+    int error;
 
-    if (!obj_id || !pp_buff)
+    if (!obj_id || !pp_buff || !p_size)
         return ak_error_null_pointer;
 
-    *p_size = new_asn_get_oid_byte_cnt(obj_id);
+    if (!(*p_size = new_asn_get_oid_byte_cnt(obj_id)))
+        return ak_error_wrong_asn1_encode;
 
     *pp_buff = malloc(*p_size);
     if(!(*pp_buff))
@@ -376,31 +362,12 @@ int new_asn_put_objid(object_identifier obj_id, ak_byte** pp_buff, ak_uint32* p_
         return ak_error_out_of_memory;
     }
 
-    num = strtoul((char *) obj_id, &p_objid_end, 10);
-    obj_id = ++p_objid_end;
-    num = num * 40 + strtol((char *) obj_id, &p_objid_end, 10);
-    *((*pp_buff)++) = (ak_byte) num;
-
-    while (*p_objid_end != '\0')
+    if ((error = ak_asn_core_put_objid(obj_id, *pp_buff)) != ak_error_ok)
     {
-        obj_id = ++p_objid_end;
-        num = strtoul((char *) obj_id, &p_objid_end, 10);
-
-        if (num > 0x7Fu)
-        {
-            ak_byte seven_bits;
-            int8_t i;
-            i = 3;
-            while (i > 0)
-            {
-                seven_bits = (ak_byte) ((num >> ((uint8_t) i * 7u)) & 0x7Fu);
-                if (seven_bits)
-                    *((*pp_buff)++) = (ak_byte) (0x80u ^ seven_bits);
-                i--;
-            }
-        }
-
-        *((*pp_buff)++) = (ak_byte) (num & 0x7Fu);
+        free(*pp_buff);
+        *pp_buff = NULL;
+        *p_size = 0;
+        return ak_error_message(error, __func__, "wrong format of object identifier");
     }
 
     return ak_error_ok;
@@ -472,7 +439,9 @@ int new_asn_put_bool(boolean val, ak_byte** pp_buff, ak_uint32* p_size)
 /* ----------------------------------------------------------------------------------------------- */
 int new_asn_put_generalized_time(generalized_time time, ak_byte** pp_buff, ak_uint32* p_size)
 {
-    if (!time || !pp_buff)
+    int error;
+
+    if (!time || !pp_buff || !p_size)
         return ak_error_null_pointer;
 
     *p_size = new_asn_get_gentime_byte_cnt(time);
@@ -486,82 +455,14 @@ int new_asn_put_generalized_time(generalized_time time, ak_byte** pp_buff, ak_ui
         return ak_error_out_of_memory;
     }
 
-    /* YYYY */
-    for (uint8_t i = 0; i < 4; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of year value");
-        *((*pp_buff)++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* MM */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of month value");
-        *((*pp_buff)++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* DD */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of day value");
-        *((*pp_buff)++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* HH */
-    for (uint8_t i = 0; i < 2; i++)
+    if ((error = ak_asn_core_put_gentime(time, *pp_buff)) != ak_error_ok)
     {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of hour value");
-        *((*pp_buff)++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* MM */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of minute value");
-        *((*pp_buff)++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* SS */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of second value");
-        *((*pp_buff)++) = (ak_byte) *(time++);
-    }
-
-    /* .mmm */
-    if (*time == '.')
-    {
-        int8_t ms_cnt = (int8_t) ((strchr(time, ' ') - time) - 1);
-        if (ms_cnt == 0)
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "quota of second absent");
-
-        if (time[ms_cnt] == '0')
-            return ak_error_message(ak_error_wrong_asn1_encode,
-                                    __func__,
-                                    "wrong format of quota of second value (it can't end by 0 symbol)");
-
-        *((*pp_buff)++) = (ak_byte) *(time++); // помещаем символ точки
-        for (uint8_t i = 0; i < ms_cnt; i++)
-        {
-            if (!isdigit(*time))
-                return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of quota of second value");
-            *((*pp_buff)++) = (ak_byte) *(time++);
-        }
+        free(*pp_buff);
+        *pp_buff = NULL;
+        *p_size = 0;
+        return ak_error_message(error, __func__, "wrong format of time string");
     }
 
-    **pp_buff = 'Z';
-
     return ak_error_ok;
 }
 
@@ -581,7 +482,7 @@ int new_asn_put_generalized_time(generalized_time time, ak_byte** pp_buff, ak_ui
 //    @return В случае успеха функция возввращает ak_error_ok (ноль).
 //    В противном случае, возвращается код ошибки.                                                   */
 ///* ----------------------------------------------------------------------------------------------- */
-//int new_asn_put_universal_tlv(uint8_t tag_number,
+//int new_asn_put_universal_tlv(ak_uint8 tag_number,
 //                          void *p_data,
 //                          size_t seq_or_set_len,
 //                          s_ptr_server *p_main_ps,
@@ -767,18 +668,7 @@ int new_asn_put_generalized_time(generalized_time time, ak_byte** pp_buff, ak_ui
 /* ----------------------------------------------------------------------------------------------- */
 ak_uint8 new_asn_get_len_byte_cnt(size_t len)
 {
-    if (len < 0x80u && len >= 0)
-        return 1;
-    if (len <= 0xFFu)
-        return 2;
-    if (len <= 0xFFFFu)
-        return 3;
-    if (len <= 0xFFFFFFu)
-        return 4;
-    if (len <= 0xFFFFFFFFu)
-        return 5;
-    else
-        return 0;
+    return ak_asn_core_len_byte_cnt(len);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -786,36 +676,7 @@ ak_uint8 new_asn_get_len_byte_cnt(size_t len)
     @return Кол-во байтов, необходимое для хранения закодированного идентификатора.                */
 /* ----------------------------------------------------------------------------------------------- */
 ak_uint8 new_asn_get_oid_byte_cnt(object_identifier oid) {
-    ak_uint8 byte_cnt;
-    object_identifier p_end;
-    size_t num;
-
-    if (!oid)
-        return 0;
-
-    byte_cnt = 1;
-
-    /* Пропускаем 2 первых идентификатора */
-    strtoul((char *) oid, &p_end, 10);
-    oid = ++p_end;
-    strtol((char *) oid, &p_end, 10);
-
-    while (*p_end != '\0')
-    {
-        oid = ++p_end;
-        num = (size_t) strtol((char *) oid, &p_end, 10);
-        if (num <= 0x7Fu)             /*                               0111 1111 -  7 бит */
-            byte_cnt += 1;
-        else if (num <= 0x3FFFu)      /*                     0011 1111 1111 1111 - 14 бит */
-            byte_cnt += 2;
-        else if (num <= 0x1FFFFFu)    /*           0001 1111 1111 1111 1111 1111 - 21 бит */
-            byte_cnt += 3;
-        else if (num <= 0x0FFFFFFFu)  /* 0000 1111 1111 1111 1111 1111 1111 1111 - 28 бит */
-            byte_cnt += 4;
-        else
-            return 0;
-    }
-    return byte_cnt;
+    return ak_asn_core_objid_byte_cnt(oid);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -823,13 +684,5 @@ ak_uint8 new_asn_get_oid_byte_cnt(object_identifier oid) {
     @return Кол-во байтов, необходимое для хранения закодированного времени.                       */
 /* ----------------------------------------------------------------------------------------------- */
 ak_uint8 new_asn_get_gentime_byte_cnt(generalized_time time) {
-    if (!time)
-        return 0;
-    /*
-     * 8 имеет след. смысл:
-     * - из строки "YYYY-MM-DD HH:MM:SS.[ms] UTC" удалить символы "-- :: UTC"
-     * - добавить символ "Z"
-     * Примечание: эл-ов ms может быть неограниченное кол-во.
-    */
-    return (ak_uint8) (strlen(time) - 8);
+    return ak_asn_core_gentime_byte_cnt(time);
 }
@@ -194,6 +194,8 @@ extern "C" {
  #define ak_error_terminal                    (-27)
 /*! \brief Использование неопределенного буффера. */
  #define ak_error_wrong_buffer                (-28)
+/*! \brief Ошибка тестирования криптографического алгоритма (контрольный пример не выполнен). */
+ #define ak_error_self_test                   (-29)
 
 /*! \brief Неверное значение дескриптора объекта. */
  #define ak_error_wrong_handle                (-30)
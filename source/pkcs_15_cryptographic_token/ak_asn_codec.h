@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <libakrypt.h>
 #include <pkcs_15_cryptographic_token/ak_pointer_server.h>
+#include <asn_processor/ak_asn_core.h>
 
 
 /*! \brief флаги, определяющие класс данных ASN.1. */
@@ -96,7 +97,7 @@ typedef struct s_asn_oct_str_type octet_string;
 int asn_get_tag(ak_byte *p_buff, tag *p_tag);
 
 /*! \brief Декодирование длины данных из DER последовательности. */
-int asn_get_len(ak_byte *pp_data, size_t *p_len, ak_uint8 *p_len_byte_cnt);
+int asn_get_len(ak_byte *pp_data, const ak_byte *p_end, size_t *p_len, ak_uint8 *p_len_byte_cnt);
 
 /*! \brief Декодирование целого числа из DER последовательности. */
 int asn_get_int(ak_byte *p_buff, size_t len, integer *p_val);
@@ -167,6 +168,12 @@ int asn_get_expected_tlv(tag expected_tag, s_ptr_server *p_curr_ps, void *p_resu
 /*! \brief Метод для определения кол-ва элементов в блоке данных DER последовательности. */
 int asn_get_num_of_elems_in_constructed_obj(s_ptr_server *p_data, ak_uint8 *p_num_of_elems);
 
+/*! \brief Метод для получения границ очередного блока TLV и перехода к следующему блоку. */
+int asn_get_next_tlv(s_ptr_server *p_curr_ps, tag *p_tag, s_ptr_server *p_tlv);
+
+/*! \brief Метод для пропуска очередного блока TLV. */
+int asn_skip_tlv(s_ptr_server *p_curr_ps);
+
 /*! \brief Метод для определения необходимого кол-ва памяти для хранения длины данных. */
 ak_uint8 asn_get_len_byte_cnt(size_t len);
 
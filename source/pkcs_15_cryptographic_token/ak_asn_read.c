@@ -43,36 +43,18 @@ int asn_get_tag(ak_byte *p_buff, tag *p_tag) {
     чем в 4 байтах.
 
     @param p_buff указатель на длину данных
+    @param p_end указатель на первый байт после блока данных, содержащего длину
     @param p_len указатель переменную, содержащую длинну блока данных
     @param p_len_byte_cnt указатель переменную, содержащую кол-во памяти (в байтах),
            необходимое для хранения длины блока данных в DER последовательности
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int asn_get_len(ak_byte *p_buff, size_t *p_len, uint8_t *p_len_byte_cnt) {
-    if (!p_buff || !p_len_byte_cnt)
+int asn_get_len(ak_byte *p_buff, const ak_byte *p_end, size_t *p_len, ak_uint8 *p_len_byte_cnt) {
+    if (!p_buff || !p_end || !p_len || !p_len_byte_cnt)
         return ak_error_null_pointer;
 
-    *p_len = 0;
-    *p_len_byte_cnt = 1;
-
-    if (*p_buff & 0x80u)
-    {
-        *p_len_byte_cnt = (uint8_t) ((*p_buff++) & 0x7Fu);
-        if (*p_len_byte_cnt > 4)
-            return ak_error_wrong_length;
-
-        for (uint8_t i = 0; i < *p_len_byte_cnt; i++)
-        {
-            *p_len = (*p_len << 8u) | (*p_buff);
-            p_buff++;
-        }
-        *p_len_byte_cnt += 1;
-    }
-    else
-        *p_len = *p_buff;
-
-    return ak_error_ok;
+    return ak_asn_core_get_len(p_buff, p_end, p_len, p_len_byte_cnt);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -210,45 +192,10 @@ int asn_get_vsblstr(ak_byte *p_buff, size_t len, visible_string *p_str) {
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int asn_get_objid(ak_byte *p_buff, size_t len, object_identifier *p_objid) {
-    uint32_t value;
-    size_t curr_size;
-    object_identifier obj_id;
-
     if (!p_buff || !p_objid)
         return ak_error_null_pointer;
 
-    if (((p_buff[0] / 40) > 2) || ((p_buff[0] % 40) > 32))
-        return ak_error_wrong_asn1_decode;
-
-    obj_id = (object_identifier) malloc(50);
-    if (!obj_id)
-        return ak_error_out_of_memory;
-
-    sprintf(obj_id, "%d.%d", p_buff[0] / 40, p_buff[0] % 40);
-
-    for (int i = 1; i < len; i++)
-    {
-        value = 0u;
-        while (p_buff[i] & 0x80u)
-        {
-            value ^= p_buff[i] & 0x7Fu;
-            value = value << 7u;
-            i++;
-        }
-
-        value += p_buff[i] & 0x7Fu;
-
-        if ((curr_size = strlen(obj_id)) >= 50)
-        {
-            free(obj_id);
-            return ak_error_wrong_asn1_decode;
-        }
-
-        sprintf(obj_id + curr_size, ".%u", value);
-    }
-
-    *p_objid = obj_id;
-    return ak_error_ok;
+    return ak_asn_core_get_objid(p_buff, len, p_objid);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -312,52 +259,10 @@ int asn_get_bool(ak_byte *p_buff, size_t len, boolean *p_value) {
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int asn_get_generalized_time(ak_byte *p_buff, size_t len, generalized_time *p_time) {
-    generalized_time date_time;
-
     if (!p_buff || !p_time)
         return ak_error_null_pointer;
 
-    if (len < 15 || toupper(p_buff[len - 1]) != 'Z')
-    {
-        *p_time = NULL;
-        return ak_error_wrong_asn1_decode;
-    }
-
-    /* Дополнительные 9 байтов для символов пробела, тире и т.д. */
-    date_time = (generalized_time) malloc(len + 9);
-    date_time[0] = '\0';
-
-    /* YYYY */
-    strncat(date_time, (char *) p_buff, 4);
-    strcat(date_time, "-");
-    p_buff += 4;
-
-    /* MM */
-    strncat(date_time, (char *) p_buff, 2);
-    strcat(date_time, "-");
-    p_buff += 2;
-
-    /* DD */
-    strncat(date_time, (char *) p_buff, 2);
-    strcat(date_time, " ");
-    p_buff += 2;
-
-    /* HH */
-    strncat(date_time, (char *) p_buff, 2);
-    strcat(date_time, ":");
-    p_buff += 2;
-
-    /* MM */
-    strncat(date_time, (char *) p_buff, 2);
-    strcat(date_time, ":");
-    p_buff += 2;
-
-    /* SS.mmm */
-    strncat(date_time, (char *) p_buff, len - 13); /* 13 = YYYY + MM + DD + HH + MM + 'Z' */
-    strcat(date_time, " UTC");
-
-    *p_time = date_time;
-    return ak_error_ok;
+    return ak_asn_core_get_gentime(p_buff, len, p_time);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -380,26 +285,27 @@ int asn_get_expected_tlv(tag expected_tag, s_ptr_server *p_curr_ps, void *p_resu
     int error;
     tag real_tag;
     size_t value_len;
-    uint8_t len_byte_cnt;
+    size_t header_len;
 
     if (!expected_tag || !p_curr_ps || !p_result)
         return ak_error_null_pointer;
 
     real_tag = 0;
     value_len = 0;
-    len_byte_cnt = 0;
+    header_len = 0;
 
-    if ((error = asn_get_tag(p_curr_ps->mp_curr, &real_tag)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problems with getting tag");
+    if (!ps_get_curr_size(p_curr_ps))
+        return ak_error_diff_tags;
 
-    if (expected_tag != real_tag)
+    /* Сравниваем тег до разбора длины, чтобы необязательные поля пропускались без лишних проверок */
+    if (expected_tag != *p_curr_ps->mp_curr)
         return ak_error_diff_tags;
 
-    if ((error = asn_get_len(p_curr_ps->mp_curr + 1, &value_len, &len_byte_cnt)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problems with getting data length");
+    /* Заголовок разбирается один раз вместе с проверкой выхода за границы блока данных */
+    if ((error = ak_asn_core_get_header(p_curr_ps->mp_curr, p_curr_ps->mp_end, &real_tag, &value_len, &header_len)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting tag and data length");
 
-    if ((error = ps_move_cursor(p_curr_ps, 1 + len_byte_cnt)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problems with moving cursor");
+    p_curr_ps->mp_curr += header_len;
 
     if (expected_tag == TOCTET_STRING)
     {
@@ -443,8 +349,7 @@ int asn_get_expected_tlv(tag expected_tag, s_ptr_server *p_curr_ps, void *p_resu
             return ak_error_message(error, __func__, "problems with setting pointer server");
     }
 
-    if ((error = ps_move_cursor(p_curr_ps, value_len)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problems with moving cursor");
+    p_curr_ps->mp_curr += value_len;
 
     return ak_error_ok;
 }
@@ -455,31 +360,78 @@ int asn_get_expected_tlv(tag expected_tag, s_ptr_server *p_curr_ps, void *p_resu
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int asn_get_num_of_elems_in_constructed_obj(s_ptr_server *p_data, uint8_t *p_num_of_elems) {
+int asn_get_num_of_elems_in_constructed_obj(s_ptr_server *p_data, ak_uint8 *p_num_of_elems) {
     int error;
-    size_t value_len;
-    uint8_t len_byte_cnt;
     s_ptr_server data_copy;
-    value_len = 0;
-    len_byte_cnt = 0;
+
+    if (!p_data || !p_num_of_elems)
+        return ak_error_null_pointer;
 
     data_copy = *p_data;
     *p_num_of_elems = 0;
 
     while (ps_get_curr_size(&data_copy))
     {
-        if ((error = asn_get_len(data_copy.mp_curr + 1, &value_len, &len_byte_cnt)) != ak_error_ok)
-            return ak_error_message(error, __func__, "problems with getting data length");
-
-        // смещаемся на расстояние равное длине блока tlv
-        if ((error = ps_move_cursor(&data_copy, 1 + len_byte_cnt + value_len)) != ak_error_ok)
-            return ak_error_message(error, __func__, "problems with moving cursor");
+        if ((error = asn_skip_tlv(&data_copy)) != ak_error_ok)
+            return ak_error_message(error, __func__, "problems with skipping tlv");
         *p_num_of_elems += 1;
     }
 
     return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция разбирает заголовок очередного блока TLV (с проверкой выхода за границы данных)
+    и помещает в объект p_tlv границы всего блока (тег, длина и данные) в режиме PS_U_MODE.
+    Указатель на текущую позицию в объекте p_curr_ps смещается на начало следующего блока.
+
+    @param p_curr_ps указатель на объект типа s_ptr_server, из которого считывается блок
+    @param p_tag указатель на переменную, в которую помещается тег блока (может быть равен NULL)
+    @param p_tlv указатель на объект типа s_ptr_server, в который помещаются границы блока
+           (может быть равен NULL)
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int asn_get_next_tlv(s_ptr_server *p_curr_ps, tag *p_tag, s_ptr_server *p_tlv) {
+    int error;
+    tag real_tag;
+    size_t value_len;
+    size_t header_len;
+
+    if (!p_curr_ps || !p_curr_ps->mp_curr)
+        return ak_error_null_pointer;
+
+    if (p_curr_ps->m_mode != PS_R_MODE)
+        return ak_error_wrong_ps_mode;
+
+    if ((error = ak_asn_core_get_header(p_curr_ps->mp_curr, p_curr_ps->mp_end, &real_tag, &value_len, &header_len)) != ak_error_ok)
+        return error;
+
+    if (p_tag)
+        *p_tag = real_tag;
+
+    if (p_tlv)
+    {
+        p_tlv->m_mode = PS_U_MODE;
+        p_tlv->mp_begin = p_curr_ps->mp_curr;
+        p_tlv->mp_end = p_curr_ps->mp_curr + header_len + value_len;
+        p_tlv->mp_curr = NULL;
+    }
+
+    p_curr_ps->mp_curr += header_len + value_len;
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_curr_ps указатель на объект типа s_ptr_server, в котором пропускается блок TLV
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int asn_skip_tlv(s_ptr_server *p_curr_ps) {
+    return asn_get_next_tlv(p_curr_ps, NULL, NULL);
+}
+
 void asn_free_int(integer *p_val) {
     if (p_val->mp_value)
     {
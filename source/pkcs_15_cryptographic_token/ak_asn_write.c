@@ -37,25 +37,16 @@ int asn_put_tag(tag tag, ak_byte *p_buff) {
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int asn_put_len(size_t len, ak_byte *p_buff) {
-    int8_t len_byte_cnt;
+    ak_uint8 len_byte_cnt;
 
     if (!p_buff)
         return ak_error_message(ak_error_null_pointer, __func__, "bad pointer to buffer");
 
-    len_byte_cnt = asn_get_len_byte_cnt(len);
+    len_byte_cnt = ak_asn_core_len_byte_cnt(len);
     if (!len_byte_cnt)
-        return ak_error_message(ak_error_null_pointer, __func__, "wrong length");
+        return ak_error_message(ak_error_wrong_length, __func__, "wrong length");
 
-    if (len_byte_cnt == 1)
-        *p_buff = (ak_byte) len;
-    else
-    {
-        *(p_buff++) = (ak_byte) (0x80u ^ (uint8_t) (--len_byte_cnt));
-        while (--len_byte_cnt >= 0)
-            *(p_buff++) = (ak_byte) ((len >> (8u * len_byte_cnt)) & 0xFFu);
-    }
-
-    return ak_error_ok;
+    return ak_asn_core_put_len(len, len_byte_cnt, p_buff);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -156,8 +147,7 @@ int asn_put_vsblstr(visible_string str, ak_byte *p_buff) {
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int asn_put_objid(object_identifier obj_id, ak_byte *p_buff) {
-    size_t num;
-    object_identifier p_objid_end;
+    int error;
 
     if (!p_buff)
         return ak_error_message(ak_error_null_pointer, __func__, "bad pointer to buffer");
@@ -165,32 +155,8 @@ int asn_put_objid(object_identifier obj_id, ak_byte *p_buff) {
     if (!obj_id)
         return ak_error_message(ak_error_null_pointer, __func__, "null value");
 
-    num = (size_t) strtoul((char *) obj_id, &p_objid_end, 10);
-    obj_id = ++p_objid_end;
-    num = num * 40 + (size_t) strtol((char *) obj_id, &p_objid_end, 10);
-    *(p_buff++) = (ak_byte) num;
-
-    while (*p_objid_end != '\0')
-    {
-        obj_id = ++p_objid_end;
-        num = (size_t) strtol((char *) obj_id, &p_objid_end, 10);
-
-        if (num > 0x7Fu)
-        {
-            ak_byte seven_bits;
-            int8_t i;
-            i = 3;
-            while (i > 0)
-            {
-                seven_bits = (ak_byte) ((num >> ((uint8_t) i * 7u)) & 0x7Fu);
-                if (seven_bits)
-                    *(p_buff++) = (ak_byte) (0x80u ^ seven_bits);
-                i--;
-            }
-        }
-
-        *(p_buff++) = (ak_byte) (num & 0x7Fu);
-    }
+    if ((error = ak_asn_core_put_objid(obj_id, p_buff)) != ak_error_ok)
+        return ak_error_message(error, __func__, "wrong format of object identifier");
 
     return ak_error_ok;
 }
@@ -242,7 +208,7 @@ int asn_put_bool(boolean val, ak_byte *p_buff) {
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int asn_put_generalized_time(generalized_time time, ak_byte *p_buff) {
-    int8_t byte_cnt;
+    int error;
 
     if (!p_buff)
         return ak_error_message(ak_error_null_pointer, __func__, "bad pointer to buffer");
@@ -250,85 +216,8 @@ int asn_put_generalized_time(generalized_time time, ak_byte *p_buff) {
     if (!time)
         return ak_error_message(ak_error_null_pointer, __func__, "bad pointer to time string");
 
-    byte_cnt = asn_get_gentime_byte_cnt(time);
-    if (byte_cnt < 15)
-        return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong length of time string");
-
-    /* YYYY */
-    for (uint8_t i = 0; i < 4; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of year value");
-        *(p_buff++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* MM */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of month value");
-        *(p_buff++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* DD */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of day value");
-        *(p_buff++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* HH */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of hour value");
-        *(p_buff++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* MM */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of minute value");
-        *(p_buff++) = (ak_byte) *(time++);
-    }
-    time++;
-
-    /* SS */
-    for (uint8_t i = 0; i < 2; i++)
-    {
-        if (!isdigit(*time))
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of second value");
-        *(p_buff++) = (ak_byte) *(time++);
-    }
-
-    /* .mmm */
-    if (*time == '.')
-    {
-        int8_t ms_cnt = (int8_t) ((strchr(time, ' ') - time) - 1);
-        if (ms_cnt == 0)
-            return ak_error_message(ak_error_wrong_asn1_encode, __func__, "quota of second absent");
-
-        if (time[ms_cnt] == '0')
-            return ak_error_message(ak_error_wrong_asn1_encode,
-                                    __func__,
-                                    "wrong format of quota of second value (it can't end by 0 symbol)");
-
-        *(p_buff++) = (ak_byte) *(time++); // помещаем символ точки
-        for (uint8_t i = 0; i < ms_cnt; i++)
-        {
-            if (!isdigit(*time))
-                return ak_error_message(ak_error_wrong_asn1_encode, __func__, "wrong format of quota of second value");
-            *(p_buff++) = (ak_byte) *(time++);
-        }
-    }
-
-    *p_buff = 'Z';
+    if ((error = ak_asn_core_put_gentime(time, p_buff)) != ak_error_ok)
+        return ak_error_message(error, __func__, "wrong format of time string");
 
     return ak_error_ok;
 }
@@ -349,7 +238,7 @@ int asn_put_generalized_time(generalized_time time, ak_byte *p_buff) {
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int asn_put_universal_tlv(uint8_t tag_number,
+int asn_put_universal_tlv(ak_uint8 tag_number,
                           void *p_data,
                           size_t seq_or_set_len,
                           s_ptr_server *p_main_ps,
@@ -518,10 +407,8 @@ int asn_put_universal_tlv(uint8_t tag_number,
             return ak_error_message(error, __func__, "problems with moving cursor");
     }
 
-    asn_put_tag(tag_number, p_main_ps->mp_curr);
-
-    if ((error = asn_put_len(value_len, p_main_ps->mp_curr + 1)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problem with adding data length");
+    if ((error = ak_asn_core_put_header(tag_number, value_len, p_main_ps->mp_curr, NULL)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with adding tag and data length");
 
     if ((error = ps_set(p_result, p_main_ps->mp_curr, 1 + len_byte_cnt + value_len, PS_U_MODE)) != ak_error_ok)
         return ak_error_message(error, __func__, "problems with making union of asn data");
@@ -534,18 +421,7 @@ int asn_put_universal_tlv(uint8_t tag_number,
     @return Кол-во байтов, необходимое для хранения закодированной длины.                          */
 /* ----------------------------------------------------------------------------------------------- */
 ak_uint8 asn_get_len_byte_cnt(size_t len) {
-    if (len < 0x80u && len >= 0)
-        return 1;
-    if (len <= 0xFFu)
-        return 2;
-    if (len <= 0xFFFFu)
-        return 3;
-    if (len <= 0xFFFFFFu)
-        return 4;
-    if (len <= 0xFFFFFFFFu)
-        return 5;
-    else
-        return 0;
+    return ak_asn_core_len_byte_cnt(len);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -553,36 +429,7 @@ ak_uint8 asn_get_len_byte_cnt(size_t len) {
     @return Кол-во байтов, необходимое для хранения закодированного идентификатора.                */
 /* ----------------------------------------------------------------------------------------------- */
 ak_uint8 asn_get_oid_byte_cnt(object_identifier oid) {
-    ak_uint8 byte_cnt;
-    object_identifier p_end;
-    size_t num;
-
-    if (!oid)
-        return 0;
-
-    byte_cnt = 1;
-
-    /* Пропускаем 2 первых идентификатора */
-    strtoul((char *) oid, &p_end, 10);
-    oid = ++p_end;
-    strtol((char *) oid, &p_end, 10);
-
-    while (*p_end != '\0')
-    {
-        oid = ++p_end;
-        num = (size_t) strtol((char *) oid, &p_end, 10);
-        if (num <= 0x7Fu)             /*                               0111 1111 -  7 бит */
-            byte_cnt += 1;
-        else if (num <= 0x3FFFu)      /*                     0011 1111 1111 1111 - 14 бит */
-            byte_cnt += 2;
-        else if (num <= 0x1FFFFFu)    /*           0001 1111 1111 1111 1111 1111 - 21 бит */
-            byte_cnt += 3;
-        else if (num <= 0x0FFFFFFFu)  /* 0000 1111 1111 1111 1111 1111 1111 1111 - 28 бит */
-            byte_cnt += 4;
-        else
-            return 0;
-    }
-    return byte_cnt;
+    return ak_asn_core_objid_byte_cnt(oid);
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -590,13 +437,5 @@ ak_uint8 asn_get_oid_byte_cnt(object_identifier oid) {
     @return Кол-во байтов, необходимое для хранения закодированного времени.                       */
 /* ----------------------------------------------------------------------------------------------- */
 ak_uint8 asn_get_gentime_byte_cnt(generalized_time time) {
-    if (!time)
-        return 0;
-    /*
-     * 8 имеет след. смысл:
-     * - из строки "YYYY-MM-DD HH:MM:SS.[ms] UTC" удалить символы "-- :: UTC"
-     * - добавить символ "Z"
-     * Примечание: эл-ов ms может быть неограниченное кол-во.
-    */
-    return (ak_uint8) (strlen(time) - 8);
+    return ak_asn_core_gentime_byte_cnt(time);
 }
@@ -154,7 +154,7 @@ int pkcs_15_put_common_key_attributes(s_der_buffer* p_pkcs_15_token_der, s_commo
     /* Добавляем дату окночания периода действия ключа */
     if (p_key_attrs->m_end_date)
     {
-        uint8_t end_date_len = (uint8_t) asn_get_gentime_byte_cnt(p_key_attrs->m_end_date);
+        ak_uint8 end_date_len = (ak_uint8) asn_get_gentime_byte_cnt(p_key_attrs->m_end_date);
         if ((error = ps_move_cursor(p_pkcs_15_token_der, end_date_len + asn_get_len_byte_cnt(end_date_len) + 1)) !=
                 ak_error_ok)
             return ak_error_message(error, __func__, "problems with moving cursor");
@@ -254,10 +254,10 @@ int pkcs_15_put_common_key_attributes(s_der_buffer* p_pkcs_15_token_der, s_commo
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int pkcs_15_put_recipient_infos(s_der_buffer* p_pkcs_15_token, s_recipient_info** pp_recipient_infos, uint8_t num_of_recipient_infos, s_der_buffer* p_recipient_infos_der)
+int pkcs_15_put_recipient_infos(s_der_buffer* p_pkcs_15_token, s_recipient_info** pp_recipient_infos, ak_uint8 num_of_recipient_infos, s_der_buffer* p_recipient_infos_der)
 {
     int error;
-    uint8_t recipient_infos_len;
+    ak_uint8 recipient_infos_len;
     s_der_buffer recipient_info;
 
     if (!p_pkcs_15_token || !pp_recipient_infos || !num_of_recipient_infos || !p_recipient_infos_der)
@@ -265,7 +265,7 @@ int pkcs_15_put_recipient_infos(s_der_buffer* p_pkcs_15_token, s_recipient_info*
 
     recipient_infos_len = 0;
 
-    for (uint8_t i = 0; i < num_of_recipient_infos; i++)
+    for (ak_uint8 i = 0; i < num_of_recipient_infos; i++)
     {
         if (!pp_recipient_infos[i])
             return ak_error_message(ak_error_null_pointer, __func__, "recipient info absent");
@@ -595,7 +595,7 @@ int pkcs_15_get_object_direct_protected(s_der_buffer* p_object_der, s_enveloped_
     int error;
     tag tag;
     size_t len;
-    uint8_t len_byte_cnt;
+    ak_uint8 len_byte_cnt;
     s_der_buffer enveloped_data_der;
 
     tag = 0;
@@ -623,7 +623,7 @@ int pkcs_15_get_object_direct_protected(s_der_buffer* p_object_der, s_enveloped_
     if (tag == (CONTEXT_SPECIFIC | CONSTRUCTED | 0u))
     {
         ak_error_message(ak_error_invalid_value, __func__, "getting originator does not realized yet");
-        if ((error = asn_get_len(enveloped_data_der.mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
+        if ((error = asn_get_len(enveloped_data_der.mp_curr + 1, enveloped_data_der.mp_end, &len, &len_byte_cnt)) != ak_error_ok)
             return ak_error_message(error, __func__, "problems with getting data length");
 
         if ((error = ps_move_cursor(&enveloped_data_der, len + len_byte_cnt)) != ak_error_ok)
@@ -641,7 +641,7 @@ int pkcs_15_get_object_direct_protected(s_der_buffer* p_object_der, s_enveloped_
     if (ps_get_curr_size(&enveloped_data_der))
     {
         ak_error_message(ak_error_invalid_value, __func__, "getting unprotected attributes doesn't realized yet");
-        if ((error = asn_get_len(enveloped_data_der.mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
+        if ((error = asn_get_len(enveloped_data_der.mp_curr + 1, enveloped_data_der.mp_end, &len, &len_byte_cnt)) != ak_error_ok)
             return ak_error_message(error, __func__, "problems with getting data length");
 
         if ((error = ps_move_cursor(&enveloped_data_der, len + len_byte_cnt)) != ak_error_ok)
@@ -794,7 +794,7 @@ int pkcs_15_get_common_key_attributes(s_der_buffer* p_object_der, s_common_key_a
 int pkcs_15_get_recipient_infos(s_der_buffer* p_enveloped_data_der, s_enveloped_data* p_enveloped_data)
 {
     int error;
-    uint8_t num_of_ri;
+    ak_uint8 num_of_ri;
     s_der_buffer recipient_infos_der;
 
     num_of_ri = 0;
@@ -812,7 +812,7 @@ int pkcs_15_get_recipient_infos(s_der_buffer* p_enveloped_data_der, s_enveloped_
     if (!p_enveloped_data->mpp_recipient_infos)
         return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
 
-    for (uint8_t i = 0; i < num_of_ri; i++)
+    for (ak_uint8 i = 0; i < num_of_ri; i++)
     {
         p_enveloped_data->mpp_recipient_infos[i] = malloc(sizeof(s_recipient_info));
         if (!p_enveloped_data->mpp_recipient_infos[i])
@@ -840,7 +840,7 @@ int pkcs_15_get_sngl_recipient_info(s_der_buffer* p_recipient_infos_der, s_recip
     int error;
     tag tag;
     size_t len;
-    uint8_t len_byte_cnt;
+    ak_uint8 len_byte_cnt;
 
     tag = 0;
     len = 0;
@@ -855,7 +855,7 @@ int pkcs_15_get_sngl_recipient_info(s_der_buffer* p_recipient_infos_der, s_recip
     {
     case (CONTEXT_SPECIFIC | CONSTRUCTED | PWRI):
         ak_error_message(ak_error_invalid_value, __func__, "getting password recipient info does not realized yet");
-        if ((error = asn_get_len(p_recipient_infos_der->mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
+        if ((error = asn_get_len(p_recipient_infos_der->mp_curr + 1, p_recipient_infos_der->mp_end, &len, &len_byte_cnt)) != ak_error_ok)
             return ak_error_message(error, __func__, "problems with getting data length");
 
         if ((error = ps_move_cursor(p_recipient_infos_der, len + len_byte_cnt)) != ak_error_ok)
@@ -863,7 +863,7 @@ int pkcs_15_get_sngl_recipient_info(s_der_buffer* p_recipient_infos_der, s_recip
 
         break;
     case (CONTEXT_SPECIFIC | CONSTRUCTED | KEKRI):p_sngl_recipient_info->m_type = KEKRI;
-        p_sngl_recipient_info->m_ri.mp_kekri = malloc(sizeof(s_kekri));
+        p_sngl_recipient_info->m_ri.mp_kekri = calloc(1, sizeof(s_kekri));
         if (!p_sngl_recipient_info->m_ri.mp_kekri)
             return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
 
@@ -937,7 +937,7 @@ int pkcs_15_get_key_encryption_algorithm(s_der_buffer* p_kekri_der, s_kekri* p_k
 {
     int error;
     size_t len;
-    uint8_t len_byte_cnt;
+    ak_uint8 len_byte_cnt;
     s_der_buffer key_enc_ald_der;
     s_der_buffer prms_der;
 
@@ -961,7 +961,7 @@ int pkcs_15_get_key_encryption_algorithm(s_der_buffer* p_kekri_der, s_kekri* p_k
         /* Считываем параметры алгоритма шифрования ключа CEK */
         if (ps_get_curr_size(&key_enc_ald_der))
         {
-            s_gost28147_89_key_wrap_prms* p_key_wrap_prms = malloc(sizeof(s_gost28147_89_key_wrap_prms));
+            s_gost28147_89_key_wrap_prms* p_key_wrap_prms = calloc(1, sizeof(s_gost28147_89_key_wrap_prms));
             if (!p_key_wrap_prms)
                 return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
 
@@ -989,7 +989,7 @@ int pkcs_15_get_key_encryption_algorithm(s_der_buffer* p_kekri_der, s_kekri* p_k
     else
     {
         ak_error_message(ak_error_invalid_value, __func__, "this algorithm doesn't support");
-        if ((error = asn_get_len(key_enc_ald_der.mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
+        if ((error = asn_get_len(key_enc_ald_der.mp_curr + 1, key_enc_ald_der.mp_end, &len, &len_byte_cnt)) != ak_error_ok)
             return ak_error_message(error, __func__, "problems with getting data length");
 
         if ((error = ps_move_cursor(&key_enc_ald_der, len + len_byte_cnt)) != ak_error_ok)
@@ -1062,7 +1062,7 @@ int pkcs_15_get_content_encryption_algorithm(s_der_buffer* p_encrypted_content_i
 {
     int error;
     size_t len;
-    uint8_t len_byte_cnt;
+    ak_uint8 len_byte_cnt;
     s_der_buffer content_enc_alg_der;
     s_der_buffer prms_der;
 
@@ -1112,7 +1112,7 @@ int pkcs_15_get_content_encryption_algorithm(s_der_buffer* p_encrypted_content_i
     else
     {
         ak_error_message(ak_error_invalid_value, __func__, "this algorithm doesn't support");
-        if ((error = asn_get_len(content_enc_alg_der.mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
+        if ((error = asn_get_len(content_enc_alg_der.mp_curr + 1, content_enc_alg_der.mp_end, &len, &len_byte_cnt)) != ak_error_ok)
             return ak_error_message(error, __func__, "problems with getting data length");
 
         if ((error = ps_move_cursor(&content_enc_alg_der, len + len_byte_cnt)) != ak_error_ok)
@@ -1145,18 +1145,25 @@ void pkcs_15_free_enveloped_data(s_enveloped_data* p_ed)
 
         switch (p_ed->m_prm_set_type)
         {
-        case GOST_CONTENT_ENC_SET:asn_free_objid(&p_ed->m_prm_set.p_content_enc_prm_set->m_encryption_param_set);
-            asn_free_octetstr(&p_ed->m_prm_set.p_content_enc_prm_set->m_iv);
+        case GOST_CONTENT_ENC_SET:
+            if (p_ed->m_prm_set.p_content_enc_prm_set)
+            {
+                asn_free_objid(&p_ed->m_prm_set.p_content_enc_prm_set->m_encryption_param_set);
+                asn_free_octetstr(&p_ed->m_prm_set.p_content_enc_prm_set->m_iv);
+                free(p_ed->m_prm_set.p_content_enc_prm_set);
+                p_ed->m_prm_set.p_content_enc_prm_set = NULL;
+            }
             break;
         default:break;
         }
 
         asn_free_objid(&p_ed->m_content_type);
-        if (!p_ed->mpp_recipient_infos)
+        if (p_ed->mpp_recipient_infos)
         {
             for (i = 0; i < p_ed->m_ri_size; i++)
             {
                 pkcs_15_free_recipient_info(p_ed->mpp_recipient_infos[i]);
+                free(p_ed->mpp_recipient_infos[i]);
                 p_ed->mpp_recipient_infos[i] = NULL;
             }
             free(p_ed->mpp_recipient_infos);
@@ -1172,7 +1179,9 @@ void pkcs_15_free_recipient_info(s_recipient_info* p_ri)
         switch (p_ri->m_type)
         {
         case KEKRI:pkcs_15_free_kekri(p_ri->m_ri.mp_kekri);
+            free(p_ri->m_ri.mp_kekri);
             p_ri->m_ri.mp_kekri = NULL;
+            break;
         default:break;
         }
     }
@@ -1185,12 +1194,19 @@ void pkcs_15_free_kekri(s_kekri* p_kekri)
         asn_free_int(&p_kekri->m_version);
         switch (p_kekri->m_prm_set_type)
         {
-        case GOST_KEY_WRAP_SET:asn_free_octetstr(&p_kekri->m_prm_set.p_key_wrap_set->m_ukm);
-            asn_free_objid(&p_kekri->m_prm_set.p_key_wrap_set->m_enc_prm_set);
+        case GOST_KEY_WRAP_SET:
+            if (p_kekri->m_prm_set.p_key_wrap_set)
+            {
+                asn_free_octetstr(&p_kekri->m_prm_set.p_key_wrap_set->m_ukm);
+                asn_free_objid(&p_kekri->m_prm_set.p_key_wrap_set->m_enc_prm_set);
+                free(p_kekri->m_prm_set.p_key_wrap_set);
+                p_kekri->m_prm_set.p_key_wrap_set = NULL;
+            }
             break;
         default:break;
         }
 
+        asn_free_objid(&p_kekri->m_key_enc_alg_id);
         asn_free_octetstr(&p_kekri->m_encrypted_key);
         asn_free_octetstr(&p_kekri->m_key_identifire);
         asn_free_generalized_time(&p_kekri->m_date);
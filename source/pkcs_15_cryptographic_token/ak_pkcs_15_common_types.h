@@ -26,7 +26,7 @@ typedef enum {
     NON_REPUDIATION = 0x0040u
 } en_usage_bits;
 
-typedef ushort key_usage_flags_t;
+typedef unsigned short key_usage_flags_t;
 
 /*! \brief Структура, хранящая общие атрибуты объекта PKCS 15 Object. */
 typedef struct {
@@ -104,7 +104,7 @@ typedef struct {
     /*! \brief массив указателей на данные о получателях ключа */
     s_recipient_info **mpp_recipient_infos;
     /*! \brief количество получателей ключа */
-    uint8_t m_ri_size;
+    ak_uint8 m_ri_size;
     /*! \brief идентификатор зашифрованного содержимого */
     object_identifier m_content_type;
     /*! \brief идентификатор алгоритма шифрования содержимого */
@@ -143,7 +143,7 @@ int pkcs_15_put_common_key_attributes(s_der_buffer *p_pkcs_15_token_der,
 /*! \brief Добавление информации о получателях данных в DER последовательность. */
 int pkcs_15_put_recipient_infos(s_der_buffer *p_pkcs_15_token,
                                 s_recipient_info **pp_recipient_infos,
-                                uint8_t num_of_recipient_infos,
+                                ak_uint8 num_of_recipient_infos,
                                 s_der_buffer *p_recipient_infos_der);
 
 /*! \brief Добавление информации о конкретном получателе данных в DER последовательность. */
@@ -385,6 +385,52 @@ int pkcs_15_get_gost_key(s_der_buffer *p_object_der, s_gost_sec_key *p_key) {
     return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция декодирует только идентификатор алгоритма и общие атрибуты объекта и ключа
+    (CommonObjectAttributes и CommonKeyAttributes). Атрибуты секретного ключа, в том числе
+    зашифрованное значение ключа, не разбираются: блок ключа целиком пропускается в
+    DER последовательности p_object_der.
+
+    @param p_object_der указатель на объект, содержащий DER последовательность
+    @param p_key указатель на секретный ключ
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_get_gost_key_common_attrs(s_der_buffer *p_object_der, s_gost_sec_key *p_key) {
+    int error;
+    s_der_buffer gost_key_der;
+    s_der_buffer key_attrs;
+
+    if (!p_object_der || !p_key)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    error = ak_error_ok;
+    memset(&gost_key_der, 0, sizeof(gost_key_der));
+    memset(&key_attrs, 0, sizeof(key_attrs));
+
+    if ((error = asn_get_expected_tlv(CONTEXT_SPECIFIC | CONSTRUCTED | 27u, p_object_der, (void *) &gost_key_der))
+        != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting gost key in der");
+
+    /* Декодируем идентификатор алгоритма, для которого предназначен ключ */
+    if ((error = asn_get_expected_tlv(TOBJECT_IDENTIFIER, &gost_key_der, (void *) &p_key->m_key_type_gost))
+        != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting gost key type");
+
+    if ((error = asn_get_expected_tlv(CONSTRUCTED | TSEQUENCE, &gost_key_der, (void *) &key_attrs)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting gost key attributes in der");
+
+    /* Декодируем общие атрибуты объекта PKCS 15 */
+    if ((error = pkcs_15_get_common_object_attributes(&key_attrs, &p_key->m_obj_attrs)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting common object attributes");
+
+    /* Декодируем общие атрибуты ключа */
+    if ((error = pkcs_15_get_common_key_attributes(&key_attrs, &p_key->m_key_attrs)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting common key attributes");
+
+    return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param p_key_der указатель на объект, содержащий DER последовательность
     @param p_key указатель на секретный ключ
@@ -596,15 +642,18 @@ int pkcs_15_make_gost_key_value_mask(ak_buffer masked_key, ak_buffer mask, ssize
         kvm_der.mp_curr[counter_var_size - i - 1] = (ak_byte) ((counter >> (i * 8u)) & 0xFFu);
     }
 
-    if ((error = ps_move_cursor(&kvm_der, masked_key->size)) != ak_error_ok)
+    /* Последовательность заполняется справа налево, поэтому маска записывается раньше
+       замаскированного значения ключа: в итоге порядок полей совпадает с порядком,
+       ожидаемым функцией pkcs_15_parse_gost_key_value_mask() */
+    if ((error = ps_move_cursor(&kvm_der, mask->size)) != ak_error_ok)
         return ak_error_message(error, __func__, "problems with moving cursor");
 
-    memcpy(kvm_der.mp_curr, masked_key->data, masked_key->size);
+    memcpy(kvm_der.mp_curr, mask->data, mask->size);
 
-    if ((error = ps_move_cursor(&kvm_der, mask->size)) != ak_error_ok)
+    if ((error = ps_move_cursor(&kvm_der, masked_key->size)) != ak_error_ok)
         return ak_error_message(error, __func__, "problems with moving cursor");
 
-    memcpy(kvm_der.mp_curr, mask->data, mask->size);
+    memcpy(kvm_der.mp_curr, masked_key->data, masked_key->size);
 
     if ((error = ps_move_cursor(&kvm_der, 1 + len_byte_cnt)) != ak_error_ok)
         return ak_error_message(error, __func__, "problems with moving cursor");
@@ -676,12 +725,12 @@ int pkcs_15_make_enc_key_plus_mac_seq(ak_buffer encrypted_cek, ak_buffer mac, ak
 /* ----------------------------------------------------------------------------------------------- */
 int pkcs_15_parse_gost_key_value_mask(ak_buffer gost_kvm_der, ak_buffer masked_key, ak_buffer mask, ssize_t *counter) {
     int error;
-    uint8_t i;
+    ak_uint8 i;
     ak_byte *p_curr_pos;
     tag curr_tag;
     size_t data_len;
-    uint8_t len_byte_cnt;
-    uint8_t counter_var_size;
+    ak_uint8 len_byte_cnt;
+    ak_uint8 counter_var_size;
     size_t key_len;
 
     counter_var_size = 4;
@@ -691,9 +740,11 @@ int pkcs_15_parse_gost_key_value_mask(ak_buffer gost_kvm_der, ak_buffer masked_k
         return ak_error_invalid_value;
 
     ++p_curr_pos;
-    if ((error = asn_get_len(p_curr_pos, &data_len, &len_byte_cnt)) != ak_error_ok)
+    if ((error = asn_get_len(p_curr_pos, (ak_byte *) gost_kvm_der->data + gost_kvm_der->size, &data_len, &len_byte_cnt)) != ak_error_ok)
         return ak_error_message(error, __func__, "problem with getting data length");
     p_curr_pos += len_byte_cnt;
+    if (data_len < counter_var_size)
+        return ak_error_message(ak_error_wrong_length, __func__, "wrong length of masked key value");
 
     key_len = (data_len - counter_var_size) / 2;
 
@@ -726,27 +777,31 @@ int pkcs_15_parse_gost_key_value_mask(ak_buffer gost_kvm_der, ak_buffer masked_k
 int pkcs_15_parse_enc_key_plus_mac_seq(octet_string encrypted_key_der, ak_buffer p_encrypted_cek, ak_buffer p_mac) {
     int error;
     ak_byte *p_curr_pos;
+    const ak_byte *p_end;
     tag curr_tag;
     size_t data_len;
-    uint8_t len_byte_cnt;
+    ak_uint8 len_byte_cnt;
 
     p_curr_pos = encrypted_key_der.mp_value;
+    p_end = encrypted_key_der.mp_value + encrypted_key_der.m_val_len;
     asn_get_tag(p_curr_pos, &curr_tag);
     if (curr_tag != (CONSTRUCTED | TSEQUENCE))
         return ak_error_invalid_value;
 
     ++p_curr_pos;
-    if ((error = asn_get_len(p_curr_pos, &data_len, &len_byte_cnt)) != ak_error_ok)
+    if ((error = asn_get_len(p_curr_pos, p_end, &data_len, &len_byte_cnt)) != ak_error_ok)
         return ak_error_message(error, __func__, "problem with getting data length");
     p_curr_pos += len_byte_cnt;
 
     /* Декодируем значение ключа и маски */
+    if (p_curr_pos >= p_end)
+        return ak_error_wrong_length;
     asn_get_tag(p_curr_pos, &curr_tag);
     if (curr_tag != (TOCTET_STRING))
         return ak_error_invalid_value;
 
     ++p_curr_pos;
-    if ((error = asn_get_len(p_curr_pos, &data_len, &len_byte_cnt)) != ak_error_ok)
+    if ((error = asn_get_len(p_curr_pos, p_end, &data_len, &len_byte_cnt)) != ak_error_ok)
         return ak_error_message(error, __func__, "problem with getting data length");
     p_curr_pos += len_byte_cnt;
 
@@ -757,12 +812,14 @@ int pkcs_15_parse_enc_key_plus_mac_seq(octet_string encrypted_key_der, ak_buffer
 
 
     /* Декодируем значение MAC */
+    if (p_curr_pos >= p_end)
+        return ak_error_wrong_length;
     asn_get_tag(p_curr_pos, &curr_tag);
     if (curr_tag != (TOCTET_STRING))
         return ak_error_invalid_value;
 
     ++p_curr_pos;
-    if ((error = asn_get_len(p_curr_pos, &data_len, &len_byte_cnt)) != ak_error_ok)
+    if ((error = asn_get_len(p_curr_pos, p_end, &data_len, &len_byte_cnt)) != ak_error_ok)
         return ak_error_message(error, __func__, "problem with getting data length");
     p_curr_pos += len_byte_cnt;
 
@@ -63,6 +63,9 @@ int pkcs_15_make_enc_key_plus_mac_seq(ak_buffer encrypted_cek, ak_buffer mac, ak
 /*! \brief Декодирование секретного ключа из DER последовательности. */
 int pkcs_15_get_gost_key(s_der_buffer *p_object_der, s_gost_sec_key *p_key);
 
+/*! \brief Декодирование только общих атрибутов объекта и ключа (без зашифрованного значения ключа). */
+int pkcs_15_get_gost_key_common_attrs(s_der_buffer *p_object_der, s_gost_sec_key *p_key);
+
 /*! \brief Декодирование всех атрибутов секретного ключа из DER последовательности. */
 int pkcs_15_get_key_attr(s_der_buffer *p_key_der, s_gost_sec_key *p_key);
 
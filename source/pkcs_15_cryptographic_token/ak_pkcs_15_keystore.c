@@ -0,0 +1,898 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Файл ak_pkcs_15_keystore.c                                                                     */
+/*  - содержит реализацию хранилища, объединяющего множество контейнеров PKCS 15 в одном каталоге. */
+/*                                                                                                 */
+/*  Индексный файл хранилища имеет следующий формат (все целые числа - 32 бита, little-endian):    */
+/*   - заголовок: сигнатура "AKKI", версия, количество записей count, размер области строк;        */
+/*   - count записей, упорядоченных по идентификатору ключа: смещение и длина идентификатора,      */
+/*     смещения имени файла, названия и идентификатора алгоритма в области строк, смещение         */
+/*     объекта в контейнере;                                                                       */
+/*   - count номеров записей, упорядоченных по названию ключа;                                     */
+/*   - область строк и идентификаторов.                                                            */
+/*  Такой формат позволяет использовать отображенный в память файл без какого-либо разбора и       */
+/*  выполнять поиск по идентификатору и по названию ключа двоичным поиском.                        */
+/* ----------------------------------------------------------------------------------------------- */
+
+/* эти объявления нужны для использования функций fsync(), mmap(), mkstemp() и flock() */
+#ifdef __linux__
+ #ifndef _POSIX_C_SOURCE
+   #define _POSIX_C_SOURCE 200112L
+ #endif
+ #ifndef _DEFAULT_SOURCE
+   #define _DEFAULT_SOURCE
+ #endif
+#endif
+
+#ifdef LIBAKRYPT_HAVE_STDLIB_H
+#include <stdlib.h>
+#else
+#error Library cannot be compiled without stdlib.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_STRING_H
+#include <string.h>
+#else
+#error Library cannot be compiled without string.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_STDIO_H
+#include <stdio.h>
+#else
+#error Library cannot be compiled without stdio.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef LIBAKRYPT_HAVE_SYSMMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef LIBAKRYPT_HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef LIBAKRYPT_HAVE_SYSFILE_H
+#include <sys/file.h>
+#endif
+
+#include <ak_tools.h>
+#include <pkcs_15_cryptographic_token/ak_pkcs_15_keystore.h>
+
+/*! \brief Версия формата индексного файла. */
+#define KEYSTORE_INDEX_VERSION 1u
+/*! \brief Размер заголовка индексного файла. */
+#define KEYSTORE_HEADER_SIZE 16u
+/*! \brief Размер одной записи индексного файла. */
+#define KEYSTORE_RECORD_SIZE 24u
+
+/*! \brief Струкртура, хранящая запись индекса в процессе его построения. */
+struct keystore_record {
+    const ak_byte *id;
+    size_t id_size;
+    const char *file;
+    const char *label;
+    const char *algorithm;
+    size_t offset;
+};
+
+/* ----------------------------------------------------------------------------------------------- */
+static void keystore_put_u32(ak_byte *p_buff, ak_uint32 val) {
+    p_buff[0] = (ak_byte) (val & 0xFFu);
+    p_buff[1] = (ak_byte) ((val >> 8) & 0xFFu);
+    p_buff[2] = (ak_byte) ((val >> 16) & 0xFFu);
+    p_buff[3] = (ak_byte) ((val >> 24) & 0xFFu);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+static ak_uint32 keystore_get_u32(const ak_byte *p_buff) {
+    return (ak_uint32) p_buff[0] | ((ak_uint32) p_buff[1] << 8) | ((ak_uint32) p_buff[2] << 16) | ((ak_uint32) p_buff[3] << 24);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_compare_ids(const ak_byte *p_id_a, size_t size_a, const ak_byte *p_id_b, size_t size_b) {
+    int res = memcmp(p_id_a, p_id_b, size_a < size_b ? size_a : size_b);
+
+    if (res)
+        return res;
+    return (size_a > size_b) - (size_a < size_b);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_compare_records_by_id(const void *p_a, const void *p_b) {
+    const struct keystore_record *p_rec_a = (const struct keystore_record *) p_a;
+    const struct keystore_record *p_rec_b = (const struct keystore_record *) p_b;
+
+    return keystore_compare_ids(p_rec_a->id, p_rec_a->id_size, p_rec_b->id, p_rec_b->id_size);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_compare_records_by_label(const void *p_a, const void *p_b) {
+    const struct keystore_record *p_rec_a = *(const struct keystore_record * const *) p_a;
+    const struct keystore_record *p_rec_b = *(const struct keystore_record * const *) p_b;
+    int res = strcmp(p_rec_a->label, p_rec_b->label);
+
+    /* При совпадении названий сохраняем порядок идентификаторов, чтобы индекс был однозначным */
+    if (res)
+        return res;
+    return (p_rec_a > p_rec_b) - (p_rec_a < p_rec_b);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_ks указатель на хранилище
+    @param name имя файла в каталоге хранилища
+    @return Функция возвращает указатель на строку с полным путем к файлу или NULL в случае ошибки.
+    Память должна быть освобождена функцией free().                                                */
+/* ----------------------------------------------------------------------------------------------- */
+static char *keystore_make_path(struct keystore *p_ks, const char *name) {
+    char *p_path;
+    size_t len = strlen(p_ks->path) + strlen(name) + 2;
+
+    if ((p_path = malloc(len)) == NULL)
+        return NULL;
+    sprintf(p_path, "%s/%s", p_ks->path, name);
+
+    return p_path;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_path путь к файлу
+    @param pp_data указатель на указатель на содержимое файла
+    @param p_size размер файла в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_read_file(const char *p_path, ak_byte **pp_data, size_t *p_size) {
+    int error;
+    struct file file;
+    size_t done;
+    ssize_t len;
+
+    if ((error = ak_file_open_to_read(&file, p_path)) != ak_error_ok)
+        return error;
+
+    *p_size = (size_t) file.size;
+    if ((*pp_data = malloc(*p_size ? *p_size : 1)) == NULL)
+    {
+        ak_file_close(&file);
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    }
+
+    for (done = 0; done < *p_size; done += (size_t) len)
+    {
+        if ((len = ak_file_read(&file, *pp_data + done, *p_size - done)) <= 0)
+        {
+            free(*pp_data);
+            *pp_data = NULL;
+            ak_file_close(&file);
+            return ak_error_message_fmt(ak_error_read_data, __func__, "wrong reading a file %s", p_path);
+        }
+    }
+    ak_file_close(&file);
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Данные записываются во временный файл, который затем переименовывается. Поэтому при сбое
+    в процессе записи файл с заданным именем либо остается прежним, либо полностью обновляется.
+    Имя временного файла уникально (создается функцией mkstemp()) и начинается с точки, поэтому
+    не совпадает ни с временными файлами других записывающих процессов, ни с именами контейнеров.
+
+    @param p_path путь к файлу
+    @param p_data указатель на записываемые данные
+    @param size размер данных в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_write_file_atomic(const char *p_path, const ak_byte *p_data, size_t size) {
+    struct file file;
+    char *p_tmp_path;
+    size_t done;
+    ssize_t len;
+#ifdef LIBAKRYPT_HAVE_WINDOWS_H
+    int error;
+
+    if ((p_tmp_path = malloc(strlen(p_path) + 5)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    sprintf(p_tmp_path, "%s.tmp", p_path);
+
+    if ((error = ak_file_create_to_write(&file, p_tmp_path)) != ak_error_ok)
+    {
+        free(p_tmp_path);
+        return error;
+    }
+#else
+    const char *p_name = strrchr(p_path, '/');
+    size_t dir_len = p_name ? (size_t) (p_name - p_path) + 1 : 0;
+
+    /* Временный файл "<каталог>/.<имя>.XXXXXX" создается в том же каталоге */
+    p_name = p_path + dir_len;
+    if ((p_tmp_path = malloc(strlen(p_path) + 9)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    memcpy(p_tmp_path, p_path, dir_len);
+    sprintf(p_tmp_path + dir_len, ".%s.XXXXXX", p_name);
+
+    memset(&file, 0, sizeof(struct file));
+    if ((file.fd = mkstemp(p_tmp_path)) < 0)
+    {
+        free(p_tmp_path);
+        return ak_error_message_fmt(ak_error_create_file, __func__, "wrong creation of temporary file for %s", p_path);
+    }
+#endif
+
+    for (done = 0; done < size; done += (size_t) len)
+    {
+        if ((len = ak_file_write(&file, p_data + done, size - done)) <= 0)
+        {
+            ak_file_close(&file);
+            remove(p_tmp_path);
+            free(p_tmp_path);
+            return ak_error_message_fmt(ak_error_write_data, __func__, "wrong writing a file %s", p_path);
+        }
+    }
+
+#if defined(LIBAKRYPT_HAVE_UNISTD_H) && !defined(LIBAKRYPT_HAVE_WINDOWS_H)
+    /* Данные должны оказаться на диске до того, как файл заменит прежний */
+    fsync(file.fd);
+#endif
+    ak_file_close(&file);
+
+#ifdef LIBAKRYPT_HAVE_WINDOWS_H
+    remove(p_path);
+#endif
+    if (rename(p_tmp_path, p_path) != 0)
+    {
+        remove(p_tmp_path);
+        free(p_tmp_path);
+        return ak_error_message_fmt(ak_error_write_data, __func__, "wrong renaming a file %s", p_path);
+    }
+    free(p_tmp_path);
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет, что все смещения индекса указывают внутрь файла, а строки завершаются нулем.
+    После успешной проверки к индексу можно обращаться без дополнительных проверок.
+
+    @param p_index указатель на содержимое индексного файла
+    @param size размер индексного файла
+    @param p_count указатель на переменную, в которую записывается количество записей
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_check_index(const ak_byte *p_index, size_t size, ak_uint32 *p_count) {
+    ak_uint32 i, j;
+    ak_uint32 count, pool_size;
+    const ak_byte *p_rec;
+    const ak_byte *p_pool;
+
+    if (size < KEYSTORE_HEADER_SIZE || memcmp(p_index, "AKKI", 4) != 0
+        || keystore_get_u32(p_index + 4) != KEYSTORE_INDEX_VERSION)
+        return ak_error_message(ak_error_invalid_value, __func__, "wrong keystore index header");
+
+    count = keystore_get_u32(p_index + 8);
+    pool_size = keystore_get_u32(p_index + 12);
+    if ((size - KEYSTORE_HEADER_SIZE) / (KEYSTORE_RECORD_SIZE + 4) < count
+        || size != KEYSTORE_HEADER_SIZE + (size_t) count * (KEYSTORE_RECORD_SIZE + 4) + pool_size)
+        return ak_error_message(ak_error_wrong_length, __func__, "wrong keystore index length");
+
+    p_pool = p_index + KEYSTORE_HEADER_SIZE + (size_t) count * (KEYSTORE_RECORD_SIZE + 4);
+    for (i = 0; i < count; i++)
+    {
+        p_rec = p_index + KEYSTORE_HEADER_SIZE + (size_t) i * KEYSTORE_RECORD_SIZE;
+        if (keystore_get_u32(p_rec) > pool_size || keystore_get_u32(p_rec + 4) > pool_size - keystore_get_u32(p_rec))
+            return ak_error_message(ak_error_wrong_length, __func__, "wrong key id in keystore index");
+
+        for (j = 8; j < 20; j += 4)
+        {
+            ak_uint32 str_off = keystore_get_u32(p_rec + j);
+            if (str_off >= pool_size || !memchr(p_pool + str_off, 0, pool_size - str_off))
+                return ak_error_message(ak_error_wrong_length, __func__, "wrong string in keystore index");
+        }
+
+        if (keystore_get_u32(p_index + KEYSTORE_HEADER_SIZE + (size_t) count * KEYSTORE_RECORD_SIZE + (size_t) i * 4) >= count)
+            return ak_error_message(ak_error_wrong_length, __func__, "wrong label table in keystore index");
+    }
+
+    *p_count = count;
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_ks указатель на хранилище
+    @param i номер записи индекса
+    @param p_entry указатель на структуру, в которую записывается запись индекса                   */
+/* ----------------------------------------------------------------------------------------------- */
+static void keystore_get_entry(struct keystore *p_ks, ak_uint32 i, struct keystore_entry *p_entry) {
+    const ak_byte *p_rec = p_ks->p_index + KEYSTORE_HEADER_SIZE + (size_t) i * KEYSTORE_RECORD_SIZE;
+    const ak_byte *p_pool = p_ks->p_index + KEYSTORE_HEADER_SIZE + (size_t) p_ks->count * (KEYSTORE_RECORD_SIZE + 4);
+
+    p_entry->id = p_pool + keystore_get_u32(p_rec);
+    p_entry->id_size = keystore_get_u32(p_rec + 4);
+    p_entry->file = (const char *) p_pool + keystore_get_u32(p_rec + 8);
+    p_entry->label = (const char *) p_pool + keystore_get_u32(p_rec + 12);
+    p_entry->algorithm = (const char *) p_pool + keystore_get_u32(p_rec + 16);
+    p_entry->offset = keystore_get_u32(p_rec + 20);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_ks указатель на хранилище                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+static void keystore_unload_index(struct keystore *p_ks) {
+    if (p_ks->p_index)
+    {
+#ifdef LIBAKRYPT_HAVE_SYSMMAN_H
+        if (p_ks->mapped)
+            munmap(p_ks->p_index, p_ks->index_size);
+        else
+#endif
+            free(p_ks->p_index);
+    }
+    p_ks->p_index = NULL;
+    p_ks->index_size = 0;
+    p_ks->count = 0;
+    p_ks->mapped = ak_false;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Индексный файл отображается в память, если это поддерживается операционной системой;
+    в противном случае он целиком считывается в буфер. Отсутствие индексного файла означает
+    пустое хранилище.
+
+    @param p_ks указатель на хранилище
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_load_index(struct keystore *p_ks) {
+    int error;
+    char *p_path;
+    struct file file;
+
+    keystore_unload_index(p_ks);
+    if ((p_path = keystore_make_path(p_ks, PKCS_15_KEYSTORE_INDEX_NAME)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+
+    if (ak_file_open_to_read(&file, p_path) != ak_error_ok)
+    {
+        /* Индекс еще не создан */
+        free(p_path);
+        ak_error_set_value(ak_error_ok);
+        return ak_error_ok;
+    }
+    p_ks->index_size = (size_t) file.size;
+
+#ifdef LIBAKRYPT_HAVE_SYSMMAN_H
+    if (p_ks->index_size)
+    {
+        void *p_map = mmap(NULL, p_ks->index_size, PROT_READ, MAP_SHARED, file.fd, 0);
+        if (p_map != MAP_FAILED)
+        {
+            p_ks->p_index = (ak_byte *) p_map;
+            p_ks->mapped = ak_true;
+        }
+    }
+#endif
+    ak_file_close(&file);
+
+    if (!p_ks->mapped && (error = keystore_read_file(p_path, &p_ks->p_index, &p_ks->index_size)) != ak_error_ok)
+    {
+        free(p_path);
+        return ak_error_message(error, __func__, "wrong reading of keystore index");
+    }
+    free(p_path);
+
+    if ((error = keystore_check_index(p_ks->p_index, p_ks->index_size, &p_ks->count)) != ak_error_ok)
+    {
+        keystore_unload_index(p_ks);
+        return ak_error_message(error, __func__, "wrong keystore index");
+    }
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция захватывает монопольную блокировку файла PKCS_15_KEYSTORE_LOCK_NAME в каталоге
+    хранилища. Блокировка, установленная функцией flock(), исключает одновременное изменение
+    хранилища через разные дескрипторы, в том числе принадлежащие одному процессу.
+    Если операционная система не поддерживает блокировку файлов, функция ничего не делает.
+
+    @param p_ks указатель на хранилище
+    @param p_fd указатель на переменную, в которую записывается дескриптор файла блокировки
+           (или -1, если блокировка не захватывалась)
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_lock(struct keystore *p_ks, int *p_fd) {
+#if defined(LIBAKRYPT_HAVE_SYSFILE_H) && defined(LIBAKRYPT_HAVE_FCNTL_H)
+    int fd;
+    char *p_path;
+
+    *p_fd = -1;
+    if ((p_path = keystore_make_path(p_ks, PKCS_15_KEYSTORE_LOCK_NAME)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    fd = open(p_path, O_RDWR | O_CREAT, 0600);
+    free(p_path);
+    if (fd < 0)
+        return ak_error_message(ak_error_open_file, __func__, "wrong opening of keystore lock file");
+
+    if (flock(fd, LOCK_EX) != 0)
+    {
+        close(fd);
+        return ak_error_message(ak_error_access_file, __func__, "wrong locking of keystore");
+    }
+    *p_fd = fd;
+#else
+    (void) p_ks;
+    *p_fd = -1;
+#endif
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param fd дескриптор файла блокировки, полученный функцией keystore_lock()                     */
+/* ----------------------------------------------------------------------------------------------- */
+static void keystore_unlock(int fd) {
+#if defined(LIBAKRYPT_HAVE_SYSFILE_H) && defined(LIBAKRYPT_HAVE_FCNTL_H)
+    if (fd < 0)
+        return;
+    flock(fd, LOCK_UN);
+    close(fd);
+#else
+    (void) fd;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция строит новый индекс из записей текущего индекса, не относящихся к файлу file_name,
+    и описаний ключей pp_descs, после чего атомарно заменяет индексный файл и загружает его.
+    Все действия выполняются под блокировкой хранилища, а индекс перед построением повторно
+    загружается из файла, поэтому изменения, сделанные через другие дескрипторы хранилища
+    (или другими процессами), не теряются.
+
+    @param p_ks указатель на хранилище
+    @param file_name имя файла контейнера, записи которого заменяются
+    @param pp_descs массив описаний ключей нового контейнера (может быть равен NULL)
+    @param num_of_descs количество описаний
+    @param p_container содержимое нового контейнера (может быть равно NULL)
+    @param container_size размер нового контейнера
+    @return В случае успеха функция возввращает ak_error_ok (ноль). Если идентификатор ключа
+    уже присутствует в другом контейнере, возвращается ak_error_invalid_value.
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int keystore_update(struct keystore *p_ks, const char *file_name, struct key_description **pp_descs, ak_uint8 num_of_descs,
+                           const ak_byte *p_container, size_t container_size) {
+    int error, lock_fd;
+    ak_uint32 i, count;
+    size_t pool_size, size, pool_off, len;
+    struct keystore_entry entry;
+    struct keystore_record *p_recs;
+    struct keystore_record **pp_by_label;
+    ak_byte *p_index, *p_pool;
+    char *p_path;
+
+    p_index = NULL;
+    p_path = NULL;
+    p_recs = NULL;
+    pp_by_label = NULL;
+
+    /* Перечитываем индекс под блокировкой: он мог быть изменен после загрузки */
+    if ((error = keystore_lock(p_ks, &lock_fd)) != ak_error_ok)
+        return ak_error_message(error, __func__, "wrong locking of keystore");
+    if ((error = keystore_load_index(p_ks)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "wrong loading of keystore index");
+        goto exit;
+    }
+
+    p_recs = calloc((size_t) p_ks->count + num_of_descs + 1, sizeof(struct keystore_record));
+    pp_by_label = calloc((size_t) p_ks->count + num_of_descs + 1, sizeof(struct keystore_record *));
+    if (!p_recs || !pp_by_label)
+    {
+        error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        goto exit;
+    }
+
+    /* Собираем записи: прежние записи других контейнеров и записи нового контейнера */
+    count = 0;
+    for (i = 0; i < p_ks->count; i++)
+    {
+        keystore_get_entry(p_ks, i, &entry);
+        if (strcmp(entry.file, file_name) == 0)
+            continue;
+        p_recs[count].id = entry.id;
+        p_recs[count].id_size = entry.id_size;
+        p_recs[count].file = entry.file;
+        p_recs[count].label = entry.label;
+        p_recs[count].algorithm = entry.algorithm;
+        p_recs[count++].offset = entry.offset;
+    }
+    for (i = 0; i < num_of_descs; i++)
+    {
+        if (pp_descs[i]->offset > 0xFFFFFFFFu)
+        {
+            error = ak_error_message(ak_error_wrong_length, __func__, "too large container");
+            goto exit;
+        }
+        p_recs[count].id = pp_descs[i]->id ? pp_descs[i]->id : (const ak_byte *) "";
+        p_recs[count].id_size = pp_descs[i]->id_size;
+        p_recs[count].file = file_name;
+        p_recs[count].label = pp_descs[i]->label ? (const char *) pp_descs[i]->label : "";
+        p_recs[count].algorithm = pp_descs[i]->algorithm ? pp_descs[i]->algorithm : "";
+        p_recs[count++].offset = pp_descs[i]->offset;
+    }
+
+    /* Упорядочиваем записи по идентификатору; идентификаторы должны быть уникальны в хранилище */
+    qsort(p_recs, count, sizeof(struct keystore_record), keystore_compare_records_by_id);
+    for (i = 1; i < count; i++)
+    {
+        if (!keystore_compare_records_by_id(&p_recs[i - 1], &p_recs[i]))
+        {
+            error = ak_error_message(ak_error_invalid_value, __func__, "key id already exists in keystore");
+            goto exit;
+        }
+    }
+    for (i = 0; i < count; i++)
+        pp_by_label[i] = &p_recs[i];
+    qsort(pp_by_label, count, sizeof(struct keystore_record *), keystore_compare_records_by_label);
+
+    /* Кодируем индекс */
+    pool_size = 0;
+    for (i = 0; i < count; i++)
+        pool_size += p_recs[i].id_size + strlen(p_recs[i].file) + strlen(p_recs[i].label) + strlen(p_recs[i].algorithm) + 3;
+    size = KEYSTORE_HEADER_SIZE + (size_t) count * (KEYSTORE_RECORD_SIZE + 4) + pool_size;
+    if (pool_size > 0xFFFFFFFFu)
+    {
+        error = ak_error_message(ak_error_wrong_length, __func__, "too large keystore index");
+        goto exit;
+    }
+
+    if ((p_index = malloc(size)) == NULL)
+    {
+        error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        goto exit;
+    }
+    memcpy(p_index, "AKKI", 4);
+    keystore_put_u32(p_index + 4, KEYSTORE_INDEX_VERSION);
+    keystore_put_u32(p_index + 8, count);
+    keystore_put_u32(p_index + 12, (ak_uint32) pool_size);
+
+    p_pool = p_index + KEYSTORE_HEADER_SIZE + (size_t) count * (KEYSTORE_RECORD_SIZE + 4);
+    pool_off = 0;
+    for (i = 0; i < count; i++)
+    {
+        ak_byte *p_rec = p_index + KEYSTORE_HEADER_SIZE + (size_t) i * KEYSTORE_RECORD_SIZE;
+
+        keystore_put_u32(p_rec, (ak_uint32) pool_off);
+        keystore_put_u32(p_rec + 4, (ak_uint32) p_recs[i].id_size);
+        memcpy(p_pool + pool_off, p_recs[i].id, p_recs[i].id_size);
+        pool_off += p_recs[i].id_size;
+
+        keystore_put_u32(p_rec + 8, (ak_uint32) pool_off);
+        len = strlen(p_recs[i].file) + 1;
+        memcpy(p_pool + pool_off, p_recs[i].file, len);
+        pool_off += len;
+
+        keystore_put_u32(p_rec + 12, (ak_uint32) pool_off);
+        len = strlen(p_recs[i].label) + 1;
+        memcpy(p_pool + pool_off, p_recs[i].label, len);
+        pool_off += len;
+
+        keystore_put_u32(p_rec + 16, (ak_uint32) pool_off);
+        len = strlen(p_recs[i].algorithm) + 1;
+        memcpy(p_pool + pool_off, p_recs[i].algorithm, len);
+        pool_off += len;
+
+        keystore_put_u32(p_rec + 20, (ak_uint32) p_recs[i].offset);
+        keystore_put_u32(p_index + KEYSTORE_HEADER_SIZE + (size_t) count * KEYSTORE_RECORD_SIZE + (size_t) i * 4,
+                         (ak_uint32) (pp_by_label[i] - p_recs));
+    }
+
+    /* Сначала заменяем (или удаляем) контейнер, затем индекс; индекс всегда проверяется при чтении
+       ключа, поэтому сбой между двумя операциями приводит лишь к устаревшей записи индекса */
+    if ((p_path = keystore_make_path(p_ks, file_name)) == NULL)
+    {
+        error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        goto exit;
+    }
+    if (p_container)
+    {
+        if ((error = keystore_write_file_atomic(p_path, p_container, container_size)) != ak_error_ok)
+        {
+            ak_error_message(error, __func__, "wrong writing of container");
+            goto exit;
+        }
+    }
+    else
+        remove(p_path);
+    free(p_path);
+    p_path = NULL;
+
+    if ((p_path = keystore_make_path(p_ks, PKCS_15_KEYSTORE_INDEX_NAME)) == NULL)
+    {
+        error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        goto exit;
+    }
+    if ((error = keystore_write_file_atomic(p_path, p_index, size)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "wrong writing of keystore index");
+        goto exit;
+    }
+
+    /* Записи ссылались на прежний индекс, поэтому он выгружается только после записи нового */
+    if ((error = keystore_load_index(p_ks)) != ak_error_ok)
+        ak_error_message(error, __func__, "wrong loading of keystore index");
+
+exit:
+    keystore_unlock(lock_fd);
+    free(p_path);
+    free(p_index);
+    free(pp_by_label);
+    free(p_recs);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_ks указатель на структуру хранилища
+    @param path путь к существующему каталогу хранилища
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int keystore_open(struct keystore *p_ks, const char *path) {
+    int error;
+
+    if (!p_ks || !path)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    memset(p_ks, 0, sizeof(struct keystore));
+    if ((p_ks->path = malloc(strlen(path) + 1)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    strcpy(p_ks->path, path);
+
+    if ((error = keystore_load_index(p_ks)) != ak_error_ok)
+    {
+        keystore_close(p_ks);
+        return ak_error_message(error, __func__, "wrong loading of keystore index");
+    }
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_ks указатель на хранилище                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+void keystore_close(struct keystore *p_ks) {
+    if (!p_ks)
+        return;
+
+    keystore_unload_index(p_ks);
+    free(p_ks->path);
+    p_ks->path = NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param file_name имя файла
+    @return Функция возвращает ak_true, если имя файла может использоваться для контейнера.         */
+/* ----------------------------------------------------------------------------------------------- */
+static bool_t keystore_is_valid_name(const char *file_name) {
+    if (!file_name || !*file_name || file_name[0] == '.' || strchr(file_name, '/') || strchr(file_name, '\\'))
+        return ak_false;
+    if (strcmp(file_name, PKCS_15_KEYSTORE_INDEX_NAME) == 0 || strcmp(file_name, PKCS_15_KEYSTORE_LOCK_NAME) == 0)
+        return ak_false;
+
+    return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Контейнер создается функцией write_keys_to_container() и записывается в файл file_name каталога
+    хранилища (существующий файл заменяется). Записи индекса, относившиеся к прежнему содержимому
+    файла, удаляются. Идентификаторы ключей должны быть уникальны в пределах всего хранилища.
+
+    @param p_ks указатель на хранилище
+    @param file_name имя файла контейнера в каталоге хранилища
+    @param pp_inp_keys массив указателей на ключи, которые необходимо добавить в контенер
+    @param num_of_inp_keys количество ключей
+    @param password пароль (в кодировке UTF-8), из которого вырабатывается ключ для шифрования данных
+    @param password_size длинна пароля в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int keystore_write_container(struct keystore *p_ks, const char *file_name, struct extended_key **pp_inp_keys, ak_uint8 num_of_inp_keys, ak_pointer password, size_t password_size) {
+    int error;
+    ak_byte *p_container;
+    size_t container_size;
+    struct key_description **pp_descs;
+    ak_uint8 num_of_descs;
+
+    if (!p_ks || !p_ks->path || !pp_inp_keys || !password)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    if (!keystore_is_valid_name(file_name))
+        return ak_error_message(ak_error_invalid_value, __func__, "invalid container file name");
+
+    p_container = NULL;
+    pp_descs = NULL;
+    num_of_descs = 0;
+
+    if ((error = write_keys_to_container(pp_inp_keys, num_of_inp_keys, password, password_size, &p_container, &container_size)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with writing keys to container");
+
+    /* Смещения объектов определяются по уже закодированному контейнеру */
+    if ((error = list_keys_in_container(p_container, container_size, &pp_descs, &num_of_descs)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with listing keys in container");
+        goto exit;
+    }
+
+    if ((error = keystore_update(p_ks, file_name, pp_descs, num_of_descs, p_container, container_size)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with updating keystore");
+
+exit:
+    free_key_descriptions(pp_descs, num_of_descs);
+    free(pp_descs);
+    free(p_container);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_ks указатель на хранилище
+    @param file_name имя файла контейнера в каталоге хранилища
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int keystore_remove_container(struct keystore *p_ks, const char *file_name) {
+    int error;
+
+    if (!p_ks || !p_ks->path)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    if (!keystore_is_valid_name(file_name))
+        return ak_error_message(ak_error_invalid_value, __func__, "invalid container file name");
+
+    if ((error = keystore_update(p_ks, file_name, NULL, 0, NULL, 0)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with updating keystore");
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_ks указатель на хранилище
+    @param id указатель на уникальный идентификатор ключа
+    @param id_size длина идентификатора в байтах
+    @param p_entry указатель на структуру, в которую записывается найденная запись индекса
+    @return В случае успеха функция возввращает ak_error_ok (ноль). Если ключ с заданным
+    идентификатором отсутствует, возвращается ak_error_undefined_value.
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int keystore_find_by_id(struct keystore *p_ks, const ak_byte *id, size_t id_size, struct keystore_entry *p_entry) {
+    int res;
+    ak_uint32 low, high, mid;
+
+    if (!p_ks || !id || !p_entry)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    if (!p_ks->count)
+        return ak_error_undefined_value;
+
+    low = 0;
+    high = p_ks->count;
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        keystore_get_entry(p_ks, mid, p_entry);
+        if ((res = keystore_compare_ids(p_entry->id, p_entry->id_size, id, id_size)) == 0)
+            return ak_error_ok;
+        if (res < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return ak_error_undefined_value;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Если в хранилище несколько ключей с одинаковым названием, возвращается запись ключа
+    с наименьшим идентификатором.
+
+    @param p_ks указатель на хранилище
+    @param label название ключа
+    @param p_entry указатель на структуру, в которую записывается найденная запись индекса
+    @return В случае успеха функция возввращает ak_error_ok (ноль). Если ключ с заданным
+    названием отсутствует, возвращается ak_error_undefined_value.
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int keystore_find_by_label(struct keystore *p_ks, const char *label, struct keystore_entry *p_entry) {
+    ak_uint32 low, high, mid;
+    const ak_byte *p_by_label;
+
+    if (!p_ks || !label || !p_entry)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    if (!p_ks->count)
+        return ak_error_undefined_value;
+
+    /* Ищем первую запись, название которой не меньше заданного */
+    p_by_label = p_ks->p_index + KEYSTORE_HEADER_SIZE + (size_t) p_ks->count * KEYSTORE_RECORD_SIZE;
+    low = 0;
+    high = p_ks->count;
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        keystore_get_entry(p_ks, keystore_get_u32(p_by_label + (size_t) mid * 4), p_entry);
+        if (strcmp(p_entry->label, label) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low < p_ks->count)
+    {
+        keystore_get_entry(p_ks, keystore_get_u32(p_by_label + (size_t) low * 4), p_entry);
+        if (strcmp(p_entry->label, label) == 0)
+            return ak_error_ok;
+    }
+
+    return ak_error_undefined_value;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция находит ключ в индексе, считывает единственный контейнер, в котором он хранится,
+    и расшифровывает только объект, расположенный по указанному в индексе смещению.
+
+    @param p_ks указатель на хранилище
+    @param password пароль, из которого вырабатывается ключ для шифрования данных
+    @param password_size длинна пароля в байтах
+    @param id указатель на уникальный идентификатор ключа
+    @param id_size длина идентификатора в байтах
+    @param pp_out_key указатель на переменную, в которую запишется указатель на ключ
+    @return В случае успеха функция возввращает ak_error_ok (ноль). Если ключ с заданным
+    идентификатором отсутствует в индексе, возвращается ak_error_undefined_value; если индекс
+    не соответствует содержимому контейнера, возвращается ak_error_not_equal_data.
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int keystore_read_key_by_id(struct keystore *p_ks, ak_pointer password, size_t password_size, const ak_byte *id, size_t id_size, struct extended_key **pp_out_key) {
+    int error;
+    char *p_path;
+    ak_byte *p_container;
+    size_t container_size;
+    struct keystore_entry entry;
+    struct extended_key *p_key;
+
+    if (!p_ks || !password || !id || !pp_out_key)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    *pp_out_key = NULL;
+    if ((error = keystore_find_by_id(p_ks, id, id_size, &entry)) != ak_error_ok)
+        return ak_error_message(error, __func__, "key with given id not found");
+
+    if ((p_path = keystore_make_path(p_ks, entry.file)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    error = keystore_read_file(p_path, &p_container, &container_size);
+    free(p_path);
+    if (error != ak_error_ok)
+        return ak_error_message(error, __func__, "wrong reading of container");
+
+    if ((error = read_key_from_container_at(password, password_size, p_container, container_size, entry.offset, &p_key)) != ak_error_ok)
+    {
+        free(p_container);
+        return ak_error_message(error, __func__, "problem with reading key from container");
+    }
+    free(p_container);
+
+    /* Проверяем, что индекс соответствует содержимому контейнера */
+    if (!p_key->key.sec_key || p_key->key.sec_key->key.number.size != id_size
+        || memcmp(p_key->key.sec_key->key.number.data, id, id_size) != 0)
+    {
+        if (p_key->key.sec_key)
+        {
+            ak_bckey_context_destroy(p_key->key.sec_key);
+            free(p_key->key.sec_key);
+        }
+        free(p_key->label);
+        free(p_key);
+        return ak_error_message(ak_error_not_equal_data, __func__, "keystore index is out of date");
+    }
+
+    *pp_out_key = p_key;
+
+    return ak_error_ok;
+}
@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Файл ak_pkcs_15_keystore.h                                                                     */
+/*  - содержит описание хранилища, объединяющего множество контейнеров PKCS 15 в одном каталоге;   */
+/*  - содержит описание функций для поиска ключей по индексу без разбора всех контейнеров.         */
+/* ----------------------------------------------------------------------------------------------- */
+
+#ifndef __AK_PKCS_15_KEYSTORE_H__
+#define __AK_PKCS_15_KEYSTORE_H__
+
+#include <pkcs_15_cryptographic_token/ak_pkcs_15_token_manager.h>
+
+/*! \brief Имя индексного файла в каталоге хранилища. */
+#define PKCS_15_KEYSTORE_INDEX_NAME "keystore.idx"
+/*! \brief Имя файла блокировки, захватываемой при изменении хранилища. */
+#define PKCS_15_KEYSTORE_LOCK_NAME "keystore.lock"
+
+/*! \brief Струкртура, хранящая запись индекса хранилища.
+    \details Указатели ссылаются на память индекса и остаются корректными до следующего изменения
+    хранилища или до вызова функции keystore_close(). */
+struct keystore_entry {
+    /*! \brief имя файла контейнера (относительно каталога хранилища) */
+    const char *file;
+    /*! \brief уникальный идентификатор ключа */
+    const ak_byte *id;
+    /*! \brief длина уникального идентификатора ключа в байтах */
+    size_t id_size;
+    /*! \brief название ключа понятное человеку */
+    const char *label;
+    /*! \brief идентификатор алгоритма, для которого предназначен ключ */
+    const char *algorithm;
+    /*! \brief смещение объекта от начала DER последовательности контейнера */
+    size_t offset;
+};
+
+/*! \brief Струкртура, хранящая открытое хранилище контейнеров. */
+struct keystore {
+    /*! \brief путь к каталогу хранилища */
+    char *path;
+    /*! \brief содержимое индексного файла */
+    ak_byte *p_index;
+    /*! \brief размер индексного файла в байтах */
+    size_t index_size;
+    /*! \brief количество записей индекса */
+    ak_uint32 count;
+    /*! \brief флаг, определяющий, что индекс отображен в память (а не считан в буфер) */
+    bool_t mapped;
+};
+
+/*! \brief Открытие хранилища и загрузка индекса. */
+int keystore_open(struct keystore *p_ks, const char *path);
+
+/*! \brief Закрытие хранилища и освобождение памяти. */
+void keystore_close(struct keystore *p_ks);
+
+/*! \brief Запись контейнера в хранилище с обновлением индекса. */
+int keystore_write_container(struct keystore *p_ks, const char *file_name, struct extended_key **pp_inp_keys, ak_uint8 num_of_inp_keys, ak_pointer password, size_t password_size);
+
+/*! \brief Удаление контейнера из хранилища с обновлением индекса. */
+int keystore_remove_container(struct keystore *p_ks, const char *file_name);
+
+/*! \brief Поиск записи индекса по уникальному идентификатору ключа. */
+int keystore_find_by_id(struct keystore *p_ks, const ak_byte *id, size_t id_size, struct keystore_entry *p_entry);
+
+/*! \brief Поиск записи индекса по названию ключа. */
+int keystore_find_by_label(struct keystore *p_ks, const char *label, struct keystore_entry *p_entry);
+
+/*! \brief Считывание из хранилища единственного ключа с заданным идентификатором. */
+int keystore_read_key_by_id(struct keystore *p_ks, ak_pointer password, size_t password_size, const ak_byte *id, size_t id_size, struct extended_key **pp_out_key);
+
+#endif /* __AK_PKCS_15_KEYSTORE_H__ */
@@ -12,42 +12,16 @@
 #include "ak_pkcs_15_token.h"
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! @param p_pkcs_15_token указатель на структуру, содержащую всю информацию о токене
-    @param pp_data указатель на указатель на выходную DER последовательность
-    @param p_size размер получившийся DER последовательности
+/*! @param p_pkcs_15_token_der указатель на токен, содержащий всю DER последовательность
+    @param p_pkcs_15_token указатель на структуру, содержащую всю информацию о токене
+    @param p_key_management_info_der результат закодирования объекта keyManagementInfo
+    (остается пустым, если объект отсутствует)
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int pkcs_15_generate_token(s_pkcs_15_token *p_pkcs_15_token, ak_byte **pp_data, size_t *p_size) {
+static int pkcs_15_put_token_key_infos(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_token *p_pkcs_15_token, s_der_buffer *p_key_management_info_der) {
     int error;
-    s_der_buffer pkcs_token_der;
-    s_der_buffer objects;
-    s_der_buffer key_management_info;
-    s_der_buffer token_ver;
-    size_t token_len;
-
-    memset(&pkcs_token_der, 0, sizeof(s_der_buffer));
-    memset(&objects, 0, sizeof(s_der_buffer));
-    memset(&key_management_info, 0, sizeof(s_der_buffer));
-    memset(&token_ver, 0, sizeof(s_der_buffer));
-
-    if (!p_pkcs_15_token || !pp_data || !p_size)
-        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
-
-    /* Выделяем память под DER последовательность */
-    ps_alloc(&pkcs_token_der, 2000, PS_W_MODE);
-
-    /* Добавляем объекты PKCS 15 Objects в DER последовательность */
-    if (p_pkcs_15_token->mpp_pkcs_15_objects && p_pkcs_15_token->m_obj_size)
-    {
-        if ((error = pkcs_15_put_pkcs_objects(&pkcs_token_der, p_pkcs_15_token->mpp_pkcs_15_objects, p_pkcs_15_token->m_obj_size, &objects)) != ak_error_ok)
-            return ak_error_message(error, __func__, "problems with adding objects");
-    }
-    else
-        return ak_error_message(ak_error_invalid_value, __func__, "objects absent");
-
 
-    /* Добавляем объект keyManagementInfo в DER последовательность, если он присутствует */
     if (p_pkcs_15_token->m_info_size != 0)
     {
         size_t key_management_info_len = 0;
@@ -62,7 +36,7 @@ int pkcs_15_generate_token(s_pkcs_15_token *p_pkcs_15_token, ak_byte **pp_data,
             if (!p_pkcs_15_token->mpp_key_infos[i])
                 return ak_error_message(ak_error_null_pointer, __func__, "bad pointer to key management info");
 
-            if ((error = pkcs_15_put_key_management_info(&pkcs_token_der, p_pkcs_15_token->mpp_key_infos[i], &sngl_key_management_info)) != ak_error_ok)
+            if ((error = pkcs_15_put_key_management_info(p_pkcs_15_token_der, p_pkcs_15_token->mpp_key_infos[i], &sngl_key_management_info)) != ak_error_ok)
                 return ak_error_message(error, __func__, "problems with adding key management info");
 
             key_management_info_len += ps_get_full_size(&sngl_key_management_info);
@@ -70,21 +44,64 @@ int pkcs_15_generate_token(s_pkcs_15_token *p_pkcs_15_token, ak_byte **pp_data,
 
         if (key_management_info_len)
         {
-            if ((error = ps_move_cursor(&pkcs_token_der, asn_get_len_byte_cnt(key_management_info_len) + 1)) !=
+            if ((error = ps_move_cursor(p_pkcs_15_token_der, asn_get_len_byte_cnt(key_management_info_len) + 1)) !=
                 ak_error_ok)
                 return ak_error_message(error, __func__, "problems with moving cursor");
 
             /* Добавляем тег и длину объекта keyManagementInfo в DER последовательность */
-            asn_put_tag(CONTEXT_SPECIFIC | CONSTRUCTED | 0u, pkcs_token_der.mp_curr);
+            asn_put_tag(CONTEXT_SPECIFIC | CONSTRUCTED | 0u, p_pkcs_15_token_der->mp_curr);
 
-            if ((error = asn_put_len(key_management_info_len, pkcs_token_der.mp_curr + 1)) != ak_error_ok)
+            if ((error = asn_put_len(key_management_info_len, p_pkcs_15_token_der->mp_curr + 1)) != ak_error_ok)
                 return ak_error_message_fmt(error, __func__, "problem with adding key management info length");
 
-            if ((error = ps_set(&key_management_info, pkcs_token_der.mp_curr, key_management_info_len + asn_get_len_byte_cnt(key_management_info_len) + 1, PS_U_MODE)) != ak_error_ok)
+            if ((error = ps_set(p_key_management_info_der, p_pkcs_15_token_der->mp_curr, key_management_info_len + asn_get_len_byte_cnt(key_management_info_len) + 1, PS_U_MODE)) != ak_error_ok)
                 return ak_error_message(error, __func__, "problems with making union of asn data");
         }
     }
 
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_pkcs_15_token указатель на структуру, содержащую всю информацию о токене
+    @param pp_data указатель на указатель на выходную DER последовательность
+    @param p_size размер получившийся DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_generate_token(s_pkcs_15_token *p_pkcs_15_token, ak_byte **pp_data, size_t *p_size) {
+    int error;
+    s_der_buffer pkcs_token_der;
+    s_der_buffer objects;
+    s_der_buffer key_management_info;
+    s_der_buffer token_ver;
+    size_t token_len;
+
+    memset(&pkcs_token_der, 0, sizeof(s_der_buffer));
+    memset(&objects, 0, sizeof(s_der_buffer));
+    memset(&key_management_info, 0, sizeof(s_der_buffer));
+    memset(&token_ver, 0, sizeof(s_der_buffer));
+
+    if (!p_pkcs_15_token || !pp_data || !p_size)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    /* Выделяем память под DER последовательность */
+    ps_alloc(&pkcs_token_der, 2000, PS_W_MODE);
+
+    /* Добавляем объекты PKCS 15 Objects в DER последовательность */
+    if (p_pkcs_15_token->mpp_pkcs_15_objects && p_pkcs_15_token->m_obj_size)
+    {
+        if ((error = pkcs_15_put_pkcs_objects(&pkcs_token_der, p_pkcs_15_token->mpp_pkcs_15_objects, p_pkcs_15_token->m_obj_size, &objects)) != ak_error_ok)
+            return ak_error_message(error, __func__, "problems with adding objects");
+    }
+    else
+        return ak_error_message(ak_error_invalid_value, __func__, "objects absent");
+
+
+    /* Добавляем объект keyManagementInfo в DER последовательность, если он присутствует */
+    if ((error = pkcs_15_put_token_key_infos(&pkcs_token_der, p_pkcs_15_token, &key_management_info)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with adding key management info");
+
     /* Добавляем версию токена в DER последовательность */
     if ((error = asn_put_universal_tlv(TINTEGER, (void *) &p_pkcs_15_token->m_version, 0, &pkcs_token_der, &token_ver)) != ak_error_ok)
         return ak_error_message(error, __func__, "problem with adding token version");
@@ -108,6 +125,81 @@ int pkcs_15_generate_token(s_pkcs_15_token *p_pkcs_15_token, ak_byte **pp_data,
     return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция кодирует все блоки контейнера, предшествующие содержимому последовательности
+    PKCS 15 Objects: заголовок контейнера, версию, объект keyManagementInfo и заголовок
+    последовательности объектов. Объекты контейнера при этом не требуются: их суммарная длина
+    передается в функцию, а сами объекты могут быть закодированы и записаны вслед за заголовком
+    по одному (см. container_writer_put_key()).
+
+    @param p_pkcs_15_token указатель на структуру, содержащую версию и информацию о ключе KEK
+    @param objs_len суммарная длина закодированных объектов PKCS15Object
+    @param pp_data указатель на указатель на выходную DER последовательность
+    @param p_size размер получившийся DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_generate_token_header(s_pkcs_15_token *p_pkcs_15_token, size_t objs_len, ak_byte **pp_data, size_t *p_size) {
+    int error;
+    ak_byte token_header[2 + AK_ASN_MAX_LEN_BYTE_CNT];
+    ak_byte objs_header[2 + AK_ASN_MAX_LEN_BYTE_CNT];
+    size_t token_header_len;
+    size_t objs_header_len;
+    size_t info_len;
+    s_der_buffer pkcs_token_der;
+    s_der_buffer key_management_info;
+    s_der_buffer token_ver;
+
+    memset(&key_management_info, 0, sizeof(s_der_buffer));
+    memset(&token_ver, 0, sizeof(s_der_buffer));
+
+    if (!p_pkcs_15_token || !pp_data || !p_size)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    /* Заголовок последовательности PKCS 15 Objects кодируется без содержимого */
+    if ((error = ak_asn_core_put_header(CONSTRUCTED | TSEQUENCE, objs_len, objs_header, &objs_header_len)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with encoding pkcs 15 objects header");
+
+    /* Кодируем версию и объект keyManagementInfo */
+    if ((error = ps_alloc(&pkcs_token_der, 512, PS_W_MODE)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with memory allocation");
+
+    if ((error = pkcs_15_put_token_key_infos(&pkcs_token_der, p_pkcs_15_token, &key_management_info)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problems with adding key management info");
+        goto exit;
+    }
+
+    if ((error = asn_put_universal_tlv(TINTEGER, (void *) &p_pkcs_15_token->m_version, 0, &pkcs_token_der, &token_ver)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with adding token version");
+        goto exit;
+    }
+    info_len = ps_get_curr_size(&pkcs_token_der);
+
+    if ((error = ak_asn_core_put_header(CONSTRUCTED | TSEQUENCE, info_len + objs_header_len + objs_len,
+                                        token_header, &token_header_len)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problems with encoding token header");
+        goto exit;
+    }
+
+    *p_size = token_header_len + info_len + objs_header_len;
+    if ((*pp_data = malloc(*p_size)) == NULL)
+    {
+        error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        goto exit;
+    }
+    memcpy(*pp_data, token_header, token_header_len);
+    memcpy(*pp_data + token_header_len, pkcs_token_der.mp_curr, info_len);
+    memcpy(*pp_data + token_header_len + info_len, objs_header, objs_header_len);
+
+exit:
+    free(pkcs_token_der.mp_begin);
+
+    return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param p_pkcs_15_token_der указатель на токен, содержащий всю DER последовательность
     @param pp_pkcs_15_objects массив указателей на объекты PKCS15Object
@@ -116,7 +208,7 @@ int pkcs_15_generate_token(s_pkcs_15_token *p_pkcs_15_token, ak_byte **pp_data,
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int pkcs_15_put_pkcs_objects(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_object **pp_pkcs_15_objects, int8_t size, s_der_buffer *p_pkcs_15_object_der) {
+int pkcs_15_put_pkcs_objects(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_object **pp_pkcs_15_objects, ak_uint8 size, s_der_buffer *p_pkcs_15_object_der) {
     int error;
     size_t objects_len;
 
@@ -125,7 +217,7 @@ int pkcs_15_put_pkcs_objects(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_object
 
 
     objects_len = 0;
-    for (int8_t i = 0; i < size; i++)
+    for (ak_uint8 i = 0; i < size; i++)
     {
         s_der_buffer added_object;
 
@@ -475,53 +567,84 @@ int pkcs_15_put_params_pbkdf2(s_der_buffer *p_pkcs_15_token_der, s_pwd_info *p_p
 
 /*            ------------- Parser -------------            */
 
+static int pkcs_15_get_pkcs_objects_ex(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_token *p_pkcs_15_token, bool_t attrs_only);
+static int pkcs_15_get_obj_ex(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkcs_15_object, bool_t attrs_only);
+static int pkcs_15_get_direct_obj_ex(s_der_buffer *p_pkcs_15_object_der, s_pkcs_15_object *p_pkcs_15_object, bool_t attrs_only);
+
 /* ----------------------------------------------------------------------------------------------- */
-/*! @param p_data указатель на DER последовательность
+/*! Функция разбирает заголовок контейнера, его версию и информацию о выработке ключа KEK.
+    После выполнения функции объект p_token указывает на последовательность PKCS 15 Objects.
+
+    @param p_data указатель на DER последовательность
     @param size размер DER последовательности
     @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+    @param p_token указатель на объект, в который записываются границы содержимого контейнера
+    @param skip_kmi флаг, при установке которого информация о выработке ключа KEK пропускается
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int pkcs_15_parse_token(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token) {
+static int pkcs_15_open_token(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token, s_der_buffer *p_token, bool_t skip_kmi) {
     int error;
     tag tag;
     size_t len;
-    uint8_t len_byte_cnt;
-    s_der_buffer token;
+    size_t header_len;
 
     tag = 0;
     len = 0;
-    len_byte_cnt = 0;
-    memset(&token, 0, sizeof(s_der_buffer));
+    header_len = 0;
 
     if (!p_data || !size || !p_pkcs_15_token)
         return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
 
-    asn_get_tag(p_data, &tag);
+    if ((error = ak_asn_core_get_header(p_data, p_data + size, &tag, &len, &header_len)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting token header");
+
     if (tag != (CONSTRUCTED | TSEQUENCE))
         return ak_error_invalid_token;
 
-    if ((error = asn_get_len(p_data + 1, &len, &len_byte_cnt)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problems with getting data length");
-
     /* Содаем объект s_der_buffer, в который записывается токен */
-    if ((error = ps_set(&token, p_data + 1 + len_byte_cnt, len, PS_R_MODE)) != ak_error_ok)
+    if ((error = ps_set(p_token, p_data + header_len, len, PS_R_MODE)) != ak_error_ok)
         return ak_error_message(error, __func__, "problems with setting pointer server");
 
     /* Считываем версию токена */
-    if ((error = asn_get_expected_tlv(TINTEGER, &token, (void *) &p_pkcs_15_token->m_version)) != ak_error_ok)
+    if ((error = asn_get_expected_tlv(TINTEGER, p_token, (void *) &p_pkcs_15_token->m_version)) != ak_error_ok)
         return ak_error_message(error, __func__, "problems with getting token version");
 
     /* Считываем keyManagementInfo, если эти данные присутствуют */
-    asn_get_tag(token.mp_curr, &tag);
+    asn_get_tag(p_token->mp_curr, &tag);
     if (tag == (CONTEXT_SPECIFIC | CONSTRUCTED | 0u))
     {
-        if ((error = pkcs_15_get_key_management_info(&token, p_pkcs_15_token)) != ak_error_ok)
+        if (skip_kmi)
+        {
+            if ((error = asn_skip_tlv(p_token)) != ak_error_ok)
+                return ak_error_message(error, __func__, "problems with skipping key management info");
+        }
+        else if ((error = pkcs_15_get_key_management_info(p_token, p_pkcs_15_token)) != ak_error_ok)
             return ak_error_message(error, __func__, "problems with getting key management info");
     }
 
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_data указатель на DER последовательность
+    @param size размер DER последовательности
+    @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+    @param attrs_only флаг, при установке которого из объектов считываются только общие атрибуты
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_parse_token_ex(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token, bool_t attrs_only) {
+    int error;
+    s_der_buffer token;
+
+    memset(&token, 0, sizeof(s_der_buffer));
+
+    if ((error = pkcs_15_open_token(p_data, size, p_pkcs_15_token, &token, attrs_only)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with opening token");
+
     /* Считываем объекты из контенера */
-    if ((error = pkcs_15_get_pkcs_objects(&token, p_pkcs_15_token)) != ak_error_ok)
+    if ((error = pkcs_15_get_pkcs_objects_ex(&token, p_pkcs_15_token, attrs_only)) != ak_error_ok)
         return ak_error_message(error, __func__, "problems with getting pkcs 15 objects");
 
     /* Проверяем, что не осталось непрочитанных данных */
@@ -531,6 +654,339 @@ int pkcs_15_parse_token(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15
     return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_data указатель на DER последовательность
+    @param size размер DER последовательности
+    @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_parse_token(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token) {
+    return pkcs_15_parse_token_ex(p_data, size, p_pkcs_15_token, ak_false);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция не разбирает информацию о выработке ключа KEK и зашифрованные значения ключей:
+    для каждого объекта считываются только общие атрибуты объекта и ключа (метка,
+    идентификатор, флаги использования, период действия).
+
+    @param p_data указатель на DER последовательность
+    @param size размер DER последовательности
+    @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_parse_token_attrs(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token) {
+    return pkcs_15_parse_token_ex(p_data, size, p_pkcs_15_token, ak_true);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_obj_der указатель на DER последовательность, содержащую ровно один объект
+    @param p_id указатель на уникальный идентификатор
+    @param id_size длина идентификатора в байтах
+    @param p_match указатель на переменную, в которую записывается результат сравнения
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_obj_id_equals(s_der_buffer *p_obj_der, const ak_byte *p_id, size_t id_size, bool_t *p_match) {
+    int error;
+    s_pkcs_15_object candidate;
+    s_common_key_attrs *p_key_attrs;
+
+    *p_match = ak_false;
+    memset(&candidate, 0, sizeof(s_pkcs_15_object));
+    if ((error = pkcs_15_get_obj_ex(p_obj_der, &candidate, ak_true)) != ak_error_ok)
+    {
+        free_pkcs_15_object(&candidate);
+        return ak_error_message(error, __func__, "problems with getting object attributes");
+    }
+
+    if (candidate.m_type == SEC_KEY && candidate.m_obj.mp_sec_key)
+    {
+        p_key_attrs = &candidate.m_obj.mp_sec_key->m_key_attrs;
+        *p_match = (p_key_attrs->m_id.m_val_len == id_size) && !memcmp(p_key_attrs->m_id.mp_value, p_id, id_size);
+    }
+    free_pkcs_15_object(&candidate);
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_obj указатель на DER последовательность, содержащую ровно один объект
+    @param obj_size размер DER последовательности
+    @param p_pkcs_15_token указатель на структуру, в которую помещается единственный объект
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_parse_single_obj(ak_byte *p_obj, size_t obj_size, s_pkcs_15_token *p_pkcs_15_token) {
+    int error;
+    s_der_buffer obj_der;
+    s_pkcs_15_object *p_object;
+
+    p_pkcs_15_token->mpp_pkcs_15_objects = malloc(sizeof(s_pkcs_15_object *));
+    if (!p_pkcs_15_token->mpp_pkcs_15_objects)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+
+    p_object = calloc(1, sizeof(s_pkcs_15_object));
+    if (!p_object)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    p_pkcs_15_token->mpp_pkcs_15_objects[p_pkcs_15_token->m_obj_size++] = p_object;
+
+    if ((error = ps_set(&obj_der, p_obj, obj_size, PS_R_MODE)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with setting pointer server");
+
+    if ((error = pkcs_15_get_obj_ex(&obj_der, p_object, ak_false)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting object");
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция полностью разбирает информацию о выработке ключа KEK и определяет смещения блоков
+    контейнера. Объекты контейнера не разбираются; если задан идентификатор p_id, то для каждого
+    объекта считываются только общие атрибуты, необходимые для сравнения идентификаторов.
+
+    @param p_data указатель на DER последовательность
+    @param size размер DER последовательности
+    @param p_pkcs_15_token указатель на структуру, в которую записывается информация о ключе KEK
+    @param p_id указатель на уникальный идентификатор искомого объекта (может быть равен NULL)
+    @param id_size длина идентификатора в байтах
+    @param p_layout указатель на структуру, в которую записываются смещения блоков
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_get_token_layout(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token,
+                             const ak_byte *p_id, size_t id_size, s_pkcs_15_token_layout *p_layout) {
+    int error;
+    bool_t match;
+    s_der_buffer token;
+    s_der_buffer obj_tlv;
+    s_der_buffer obj_der;
+    s_der_buffer pkcs_15_objects;
+
+    if (!p_layout || (p_id && !id_size))
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    memset(p_layout, 0, sizeof(s_pkcs_15_token_layout));
+    memset(&token, 0, sizeof(s_der_buffer));
+
+    if ((error = pkcs_15_open_token(p_data, size, p_pkcs_15_token, &token, ak_false)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with opening token");
+
+    p_layout->m_body_begin = (size_t) (token.mp_begin - p_data);
+    p_layout->m_body_end = (size_t) (token.mp_end - p_data);
+    p_layout->m_objs_begin = (size_t) (token.mp_curr - p_data);
+
+    if ((error = asn_get_expected_tlv((CONSTRUCTED | TSEQUENCE), &token, (void *) &pkcs_15_objects)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting pkcs 15 objects in der");
+
+    p_layout->m_objs_value = (size_t) (pkcs_15_objects.mp_begin - p_data);
+    p_layout->m_objs_end = (size_t) (pkcs_15_objects.mp_end - p_data);
+
+    while (ps_get_curr_size(&pkcs_15_objects))
+    {
+        if ((error = asn_get_next_tlv(&pkcs_15_objects, NULL, &obj_tlv)) != ak_error_ok)
+            return ak_error_message(error, __func__, "problems with getting pkcs 15 object bounds");
+        ++p_layout->m_obj_count;
+
+        if (!p_id || p_layout->m_found)
+            continue;
+
+        if ((error = ps_set(&obj_der, obj_tlv.mp_begin, ps_get_full_size(&obj_tlv), PS_R_MODE)) != ak_error_ok)
+            return ak_error_message(error, __func__, "problems with setting pointer server");
+
+        if ((error = pkcs_15_obj_id_equals(&obj_der, p_id, id_size, &match)) != ak_error_ok)
+            return ak_error_message(error, __func__, "problems with comparing object id");
+
+        if (match)
+        {
+            p_layout->m_found = ak_true;
+            p_layout->m_obj_begin = (size_t) (obj_tlv.mp_begin - p_data);
+            p_layout->m_obj_end = (size_t) (obj_tlv.mp_end - p_data);
+        }
+    }
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция полностью разбирает информацию о выработке ключа KEK и только тот объект, уникальный
+    идентификатор которого совпадает с заданным. Для остальных объектов считываются лишь общие
+    атрибуты, необходимые для сравнения идентификаторов. Если объект найден, то он помещается
+    в контейнер p_pkcs_15_token единственным объектом; в противном случае поле m_obj_size равно нулю.
+
+    @param p_data указатель на DER последовательность
+    @param size размер DER последовательности
+    @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+    @param p_id указатель на уникальный идентификатор искомого объекта
+    @param id_size длина идентификатора в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_parse_token_obj_by_id(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token,
+                                  const ak_byte *p_id, size_t id_size) {
+    int error;
+    s_pkcs_15_token_layout layout;
+
+    if (!p_id || !id_size)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    if ((error = pkcs_15_get_token_layout(p_data, size, p_pkcs_15_token, p_id, id_size, &layout)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting token layout");
+
+    p_pkcs_15_token->m_obj_size = 0;
+    p_pkcs_15_token->mpp_pkcs_15_objects = NULL;
+
+    if (!layout.m_found)
+        return ak_error_ok;
+
+    return pkcs_15_parse_single_obj(p_data + layout.m_obj_begin, layout.m_obj_end - layout.m_obj_begin, p_pkcs_15_token);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция полностью разбирает информацию о выработке ключа KEK и единственный объект, начинающийся
+    с заданного смещения. Остальные объекты контейнера не просматриваются, поэтому функция
+    предназначена для использования совместно с внешним индексом, хранящим смещения объектов.
+
+    @param p_data указатель на DER последовательность
+    @param size размер DER последовательности
+    @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+    @param offset смещение объекта от начала DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_parse_token_obj_at(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token, size_t offset) {
+    int error;
+    s_der_buffer token;
+    s_der_buffer obj_tlv;
+    s_der_buffer pkcs_15_objects;
+
+    memset(&token, 0, sizeof(s_der_buffer));
+
+    if ((error = pkcs_15_open_token(p_data, size, p_pkcs_15_token, &token, ak_false)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with opening token");
+
+    if ((error = asn_get_expected_tlv((CONSTRUCTED | TSEQUENCE), &token, (void *) &pkcs_15_objects)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting pkcs 15 objects in der");
+
+    /* Смещение должно указывать внутрь последовательности PKCS 15 Objects */
+    if (offset < (size_t) (pkcs_15_objects.mp_begin - p_data) || offset >= (size_t) (pkcs_15_objects.mp_end - p_data))
+        return ak_error_message(ak_error_invalid_value, __func__, "object offset is out of pkcs 15 objects");
+
+    pkcs_15_objects.mp_curr = p_data + offset;
+    if ((error = asn_get_next_tlv(&pkcs_15_objects, NULL, &obj_tlv)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with getting pkcs 15 object bounds");
+
+    p_pkcs_15_token->m_obj_size = 0;
+    p_pkcs_15_token->mpp_pkcs_15_objects = NULL;
+
+    return pkcs_15_parse_single_obj(obj_tlv.mp_begin, ps_get_full_size(&obj_tlv), p_pkcs_15_token);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_pkcs_15_object указатель на объект PKCS15Object
+    @param pp_data указатель на указатель на выходную DER последовательность
+    @param p_size размер получившийся DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_encode_obj(s_pkcs_15_object *p_pkcs_15_object, ak_byte **pp_data, size_t *p_size) {
+    int error;
+    s_der_buffer object_der;
+    s_der_buffer added_object;
+
+    if (!p_pkcs_15_object || !pp_data || !p_size)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    memset(&added_object, 0, sizeof(s_der_buffer));
+    if ((error = ps_alloc(&object_der, 512, PS_W_MODE)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with memory allocation");
+
+    if ((error = pkcs_15_put_obj(&object_der, p_pkcs_15_object, &added_object)) != ak_error_ok)
+    {
+        free(object_der.mp_begin);
+        return ak_error_message(error, __func__, "problems with adding object");
+    }
+
+    *p_size = ps_get_curr_size(&object_der);
+    if ((*pp_data = malloc(*p_size)) == NULL)
+    {
+        free(object_der.mp_begin);
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    }
+    memcpy(*pp_data, object_der.mp_curr, *p_size);
+    free(object_der.mp_begin);
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция заменяет фрагмент [cut_begin, cut_end) последовательности PKCS 15 Objects на блок
+    p_ins и пересчитывает длины охватывающих блоков (PKCS 15 Objects и самого контейнера).
+    Остальные данные контейнера копируются без повторного кодирования.
+
+    @param p_data указатель на исходную DER последовательность
+    @param p_layout смещения блоков исходного контейнера
+    @param cut_begin смещение начала удаляемого фрагмента
+    @param cut_end смещение конца удаляемого фрагмента (при вставке совпадает с cut_begin)
+    @param p_ins указатель на вставляемый фрагмент (может быть равен NULL при ins_size = 0)
+    @param ins_size длина вставляемого фрагмента
+    @param pp_out указатель на указатель на выходную DER последовательность
+    @param p_out_size размер получившийся DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_splice_token(ak_byte *p_data, s_pkcs_15_token_layout *p_layout, size_t cut_begin, size_t cut_end,
+                         const ak_byte *p_ins, size_t ins_size, ak_byte **pp_out, size_t *p_out_size) {
+    int error;
+    ak_byte token_header[2 + AK_ASN_MAX_LEN_BYTE_CNT];
+    ak_byte objs_header[2 + AK_ASN_MAX_LEN_BYTE_CNT];
+    size_t token_header_len;
+    size_t objs_header_len;
+    size_t objs_len;
+    size_t body_len;
+    ak_byte *p_out;
+
+    if (!p_data || !p_layout || !pp_out || !p_out_size || (ins_size && !p_ins))
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    if (cut_begin < p_layout->m_objs_value || cut_end < cut_begin || cut_end > p_layout->m_objs_end)
+        return ak_error_message(ak_error_invalid_value, __func__, "spliced fragment is out of pkcs 15 objects");
+
+    /* Пересчитываем длины блоков */
+    objs_len = (p_layout->m_objs_end - p_layout->m_objs_value) - (cut_end - cut_begin) + ins_size;
+    if ((error = ak_asn_core_put_header(CONSTRUCTED | TSEQUENCE, objs_len, objs_header, &objs_header_len)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with encoding pkcs 15 objects header");
+
+    body_len = (p_layout->m_objs_begin - p_layout->m_body_begin) + objs_header_len + objs_len +
+               (p_layout->m_body_end - p_layout->m_objs_end);
+    if ((error = ak_asn_core_put_header(CONSTRUCTED | TSEQUENCE, body_len, token_header, &token_header_len)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problems with encoding token header");
+
+    *p_out_size = token_header_len + body_len;
+    if ((p_out = malloc(*p_out_size)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    *pp_out = p_out;
+
+    /* Собираем контейнер: заголовок, версия и KeyManagementInfo без изменений, затем объекты */
+    memcpy(p_out, token_header, token_header_len);
+    p_out += token_header_len;
+    memcpy(p_out, p_data + p_layout->m_body_begin, p_layout->m_objs_begin - p_layout->m_body_begin);
+    p_out += p_layout->m_objs_begin - p_layout->m_body_begin;
+    memcpy(p_out, objs_header, objs_header_len);
+    p_out += objs_header_len;
+    memcpy(p_out, p_data + p_layout->m_objs_value, cut_begin - p_layout->m_objs_value);
+    p_out += cut_begin - p_layout->m_objs_value;
+    if (ins_size)
+    {
+        memcpy(p_out, p_ins, ins_size);
+        p_out += ins_size;
+    }
+    memcpy(p_out, p_data + cut_end, p_layout->m_body_end - cut_end);
+
+    return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param p_pkcs_15_token_der указатель на DER последовательность
     @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
@@ -539,10 +995,10 @@ int pkcs_15_parse_token(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15
 /* ----------------------------------------------------------------------------------------------- */
 int pkcs_15_get_key_management_info(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_token *p_pkcs_15_token) {
     int error;
-    uint8_t num_of_kmi_objs;
+    size_t capacity;
     s_der_buffer key_management_info;
 
-    num_of_kmi_objs = 0;
+    capacity = 0;
     memset(&key_management_info, 0, sizeof(s_der_buffer));
 
     if (!p_pkcs_15_token_der || !p_pkcs_15_token)
@@ -552,26 +1008,33 @@ int pkcs_15_get_key_management_info(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15
     if ((error = asn_get_expected_tlv((CONTEXT_SPECIFIC | CONSTRUCTED | 0u), p_pkcs_15_token_der, (void *) &key_management_info)) != ak_error_ok)
         return ak_error_message(error, __func__, "problems with key management info");
 
-    /* Вычисляем кол-во элементов в объекте keyManagementInfo */
-    if ((error = asn_get_num_of_elems_in_constructed_obj(&key_management_info, &num_of_kmi_objs)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problems with getting num of elements in constructed data object");
-
     p_pkcs_15_token->m_info_size = 0;
-    p_pkcs_15_token->mpp_key_infos = calloc(num_of_kmi_objs, sizeof(s_key_management_info *));
-    if (!p_pkcs_15_token->mpp_key_infos)
-        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    p_pkcs_15_token->mpp_key_infos = NULL;
 
-    /* Считываем отдельный элемент в объекте keyManagementInfo */
+    /* Считываем элементы объекта keyManagementInfo за один проход, без предварительного подсчета */
     while (ps_get_curr_size(&key_management_info))
     {
+        if (p_pkcs_15_token->m_info_size == capacity)
+        {
+            s_key_management_info **pp_new_infos;
+
+            if (capacity == 0xFFu)
+                return ak_error_message(ak_error_wrong_length, __func__, "too many key management info objects");
+
+            capacity = capacity ? 2 * capacity : 2;
+            if (capacity > 0xFFu)
+                capacity = 0xFFu;
+
+            pp_new_infos = realloc(p_pkcs_15_token->mpp_key_infos, capacity * sizeof(s_key_management_info *));
+            if (!pp_new_infos)
+                return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+            p_pkcs_15_token->mpp_key_infos = pp_new_infos;
+        }
+
         if ((error = pkcs_15_get_sngl_kmi(&key_management_info, p_pkcs_15_token)) != ak_error_ok)
             return ak_error_message(error, __func__, "problems with getting single key management info");
     }
 
-    /* Проверяем, что не осталось непрочитанных данных */
-    if (ps_get_curr_size(&key_management_info) != 0)
-        return ak_error_invalid_token;
-
     return ak_error_ok;
 }
 
@@ -584,14 +1047,10 @@ int pkcs_15_get_key_management_info(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15
 int pkcs_15_get_sngl_kmi(s_der_buffer *p_key_management_info_der, s_pkcs_15_token *p_pkcs_15_token) {
     int error;
     tag tag;
-    size_t len;
-    uint8_t len_byte_cnt;
     s_key_management_info *p_sngl_kmi;
     s_der_buffer sngl_info;
 
     tag = 0;
-    len = 0;
-    len_byte_cnt = 0;
     memset(&sngl_info, 0, sizeof(s_der_buffer));
 
     if (!p_key_management_info_der || !p_pkcs_15_token)
@@ -626,20 +1085,14 @@ int pkcs_15_get_sngl_kmi(s_der_buffer *p_key_management_info_der, s_pkcs_15_toke
     else if (tag == (CONTEXT_SPECIFIC | CONSTRUCTED | PWRI))
     {
         ak_error_message(ak_error_invalid_value, __func__, "getting pwri into key management info does not realized yet");
-        if ((error = asn_get_len(p_key_management_info_der->mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
-            return ak_error_message(error, __func__, "problems with getting data length");
-
-        if ((error = ps_move_cursor(p_key_management_info_der, len + len_byte_cnt)) != ak_error_ok)
-            return ak_error_message(error, __func__, "problems with moving cursor");
+        if ((error = asn_skip_tlv(&sngl_info)) != ak_error_ok)
+            return ak_error_message(error, __func__, "problems with skipping pwri");
     }
     else if (tag == (CONTEXT_SPECIFIC | CONSTRUCTED | KEKRI))
     {
         ak_error_message(ak_error_invalid_value, __func__, "getting kekri into key management info does not realized yet");
-        if ((error = asn_get_len(p_key_management_info_der->mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
-            return ak_error_message(error, __func__, "problems with getting data length");
-
-        if ((error = ps_move_cursor(p_key_management_info_der, len + len_byte_cnt)) != ak_error_ok)
-            return ak_error_message(error, __func__, "problems with moving cursor");
+        if ((error = asn_skip_tlv(&sngl_info)) != ak_error_ok)
+            return ak_error_message(error, __func__, "problems with skipping kekri");
     }
 
     /* Проверяем, что не осталось непрочитанных данных */
@@ -793,13 +1246,24 @@ int pkcs_15_get_params_pbkdf2(s_der_buffer *p_alg_id_der, s_pwd_info *p_pwd_info
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int pkcs_15_get_pkcs_objects(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_token *p_pkcs_15_token) {
+    return pkcs_15_get_pkcs_objects_ex(p_pkcs_15_token_der, p_pkcs_15_token, ak_false);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_pkcs_15_token_der указатель на DER последовательность
+    @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+    @param attrs_only флаг, при установке которого из объектов считываются только общие атрибуты
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_get_pkcs_objects_ex(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_token *p_pkcs_15_token, bool_t attrs_only) {
     int error;
+    size_t capacity;
     s_der_buffer pkcs_15_objects;
-    uint8_t num_of_pkcs_15_objects;
+    s_pkcs_15_object *p_object;
 
     memset(&pkcs_15_objects, 0, sizeof(s_der_buffer));
-    num_of_pkcs_15_objects = 0;
-
+    capacity = 0;
 
     if (!p_pkcs_15_token_der || !p_pkcs_15_token)
         return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
@@ -808,47 +1272,79 @@ int pkcs_15_get_pkcs_objects(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_token
         != ak_error_ok)
         return ak_error_message(error, __func__, "problems with getting pkcs 15 objects in der");
 
-    /* Подсчитываем кол-во объектов в контейнере */
-    if ((error = asn_get_num_of_elems_in_constructed_obj(&pkcs_15_objects, &num_of_pkcs_15_objects)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problems with getting num of elements in constructed data object");
+    p_pkcs_15_token->m_obj_size = 0;
+    p_pkcs_15_token->mpp_pkcs_15_objects = NULL;
 
-    p_pkcs_15_token->m_obj_size = num_of_pkcs_15_objects;
-    p_pkcs_15_token->mpp_pkcs_15_objects = calloc(num_of_pkcs_15_objects, sizeof(s_pkcs_15_object *));
-
-    for (size_t i = 0; i < num_of_pkcs_15_objects; i++)
+    /* Считываем объекты за один проход: заголовок каждого объекта разбирается только один раз,
+       массив указателей увеличивается по мере необходимости */
+    while (ps_get_curr_size(&pkcs_15_objects))
     {
-        p_pkcs_15_token->mpp_pkcs_15_objects[i] = calloc(1, sizeof(s_pkcs_15_object));;
-        if (!p_pkcs_15_token->mpp_pkcs_15_objects[i])
+        if (p_pkcs_15_token->m_obj_size == capacity)
+        {
+            s_pkcs_15_object **pp_new_objects;
+
+            if (capacity == 0xFFu)
+                return ak_error_message(ak_error_wrong_length, __func__, "too many pkcs 15 objects");
+
+            capacity = capacity ? 2 * capacity : 4;
+            if (capacity > 0xFFu)
+                capacity = 0xFFu;
+
+            pp_new_objects = realloc(p_pkcs_15_token->mpp_pkcs_15_objects, capacity * sizeof(s_pkcs_15_object *));
+            if (!pp_new_objects)
+                return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+            p_pkcs_15_token->mpp_pkcs_15_objects = pp_new_objects;
+        }
+
+        p_object = calloc(1, sizeof(s_pkcs_15_object));
+        if (!p_object)
             return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
 
+        /* Объект добавляется в контейнер до разбора, чтобы в случае ошибки он был освобожден
+           функцией free_pkcs_15_token() */
+        p_pkcs_15_token->mpp_pkcs_15_objects[p_pkcs_15_token->m_obj_size++] = p_object;
+
         /* Считываем объект */
-        if ((error = pkcs_15_get_obj(&pkcs_15_objects, p_pkcs_15_token->mpp_pkcs_15_objects[i])) != ak_error_ok)
+        if ((error = pkcs_15_get_obj_ex(&pkcs_15_objects, p_object, attrs_only)) != ak_error_ok)
             return ak_error_message(error, __func__, "problems with getting object");
     }
 
-    /* Проверяем, что не осталось непрочитанных данных */
-    if (ps_get_curr_size(&pkcs_15_objects) != 0)
-        return ak_error_invalid_token;
-
     return ak_error_ok;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! @param p_pkcs_15_token_der указатель на DER последовательность
-    @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+/*! @param p_pkcs_15_objects_der указатель на DER последовательность
+    @param p_pkcs_15_object указатель на структуру, в которую записывается объект
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int pkcs_15_get_obj(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkcs_15_object) {
+    return pkcs_15_get_obj_ex(p_pkcs_15_objects_der, p_pkcs_15_object, ak_false);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_pkcs_15_objects_der указатель на DER последовательность
+    @param p_pkcs_15_object указатель на структуру, в которую записываются общие атрибуты объекта
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int pkcs_15_get_obj_attrs(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkcs_15_object) {
+    return pkcs_15_get_obj_ex(p_pkcs_15_objects_der, p_pkcs_15_object, ak_true);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_pkcs_15_objects_der указатель на DER последовательность
+    @param p_pkcs_15_object указатель на структуру, в которую записывается объект
+    @param attrs_only флаг, при установке которого считываются только общие атрибуты объекта
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_get_obj_ex(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkcs_15_object, bool_t attrs_only) {
     int error;
     tag tag;
-    size_t len;
-    uint8_t len_byte_cnt;
     s_der_buffer pkcs_15_sngl_object_der;
 
     tag = 0;
-    len = 0;
-    len_byte_cnt = 0;
     memset(&pkcs_15_sngl_object_der, 0, sizeof(s_der_buffer));
 
     if (!p_pkcs_15_objects_der || !p_pkcs_15_object)
@@ -862,23 +1358,15 @@ int pkcs_15_get_obj(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkc
             p_pkcs_15_object->m_type = SEC_KEY;
             break;
         case (CONTEXT_SPECIFIC | CONSTRUCTED | PRI_KEY):
+            p_pkcs_15_object->m_type = PRI_KEY;
             ak_error_message(ak_error_invalid_value, __func__, "getting private key does not realized yet");
-            if ((error = asn_get_len(p_pkcs_15_objects_der->mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
-                return ak_error_message(error, __func__, "problems with getting data length");
-
-            if ((error = ps_move_cursor(p_pkcs_15_objects_der, len + len_byte_cnt)) != ak_error_ok)
-                return ak_error_message(error, __func__, "problems with moving cursor");
-            break;
+            return asn_skip_tlv(p_pkcs_15_objects_der);
         case (CONTEXT_SPECIFIC | CONSTRUCTED | PUB_KEY):
+            p_pkcs_15_object->m_type = PUB_KEY;
             ak_error_message(ak_error_invalid_value, __func__, "getting public key does not realized yet");
-            if ((error = asn_get_len(p_pkcs_15_objects_der->mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
-                return ak_error_message(error, __func__, "problems with getting data length");
-
-            if ((error = ps_move_cursor(p_pkcs_15_objects_der, len + len_byte_cnt)) != ak_error_ok)
-                return ak_error_message(error, __func__, "problems with moving cursor");
-            break;
+            return asn_skip_tlv(p_pkcs_15_objects_der);
         default:
-            break;
+            return ak_error_message(ak_error_invalid_token, __func__, "unexpected type of pkcs 15 object");
     }
 
     if ((error = asn_get_expected_tlv(tag, p_pkcs_15_objects_der, (void *) &pkcs_15_sngl_object_der)) != ak_error_ok)
@@ -889,16 +1377,14 @@ int pkcs_15_get_obj(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkc
     switch (tag)
     {
         case (CONTEXT_SPECIFIC | CONSTRUCTED | 0u):
-            if ((error = pkcs_15_get_direct_obj(&pkcs_15_sngl_object_der, p_pkcs_15_object)) != ak_error_ok)
+            if ((error = pkcs_15_get_direct_obj_ex(&pkcs_15_sngl_object_der, p_pkcs_15_object, attrs_only)) != ak_error_ok)
                 return ak_error_message(error, __func__, "problems with getting object direct");
             break;
         case (CONTEXT_SPECIFIC | CONSTRUCTED | 2u):
             ak_error_message(ak_error_invalid_value, __func__, "getting direct protected object does not realized yet");
-            if ((error = asn_get_len(pkcs_15_sngl_object_der.mp_curr + 1, &len, &len_byte_cnt)) != ak_error_ok)
-                return ak_error_message(error, __func__, "problems with getting data length");
-
-            if ((error = ps_move_cursor(&pkcs_15_sngl_object_der, len + len_byte_cnt)) != ak_error_ok)
-                return ak_error_message(error, __func__, "problems with moving cursor");
+            if ((error = asn_skip_tlv(&pkcs_15_sngl_object_der)) != ak_error_ok)
+                return ak_error_message(error, __func__, "problems with skipping object");
+            break;
         default:
             break;
     }
@@ -911,12 +1397,23 @@ int pkcs_15_get_obj(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkc
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! @param p_pkcs_15_token_der указатель на DER последовательность
-    @param p_pkcs_15_token указатель на структуру, хранящую информацию о контейнере
+/*! @param p_pkcs_15_object_der указатель на DER последовательность
+    @param p_pkcs_15_object указатель на структуру, в которую записывается объект
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
 int pkcs_15_get_direct_obj(s_der_buffer *p_pkcs_15_object_der, s_pkcs_15_object *p_pkcs_15_object) {
+    return pkcs_15_get_direct_obj_ex(p_pkcs_15_object_der, p_pkcs_15_object, ak_false);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_pkcs_15_object_der указатель на DER последовательность
+    @param p_pkcs_15_object указатель на структуру, в которую записывается объект
+    @param attrs_only флаг, при установке которого считываются только общие атрибуты объекта
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_get_direct_obj_ex(s_der_buffer *p_pkcs_15_object_der, s_pkcs_15_object *p_pkcs_15_object, bool_t attrs_only) {
     int error;
     tag tag;
     s_der_buffer direct_object_der;
@@ -939,7 +1436,12 @@ int pkcs_15_get_direct_obj(s_der_buffer *p_pkcs_15_object_der, s_pkcs_15_object
             if (!p_pkcs_15_object->m_obj.mp_sec_key)
                 return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
 
-            if ((error = pkcs_15_get_gost_key(&direct_object_der, p_pkcs_15_object->m_obj.mp_sec_key)) != ak_error_ok)
+            if (attrs_only)
+                error = pkcs_15_get_gost_key_common_attrs(&direct_object_der, p_pkcs_15_object->m_obj.mp_sec_key);
+            else
+                error = pkcs_15_get_gost_key(&direct_object_der, p_pkcs_15_object->m_obj.mp_sec_key);
+
+            if (error != ak_error_ok)
                 return ak_error_message(error, __func__, "problems with getting object direct");
             break;
         default:
@@ -974,6 +1476,7 @@ void free_pkcs_15_token(s_pkcs_15_token *p_pkcs_15_token) {
             for (i = 0; i < p_pkcs_15_token->m_obj_size; i++)
             {
                 free_pkcs_15_object(p_pkcs_15_token->mpp_pkcs_15_objects[i]);
+                free(p_pkcs_15_token->mpp_pkcs_15_objects[i]);
                 p_pkcs_15_token->mpp_pkcs_15_objects[i] = NULL;
             }
             free(p_pkcs_15_token->mpp_pkcs_15_objects);
@@ -1016,6 +1519,8 @@ void free_pkcs_15_object(s_pkcs_15_object *p_object) {
         {
             case SEC_KEY:
                 pcks_15_free_gost_sec_key(p_object->m_obj.mp_sec_key);
+                free(p_object->m_obj.mp_sec_key);
+                p_object->m_obj.mp_sec_key = NULL;
                 break;
             case PRI_KEY:
                 break;
@@ -77,22 +77,47 @@ typedef struct {
     /*! \brief массив указателей на информацию о выработке ключа KEK */
     s_key_management_info **mpp_key_infos;
     /*! \brief количество элементов в массиве mpp_key_infos */
-    uint8_t m_info_size;
+    ak_uint8 m_info_size;
     /*! \brief массив указателей на объекты PKCS 15 Objects */
     s_pkcs_15_object **mpp_pkcs_15_objects;
     /*! \brief количество элементов в массиве mpp_pkcs_15_objects */
-    uint8_t m_obj_size;
+    ak_uint8 m_obj_size;
 } s_pkcs_15_token;
 
+/*! \brief Структура, хранящая смещения (от начала DER последовательности) блоков контейнера. */
+typedef struct {
+    /*! \brief начало содержимого контейнера (сразу после тега и длины) */
+    size_t m_body_begin;
+    /*! \brief конец содержимого контейнера */
+    size_t m_body_end;
+    /*! \brief начало блока PKCS 15 Objects (тег) */
+    size_t m_objs_begin;
+    /*! \brief начало содержимого блока PKCS 15 Objects */
+    size_t m_objs_value;
+    /*! \brief конец блока PKCS 15 Objects */
+    size_t m_objs_end;
+    /*! \brief количество объектов в контейнере */
+    size_t m_obj_count;
+    /*! \brief флаг, определяющий наличие объекта с заданным идентификатором */
+    bool_t m_found;
+    /*! \brief начало найденного объекта (тег) */
+    size_t m_obj_begin;
+    /*! \brief конец найденного объекта */
+    size_t m_obj_end;
+} s_pkcs_15_token_layout;
+
 /** Методы добавления данных **/
 
 /*! \brief Метод по сбору контейнера в DER последовательность. */
 int pkcs_15_generate_token(s_pkcs_15_token *p_pkcs_15_token, ak_byte **pp_data, size_t *p_size);
 
+/*! \brief Кодирование блоков контейнера, предшествующих содержимому последовательности PKCS 15 Objects. */
+int pkcs_15_generate_token_header(s_pkcs_15_token *p_pkcs_15_token, size_t objs_len, ak_byte **pp_data, size_t *p_size);
+
 /*! \brief Добавление объектов в DER последовательность. */
 int pkcs_15_put_pkcs_objects(s_der_buffer *p_pkcs_15_token_der,
                              s_pkcs_15_object **pp_pkcs_15_objects,
-                             int8_t size,
+                             ak_uint8 size,
                              s_der_buffer *p_pkcs_15_object_der);
 
 /*! \brief Добавление конкретного объекта в DER последовательность. */
@@ -119,17 +144,41 @@ int pkcs_15_put_alg_id(s_der_buffer *p_pkcs_15_token_der, s_pwd_info *p_pwd_info
 /*! \brief Добавление информации о параметрах алгоритма PBKDF2 в DER последовательность. */
 int pkcs_15_put_params_pbkdf2(s_der_buffer *p_pkcs_15_token_der, s_pwd_info *p_pwd_info, s_der_buffer *p_parameters_der);
 
+/*! \brief Кодирование одного объекта PKCS15Object в отдельную DER последовательность. */
+int pkcs_15_encode_obj(s_pkcs_15_object *p_pkcs_15_object, ak_byte **pp_data, size_t *p_size);
+
+/*! \brief Замена фрагмента последовательности PKCS 15 Objects с пересчетом длин охватывающих блоков. */
+int pkcs_15_splice_token(ak_byte *p_data, s_pkcs_15_token_layout *p_layout, size_t cut_begin, size_t cut_end,
+                         const ak_byte *p_ins, size_t ins_size, ak_byte **pp_out, size_t *p_out_size);
+
 /** Методы декодирования данных **/
 
 /*! \brief Метод по разбору DER последовательности, представляющую контейнер ключевой информации. */
 int pkcs_15_parse_token(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token);
 
+/*! \brief Метод по разбору только общих атрибутов объектов контейнера (без расшифрования ключей). */
+int pkcs_15_parse_token_attrs(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token);
+
+/*! \brief Метод по разбору информации о ключе KEK и единственного объекта с заданным идентификатором. */
+int pkcs_15_parse_token_obj_by_id(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token,
+                                  const ak_byte *p_id, size_t id_size);
+
+/*! \brief Метод по разбору информации о ключе KEK и единственного объекта с заданным смещением. */
+int pkcs_15_parse_token_obj_at(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token, size_t offset);
+
+/*! \brief Метод по разбору информации о ключе KEK и определению смещений блоков контейнера. */
+int pkcs_15_get_token_layout(ak_byte *p_data, size_t size, s_pkcs_15_token *p_pkcs_15_token,
+                             const ak_byte *p_id, size_t id_size, s_pkcs_15_token_layout *p_layout);
+
 /*! \brief Декодирование объектов контейнера из DER последовательности. */
 int pkcs_15_get_pkcs_objects(s_der_buffer *p_pkcs_15_token_der, s_pkcs_15_token *p_pkcs_15_token);
 
 /*! \brief Декодирование конкретного объекта из DER последовательности. */
 int pkcs_15_get_obj(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkcs_15_object);
 
+/*! \brief Декодирование только общих атрибутов конкретного объекта из DER последовательности. */
+int pkcs_15_get_obj_attrs(s_der_buffer *p_pkcs_15_objects_der, s_pkcs_15_object *p_pkcs_15_object);
+
 /*! \brief Декодирование объекта,представленного в открытом виде, из DER последовательности. */
 int pkcs_15_get_direct_obj(s_der_buffer *p_pkcs_15_object_der, s_pkcs_15_object *p_pkcs_15_object);
 
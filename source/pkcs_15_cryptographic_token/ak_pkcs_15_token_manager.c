@@ -1,3 +1,10 @@
+/* это объявление нужно для использования функции ftruncate() */
+#ifdef __linux__
+ #ifndef _POSIX_C_SOURCE
+   #define _POSIX_C_SOURCE 200112L
+ #endif
+#endif
+
 #ifdef LIBAKRYPT_HAVE_STDLIB_H
 #include <stdlib.h>
 #else
@@ -13,10 +20,23 @@
 #else
 #error Library cannot be compiled without stdio.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_TIME_H
+#include <time.h>
+#else
+#error Library cannot be compiled without time.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include "ak_pkcs_15_token_manager.h"
 #include <assert.h>
 
+#include <ak_hash.h>
+#include <ak_hmac.h>
 #include <ak_tools.h>
 
 const object_identifier ALGORITHM_PBKDF2 = {"1.2.840.113549.1.5.12"};
@@ -28,6 +48,38 @@ const object_identifier CONTENT_TYPE = {"1.2.840.113549.1.7.1"};
 const object_identifier CONTENT_ENG_ALGORITHM = {"1.2.643.2.4.3.2.2"};
 const object_identifier CRYPTO_PRO_PARAM_A = {"1.2.643.2.2.31.1"};
 
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/*! \brief Мьютекс, защищающий генератор ключей менеджера контекстов при параллельной
+           обработке объектов контейнера. */
+static pthread_mutex_t pkcs_15_key_generator_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*! \brief Мьютекс, защищающий кэш ключей KEK. */
+static pthread_mutex_t pkcs_15_kek_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/*! \brief Количество записей в кэше ключей KEK. */
+#define PKCS_15_KEK_CACHE_SIZE 16
+
+/*! \brief Струкртура, хранящая запись кэша ключей KEK. */
+struct pkcs_15_kek_cache_entry {
+    /*! \brief имитовставка от пароля и параметров алгоритма выработки ключа */
+    ak_byte digest[32];
+    /*! \brief момент времени, после которого запись недействительна */
+    time_t expires;
+    /*! \brief флаг, определяющий, что запись содержит ключ */
+    bool_t used;
+    /*! \brief ключ KEK (хранится в маскированном виде) */
+    struct bckey kek;
+};
+
+/*! \brief Кэш ключей KEK, выработанных из пароля. */
+static struct pkcs_15_kek_cache_entry pkcs_15_kek_cache[PKCS_15_KEK_CACHE_SIZE];
+
+/*! \brief Ключ алгоритма HMAC, используемый для вычисления имитовставок записей кэша ключей KEK;
+           вырабатывается случайно при первом использовании кэша и не покидает процесс. */
+static struct hmac pkcs_15_kek_cache_hmac;
+/*! \brief Флаг, определяющий, что контекст ключа pkcs_15_kek_cache_hmac создан. */
+static bool_t pkcs_15_kek_cache_hmac_created = ak_false;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param p_asn_1_bool указатель на переменную, в которую запишется значение
     @param val значение, которое нужно записать
@@ -117,10 +169,10 @@ int set_asn_object_identifier(object_identifier *p_asn_1_object_identifier, cons
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int set_asn_integer(integer *p_asn_int, int32_t val) {
+int set_asn_integer(integer *p_asn_int, ak_int32 val) {
 
     ak_byte *p_val;
-    int32_t val_len;
+    ak_int32 val_len;
 
     if (!p_asn_int)
         return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
@@ -138,7 +190,7 @@ int set_asn_integer(integer *p_asn_int, int32_t val) {
 
     if (p_asn_int->m_positive)
     {
-        int8_t i = sizeof(val) - 1;
+        ak_int8 i = sizeof(val) - 1;
         while (!((val >> (i * 8u)) & 0xFF) && (i >= 0))
         {
             val_len = p_asn_int->m_val_len -= 1;
@@ -148,7 +200,7 @@ int set_asn_integer(integer *p_asn_int, int32_t val) {
     else
     {
         // todo допилить реализацию добавления отрицательного числа
-        //int8_t i = sizeof(val) - 1;
+        //ak_int8 i = sizeof(val) - 1;
         while ((((val >> ((val_len - 1) * 8u)) & 0xFF) == 0xFF) && (val_len - 1 >= 0))
         {
             val_len = p_asn_int->m_val_len -= 1;
@@ -177,7 +229,7 @@ int set_asn_integer(integer *p_asn_int, int32_t val) {
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int set_asn_bit_string(bit_string *p_asn_1_bit_string, const ak_byte *p_val, uint32_t size, uint8_t num_of_unused_bits) {
+int set_asn_bit_string(bit_string *p_asn_1_bit_string, const ak_byte *p_val, ak_uint32 size, ak_uint8 num_of_unused_bits) {
 
     if (!p_asn_1_bit_string || !p_val || (size <= 0) || (num_of_unused_bits <= 0))
         return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
@@ -198,7 +250,7 @@ int set_asn_bit_string(bit_string *p_asn_1_bit_string, const ak_byte *p_val, uin
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int set_asn_octet_string(octet_string *p_asn_1_octet_string, const ak_byte *p_val, uint32_t size) {
+int set_asn_octet_string(octet_string *p_asn_1_octet_string, const ak_byte *p_val, ak_uint32 size) {
 
     if (!p_asn_1_octet_string || !p_val || (size <= 0))
         return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
@@ -382,7 +434,7 @@ int generate_random_bytes(octet_string *p_data, const size_t size) {
 
     p_context = ak_libakrypt_get_context_manager();
 
-    p_data->mp_value = malloc(size * sizeof(p_data->mp_value));
+    p_data->mp_value = malloc(size);
     p_data->m_val_len = size;
 
     if (!p_data->mp_value)
@@ -390,8 +442,15 @@ int generate_random_bytes(octet_string *p_data, const size_t size) {
         return ak_error_message(ak_error_null_pointer, __func__, "null value");
     }
 
-    if ((error = (p_context->key_generator.random(&p_context->key_generator, p_data->mp_value, p_data->m_val_len)))
-        != ak_error_ok)
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_key_generator_mutex);
+#endif
+    error = p_context->key_generator.random(&p_context->key_generator, p_data->mp_value, p_data->m_val_len);
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_key_generator_mutex);
+#endif
+
+    if (error != ak_error_ok)
     {
         return ak_error_message(error, __func__, "error in generating random bytes");
     }
@@ -399,6 +458,278 @@ int generate_random_bytes(octet_string *p_data, const size_t size) {
     return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция ak_bckey_context_create_and_set_bckey() перемаскирует исходный ключ, поэтому копии
+    создаются последовательно (до запуска потоков или под защитой мьютекса кэша). Уникальный номер
+    ключа также копируется, поскольку он помещается в контейнер в качестве идентификатора ключа KEK.
+
+    @param p_kek указатель на копию ключа
+    @param p_src указатель на исходный ключ KEK
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_clone_kek(ak_bckey p_kek, ak_bckey p_src) {
+    int error;
+
+    if ((error = ak_bckey_context_create_and_set_bckey(p_kek, p_src)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with cloning of kek");
+
+    if ((error = ak_buffer_set_ptr(&p_kek->key.number, p_src->key.number.data, p_src->key.number.size, ak_true)) != ak_error_ok)
+    {
+        ak_bckey_context_destroy(p_kek);
+        return ak_error_message(error, __func__, "problem with copying of kek number");
+    }
+
+    return ak_error_ok;
+}
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_entry указатель на запись кэша                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+static void pkcs_15_kek_cache_release(struct pkcs_15_kek_cache_entry *p_entry) {
+    if (p_entry->used)
+        ak_bckey_context_destroy(&p_entry->kek);
+    if (pkcs_15_kek_cache_hmac_created)
+        ak_ptr_wipe(p_entry->digest, sizeof(p_entry->digest), &pkcs_15_kek_cache_hmac.key.generator, ak_true);
+    memset(p_entry, 0, sizeof(struct pkcs_15_kek_cache_entry));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается под защитой мьютекса кэша. При первом вызове создается контекст алгоритма
+    HMAC со случайным ключом. При исчерпании ресурса ключ заменяется новым случайным значением,
+    а все записи кэша, имитовставки которых вычислены на прежнем ключе, удаляются.
+
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_kek_cache_prepare_hmac(void) {
+    int error;
+    size_t i;
+    ak_context_manager p_context;
+
+    if (pkcs_15_kek_cache_hmac_created && pkcs_15_kek_cache_hmac.key.resource.value.counter > 1)
+        return ak_error_ok;
+
+    for (i = 0; i < PKCS_15_KEK_CACHE_SIZE; i++)
+        pkcs_15_kek_cache_release(&pkcs_15_kek_cache[i]);
+    if (!pkcs_15_kek_cache_hmac_created)
+    {
+        if ((error = ak_hmac_context_create_streebog256(&pkcs_15_kek_cache_hmac)) != ak_error_ok)
+            return ak_error_message(error, __func__, "problem with creation of hmac context");
+        pkcs_15_kek_cache_hmac_created = ak_true;
+    }
+
+    p_context = ak_libakrypt_get_context_manager();
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_key_generator_mutex);
+#endif
+    error = ak_hmac_context_set_key_random(&pkcs_15_kek_cache_hmac, &p_context->key_generator);
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_key_generator_mutex);
+#endif
+    if (error != ak_error_ok)
+    {
+        ak_hmac_context_destroy(&pkcs_15_kek_cache_hmac);
+        pkcs_15_kek_cache_hmac_created = ak_false;
+        return ak_error_message(error, __func__, "problem with generation of hmac key");
+    }
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Имитовставка вычисляется от пароля и всех параметров, влияющих на результат алгоритма PBKDF2,
+    поэтому ключ из кэша используется только для контейнеров с теми же солью, числом итераций,
+    длиной ключа и алгоритмом HMAC. Для вычисления используется алгоритм HMAC-Streebog256 со
+    случайным ключом, известным только данному процессу, поэтому значение, хранящееся в кэше,
+    не позволяет проверять предполагаемые пароли, минуя трудоемкий алгоритм PBKDF2.
+
+    @param password пароль
+    @param pwd_len длина пароля
+    @param p_pwd_info указатель на параметры алгоритма выработки ключа из пароля
+    @param iteration_cnt количество итераций
+    @param key_len длина вырабатываемого ключа
+    @param digest массив, в который помещается имитовставка (32 октета)
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_kek_cache_digest(ak_pointer password, size_t pwd_len, s_pwd_info *p_pwd_info,
+                                    ak_int64 iteration_cnt, ak_int64 key_len, ak_byte *digest) {
+    int error;
+    ak_byte *p_buff, *p_curr;
+    size_t oid_len, size;
+    ak_context_manager p_context;
+
+    oid_len = strlen(p_pwd_info->m_prf_id);
+    size = 3 * sizeof(ak_uint64) + pwd_len + p_pwd_info->m_salt.m_val_len + sizeof(ak_int64) + oid_len;
+    if ((p_buff = malloc(size)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+
+    /* Поля переменной длины предваряются длиной, чтобы исключить неоднозначность разбиения */
+    p_curr = p_buff;
+    *(ak_uint64 *) p_curr = (ak_uint64) pwd_len;
+    p_curr += sizeof(ak_uint64);
+    memcpy(p_curr, password, pwd_len);
+    p_curr += pwd_len;
+    *(ak_uint64 *) p_curr = (ak_uint64) p_pwd_info->m_salt.m_val_len;
+    p_curr += sizeof(ak_uint64);
+    memcpy(p_curr, p_pwd_info->m_salt.mp_value, p_pwd_info->m_salt.m_val_len);
+    p_curr += p_pwd_info->m_salt.m_val_len;
+    *(ak_int64 *) p_curr = iteration_cnt;
+    p_curr += sizeof(ak_int64);
+    *(ak_int64 *) p_curr = key_len;
+    p_curr += sizeof(ak_int64);
+    memcpy(p_curr, p_pwd_info->m_prf_id, oid_len);
+
+    /* Контекст HMAC не допускает одновременного использования несколькими потоками */
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_kek_cache_mutex);
+#endif
+    if ((error = pkcs_15_kek_cache_prepare_hmac()) == ak_error_ok)
+    {
+        ak_hmac_context_ptr(&pkcs_15_kek_cache_hmac, p_buff, size, digest);
+        error = ak_error_get_value();
+    }
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_kek_cache_mutex);
+#endif
+
+    /* Буфер содержит пароль в открытом виде */
+    p_context = ak_libakrypt_get_context_manager();
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_key_generator_mutex);
+#endif
+    ak_ptr_wipe(p_buff, size, &p_context->key_generator, ak_true);
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_key_generator_mutex);
+#endif
+    free(p_buff);
+
+    if (error != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with hashing of password info");
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param digest имитовставка, вычисленная функцией pkcs_15_kek_cache_digest()                   */
+/* ----------------------------------------------------------------------------------------------- */
+static void pkcs_15_kek_cache_wipe_digest(ak_byte *digest) {
+    ak_context_manager p_context = ak_libakrypt_get_context_manager();
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_key_generator_mutex);
+#endif
+    ak_ptr_wipe(digest, 32, &p_context->key_generator, ak_true);
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_key_generator_mutex);
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Если действующая запись найдена, то контекст p_key пересоздается как копия ключа из кэша.
+    Просроченные записи удаляются из кэша при поиске.
+
+    @param digest хеш-код от пароля и параметров алгоритма выработки ключа
+    @param p_key указатель на созданный контекст ключа KEK
+    @return Функция возвращает ak_true, если ключ взят из кэша.                                    */
+/* ----------------------------------------------------------------------------------------------- */
+static bool_t pkcs_15_kek_cache_get(const ak_byte *digest, ak_bckey p_key) {
+    size_t i;
+    bool_t found = ak_false;
+    time_t now = time(NULL);
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_kek_cache_mutex);
+#endif
+    for (i = 0; i < PKCS_15_KEK_CACHE_SIZE; i++)
+    {
+        struct pkcs_15_kek_cache_entry *p_entry = &pkcs_15_kek_cache[i];
+
+        if (!p_entry->used)
+            continue;
+        if (p_entry->expires <= now)
+        {
+            pkcs_15_kek_cache_release(p_entry);
+            continue;
+        }
+        if (!found && !memcmp(p_entry->digest, digest, sizeof(p_entry->digest)))
+        {
+            ak_bckey_context_destroy(p_key);
+            if (pkcs_15_clone_kek(p_key, &p_entry->kek) == ak_error_ok)
+                found = ak_true;
+            else
+                ak_bckey_context_create_magma(p_key);
+        }
+    }
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_kek_cache_mutex);
+#endif
+
+    return found;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! При отсутствии свободных записей вытесняется запись с наименьшим сроком действия.
+
+    @param digest хеш-код от пароля и параметров алгоритма выработки ключа
+    @param p_key указатель на выработанный ключ KEK
+    @param ttl время жизни записи в секундах                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+static void pkcs_15_kek_cache_put(const ak_byte *digest, ak_bckey p_key, ak_int64 ttl) {
+    size_t i;
+    struct pkcs_15_kek_cache_entry *p_victim = &pkcs_15_kek_cache[0];
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_kek_cache_mutex);
+#endif
+    for (i = 0; i < PKCS_15_KEK_CACHE_SIZE; i++)
+    {
+        struct pkcs_15_kek_cache_entry *p_entry = &pkcs_15_kek_cache[i];
+
+        if (!p_entry->used || !memcmp(p_entry->digest, digest, sizeof(p_entry->digest)))
+        {
+            p_victim = p_entry;
+            break;
+        }
+        if (p_entry->expires < p_victim->expires)
+            p_victim = p_entry;
+    }
+
+    pkcs_15_kek_cache_release(p_victim);
+    if (pkcs_15_clone_kek(&p_victim->kek, p_key) == ak_error_ok)
+    {
+        memcpy(p_victim->digest, digest, sizeof(p_victim->digest));
+        p_victim->expires = time(NULL) + (time_t) ttl;
+        p_victim->used = ak_true;
+    }
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_kek_cache_mutex);
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция уничтожает все ключи, хранящиеся в кэше, независимо от их срока действия, а также
+    ключ алгоритма HMAC, использованный для вычисления имитовставок записей кэша.
+    Вызывается также при деинициализации библиотеки.                                               */
+/* ----------------------------------------------------------------------------------------------- */
+void pkcs_15_kek_cache_purge(void) {
+    size_t i;
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_kek_cache_mutex);
+#endif
+    for (i = 0; i < PKCS_15_KEK_CACHE_SIZE; i++)
+        pkcs_15_kek_cache_release(&pkcs_15_kek_cache[i]);
+    if (pkcs_15_kek_cache_hmac_created)
+    {
+        ak_hmac_context_destroy(&pkcs_15_kek_cache_hmac);
+        pkcs_15_kek_cache_hmac_created = ak_false;
+    }
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_kek_cache_mutex);
+#endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param p_key указатель на переменную, в которую запишется значение ключа KEK
     @param password пароль, из которого вырабатывается ключ
@@ -411,6 +742,8 @@ static int pkcs_15_kek_generator(ak_bckey p_key, ak_pointer password, size_t pwd
     int error;
     ak_int64 iteration_cnt;
     ak_int64 key_len;
+    ak_int64 cache_ttl;
+    ak_byte digest[32];
     s_pwd_info *p_pwd_info;
 
     if (p_kmi->m_type != PWD_INFO)
@@ -440,21 +773,41 @@ static int pkcs_15_kek_generator(ak_bckey p_key, ak_pointer password, size_t pwd
 //    if((error = ak_skey_context_create(p_key, (size_t)key_len, 8)) != ak_error_ok)
 //        return ak_error_message(error, __func__, "can't create secret key context");
 
-    /* Присваиваем ключу идентификатор, указанный в поле keyId структуры KeyManagementInfo */
-    set_key_id(p_kmi->m_key_id, &p_key->key);
-
     /* Устанвливаем кол-во итераций */
     if ((error = asn_integer_to_int64(&p_pwd_info->m_iteration_count, &iteration_cnt)) != ak_error_ok)
         return ak_error_message(error, __func__, "can't get iteration count");
 
-    if ((error = ak_libakrypt_set_option("pbkdf2_iteration_count", iteration_cnt)) != ak_error_ok)
-        return ak_error_message(error, __func__, "can't set iteration count value");
+    /* Ищем ключ в кэше, если его использование разрешено */
+    cache_ttl = ak_libakrypt_get_option("pkcs_15_kek_cache_ttl");
+    if (cache_ttl > 0)
+    {
+        if ((error = pkcs_15_kek_cache_digest(password, pwd_len, p_pwd_info, iteration_cnt, key_len, digest)) != ak_error_ok)
+            return ak_error_message(error, __func__, "can't get password info digest");
+
+        if (pkcs_15_kek_cache_get(digest, p_key))
+        {
+            pkcs_15_kek_cache_wipe_digest(digest);
+            /* Присваиваем ключу идентификатор, указанный в поле keyId структуры KeyManagementInfo */
+            set_key_id(p_kmi->m_key_id, &p_key->key);
+            return ak_error_ok;
+        }
+    }
+
+    /* Присваиваем ключу идентификатор, указанный в поле keyId структуры KeyManagementInfo */
+    set_key_id(p_kmi->m_key_id, &p_key->key);
 
     /* Генерируем ключ */
-    if ((error = ak_bckey_context_set_key_from_password(p_key, password, pwd_len, p_pwd_info->m_salt.mp_value, p_pwd_info->m_salt.m_val_len)) != ak_error_ok)
-        return ak_error_message(error, __func__, "can't create key from password");
+    if ((error = ak_libakrypt_set_option("pbkdf2_iteration_count", iteration_cnt)) != ak_error_ok)
+        ak_error_message(error, __func__, "can't set iteration count value");
+    else if ((error = ak_bckey_context_set_key_from_password(p_key, password, pwd_len, p_pwd_info->m_salt.mp_value, p_pwd_info->m_salt.m_val_len)) != ak_error_ok)
+        ak_error_message(error, __func__, "can't create key from password");
+    else if (cache_ttl > 0)
+        pkcs_15_kek_cache_put(digest, p_key, cache_ttl);
 
-    return ak_error_ok;
+    if (cache_ttl > 0)
+        pkcs_15_kek_cache_wipe_digest(digest);
+
+    return error;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -481,7 +834,7 @@ static int fill_enveloped_data(ak_skey sec_key, s_enveloped_data *p_enveloped_da
     struct buffer encrypted_key_der;
     s_recipient_info **recipient_infos;
     s_recipient_info *recipient_info;
-    uint8_t recipient_infos_size;
+    ak_uint8 recipient_infos_size;
 
     // Пример заполнения mac и ukm
     for (int i = 0; i < 4; ++i)
@@ -514,7 +867,15 @@ static int fill_enveloped_data(ak_skey sec_key, s_enveloped_data *p_enveloped_da
 
     p_context = ak_libakrypt_get_context_manager();
 
-    if ((error = ak_bckey_context_set_key_random(&cek, &p_context->key_generator)) != ak_error_ok)
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_lock(&pkcs_15_key_generator_mutex);
+#endif
+    error = ak_bckey_context_set_key_random(&cek, &p_context->key_generator);
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock(&pkcs_15_key_generator_mutex);
+#endif
+
+    if (error != ak_error_ok)
     {
         return ak_error_message(error, __func__, "problem with cek generation");
     }
@@ -565,6 +926,7 @@ static int fill_enveloped_data(ak_skey sec_key, s_enveloped_data *p_enveloped_da
     }
 
     set_asn_octet_string(&p_content_enc_prms->m_iv, iv.mp_value, iv.m_val_len);
+    free(iv.mp_value);
     set_asn_object_identifier(&p_content_enc_prms->m_encryption_param_set, CRYPTO_PRO_PARAM_A);
 
     p_enveloped_data->m_prm_set_type = GOST_CONTENT_ENC_SET;
@@ -794,6 +1156,8 @@ static int decrypt_content_enc_key(s_recipient_info *p_recipient_info, ak_skey p
 
     memcpy((ak_byte *) p_cek->key.data, (ak_byte *) encrypted_cek.data, encrypted_cek.size / 2);
     memcpy((ak_byte *) p_cek->mask.data, (ak_byte *) encrypted_cek.data + encrypted_cek.size / 2, encrypted_cek.size / 2);
+    ak_buffer_destroy(&encrypted_cek);
+    ak_buffer_destroy(&encrypted_cek_mac);
 
     /* Устанавливаем флаги наличия ключа и маски */
     p_cek->flags |= skey_flag_set_key | skey_flag_set_mask;
@@ -840,16 +1204,6 @@ static int decrypt_enveloped_data(s_enveloped_data *p_enveloped_data, ak_skey p_
                                 __func__,
                                 "encrypted_content encryption algorithm identifier absent");
 
-    if (strcmp(p_enveloped_data->m_content_enc_alg_id, "1.2.643.2.4.3.2.2") == 0)
-        ak_bckey_context_create_magma(&cek);
-    else if (strcmp(p_enveloped_data->m_content_enc_alg_id, "1.2.643.2.4.3.2.3") == 0)
-        ak_bckey_context_create_kuznechik(&cek);
-    else
-        return ak_error_message_fmt(ak_error_invalid_value,
-                                    __func__,
-                                    "this algorithm ('%s') doesn't support",
-                                    p_enveloped_data->m_content_enc_alg_id);
-
     /* Устанавливаем параметры шифрования */
     if (p_enveloped_data->m_prm_set_type != GOST_CONTENT_ENC_SET)
         return ak_error_message(ak_error_invalid_value, __func__, "only CryptoPro parameters support");
@@ -860,17 +1214,32 @@ static int decrypt_enveloped_data(s_enveloped_data *p_enveloped_data, ak_skey p_
     if (!p_content_enc_prms->m_iv.mp_value)
         return ak_error_message(ak_error_invalid_value, __func__, "initialization vector absent");
 
+    if (strcmp(p_enveloped_data->m_content_enc_alg_id, "1.2.643.2.4.3.2.2") == 0)
+        ak_bckey_context_create_magma(&cek);
+    else if (strcmp(p_enveloped_data->m_content_enc_alg_id, "1.2.643.2.4.3.2.3") == 0)
+        ak_bckey_context_create_kuznechik(&cek);
+    else
+        return ak_error_message_fmt(ak_error_invalid_value,
+                                    __func__,
+                                    "this algorithm ('%s') doesn't support",
+                                    p_enveloped_data->m_content_enc_alg_id);
+
     ak_buffer_create(&iv);
     ak_buffer_set_ptr(&iv, p_content_enc_prms->m_iv.mp_value, p_content_enc_prms->m_iv.m_val_len, ak_true);
+    ak_buffer_create(&encrypted_content);
+    ak_buffer_create(&encrypted_content_mac);
 
     /* Расшифровываем ключ шифрования контента (CEK) */
     if ((error = decrypt_content_enc_key(p_enveloped_data->mpp_recipient_infos[0], p_kek, &cek.key)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problem with decrypting CEK");
+    {
+        ak_error_message(error, __func__, "problem with decrypting CEK");
+        goto exit;
+    }
 
     /* Расшифровываем контент */
-    ak_buffer_create_size(&encrypted_content, p_enveloped_data->m_encrypted_content.m_val_len - 4);
+    ak_buffer_set_size(&encrypted_content, p_enveloped_data->m_encrypted_content.m_val_len - 4);
     memcpy(encrypted_content.data, p_enveloped_data->m_encrypted_content.mp_value, encrypted_content.size);
-    ak_buffer_create_size(&encrypted_content_mac, 4);
+    ak_buffer_set_size(&encrypted_content_mac, 4);
     memcpy(encrypted_content_mac.data, p_enveloped_data->m_encrypted_content.mp_value + encrypted_content.size, encrypted_content_mac.size);
 
     /*TODO: комментарий для Алексея Юрьевича: здесь необходимо вызвать
@@ -878,23 +1247,38 @@ static int decrypt_enveloped_data(s_enveloped_data *p_enveloped_data, ak_skey p_
 
     /* Переносим значение ключа, маски, счетчика в структуру skey */
     if ((error = pkcs_15_parse_gost_key_value_mask(&encrypted_content, &p_libakrypt_key->key, &p_libakrypt_key->mask, &p_libakrypt_key->resource.value.counter)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problem with parsing key value mask");
+    {
+        ak_error_message(error, __func__, "problem with parsing key value mask");
+        goto exit;
+    }
 
     /* Устанавливаем флаги наличия ключа и маски */
     p_libakrypt_key->flags |= skey_flag_set_key | skey_flag_set_mask;
 
     /* Перемаскируем ключ */
     if ((error = p_libakrypt_key->set_mask(p_libakrypt_key)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problem with key remasking");
+    {
+        ak_error_message(error, __func__, "problem with key remasking");
+        goto exit;
+    }
 
     /* Вычисляем контрольную сумму ключа */
     if ((error = p_libakrypt_key->set_icode(p_libakrypt_key)) != ak_error_ok)
-        return ak_error_message(error, __func__, "problem with setting icode");
+    {
+        ak_error_message(error, __func__, "problem with setting icode");
+        goto exit;
+    }
 
     /* Устанавливаем флаг наличия контрольной суммы */
     p_libakrypt_key->flags |= skey_flag_set_icode;
 
-    return ak_error_ok;
+exit:
+    ak_buffer_destroy(&encrypted_content);
+    ak_buffer_destroy(&encrypted_content_mac);
+    ak_buffer_destroy(&iv);
+    ak_bckey_context_destroy(&cek);
+
+    return error;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -956,11 +1340,225 @@ static int get_extended_key(s_pkcs_15_object *p_obj, struct skey *p_kek, struct
         return ak_error_message(error, __func__, "problem with decrypting enveloped data");
     }
 
+    /* Вырабатываем раундовые ключи, поскольку значение ключа установлено в обход функций ak_bckey_context_set_key*() */
+    if (p_libakrypt_sec_key->schedule_keys != NULL)
+    {
+        if ((error = p_libakrypt_sec_key->schedule_keys(&p_libakrypt_sec_key->key)) != ak_error_ok)
+        {
+            ak_bckey_context_destroy(p_libakrypt_sec_key);
+            return ak_error_message(error, __func__, "problem with key scheduling");
+        }
+    }
+
     p_key->key.sec_key = p_libakrypt_sec_key;
 
     return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обработки одного объекта контейнера.
+
+    Функции передаются общий контекст задачи, собственная копия ключа KEK потока
+    и номер обрабатываемого объекта.                                                               */
+typedef int (*pkcs_15_task_function)(ak_pointer, ak_bckey, size_t);
+
+/*! \brief Структура, описывающая набор независимых задач, выполняемых пулом потоков. */
+struct pkcs_15_pool {
+    /*! \brief функция обработки одного объекта */
+    pkcs_15_task_function task;
+    /*! \brief общий контекст задачи */
+    ak_pointer ctx;
+    /*! \brief ключ KEK, копии которого используются потоками */
+    ak_bckey kek;
+    /*! \brief общее количество объектов */
+    size_t count;
+    /*! \brief номер следующего необработанного объекта */
+    size_t next;
+    /*! \brief первая возникшая ошибка */
+    int error;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    /*! \brief мьютекс, защищающий поля next и error */
+    pthread_mutex_t mutex;
+#endif
+};
+
+/*! \brief Контекст параллельного расшифрования объектов контейнера. */
+struct pkcs_15_unwrap_ctx {
+    /*! \brief разобранный контейнер */
+    s_pkcs_15_token *p_token;
+    /*! \brief массив, в i-й элемент которого помещается i-й расшифрованный объект */
+    struct extended_key **pp_keys;
+};
+
+/*! \brief Контекст параллельного формирования объектов контейнера. */
+struct pkcs_15_wrap_ctx {
+    /*! \brief формируемый контейнер */
+    s_pkcs_15_token *p_token;
+    /*! \brief массив ключей, помещаемых в контейнер */
+    struct extended_key **pp_keys;
+};
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/*! \brief Параметры одного потока пула. */
+struct pkcs_15_pool_worker_arg {
+    /*! \brief общий набор задач */
+    struct pkcs_15_pool *p_pool;
+    /*! \brief собственная копия ключа KEK потока */
+    struct bckey kek;
+    /*! \brief идентификатор потока */
+    pthread_t thread;
+};
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Поток обрабатывает объекты до тех пор, пока они не закончатся или не возникнет ошибка.
+    Для шифрования используется собственная копия ключа KEK, поскольку контекст блочного
+    шифра не допускает одновременного использования несколькими потоками.
+
+    @param arg указатель на структуру struct pkcs_15_pool_worker_arg
+    @return Функция всегда возвращает NULL.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+static void *pkcs_15_pool_worker(void *arg) {
+    int error;
+    size_t idx;
+    struct pkcs_15_pool_worker_arg *p_arg = (struct pkcs_15_pool_worker_arg *) arg;
+    struct pkcs_15_pool *p_pool = p_arg->p_pool;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&p_pool->mutex);
+        if (p_pool->error != ak_error_ok || p_pool->next >= p_pool->count)
+        {
+            pthread_mutex_unlock(&p_pool->mutex);
+            break;
+        }
+        idx = p_pool->next++;
+        pthread_mutex_unlock(&p_pool->mutex);
+
+        if ((error = p_pool->task(p_pool->ctx, &p_arg->kek, idx)) != ak_error_ok)
+        {
+            pthread_mutex_lock(&p_pool->mutex);
+            if (p_pool->error == ak_error_ok)
+                p_pool->error = error;
+            pthread_mutex_unlock(&p_pool->mutex);
+        }
+    }
+
+    return NULL;
+}
+
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Количество потоков определяется опцией библиотеки `pkcs_15_threads_count`; нулевое значение
+    опции означает количество доступных процессоров. Если используется один поток (или библиотека
+    собрана без поддержки pthread), то объекты обрабатываются последовательно с ключом p_kek.
+
+    @param task функция обработки одного объекта
+    @param ctx общий контекст задачи
+    @param p_kek ключ KEK
+    @param count количество объектов
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код первой возникшей ошибки.                                  */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_pool_run(pkcs_15_task_function task, ak_pointer ctx, ak_bckey p_kek, size_t count) {
+    int error;
+    size_t i;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+    size_t threads_count;
+    size_t cloned;
+    size_t started;
+    struct pkcs_15_pool_worker_arg *p_args;
+    struct pkcs_15_pool pool;
+
+    threads_count = (size_t) ak_libakrypt_get_option("pkcs_15_threads_count");
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+    if (threads_count == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads_count = cpus > 0 ? (size_t) cpus : 1;
+    }
+#endif
+    if (threads_count > count)
+        threads_count = count;
+
+    if (threads_count > 1 && (p_args = calloc(threads_count, sizeof(struct pkcs_15_pool_worker_arg))) != NULL)
+    {
+        pool.task = task;
+        pool.ctx = ctx;
+        pool.kek = p_kek;
+        pool.count = count;
+        pool.next = 0;
+        pool.error = ak_error_ok;
+        pthread_mutex_init(&pool.mutex, NULL);
+
+        /* Создаем копии ключа KEK и запускаем потоки; при нехватке ресурсов
+           используется то количество потоков, которое удалось создать */
+        for (cloned = 0; cloned < threads_count; cloned++)
+        {
+            p_args[cloned].p_pool = &pool;
+            if (pkcs_15_clone_kek(&p_args[cloned].kek, p_kek) != ak_error_ok)
+                break;
+        }
+
+        for (started = 0; started < cloned; started++)
+        {
+            if (pthread_create(&p_args[started].thread, NULL, pkcs_15_pool_worker, &p_args[started]) != 0)
+                break;
+        }
+
+        if (started)
+        {
+            for (i = 0; i < started; i++)
+                pthread_join(p_args[i].thread, NULL);
+        }
+
+        for (i = 0; i < cloned; i++)
+            ak_bckey_context_destroy(&p_args[i].kek);
+
+        pthread_mutex_destroy(&pool.mutex);
+        free(p_args);
+
+        /* Если не удалось запустить ни одного потока, то обрабатываем объекты последовательно */
+        if (started)
+            return pool.error;
+    }
+#endif
+
+    for (i = 0; i < count; i++)
+    {
+        if ((error = task(ctx, p_kek, i)) != ak_error_ok)
+            return error;
+    }
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx указатель на контекст struct pkcs_15_unwrap_ctx
+    @param p_kek копия ключа KEK, принадлежащая текущему потоку
+    @param idx номер объекта
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int unwrap_task(ak_pointer ctx, ak_bckey p_kek, size_t idx) {
+    struct pkcs_15_unwrap_ctx *p_ctx = (struct pkcs_15_unwrap_ctx *) ctx;
+    struct extended_key *p_key;
+
+    if ((p_key = calloc(1, sizeof(struct extended_key))) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+
+    /* Объекты, которые не удалось расшифровать, пропускаются */
+    if (get_extended_key(p_ctx->p_token->mpp_pkcs_15_objects[idx], &p_kek->key, p_key) != ak_error_ok)
+    {
+        free(p_key->label);
+        free(p_key);
+        p_key = NULL;
+    }
+
+    p_ctx->pp_keys[idx] = p_key;
+    return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param password пароль, из которого вырабатывается ключ для шифрования данных
     @param pwd_size длинна пароля в байтах
@@ -974,56 +1572,657 @@ static int get_extended_key(s_pkcs_15_object *p_obj, struct skey *p_kek, struct
 int read_keys_from_container(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, struct extended_key ***ppp_out_keys, ak_uint8 *num_of_out_keys) {
 
     int error;
-    uint8_t i;
+    ak_uint8 i;
     s_pkcs_15_token main_token;
     struct bckey kek;
     struct extended_key **pp_keys;
+    struct pkcs_15_unwrap_ctx unwrap_ctx;
 
     memset(&main_token, 0, sizeof(main_token));
 
     /* Разбираем контейнер */
     if ((error = pkcs_15_parse_token(inp_container, inp_container_size, &main_token)) != ak_error_ok)
     {
+        free_pkcs_15_token(&main_token);
         return ak_error_message(error, __func__, "problem with parsing container");
     }
 
     if (!main_token.m_info_size)
     {
+        free_pkcs_15_token(&main_token);
         return ak_error_message(ak_error_invalid_value, __func__, "key management info absent");
     }
 
     if (!main_token.m_obj_size)
     {
+        free_pkcs_15_token(&main_token);
         return ak_error_message(ak_error_invalid_value, __func__, "objects absent");
     }
 
     /* Создаем ключ KEK */
     //TODO FIX
     ak_bckey_context_create_magma(&kek);
-    pkcs_15_kek_generator(&kek, password, pwd_size, main_token.mpp_key_infos[0]);
+    if ((error = pkcs_15_kek_generator(&kek, password, pwd_size, main_token.mpp_key_infos[0])) != ak_error_ok)
+    {
+        ak_bckey_context_destroy(&kek);
+        free_pkcs_15_token(&main_token);
+        return ak_error_message(error, __func__, "generation key from password failed");
+    }
 
-    /* Расшифровываем данные и создаем объекты extended_key */
-    pp_keys = malloc(main_token.m_obj_size * sizeof(struct extended_key *));
+    /* Расшифровываем данные и создаем объекты extended_key; объекты независимы друг от друга,
+       поэтому обрабатываются пулом потоков с собственными копиями ключа KEK */
+    pp_keys = calloc(main_token.m_obj_size, sizeof(struct extended_key *));
     if (!pp_keys)
-        return ak_error_message(ak_error_null_pointer, __func__, "alloc memory fail");
-
+    {
+        ak_bckey_context_destroy(&kek);
+        free_pkcs_15_token(&main_token);
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    }
+
+    unwrap_ctx.p_token = &main_token;
+    unwrap_ctx.pp_keys = pp_keys;
+    error = pkcs_15_pool_run(unwrap_task, &unwrap_ctx, &kek, main_token.m_obj_size);
+
+    /* Сдвигаем успешно расшифрованные объекты в начало массива */
     *num_of_out_keys = 0;
     for (i = 0; i < main_token.m_obj_size; i++)
     {
-        pp_keys[i] = calloc(1, sizeof(struct extended_key));
-        if (!pp_keys[i])
-            return ak_error_message(ak_error_null_pointer, __func__, "alloc memory fail");
+        if (pp_keys[i])
+            pp_keys[(*num_of_out_keys)++] = pp_keys[i];
+    }
+    for (i = *num_of_out_keys; i < main_token.m_obj_size; i++)
+        pp_keys[i] = NULL;
+
+    /* Освобождаем память */
+    ak_bckey_context_destroy(&kek);
+    free_pkcs_15_token(&main_token);
+
+    if (error != ak_error_ok)
+        ak_error_message(error, __func__, "problem with decrypting objects");
+
+    *ppp_out_keys = pp_keys;
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_obj указатель на объект PKCS15Object, из которого считаны только общие атрибуты
+    @param p_desc указатель на переменную, в которую запишутся атрибуты ключа
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int get_key_description(s_pkcs_15_object *p_obj, struct key_description *p_desc) {
+    s_gost_sec_key *p_pkcs_sec_key;
+
+    assert(p_obj && p_desc);
+
+    p_desc->key_type = p_obj->m_type;
+    if (p_obj->m_type != SEC_KEY || !p_obj->m_obj.mp_sec_key)
+        return ak_error_message(ak_error_invalid_value, __func__, "only secret key support");
+
+    p_pkcs_sec_key = p_obj->m_obj.mp_sec_key;
+
+    // идентификатор алгоритма
+    if (p_pkcs_sec_key->m_key_type_gost)
+    {
+        p_desc->algorithm = malloc(strlen(p_pkcs_sec_key->m_key_type_gost) + 1);
+        if (!p_desc->algorithm)
+            return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        strcpy(p_desc->algorithm, p_pkcs_sec_key->m_key_type_gost);
+    }
+
+    // метка ключа
+    if (p_pkcs_sec_key->m_obj_attrs.m_label)
+    {
+        p_desc->label = malloc(strlen((char *) p_pkcs_sec_key->m_obj_attrs.m_label) + 1);
+        if (!p_desc->label)
+            return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        strcpy((char *) p_desc->label, (char *) p_pkcs_sec_key->m_obj_attrs.m_label);
+    }
+
+    // уникальный идентификатор ключа
+    if (p_pkcs_sec_key->m_key_attrs.m_id.m_val_len)
+    {
+        p_desc->id = malloc(p_pkcs_sec_key->m_key_attrs.m_id.m_val_len);
+        if (!p_desc->id)
+            return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        memcpy(p_desc->id, p_pkcs_sec_key->m_key_attrs.m_id.mp_value, p_pkcs_sec_key->m_key_attrs.m_id.m_val_len);
+        p_desc->id_size = p_pkcs_sec_key->m_key_attrs.m_id.m_val_len;
+    }
+
+    // флаги предназначения ключа
+    set_usage_flags(p_pkcs_sec_key->m_key_attrs.m_usage, &p_desc->flags);
+
+    // дата начала периода действия ключа
+    if (p_pkcs_sec_key->m_key_attrs.m_start_date)
+        asn_generalized_time_to_date(p_pkcs_sec_key->m_key_attrs.m_start_date, p_desc->start_date);
+
+    // дата окончания периода действия ключа
+    if (p_pkcs_sec_key->m_key_attrs.m_end_date)
+        asn_generalized_time_to_date(p_pkcs_sec_key->m_key_attrs.m_end_date, p_desc->end_date);
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция не вырабатывает ключ KEK из пароля и не расшифровывает ключи: из контейнера считываются
+    только общие атрибуты объектов и ключей (CommonObjectAttributes и CommonKeyAttributes).
+    Для получения значения выбранного ключа следует использовать функцию read_key_from_container_by_id().
+
+    @param inp_container указатель на DER последовательность
+    @param inp_container_size длинна DER последовательности в байтах
+    @param ppp_out_descs указатель на массив указателей на описания ключей из контейнера
+    @param num_of_out_descs количество описаний в массиве
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int list_keys_in_container(ak_byte *inp_container, size_t inp_container_size, struct key_description ***ppp_out_descs, ak_uint8 *num_of_out_descs) {
+    int error;
+    s_pkcs_15_token main_token;
+    s_pkcs_15_token_layout layout;
+    s_pkcs_15_object object;
+    s_der_buffer pkcs_15_objects;
+    s_der_buffer obj_tlv;
+    s_der_buffer obj_der;
+    struct key_description **pp_descs;
+    struct key_description *p_desc;
+
+    if (!inp_container || !ppp_out_descs || !num_of_out_descs)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    *ppp_out_descs = NULL;
+    *num_of_out_descs = 0;
+    memset(&main_token, 0, sizeof(main_token));
+
+    /* Определяем границы объектов контейнера */
+    error = pkcs_15_get_token_layout(inp_container, inp_container_size, &main_token, NULL, 0, &layout);
+    free_pkcs_15_token(&main_token);
+    if (error != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with parsing container");
+
+    if (!layout.m_obj_count)
+        return ak_error_ok;
+
+    if (layout.m_obj_count > 255)
+        return ak_error_message(ak_error_invalid_value, __func__, "too many objects in container");
+
+    pp_descs = calloc(layout.m_obj_count, sizeof(struct key_description *));
+    if (!pp_descs)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+
+    /* Разбираем только атрибуты объектов, запоминая их смещения */
+    ps_set(&pkcs_15_objects, inp_container + layout.m_objs_value, layout.m_objs_end - layout.m_objs_value, PS_R_MODE);
+    while (ps_get_curr_size(&pkcs_15_objects))
+    {
+        if ((error = asn_get_next_tlv(&pkcs_15_objects, NULL, &obj_tlv)) != ak_error_ok)
+        {
+            ak_error_message(error, __func__, "problem with getting object bounds");
+            break;
+        }
+
+        memset(&object, 0, sizeof(s_pkcs_15_object));
+        ps_set(&obj_der, obj_tlv.mp_begin, ps_get_full_size(&obj_tlv), PS_R_MODE);
+        if ((error = pkcs_15_get_obj_attrs(&obj_der, &object)) != ak_error_ok)
+        {
+            free_pkcs_15_object(&object);
+            ak_error_message(error, __func__, "problem with getting object attributes");
+            break;
+        }
+
+        if ((p_desc = calloc(1, sizeof(struct key_description))) == NULL)
+        {
+            free_pkcs_15_object(&object);
+            error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+            break;
+        }
+
+        if (get_key_description(&object, p_desc) != ak_error_ok)
+        {
+            free_pkcs_15_object(&object);
+            free_key_descriptions(&p_desc, 1);
+            continue;
+        }
+        free_pkcs_15_object(&object);
+
+        p_desc->offset = (size_t) (obj_tlv.mp_begin - inp_container);
+        pp_descs[(*num_of_out_descs)++] = p_desc;
+    }
+
+    if (error != ak_error_ok)
+    {
+        free_key_descriptions(pp_descs, *num_of_out_descs);
+        free(pp_descs);
+        *num_of_out_descs = 0;
+        return error;
+    }
+
+    *ppp_out_descs = pp_descs;
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция освобождает описания ключей, но не сам массив указателей pp_descs.
+
+    @param pp_descs массив указателей на описания ключей
+    @param num_of_descs количество описаний в массиве                                              */
+/* ----------------------------------------------------------------------------------------------- */
+void free_key_descriptions(struct key_description **pp_descs, ak_uint8 num_of_descs) {
+    ak_uint8 i;
+
+    if (!pp_descs)
+        return;
+
+    for (i = 0; i < num_of_descs; i++)
+    {
+        if (!pp_descs[i])
+            continue;
+
+        free(pp_descs[i]->algorithm);
+        free(pp_descs[i]->label);
+        free(pp_descs[i]->id);
+        free(pp_descs[i]);
+        pp_descs[i] = NULL;
+    }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param password пароль, из которого вырабатывается ключ для шифрования данных
+    @param pwd_size длинна пароля в байтах
+    @param p_token указатель на контейнер, содержащий информацию о ключе KEK и единственный объект
+    @param pp_out_key указатель на переменную, в которую запишется указатель на расшифрованный ключ
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int unwrap_single_key(ak_byte *password, size_t pwd_size, s_pkcs_15_token *p_token, struct extended_key **pp_out_key) {
+    int error;
+    struct bckey kek;
+    struct extended_key *p_key;
+
+    if (!p_token->m_info_size)
+        return ak_error_message(ak_error_invalid_value, __func__, "key management info absent");
+
+    /* Создаем ключ KEK */
+    if ((error = ak_bckey_context_create_magma(&kek)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with magma context creation");
+
+    if ((error = pkcs_15_kek_generator(&kek, password, pwd_size, p_token->mpp_key_infos[0])) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "generation key from password failed");
+        goto exit;
+    }
+
+    /* Расшифровываем объект */
+    if ((p_key = calloc(1, sizeof(struct extended_key))) == NULL)
+    {
+        error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        goto exit;
+    }
+
+    if ((error = get_extended_key(p_token->mpp_pkcs_15_objects[0], &kek.key, p_key)) != ak_error_ok)
+    {
+        free(p_key->label);
+        free(p_key);
+        ak_error_message(error, __func__, "problem with getting key");
+        goto exit;
+    }
+
+    *pp_out_key = p_key;
+
+exit:
+    ak_bckey_context_destroy(&kek);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция ищет в контейнере объект с заданным уникальным идентификатором, сравнивая только общие
+    атрибуты объектов. Ключ KEK вырабатывается из пароля лишь в случае, если объект найден,
+    при этом расшифровывается только найденный объект.
+
+    @param password пароль, из которого вырабатывается ключ для шифрования данных
+    @param pwd_size длинна пароля в байтах
+    @param inp_container указатель на DER последовательность
+    @param inp_container_size длинна DER последовательности в байтах
+    @param id указатель на уникальный идентификатор ключа
+    @param id_size длина идентификатора в байтах
+    @param pp_out_key указатель на переменную, в которую запишется указатель на объект из контейнера
+    @return В случае успеха функция возввращает ak_error_ok (ноль). Если ключ с заданным
+    идентификатором отсутствует, возвращается ak_error_undefined_value.
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int read_key_from_container_by_id(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, const ak_byte *id, size_t id_size, struct extended_key **pp_out_key) {
+    int error;
+    s_pkcs_15_token main_token;
+
+    if (!password || !inp_container || !id || !pp_out_key)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    *pp_out_key = NULL;
+    memset(&main_token, 0, sizeof(main_token));
+
+    /* Разбираем информацию о ключе KEK и единственный объект с заданным идентификатором */
+    if ((error = pkcs_15_parse_token_obj_by_id(inp_container, inp_container_size, &main_token, id, id_size)) != ak_error_ok)
+    {
+        free_pkcs_15_token(&main_token);
+        return ak_error_message(error, __func__, "problem with parsing container");
+    }
+
+    if (!main_token.m_obj_size)
+    {
+        free_pkcs_15_token(&main_token);
+        return ak_error_message(ak_error_undefined_value, __func__, "key with given id not found");
+    }
+
+    error = unwrap_single_key(password, pwd_size, &main_token, pp_out_key);
+    free_pkcs_15_token(&main_token);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция не просматривает объекты контейнера: разбирается только объект, начинающийся с заданного
+    смещения (например, полученного функцией list_keys_in_container() или из внешнего индекса).
+
+    @param password пароль, из которого вырабатывается ключ для шифрования данных
+    @param pwd_size длинна пароля в байтах
+    @param inp_container указатель на DER последовательность
+    @param inp_container_size длинна DER последовательности в байтах
+    @param offset смещение объекта от начала DER последовательности
+    @param pp_out_key указатель на переменную, в которую запишется указатель на объект из контейнера
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int read_key_from_container_at(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, size_t offset, struct extended_key **pp_out_key) {
+    int error;
+    s_pkcs_15_token main_token;
+
+    if (!password || !inp_container || !pp_out_key)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    *pp_out_key = NULL;
+    memset(&main_token, 0, sizeof(main_token));
+
+    if ((error = pkcs_15_parse_token_obj_at(inp_container, inp_container_size, &main_token, offset)) != ak_error_ok)
+    {
+        free_pkcs_15_token(&main_token);
+        return ak_error_message(error, __func__, "problem with parsing container");
+    }
+
+    error = unwrap_single_key(password, pwd_size, &main_token, pp_out_key);
+    free_pkcs_15_token(&main_token);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_key указатель на ключ, который необходимо зашифровать
+    @param p_kek ключ KEK
+    @param pp_obj указатель на указатель на DER последовательность объекта
+    @param p_obj_size размер DER последовательности объекта
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int encode_wrapped_key(struct extended_key *p_key, ak_bckey p_kek, ak_byte **pp_obj, size_t *p_obj_size) {
+    int error;
+    s_pkcs_15_object object;
+
+    if (p_key->key_type != SEC_KEY)
+        return ak_error_message(ak_error_invalid_value, __func__, "only secret keys are supported");
+
+    memset(&object, 0, sizeof(s_pkcs_15_object));
+    object.m_type = SEC_KEY;
+    if ((object.m_obj.mp_sec_key = (s_gost_sec_key *) calloc(1, sizeof(s_gost_sec_key))) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+
+    if ((error = put_gost_secret_key(object.m_obj.mp_sec_key, p_key, p_kek)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with fill of gost secret key");
+    else if ((error = pkcs_15_encode_obj(&object, pp_obj, p_obj_size)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with encoding object");
+
+    free_pkcs_15_object(&object);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает ключ KEK с использованием уже существующего объекта KeyManagementInfo
+    контейнера и кодирует единственный объект PKCS15Object, содержащий зашифрованный ключ.
+
+    @param password пароль, из которого вырабатывается ключ для шифрования данных
+    @param pwd_size длинна пароля в байтах
+    @param p_kmi указатель на объект KeyManagementInfo контейнера
+    @param p_key указатель на ключ, который необходимо зашифровать
+    @param pp_obj указатель на указатель на DER последовательность объекта
+    @param p_obj_size размер DER последовательности объекта
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int wrap_single_key(ak_byte *password, size_t pwd_size, s_key_management_info *p_kmi,
+                           struct extended_key *p_key, ak_byte **pp_obj, size_t *p_obj_size) {
+    int error;
+    struct bckey kek;
+
+    if (p_key->key_type != SEC_KEY)
+        return ak_error_message(ak_error_invalid_value, __func__, "only secret keys are supported");
+
+    if ((error = ak_bckey_context_create_magma(&kek)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with magma context creation");
+
+    /* Идентификатор ключа KEK берется из KeyManagementInfo, поэтому новый объект
+       ссылается на тот же ключ, что и остальные объекты контейнера */
+    if ((error = pkcs_15_kek_generator(&kek, password, pwd_size, p_kmi)) != ak_error_ok)
+        ak_error_message(error, __func__, "generation key from password failed");
+    else if ((error = encode_wrapped_key(p_key, &kek, pp_obj, p_obj_size)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with wrapping key");
+
+    ak_bckey_context_destroy(&kek);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция добавляет в конец последовательности PKCS 15 Objects один объект, не расшифровывая и не
+    перекодируя остальные объекты контейнера. Ключ KEK вырабатывается из пароля с использованием
+    уже существующего объекта KeyManagementInfo, поэтому пароль должен совпадать с паролем,
+    использованным при создании контейнера.
+
+    @param password пароль, из которого вырабатывается ключ для шифрования данных
+    @param pwd_size длинна пароля в байтах
+    @param inp_container указатель на DER последовательность
+    @param inp_container_size длинна DER последовательности в байтах
+    @param p_key указатель на добавляемый ключ
+    @param pp_out_container указатель на массив с выходной DER последовательностью
+    @param p_out_container_size размер выходной DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль). Если ключ с таким же
+    идентификатором уже присутствует в контейнере, возвращается ak_error_invalid_value.
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int add_key_to_container(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, struct extended_key *p_key, ak_byte **pp_out_container, size_t *p_out_container_size) {
+    int error;
+    ak_byte *p_obj;
+    size_t obj_size;
+    s_pkcs_15_token main_token;
+    s_pkcs_15_token_layout layout;
+
+    if (!password || !inp_container || !p_key || !p_key->key.sec_key || !pp_out_container || !p_out_container_size)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    p_obj = NULL;
+    memset(&main_token, 0, sizeof(main_token));
+
+    if ((error = pkcs_15_get_token_layout(inp_container, inp_container_size, &main_token,
+                                          p_key->key.sec_key->key.number.data,
+                                          p_key->key.sec_key->key.number.size, &layout)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with parsing container");
+        goto exit;
+    }
+
+    if (!main_token.m_info_size)
+    {
+        error = ak_error_message(ak_error_invalid_value, __func__, "key management info absent");
+        goto exit;
+    }
+
+    if (layout.m_found)
+    {
+        error = ak_error_message(ak_error_invalid_value, __func__, "key with given id already exists");
+        goto exit;
+    }
+
+    if (layout.m_obj_count >= 255)
+    {
+        error = ak_error_message(ak_error_invalid_value, __func__, "too many objects in container");
+        goto exit;
+    }
+
+    if ((error = wrap_single_key(password, pwd_size, main_token.mpp_key_infos[0], p_key, &p_obj, &obj_size)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with wrapping key");
+        goto exit;
+    }
+
+    if ((error = pkcs_15_splice_token(inp_container, &layout, layout.m_objs_end, layout.m_objs_end,
+                                      p_obj, obj_size, pp_out_container, p_out_container_size)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with splicing container");
+
+exit:
+    free(p_obj);
+    free_pkcs_15_token(&main_token);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция заменяет объект, уникальный идентификатор которого совпадает с идентификатором ключа
+    p_key, не расшифровывая и не перекодируя остальные объекты контейнера.
+
+    @param password пароль, из которого вырабатывается ключ для шифрования данных
+    @param pwd_size длинна пароля в байтах
+    @param inp_container указатель на DER последовательность
+    @param inp_container_size длинна DER последовательности в байтах
+    @param p_key указатель на новое значение ключа
+    @param pp_out_container указатель на массив с выходной DER последовательностью
+    @param p_out_container_size размер выходной DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль). Если ключ с заданным
+    идентификатором отсутствует, возвращается ak_error_undefined_value.
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int replace_key_in_container(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, struct extended_key *p_key, ak_byte **pp_out_container, size_t *p_out_container_size) {
+    int error;
+    ak_byte *p_obj;
+    size_t obj_size;
+    s_pkcs_15_token main_token;
+    s_pkcs_15_token_layout layout;
+
+    if (!password || !inp_container || !p_key || !p_key->key.sec_key || !pp_out_container || !p_out_container_size)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    p_obj = NULL;
+    memset(&main_token, 0, sizeof(main_token));
+
+    if ((error = pkcs_15_get_token_layout(inp_container, inp_container_size, &main_token,
+                                          p_key->key.sec_key->key.number.data,
+                                          p_key->key.sec_key->key.number.size, &layout)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with parsing container");
+        goto exit;
+    }
+
+    if (!main_token.m_info_size)
+    {
+        error = ak_error_message(ak_error_invalid_value, __func__, "key management info absent");
+        goto exit;
+    }
+
+    if (!layout.m_found)
+    {
+        error = ak_error_message(ak_error_undefined_value, __func__, "key with given id not found");
+        goto exit;
+    }
+
+    if ((error = wrap_single_key(password, pwd_size, main_token.mpp_key_infos[0], p_key, &p_obj, &obj_size)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with wrapping key");
+        goto exit;
+    }
+
+    if ((error = pkcs_15_splice_token(inp_container, &layout, layout.m_obj_begin, layout.m_obj_end,
+                                      p_obj, obj_size, pp_out_container, p_out_container_size)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with splicing container");
+
+exit:
+    free(p_obj);
+    free_pkcs_15_token(&main_token);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция удаляет из контейнера объект с заданным уникальным идентификатором. Пароль не требуется,
+    поскольку ни один объект контейнера не расшифровывается.
+
+    @param inp_container указатель на DER последовательность
+    @param inp_container_size длинна DER последовательности в байтах
+    @param id указатель на уникальный идентификатор ключа
+    @param id_size длина идентификатора в байтах
+    @param pp_out_container указатель на массив с выходной DER последовательностью
+    @param p_out_container_size размер выходной DER последовательности
+    @return В случае успеха функция возввращает ak_error_ok (ноль). Если ключ с заданным
+    идентификатором отсутствует, возвращается ak_error_undefined_value.
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int remove_key_from_container(ak_byte *inp_container, size_t inp_container_size, const ak_byte *id, size_t id_size, ak_byte **pp_out_container, size_t *p_out_container_size) {
+    int error;
+    s_pkcs_15_token main_token;
+    s_pkcs_15_token_layout layout;
+
+    if (!inp_container || !id || !pp_out_container || !p_out_container_size)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    memset(&main_token, 0, sizeof(main_token));
+
+    if ((error = pkcs_15_get_token_layout(inp_container, inp_container_size, &main_token, id, id_size, &layout)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with parsing container");
+        goto exit;
+    }
 
-        if (get_extended_key(main_token.mpp_pkcs_15_objects[i], &kek.key, pp_keys[i]) != ak_error_ok)
-            pp_keys[i] = NULL;
-        else
-            *num_of_out_keys += 1;
+    if (!layout.m_found)
+    {
+        error = ak_error_message(ak_error_undefined_value, __func__, "key with given id not found");
+        goto exit;
     }
 
-    /* Освобождаем память */
+    if ((error = pkcs_15_splice_token(inp_container, &layout, layout.m_obj_begin, layout.m_obj_end,
+                                      NULL, 0, pp_out_container, p_out_container_size)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with splicing container");
+
+exit:
     free_pkcs_15_token(&main_token);
 
-    *ppp_out_keys = pp_keys;
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx указатель на контекст struct pkcs_15_wrap_ctx
+    @param p_kek копия ключа KEK, принадлежащая текущему потоку
+    @param idx номер объекта
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int wrap_task(ak_pointer ctx, ak_bckey p_kek, size_t idx) {
+    int error;
+    struct pkcs_15_wrap_ctx *p_ctx = (struct pkcs_15_wrap_ctx *) ctx;
+    s_pkcs_15_object *p_object = p_ctx->p_token->mpp_pkcs_15_objects[idx];
+
+    /* Объект неподдерживаемого типа не создавался */
+    if (!p_object)
+        return ak_error_ok;
+
+    if ((error = put_gost_secret_key(p_object->m_obj.mp_sec_key, p_ctx->pp_keys[idx], p_kek)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with fill of gost secret key");
 
     return ak_error_ok;
 }
@@ -1045,6 +2244,7 @@ int write_keys_to_container(struct extended_key **pp_inp_keys, ak_uint8 num_of_i
     s_pkcs_15_token main_token;
     s_key_management_info *p_kmi;
     size_t token_obj_ind;
+    struct pkcs_15_wrap_ctx wrap_ctx;
 
     if (!(*pp_inp_keys) || (num_of_inp_keys < 0) || !password || (password_size <= 0))
         return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
@@ -1081,15 +2281,14 @@ int write_keys_to_container(struct extended_key **pp_inp_keys, ak_uint8 num_of_i
     }
 
     main_token.mpp_pkcs_15_objects = calloc(num_of_inp_keys, sizeof(s_pkcs_15_object *));
+    if (!main_token.mpp_pkcs_15_objects)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
     main_token.m_obj_size = num_of_inp_keys;
 
-    token_obj_ind = 0;
-
-    // Заполняем PKCS15Objects
+    // Создаем объекты PKCS15Objects для поддерживаемых типов ключей; неподдерживаемые пропускаются
     for (ak_uint32 i = 0; i < num_of_inp_keys; i++)
     {
-
-        s_pkcs_15_object *current_pkcs15_object = (s_pkcs_15_object *) calloc(1, sizeof(s_pkcs_15_object));
+        s_pkcs_15_object *current_pkcs15_object;
 
         // Определеяем тип pkcs15_object
         switch (pp_inp_keys[i]->key_type)
@@ -1099,9 +2298,6 @@ int write_keys_to_container(struct extended_key **pp_inp_keys, ak_uint8 num_of_i
                 //TODO реализовать
 
                 ak_error_message(ak_error_invalid_value, __func__, "private key support not implemented yet!");
-                --main_token.m_obj_size;
-                free(current_pkcs15_object);
-                current_pkcs15_object = NULL;
                 break;
 
             case PUB_KEY:
@@ -1109,39 +2305,44 @@ int write_keys_to_container(struct extended_key **pp_inp_keys, ak_uint8 num_of_i
                 //TODO реализовать
 
                 ak_error_message(ak_error_invalid_value, __func__, "public key support not implemented yet!");
-                --main_token.m_obj_size;
-                free(current_pkcs15_object);
-                current_pkcs15_object = NULL;
                 break;
 
             case SEC_KEY:
 
-                current_pkcs15_object->m_obj.mp_sec_key = (s_gost_sec_key *) calloc(1, sizeof(s_gost_sec_key));
-                current_pkcs15_object->m_type = SEC_KEY;
-
-                if ((error = put_gost_secret_key(current_pkcs15_object->m_obj.mp_sec_key, pp_inp_keys[i], &kek))
-                    != ak_error_ok)
-                {
-                    return ak_error_message(error, __func__, "problem with fill of gost secret key");
-                }
+                current_pkcs15_object = (s_pkcs_15_object *) calloc(1, sizeof(s_pkcs_15_object));
+                if (!current_pkcs15_object)
+                    return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
 
+                current_pkcs15_object->m_type = SEC_KEY;
+                current_pkcs15_object->m_obj.mp_sec_key = (s_gost_sec_key *) calloc(1, sizeof(s_gost_sec_key));
+                main_token.mpp_pkcs_15_objects[i] = current_pkcs15_object;
+                if (!current_pkcs15_object->m_obj.mp_sec_key)
+                    return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
                 break;
 
             default:
                 ak_error_message(ak_error_invalid_value, __func__, "unsupported type of object!");
-                --main_token.m_obj_size;
-                free(current_pkcs15_object);
-                current_pkcs15_object = NULL;
                 break;
         }
+    }
 
-        if (current_pkcs15_object != NULL)
-        {
-            main_token.mpp_pkcs_15_objects[token_obj_ind] = current_pkcs15_object;
-            ++token_obj_ind;
-        }
+    // Заполняем PKCS15Objects; объекты независимы друг от друга, поэтому обрабатываются
+    // пулом потоков с собственными копиями ключа KEK
+    wrap_ctx.p_token = &main_token;
+    wrap_ctx.pp_keys = pp_inp_keys;
+    if ((error = pkcs_15_pool_run(wrap_task, &wrap_ctx, &kek, num_of_inp_keys)) != ak_error_ok)
+    {
+        return ak_error_message(error, __func__, "problem with fill of gost secret key");
+    }
 
+    // Убираем из массива пропущенные объекты
+    token_obj_ind = 0;
+    for (ak_uint32 i = 0; i < num_of_inp_keys; i++)
+    {
+        if (main_token.mpp_pkcs_15_objects[i] != NULL)
+            main_token.mpp_pkcs_15_objects[token_obj_ind++] = main_token.mpp_pkcs_15_objects[i];
     }
+    main_token.m_obj_size = (ak_uint8) token_obj_ind;
 
     // Получаем DER - последовательность
     if ((error = pkcs_15_generate_token(&main_token, pp_out_container, p_out_container_size)) != ak_error_ok)
@@ -1161,6 +2362,528 @@ int write_keys_to_container(struct extended_key **pp_inp_keys, ak_uint8 num_of_i
     return ak_error_ok;
 }
 
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальная суммарная длина объектов, записываемых в контейнер потоковым методом.
+    \details Длина контейнера кодируется не более, чем в четырех байтах, поэтому часть диапазона
+    оставлена для заголовка контейнера и объекта KeyManagementInfo. */
+ #define PKCS_15_STREAM_MAX_OBJS_LEN (0xFFFF0000u)
+
+/*! \brief Максимальная длина одного объекта, считываемого из контейнера потоковым методом. */
+ #define PKCS_15_STREAM_MAX_OBJ_SIZE (1u << 20)
+
+/*! \brief Размер буфера, используемого для переноса объектов внутри файла. */
+ #define PKCS_15_STREAM_COPY_SIZE (65536)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param fd дескриптор файла
+    @param p_data указатель на записываемые данные
+    @param size длина данных в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_stream_write(int fd, const ak_byte *p_data, size_t size) {
+    ssize_t done;
+
+    while (size)
+    {
+        if ((done = write(fd, p_data, size)) <= 0)
+            return ak_error_message(ak_error_write_data, __func__, "problem with writing to descriptor");
+        p_data += done;
+        size -= (size_t) done;
+    }
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param fd дескриптор файла
+    @param p_data указатель на область памяти, в которую помещаются данные
+    @param size длина данных в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_stream_read(int fd, ak_byte *p_data, size_t size) {
+    ssize_t done;
+
+    while (size)
+    {
+        if ((done = read(fd, p_data, size)) < 0)
+            return ak_error_message(ak_error_read_data, __func__, "problem with reading from descriptor");
+        if (done == 0)
+            return ak_error_message(ak_error_read_data, __func__, "unexpected end of container");
+        p_data += done;
+        size -= (size_t) done;
+    }
+
+    return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция переносит фрагмент файла [src, src + size) на меньшее смещение dst, используя
+    буфер фиксированного размера.
+
+    @param fd дескриптор файла
+    @param dst смещение, на которое переносится фрагмент
+    @param src смещение начала фрагмента
+    @param size длина фрагмента в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int pkcs_15_stream_move(int fd, off_t dst, off_t src, size_t size) {
+    int error;
+    size_t chunk;
+    ak_byte *p_buff;
+
+    if ((p_buff = malloc(PKCS_15_STREAM_COPY_SIZE)) == NULL)
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+
+    error = ak_error_ok;
+    while (size)
+    {
+        chunk = size < PKCS_15_STREAM_COPY_SIZE ? size : PKCS_15_STREAM_COPY_SIZE;
+        if (lseek(fd, src, SEEK_SET) < 0 || (error = pkcs_15_stream_read(fd, p_buff, chunk)) != ak_error_ok)
+        {
+            error = ak_error_message(ak_error_read_data, __func__, "problem with reading objects");
+            break;
+        }
+        if (lseek(fd, dst, SEEK_SET) < 0 || (error = pkcs_15_stream_write(fd, p_buff, chunk)) != ak_error_ok)
+        {
+            error = ak_error_message(ak_error_write_data, __func__, "problem with moving objects");
+            break;
+        }
+        src += (off_t) chunk;
+        dst += (off_t) chunk;
+        size -= chunk;
+    }
+    free(p_buff);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_wr указатель на структуру потоковой записи                                           */
+/* ----------------------------------------------------------------------------------------------- */
+static void container_writer_free(struct container_writer *p_wr) {
+    free_pkcs_15_token(&p_wr->token);
+    ak_bckey_context_destroy(&p_wr->kek);
+    memset(p_wr, 0, sizeof(struct container_writer));
+    p_wr->fd = -1;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает ключ KEK и резервирует в файле место под заголовок контейнера.
+    Ключи добавляются функцией container_writer_put_key() и записываются в файл сразу после
+    зашифрования, поэтому объем используемой памяти не зависит от количества ключей.
+    Запись завершается функцией container_writer_close(), которая записывает заголовок.
+
+    Контейнер записывается начиная с текущей позиции файла; дескриптор должен поддерживать
+    позиционирование (lseek), поскольку длина контейнера становится известна только в конце.
+
+    @param p_wr указатель на структуру потоковой записи
+    @param fd дескриптор открытого на запись файла
+    @param password пароль (в кодировке UTF-8), из которого вырабатывается ключ для шифрования данных
+    @param password_size длинна пароля в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int container_writer_open(struct container_writer *p_wr, int fd, ak_pointer password, size_t password_size) {
+    int error;
+    ak_byte *p_header;
+    s_key_management_info *p_kmi;
+
+    if (!p_wr || fd < 0 || !password || !password_size)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    memset(p_wr, 0, sizeof(struct container_writer));
+    p_wr->fd = fd;
+    p_header = NULL;
+
+    if ((error = ak_bckey_context_create_magma(&p_wr->kek)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with magma context creation");
+
+    /* Заполняем версию и единственный объект KeyManagementInfo, как и при записи
+       контейнера функцией write_keys_to_container() */
+    set_asn_integer(&p_wr->token.m_version, 0);
+    if ((p_wr->token.mpp_key_infos = calloc(1, sizeof(s_key_management_info *))) == NULL ||
+        (p_kmi = calloc(1, sizeof(s_key_management_info))) == NULL)
+    {
+        error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        goto exit;
+    }
+    p_wr->token.mpp_key_infos[0] = p_kmi;
+    p_wr->token.m_info_size = 1;
+
+    if ((error = put_key_management_info(p_kmi, &p_wr->kek.key.number)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with fill of key management info");
+        goto exit;
+    }
+
+    if ((error = pkcs_15_kek_generator(&p_wr->kek, password, password_size, p_kmi)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "generation key from password failed");
+        goto exit;
+    }
+
+    /* Резервируем место под заголовок максимально возможной длины */
+    if ((error = pkcs_15_generate_token_header(&p_wr->token, PKCS_15_STREAM_MAX_OBJS_LEN, &p_header, &p_wr->reserved)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with encoding container header");
+        goto exit;
+    }
+    memset(p_header, 0, p_wr->reserved);
+
+    if ((p_wr->start = lseek(fd, 0, SEEK_CUR)) < 0)
+    {
+        error = ak_error_message(ak_error_write_data, __func__, "descriptor does not support positioning");
+        goto exit;
+    }
+
+    if ((error = pkcs_15_stream_write(fd, p_header, p_wr->reserved)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with reserving container header");
+
+exit:
+    free(p_header);
+    if (error != ak_error_ok)
+        container_writer_free(p_wr);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_wr указатель на структуру потоковой записи
+    @param p_key указатель на добавляемый ключ
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int container_writer_put_key(struct container_writer *p_wr, struct extended_key *p_key) {
+    int error;
+    ak_byte *p_obj;
+    size_t obj_size;
+
+    if (!p_wr || p_wr->fd < 0 || !p_key || !p_key->key.sec_key)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    p_obj = NULL;
+    if ((error = encode_wrapped_key(p_key, &p_wr->kek, &p_obj, &obj_size)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with wrapping key");
+
+    if (obj_size > PKCS_15_STREAM_MAX_OBJS_LEN - p_wr->objs_len)
+        error = ak_error_message(ak_error_wrong_length, __func__, "container is too large");
+    else if ((error = pkcs_15_stream_write(p_wr->fd, p_obj, obj_size)) != ak_error_ok)
+        ak_error_message(error, __func__, "problem with writing object");
+    else
+    {
+        p_wr->objs_len += obj_size;
+        p_wr->count++;
+    }
+    free(p_obj);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция записывает заголовок контейнера, содержащий длины, вычисленные по уже записанным
+    объектам. Если заголовок короче зарезервированного места, то объекты переносятся вплотную
+    к заголовку, а файл усекается. После завершения текущая позиция файла указывает на конец
+    контейнера. Память освобождается при любом результате.
+
+    @param p_wr указатель на структуру потоковой записи
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int container_writer_close(struct container_writer *p_wr) {
+    int error;
+    ak_byte *p_header;
+    size_t header_size;
+    off_t end;
+
+    if (!p_wr || p_wr->fd < 0)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    p_header = NULL;
+    if (!p_wr->count)
+    {
+        error = ak_error_message(ak_error_invalid_value, __func__, "objects absent");
+        goto exit;
+    }
+
+    if ((error = pkcs_15_generate_token_header(&p_wr->token, p_wr->objs_len, &p_header, &header_size)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with encoding container header");
+        goto exit;
+    }
+
+    if (header_size > p_wr->reserved)
+    {
+        error = ak_error_message(ak_error_wrong_length, __func__, "container header exceeds reserved space");
+        goto exit;
+    }
+
+    if (header_size < p_wr->reserved)
+    {
+        if ((error = pkcs_15_stream_move(p_wr->fd, (off_t) p_wr->start + (off_t) header_size,
+                                         (off_t) p_wr->start + (off_t) p_wr->reserved, p_wr->objs_len)) != ak_error_ok)
+        {
+            ak_error_message(error, __func__, "problem with moving objects");
+            goto exit;
+        }
+    }
+
+    end = (off_t) p_wr->start + (off_t) (header_size + p_wr->objs_len);
+    if (lseek(p_wr->fd, (off_t) p_wr->start, SEEK_SET) < 0 ||
+        (error = pkcs_15_stream_write(p_wr->fd, p_header, header_size)) != ak_error_ok ||
+        (header_size < p_wr->reserved && ftruncate(p_wr->fd, end) != 0) ||
+        lseek(p_wr->fd, end, SEEK_SET) < 0)
+    {
+        error = ak_error_message(ak_error_write_data, __func__, "problem with writing container header");
+        goto exit;
+    }
+
+exit:
+    free(p_header);
+    container_writer_free(p_wr);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция считывает из файла заголовок очередного блока (тег и длину) и помещает его
+    в начало буфера структуры потокового чтения.
+
+    @param p_rd указатель на структуру потокового чтения
+    @param p_tag указатель на переменную, в которую помещается тег
+    @param p_len указатель на переменную, в которую помещается длина данных
+    @param p_header_len указатель на переменную, в которую помещается длина заголовка
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int container_reader_get_header(struct container_reader *p_rd, ak_byte *p_tag, size_t *p_len, size_t *p_header_len) {
+    int error;
+    ak_uint8 len_byte_cnt;
+
+    if ((error = pkcs_15_stream_read(p_rd->fd, p_rd->p_buff, 2)) != ak_error_ok)
+        return error;
+
+    if (p_rd->p_buff[1] & 0x80u)
+    {
+        len_byte_cnt = p_rd->p_buff[1] & 0x7Fu;
+        if (!len_byte_cnt || len_byte_cnt > AK_ASN_MAX_LEN_BYTE_CNT)
+            return ak_error_message(ak_error_wrong_asn1_decode, __func__, "wrong length of block");
+
+        if ((error = pkcs_15_stream_read(p_rd->fd, p_rd->p_buff + 2, len_byte_cnt)) != ak_error_ok)
+            return error;
+    }
+
+    return ak_asn_core_get_header(p_rd->p_buff, NULL, p_tag, p_len, p_header_len);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция дочитывает содержимое блока, заголовок которого уже помещен в буфер функцией
+    container_reader_get_header(). При необходимости буфер увеличивается.
+
+    @param p_rd указатель на структуру потокового чтения
+    @param len длина данных блока
+    @param header_len длина заголовка блока
+    @param p_tlv указатель на объект, в который помещается блок целиком
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+static int container_reader_get_value(struct container_reader *p_rd, size_t len, size_t header_len, s_der_buffer *p_tlv) {
+    int error;
+    ak_byte *p_new;
+
+    if (len > PKCS_15_STREAM_MAX_OBJ_SIZE)
+        return ak_error_message(ak_error_wrong_length, __func__, "block of container is too large");
+
+    if (header_len + len > p_rd->buff_size)
+    {
+        if ((p_new = realloc(p_rd->p_buff, header_len + len)) == NULL)
+            return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        p_rd->p_buff = p_new;
+        p_rd->buff_size = header_len + len;
+    }
+
+    if ((error = pkcs_15_stream_read(p_rd->fd, p_rd->p_buff + header_len, len)) != ak_error_ok)
+        return error;
+
+    return ps_set(p_tlv, p_rd->p_buff, header_len + len, PS_R_MODE);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция считывает из файла версию контейнера и объект KeyManagementInfo и вырабатывает ключ KEK.
+    После этого ключи считываются по одному функцией container_reader_next_key(), при этом
+    в памяти хранится не более одного объекта контейнера.
+
+    @param p_rd указатель на структуру потокового чтения
+    @param fd дескриптор файла, текущая позиция которого указывает на начало контейнера
+    @param password пароль, из которого вырабатывается ключ для шифрования данных
+    @param pwd_size длинна пароля в байтах
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int container_reader_open(struct container_reader *p_rd, int fd, ak_byte *password, size_t pwd_size) {
+    int error;
+    ak_byte tag;
+    size_t len, header_len, body_len, consumed;
+    s_der_buffer tlv;
+
+    if (!p_rd || fd < 0 || !password)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    memset(p_rd, 0, sizeof(struct container_reader));
+    p_rd->fd = fd;
+    if ((error = ak_bckey_context_create_magma(&p_rd->kek)) != ak_error_ok)
+    {
+        p_rd->fd = -1;
+        return ak_error_message(error, __func__, "problem with magma context creation");
+    }
+
+    p_rd->buff_size = 256;
+    if ((p_rd->p_buff = malloc(p_rd->buff_size)) == NULL)
+    {
+        error = ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+        goto exit;
+    }
+
+    /* Заголовок контейнера */
+    if ((error = container_reader_get_header(p_rd, &tag, &body_len, &header_len)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with reading container header");
+        goto exit;
+    }
+    if (tag != (CONSTRUCTED | TSEQUENCE))
+    {
+        error = ak_error_message(ak_error_invalid_token, __func__, "wrong container tag");
+        goto exit;
+    }
+
+    /* Версия контейнера */
+    if ((error = container_reader_get_header(p_rd, &tag, &len, &header_len)) != ak_error_ok ||
+        (error = container_reader_get_value(p_rd, len, header_len, &tlv)) != ak_error_ok ||
+        (error = asn_get_expected_tlv(TINTEGER, &tlv, (void *) &p_rd->token.m_version)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with reading container version");
+        goto exit;
+    }
+    consumed = header_len + len;
+
+    /* Информация о выработке ключа KEK */
+    if ((error = container_reader_get_header(p_rd, &tag, &len, &header_len)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with reading container");
+        goto exit;
+    }
+    if (tag != (CONTEXT_SPECIFIC | CONSTRUCTED | 0u))
+    {
+        error = ak_error_message(ak_error_invalid_value, __func__, "key management info absent");
+        goto exit;
+    }
+    if ((error = container_reader_get_value(p_rd, len, header_len, &tlv)) != ak_error_ok ||
+        (error = pkcs_15_get_key_management_info(&tlv, &p_rd->token)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with reading key management info");
+        goto exit;
+    }
+    consumed += header_len + len;
+
+    /* Заголовок последовательности PKCS 15 Objects; сами объекты считываются по одному */
+    if ((error = container_reader_get_header(p_rd, &tag, &len, &header_len)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "problem with reading pkcs 15 objects header");
+        goto exit;
+    }
+    if (tag != (CONSTRUCTED | TSEQUENCE) || consumed + header_len + len != body_len)
+    {
+        error = ak_error_message(ak_error_invalid_token, __func__, "wrong pkcs 15 objects header");
+        goto exit;
+    }
+    p_rd->remain = len;
+
+    if ((error = pkcs_15_kek_generator(&p_rd->kek, password, pwd_size, p_rd->token.mpp_key_infos[0])) != ak_error_ok)
+        ak_error_message(error, __func__, "generation key from password failed");
+
+exit:
+    if (error != ak_error_ok)
+        container_reader_close(p_rd);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_rd указатель на структуру потокового чтения
+    @param pp_out_key указатель на переменную, в которую запишется указатель на расшифрованный ключ;
+    после считывания последнего ключа в переменную записывается NULL
+    @return В случае успеха функция возввращает ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+int container_reader_next_key(struct container_reader *p_rd, struct extended_key **pp_out_key) {
+    int error;
+    ak_byte tag;
+    size_t len, header_len;
+    s_der_buffer tlv;
+    s_pkcs_15_object object;
+    struct extended_key *p_key;
+
+    if (!p_rd || p_rd->fd < 0 || !pp_out_key)
+        return ak_error_message(ak_error_null_pointer, __func__, "invalid arguments");
+
+    *pp_out_key = NULL;
+    if (!p_rd->remain)
+        return ak_error_ok;
+
+    if ((error = container_reader_get_header(p_rd, &tag, &len, &header_len)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with reading object header");
+
+    if (header_len + len > p_rd->remain)
+        return ak_error_message(ak_error_invalid_token, __func__, "object exceeds pkcs 15 objects");
+
+    if ((error = container_reader_get_value(p_rd, len, header_len, &tlv)) != ak_error_ok)
+        return ak_error_message(error, __func__, "problem with reading object");
+    p_rd->remain -= header_len + len;
+
+    memset(&object, 0, sizeof(s_pkcs_15_object));
+    if ((error = pkcs_15_get_obj(&tlv, &object)) != ak_error_ok)
+    {
+        free_pkcs_15_object(&object);
+        return ak_error_message(error, __func__, "problem with parsing object");
+    }
+
+    if ((p_key = calloc(1, sizeof(struct extended_key))) == NULL)
+    {
+        free_pkcs_15_object(&object);
+        return ak_error_message(ak_error_out_of_memory, __func__, "alloc memory fail");
+    }
+
+    if ((error = get_extended_key(&object, &p_rd->kek.key, p_key)) != ak_error_ok)
+    {
+        free(p_key->label);
+        free(p_key);
+        ak_error_message(error, __func__, "problem with getting key");
+    }
+    else
+        *pp_out_key = p_key;
+    free_pkcs_15_object(&object);
+
+    return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param p_rd указатель на структуру потокового чтения                                          */
+/* ----------------------------------------------------------------------------------------------- */
+void container_reader_close(struct container_reader *p_rd) {
+    if (!p_rd)
+        return;
+
+    free(p_rd->p_buff);
+    free_pkcs_15_token(&p_rd->token);
+    ak_bckey_context_destroy(&p_rd->kek);
+    memset(p_rd, 0, sizeof(struct container_reader));
+    p_rd->fd = -1;
+}
+#endif
+
 char *key_usage_flags_to_str(key_usage_flags_t flags) {
     if (flags == 0)
         return NULL;
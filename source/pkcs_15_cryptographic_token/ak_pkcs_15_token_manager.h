@@ -43,12 +43,112 @@ struct extended_key {
     key_usage_flags_t flags;
 };
 
+/*! \brief Струкртура, хранящая общие атрибуты ключа из контейнера (без значения ключа). */
+struct key_description {
+    /*! \brief тип ключа */
+    en_obj_type key_type;
+    /*! \brief идентификатор алгоритма, для которого предназначен ключ */
+    char *algorithm;
+    /*! \brief название ключа понятное человеку */
+    ak_pointer label;
+    /*! \brief уникальный идентификатор ключа */
+    ak_byte *id;
+    /*! \brief длина уникального идентификатора ключа в байтах */
+    size_t id_size;
+    /*! \brief смещение объекта от начала DER последовательности контейнера */
+    size_t offset;
+    /*! \brief начало периода действия ключа */
+    date start_date;
+    /*! \brief конец периода действия ключа */
+    date end_date;
+    /*! \brief флаги, определяющие предназначения ключа */
+    key_usage_flags_t flags;
+};
+
+/*! \brief Метод для получения списка ключей контейнера без выработки ключа KEK и расшифрования ключей. */
+int list_keys_in_container(ak_byte *inp_container, size_t inp_container_size, struct key_description ***ppp_out_descs, ak_uint8 *num_of_out_descs);
+
+/*! \brief Освобождение памяти, выделенной функцией list_keys_in_container(). */
+void free_key_descriptions(struct key_description **pp_descs, ak_uint8 num_of_descs);
+
+/*! \brief Метод для считывания из контейнера единственного ключа с заданным идентификатором. */
+int read_key_from_container_by_id(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, const ak_byte *id, size_t id_size, struct extended_key **pp_out_key);
+
+/*! \brief Метод для считывания из контейнера единственного ключа, начинающегося с заданного смещения. */
+int read_key_from_container_at(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, size_t offset, struct extended_key **pp_out_key);
+
+/*! \brief Метод для добавления в контейнер одного ключа без перешифрования остальных ключей. */
+int add_key_to_container(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, struct extended_key *p_key, ak_byte **pp_out_container, size_t *p_out_container_size);
+
+/*! \brief Метод для замены в контейнере ключа с тем же идентификатором без перешифрования остальных ключей. */
+int replace_key_in_container(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, struct extended_key *p_key, ak_byte **pp_out_container, size_t *p_out_container_size);
+
+/*! \brief Метод для удаления из контейнера ключа с заданным идентификатором. */
+int remove_key_from_container(ak_byte *inp_container, size_t inp_container_size, const ak_byte *id, size_t id_size, ak_byte **pp_out_container, size_t *p_out_container_size);
+
 /*! \brief Метод для считывания ключей из контейнера. */
 int read_keys_from_container(ak_byte *password, size_t pwd_size, ak_byte *inp_container, size_t inp_container_size, struct extended_key ***out_keys, ak_uint8 *num_of_out_keys);
 
 /*! \brief Метод для записи ключей в контейнер. */
 int write_keys_to_container(struct extended_key **pp_inp_keys, ak_uint8 num_of_inp_keys, ak_pointer password, size_t password_size, ak_byte **pp_out_container, size_t *p_out_container_size);
 
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+/*! \brief Струкртура, хранящая состояние потоковой записи ключей в контейнер. */
+struct container_writer {
+    /*! \brief дескриптор файла, в который записывается контейнер */
+    int fd;
+    /*! \brief смещение начала контейнера в файле */
+    ak_int64 start;
+    /*! \brief размер места, зарезервированного под заголовок контейнера */
+    size_t reserved;
+    /*! \brief суммарная длина записанных объектов */
+    size_t objs_len;
+    /*! \brief количество записанных ключей */
+    size_t count;
+    /*! \brief версия контейнера и информация о выработке ключа KEK */
+    s_pkcs_15_token token;
+    /*! \brief ключ KEK */
+    struct bckey kek;
+};
+
+/*! \brief Струкртура, хранящая состояние потокового чтения ключей из контейнера. */
+struct container_reader {
+    /*! \brief дескриптор файла, из которого считывается контейнер */
+    int fd;
+    /*! \brief длина еще не считанной части последовательности PKCS 15 Objects */
+    size_t remain;
+    /*! \brief буфер, хранящий один объект контейнера */
+    ak_byte *p_buff;
+    /*! \brief размер буфера */
+    size_t buff_size;
+    /*! \brief версия контейнера и информация о выработке ключа KEK */
+    s_pkcs_15_token token;
+    /*! \brief ключ KEK */
+    struct bckey kek;
+};
+
+/*! \brief Начало потоковой записи ключей в контейнер. */
+int container_writer_open(struct container_writer *p_wr, int fd, ak_pointer password, size_t password_size);
+
+/*! \brief Зашифрование и запись в контейнер одного ключа. */
+int container_writer_put_key(struct container_writer *p_wr, struct extended_key *p_key);
+
+/*! \brief Завершение потоковой записи: запись заголовка контейнера и освобождение памяти. */
+int container_writer_close(struct container_writer *p_wr);
+
+/*! \brief Начало потокового чтения ключей из контейнера. */
+int container_reader_open(struct container_reader *p_rd, int fd, ak_byte *password, size_t pwd_size);
+
+/*! \brief Считывание и расшифрование очередного ключа контейнера. */
+int container_reader_next_key(struct container_reader *p_rd, struct extended_key **pp_out_key);
+
+/*! \brief Завершение потокового чтения и освобождение памяти. */
+void container_reader_close(struct container_reader *p_rd);
+#endif
+
+/*! \brief Удаление всех ключей KEK из кэша. */
+void pkcs_15_kek_cache_purge(void);
+
 /*! \brief Метод для преобразования флагов предназначения ключа в удобочитаемую строку. */
 char *key_usage_flags_to_str(key_usage_flags_t flags);
 
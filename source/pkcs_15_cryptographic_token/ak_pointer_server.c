@@ -18,7 +18,7 @@
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int ps_alloc(s_ptr_server *p_ps, size_t size, uint8_t mode) {
+int ps_alloc(s_ptr_server *p_ps, size_t size, ak_uint8 mode) {
     if (!p_ps)
         return ak_error_message(ak_error_null_pointer, __func__, "input value is null");
 
@@ -58,7 +58,7 @@ int ps_alloc(s_ptr_server *p_ps, size_t size, uint8_t mode) {
     @return В случае успеха функция возввращает ak_error_ok (ноль).
     В противном случае, возвращается код ошибки.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-int ps_set(s_ptr_server *p_ps, ak_byte *from, size_t len, uint8_t mode) {
+int ps_set(s_ptr_server *p_ps, ak_byte *from, size_t len, ak_uint8 mode) {
     if (!p_ps || !from)
         return ak_error_message(ak_error_null_pointer, __func__, "input value is null");
 
@@ -159,7 +159,17 @@ int ps_move_cursor(s_ptr_server *p_ps, size_t num) {
         free_size = (size_t) (p_ps->mp_curr - p_ps->mp_begin);
 
         if (free_size < num)
-            ps_realloc(p_ps, (size_t) (ps_get_full_size(p_ps) * 1.5));
+        {
+            int error;
+            size_t new_size = (size_t) (ps_get_full_size(p_ps) * 1.5);
+
+            /* Увеличения в полтора раза может оказаться недостаточно для больших блоков */
+            if (new_size - ps_get_curr_size(p_ps) < num)
+                new_size = ps_get_curr_size(p_ps) + num + ps_get_full_size(p_ps) / 2;
+
+            if ((error = ps_realloc(p_ps, new_size)) != ak_error_ok)
+                return ak_error_message(error, __func__, "problems with memory reallocation");
+        }
 
         p_ps->mp_curr -= num;
     }
@@ -0,0 +1,182 @@
+/* Пример, иллюстрирующий зашифрование и расшифрование нескольких независимых блоков
+   за один вызов функций bckey.encrypt_blocks и bckey.decrypt_blocks.
+   Результат сравнивается с поблочным зашифрованием и расшифрованием.
+   Алгоритм Кузнечик проверяется дважды: с табличной обработкой одиночных блоков
+   и с векторной (опция kuznechik_constant_time).
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-bckey06.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_bckey.h>
+ #include <ak_tools.h>
+
+ #define blocks_count (150)
+
+/* проверка одного алгоритма блочного шифрования */
+ int test_encrypt_blocks( ak_bckey );
+/* проверка режима с обратной связью: один вызов против двух последовательных вызовов */
+ int test_feedback_mode( ak_bckey , ak_function_bckey_encrypt *, ak_function_bckey_encrypt *,
+                                                                                   const char * );
+
+ int main( void )
+{
+  struct bckey key;
+  int j = 0, error = ak_error_ok;
+  ak_uint8 skey[32], in[16*17], out[2][16*18];
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  for( j = 0; j < 32; j++ ) skey[j] = (ak_uint8)( 3*j + 1 );
+  for( j = 0; j < (int) sizeof( in ); j++ ) in[j] = (ak_uint8)( 5*j + 2 );
+  for( j = 0; j < 2; j++ ) {
+    /* выбираем реализацию обработки одиночных блоков */
+     ak_libakrypt_set_option( "kuznechik_constant_time", j );
+     ak_bckey_init_kuznechik_tables();
+
+     if(( error = ak_bckey_context_create_kuznechik( &key )) != ak_error_ok ) goto lab_exit;
+     if(( error = test_encrypt_blocks( &key )) == ak_error_ok )
+       error = ak_bckey_context_set_key( &key, skey, sizeof( skey ), ak_true );
+     if( error == ak_error_ok ) {
+      /* 16 блоков обрабатываются векторной реализацией, остальные -- в зависимости от опции */
+       key.encrypt_blocks( &key.key, in, out[j], 17 );
+       key.encrypt( &key.key, in, out[j] + sizeof( in ));
+     }
+     ak_bckey_context_destroy( &key );
+     if( error != ak_error_ok ) goto lab_exit;
+  }
+  ak_libakrypt_set_option( "kuznechik_constant_time", 0 );
+  ak_bckey_init_kuznechik_tables();
+  if( memcmp( out[0], out[1], sizeof( out[0] )) != 0 ) {
+    printf(" kuznechik: table and constant time implementations are not equal\n");
+    error = ak_error_not_equal_data;
+    goto lab_exit;
+  }
+
+  if(( error = ak_bckey_context_create_magma( &key )) != ak_error_ok ) goto lab_exit;
+  error = test_encrypt_blocks( &key );
+  ak_bckey_context_destroy( &key );
+
+  lab_exit:
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}
+
+ int test_encrypt_blocks( ak_bckey key )
+{
+  size_t i, count;
+  ak_uint8 iv[8] = { 0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12 };
+  ak_uint8 skey[32] = {
+      0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+      0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+  ak_uint8 in[16*blocks_count], out[16*blocks_count], check[16*blocks_count];
+  int error = ak_error_ok;
+
+  for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( i*7 + 1 );
+  if(( error = ak_bckey_context_set_key( key, skey, sizeof( skey ), ak_true )) != ak_error_ok )
+    return error;
+
+ /* сравниваем многоблочное зашифрование с поблочным для разного количества блоков */
+  for( count = 1; count <= blocks_count; count++ ) {
+     key->encrypt_blocks( &key->key, in, out, count );
+     for( i = 0; i < count; i++ )
+        key->encrypt( &key->key, in + i*key->bsize, check + i*key->bsize );
+     if( memcmp( out, check, count*key->bsize ) != 0 ) {
+       printf(" %s: encrypt_blocks( %u ) is Wrong\n", key->key.oid->name, (unsigned int) count );
+       return ak_error_not_equal_data;
+     }
+  }
+  printf(" %s: encrypt_blocks is Ok\n", key->key.oid->name );
+
+ /* то же для многоблочного расшифрования */
+  for( count = 1; count <= blocks_count; count++ ) {
+     key->decrypt_blocks( &key->key, in, out, count );
+     for( i = 0; i < count; i++ )
+        key->decrypt( &key->key, in + i*key->bsize, check + i*key->bsize );
+     if( memcmp( out, check, count*key->bsize ) != 0 ) {
+       printf(" %s: decrypt_blocks( %u ) is Wrong\n", key->key.oid->name, (unsigned int) count );
+       return ak_error_not_equal_data;
+     }
+  }
+  printf(" %s: decrypt_blocks is Ok\n", key->key.oid->name );
+
+ /* режим простой замены: зашифрование и обратное расшифрование */
+  if(( error = ak_bckey_context_encrypt_ecb( key, in, out, sizeof( in ))) != ak_error_ok )
+    return error;
+  if(( error = ak_bckey_context_decrypt_ecb( key, out, check, sizeof( in ))) != ak_error_ok )
+    return error;
+  if( memcmp( in, check, sizeof( in )) != 0 ) {
+    printf(" %s: ecb is Wrong\n", key->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  printf(" %s: ecb is Ok\n", key->key.oid->name );
+
+ /* режим гаммирования: один вызов против последовательности вызовов по одному блоку */
+  if(( error = ak_bckey_context_ctr( key, in, out, sizeof( in ) - 3, iv, key->bsize/2 )) != ak_error_ok )
+    return error;
+  if(( error = ak_bckey_context_ctr( key, in, check, key->bsize, iv, key->bsize/2 )) != ak_error_ok )
+    return error;
+  for( i = 1; i < blocks_count*16/key->bsize - 1; i++ )
+     if(( error = ak_bckey_context_ctr( key, in + i*key->bsize,
+                                   check + i*key->bsize, key->bsize, NULL, 0 )) != ak_error_ok )
+       return error;
+  if(( error = ak_bckey_context_ctr( key, in + i*key->bsize,
+                                 check + i*key->bsize, key->bsize - 3, NULL, 0 )) != ak_error_ok )
+    return error;
+  if( memcmp( out, check, sizeof( in ) - 3 ) != 0 ) {
+    printf(" %s: ctr is Wrong\n", key->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  printf(" %s: ctr is Ok\n", key->key.oid->name );
+
+  if(( error = test_feedback_mode( key, ak_bckey_context_encrypt_cbc,
+                                           ak_bckey_context_decrypt_cbc, "cbc" )) != ak_error_ok )
+    return error;
+  if(( error = test_feedback_mode( key, ak_bckey_context_encrypt_cfb,
+                                           ak_bckey_context_decrypt_cfb, "cfb" )) != ak_error_ok )
+    return error;
+  if(( error = test_feedback_mode( key, ak_bckey_context_ofb,
+                                                   ak_bckey_context_ofb, "ofb" )) != ak_error_ok )
+    return error;
+
+ return ak_error_ok;
+}
+
+ int test_feedback_mode( ak_bckey key, ak_function_bckey_encrypt *encrypt,
+                                         ak_function_bckey_encrypt *decrypt, const char *name )
+{
+  size_t i, half = 16*( blocks_count/2 ) + 16;
+  ak_uint8 iv[48], in[16*blocks_count], out[16*blocks_count], check[16*blocks_count];
+  int error = ak_error_ok;
+
+  for( i = 0; i < sizeof( iv ); i++ ) iv[i] = (ak_uint8)( i*3 + 5 );
+  for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( i*11 + 3 );
+
+ /* зашифрование за один вызов и за два последовательных вызова */
+  if(( error = encrypt( key, in, out, sizeof( in ), iv, 3*key->bsize )) != ak_error_ok )
+    return error;
+  if(( error = encrypt( key, in, check, half, iv, 3*key->bsize )) != ak_error_ok )
+    return error;
+  if(( error = encrypt( key, in + half, check + half, sizeof( in ) - half, NULL, 0 )) != ak_error_ok )
+    return error;
+  if( memcmp( out, check, sizeof( in )) != 0 ) {
+    printf(" %s: %s encryption is Wrong\n", key->key.oid->name, name );
+    return ak_error_not_equal_data;
+  }
+
+ /* расшифрование на месте */
+  if(( error = decrypt( key, check, check, sizeof( in ), iv, 3*key->bsize )) != ak_error_ok )
+    return error;
+  if( memcmp( in, check, sizeof( in )) != 0 ) {
+    printf(" %s: %s decryption is Wrong\n", key->key.oid->name, name );
+    return ak_error_not_equal_data;
+  }
+  printf(" %s: %s is Ok\n", key->key.oid->name, name );
+
+ return ak_error_ok;
+}
@@ -0,0 +1,111 @@
+/* Пример, иллюстрирующий многопоточное шифрование больших объемов данных
+   в режимах гаммирования (CTR) и CTR-ACPKM.
+   Результат сравнивается с результатом однопоточного шифрования.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-bckey07.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_tools.h>
+ #include <ak_bckey.h>
+
+ #define data_size (1048576 + 13)
+ #define data_head (1048576 - 1008)
+
+/* проверка одного алгоритма блочного шифрования */
+ int test_threads( ak_bckey, ak_uint8 *, ak_uint8 *, ak_uint8 * );
+
+ int main( void )
+{
+  struct bckey key;
+  int error = ak_error_ok;
+  ak_uint8 *in = NULL, *out = NULL, *check = NULL;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  in = malloc( data_size ); out = malloc( data_size ); check = malloc( data_size );
+  if(( in == NULL ) || ( out == NULL ) || ( check == NULL )) {
+    error = ak_error_out_of_memory;
+    goto lab_exit;
+  }
+
+  if(( error = ak_bckey_context_create_kuznechik( &key )) != ak_error_ok ) goto lab_exit;
+  error = test_threads( &key, in, out, check );
+  ak_bckey_context_destroy( &key );
+  if( error != ak_error_ok ) goto lab_exit;
+
+  if(( error = ak_bckey_context_create_magma( &key )) != ak_error_ok ) goto lab_exit;
+  error = test_threads( &key, in, out, check );
+  ak_bckey_context_destroy( &key );
+
+  lab_exit:
+   if( in != NULL ) free( in );
+   if( out != NULL ) free( out );
+   if( check != NULL ) free( check );
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}
+
+ int test_threads( ak_bckey key, ak_uint8 *in, ak_uint8 *out, ak_uint8 *check )
+{
+  size_t i;
+  int error = ak_error_ok;
+  ak_uint8 iv[8] = { 0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12 };
+  ak_uint8 skey[32] = {
+      0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+      0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+  size_t section = key->bsize*(size_t)ak_libakrypt_get_option( key->bsize == 8 ?
+                        "acpkm_section_magma_block_count" : "acpkm_section_kuznechik_block_count" );
+
+  for( i = 0; i < data_size; i++ ) in[i] = (ak_uint8)( i*13 + 7 );
+  if(( error = ak_bckey_context_set_key( key, skey, sizeof( skey ), ak_true )) != ak_error_ok )
+    return error;
+  key->key.resource.value.counter = 4*data_size;
+
+ /* режим гаммирования: однопоточное шифрование против многопоточного */
+  ak_libakrypt_set_option( "bckey_threads_threshold", 0 );
+  if(( error = ak_bckey_context_ctr( key, in, check, data_size, iv, key->bsize/2 )) != ak_error_ok )
+    return error;
+  ak_libakrypt_set_option( "bckey_threads_count", 4 );
+  ak_libakrypt_set_option( "bckey_threads_threshold", 65536 );
+  if(( error = ak_bckey_context_ctr( key, in, out, data_head, iv, key->bsize/2 )) != ak_error_ok )
+    return error;
+  if(( error = ak_bckey_context_ctr( key, in + data_head,
+                               out + data_head, data_size - data_head, NULL, 0 )) != ak_error_ok )
+    return error;
+  if( memcmp( out, check, data_size ) != 0 ) {
+    printf(" %s: multithreaded ctr is Wrong\n", key->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  printf(" %s: multithreaded ctr is Ok\n", key->key.oid->name );
+
+ /* режим CTR-ACPKM */
+  ak_libakrypt_set_option( "bckey_threads_threshold", 0 );
+  if(( error = ak_bckey_context_ctr_acpkm( key, in, check, data_size, section,
+                                                         iv, key->bsize/2 )) != ak_error_ok )
+    return error;
+  for( i = 3; i <= 5; i++ ) {
+     ak_libakrypt_set_option( "bckey_threads_count", (ak_int64)i );
+     ak_libakrypt_set_option( "bckey_threads_threshold", 65536 );
+     if(( error = ak_bckey_context_ctr_acpkm( key, in, out, data_size, section,
+                                                         iv, key->bsize/2 )) != ak_error_ok )
+       return error;
+     if( memcmp( out, check, data_size ) != 0 ) {
+       printf(" %s: multithreaded ctr-acpkm with %u threads is Wrong\n",
+                                                       key->key.oid->name, (unsigned int) i );
+       return ak_error_not_equal_data;
+     }
+  }
+  printf(" %s: multithreaded ctr-acpkm is Ok\n", key->key.oid->name );
+
+ /* восстанавливаем значения опций */
+  ak_libakrypt_set_option( "bckey_threads_count", 0 );
+  ak_libakrypt_set_option( "bckey_threads_threshold", 1048576 );
+
+ return ak_error_ok;
+}
@@ -0,0 +1,160 @@
+/* Пример, иллюстрирующий использование политик проверки целостности и перемаскирования
+   секретного ключа. Результаты зашифрования при различных политиках сравниваются
+   с результатом, полученным при политике по-умолчанию (перемаскирование при каждом вызове).
+   Также проверяется, что маска не изменяется до достижения порогового значения
+   и изменяется при его достижении.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-bckey08.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_bckey.h>
+
+ #define blocks_count (64)
+
+/* проверка одного алгоритма блочного шифрования */
+ int test_policy( ak_bckey );
+/* проверка момента перемаскирования для политик skey_policy_calls и skey_policy_bytes */
+ int test_policy_limits( ak_bckey );
+
+ int main( void )
+{
+  struct bckey key;
+  int error = ak_error_ok;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  if(( error = ak_bckey_context_create_kuznechik( &key )) != ak_error_ok ) goto lab_exit;
+  error = test_policy( &key );
+  ak_bckey_context_destroy( &key );
+  if( error != ak_error_ok ) goto lab_exit;
+
+  if(( error = ak_bckey_context_create_magma( &key )) != ak_error_ok ) goto lab_exit;
+  error = test_policy( &key );
+  ak_bckey_context_destroy( &key );
+
+  lab_exit:
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}
+
+ int test_policy( ak_bckey key )
+{
+  size_t i, j;
+  int error = ak_error_ok;
+  ak_uint8 mask[32], iv[16] = { 0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12,
+                             0x21, 0x43, 0x65, 0x87, 0xa9, 0xcb, 0xed, 0x0f };
+  ak_uint8 skey[32] = {
+      0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+      0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+  ak_uint8 in[16*blocks_count], out[16*blocks_count], check[16*blocks_count];
+  struct { skey_policy_t type; ak_uint64 limit; const char *name; } policies[3] = {
+    { skey_policy_calls, 5, "calls" },
+    { skey_policy_bytes, 100, "bytes" },
+    { skey_policy_timer, 3600, "timer" }
+  };
+
+  for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( i*5 + 3 );
+  if(( error = ak_bckey_context_set_key( key, skey, sizeof( skey ), ak_true )) != ak_error_ok )
+    return error;
+
+ /* эталонное зашифрование при политике по-умолчанию: по одному блоку за вызов */
+  if(( error = ak_bckey_context_encrypt_ecb( key, in, check, key->bsize )) != ak_error_ok )
+    return error;
+  for( i = 1; i < sizeof( in )/key->bsize; i++ )
+     if(( error = ak_bckey_context_encrypt_cbc( key, in + i*key->bsize, check + i*key->bsize,
+                             key->bsize, i == 1 ? iv : NULL, i == 1 ? key->bsize : 0 )) != ak_error_ok )
+       return error;
+
+  for( j = 0; j < 3; j++ ) {
+     if(( error = ak_skey_context_set_policy( &key->key,
+                                      policies[j].type, policies[j].limit )) != ak_error_ok )
+       return error;
+     if(( error = ak_bckey_context_encrypt_ecb( key, in, out, key->bsize )) != ak_error_ok )
+       return error;
+     for( i = 1; i < sizeof( in )/key->bsize; i++ ) {
+       /* в промежутках между перемаскированиями значение маски не должно изменяться */
+        memcpy( mask, key->key.mask.data, key->key.mask.size );
+        if(( error = ak_bckey_context_encrypt_cbc( key, in + i*key->bsize, out + i*key->bsize,
+                             key->bsize, i == 1 ? iv : NULL, i == 1 ? key->bsize : 0 )) != ak_error_ok )
+          return error;
+        if(( policies[j].type == skey_policy_timer ) &&
+                             ( memcmp( mask, key->key.mask.data, key->key.mask.size ) != 0 )) {
+          printf(" %s: mask was changed under %s policy\n", key->key.oid->name, policies[j].name );
+          return ak_error_not_equal_data;
+        }
+     }
+     if( memcmp( out, check, sizeof( in )) != 0 ) {
+       printf(" %s: encryption with %s policy is Wrong\n", key->key.oid->name, policies[j].name );
+       return ak_error_not_equal_data;
+     }
+     printf(" %s: %s policy is Ok\n", key->key.oid->name, policies[j].name );
+  }
+
+ /* нулевое пороговое значение недопустимо */
+  if( ak_skey_context_set_policy( &key->key, skey_policy_calls, 0 ) != ak_error_zero_length ) {
+    printf(" %s: zero limit was accepted\n", key->key.oid->name );
+    return ak_error_invalid_value;
+  }
+  ak_error_set_value( ak_error_ok );
+
+  if(( error = test_policy_limits( key )) != ak_error_ok ) return error;
+ return ak_skey_context_set_policy( &key->key, skey_policy_every_call, 0 );
+}
+
+ int test_policy_limits( ak_bckey key )
+{
+  size_t i, j;
+  int error = ak_error_ok;
+  bool_t changed = ak_false;
+  ak_uint8 mask[32], iv[16], in[128], out[128];
+
+  for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( i*3 + 7 );
+  for( i = 0; i < sizeof( iv ); i++ ) iv[i] = (ak_uint8)( i + 1 );
+
+ /* пять вызовов: маска изменяется только при пятом вызове */
+  if(( error = ak_skey_context_set_policy( &key->key, skey_policy_calls, 5 )) != ak_error_ok )
+    return error;
+  for( j = 0; j < 2; j++ ) {
+     memcpy( mask, key->key.mask.data, key->key.mask.size );
+     for( i = 1; i <= 5; i++ ) {
+        if(( error = ak_bckey_context_encrypt_ecb( key, in, out, key->bsize )) != ak_error_ok )
+          return error;
+        changed = ( memcmp( mask, key->key.mask.data, key->key.mask.size ) != 0 );
+        if( changed != ( i == 5 )) {
+          printf(" %s: mask %s after %u calls under calls policy\n", key->key.oid->name,
+                                          changed ? "was changed" : "was not changed", (unsigned int) i );
+          return ak_error_not_equal_data;
+        }
+     }
+  }
+
+ /* сто октетов: маска не изменяется после 99 октетов и изменяется после сотого */
+  if(( error = ak_skey_context_set_policy( &key->key, skey_policy_bytes, 100 )) != ak_error_ok )
+    return error;
+  for( j = 0; j < 2; j++ ) {
+     memcpy( mask, key->key.mask.data, key->key.mask.size );
+     if(( error = ak_bckey_context_ctr( key, in, out, 60, iv, key->bsize/2 )) != ak_error_ok )
+       return error;
+     if(( error = ak_bckey_context_ctr( key, in, out, 39, iv, key->bsize/2 )) != ak_error_ok )
+       return error;
+     if( memcmp( mask, key->key.mask.data, key->key.mask.size ) != 0 ) {
+       printf(" %s: mask was changed after 99 bytes under bytes policy\n", key->key.oid->name );
+       return ak_error_not_equal_data;
+     }
+     if(( error = ak_bckey_context_ctr( key, in, out, 1, iv, key->bsize/2 )) != ak_error_ok )
+       return error;
+     if( memcmp( mask, key->key.mask.data, key->key.mask.size ) == 0 ) {
+       printf(" %s: mask was not changed after 100 bytes under bytes policy\n", key->key.oid->name );
+       return ak_error_not_equal_data;
+     }
+  }
+  printf(" %s: remasking at the limit is Ok\n", key->key.oid->name );
+
+ return ak_error_ok;
+}
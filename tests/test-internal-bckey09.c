@@ -0,0 +1,102 @@
+/* Пример, иллюстрирующий скорость зашифрования и расшифрования одиночных блоков
+   алгоритмами блочного шифрования, а также скорость режимов с зацеплением (CBC, OMAC).
+   Для алгоритма Кузнечик измерения выполняются дважды: с табличной обработкой одиночных
+   блоков и с векторной (опция kuznechik_constant_time).
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-bckey09.c
+*/
+ #include <time.h>
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_bckey.h>
+ #include <ak_tools.h>
+
+ #define iterations (200000)
+ #define data_size (1048576)
+
+/* измерение скорости для одного ключа */
+ int test_single_block( ak_bckey , const char * );
+
+ int main( void )
+{
+  struct bckey key;
+  int error = ak_error_ok;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  if(( error = ak_bckey_context_create_magma( &key )) != ak_error_ok ) goto lab_exit;
+  error = test_single_block( &key, "magma" );
+  ak_bckey_context_destroy( &key );
+  if( error != ak_error_ok ) goto lab_exit;
+
+  if(( error = ak_bckey_context_create_kuznechik( &key )) != ak_error_ok ) goto lab_exit;
+  error = test_single_block( &key, "kuznechik (tables)" );
+  ak_bckey_context_destroy( &key );
+  if( error != ak_error_ok ) goto lab_exit;
+
+ /* повторяем измерения для векторной обработки одиночных блоков */
+  ak_libakrypt_set_option( "kuznechik_constant_time", 1 );
+  ak_bckey_init_kuznechik_tables();
+  if(( error = ak_bckey_context_create_kuznechik( &key )) != ak_error_ok ) goto lab_exit;
+  error = test_single_block( &key, "kuznechik (constant time)" );
+  ak_bckey_context_destroy( &key );
+
+  lab_exit:
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}
+
+ int test_single_block( ak_bckey key, const char *name )
+{
+  size_t i;
+  clock_t time = 0;
+  ak_uint8 skey[32], iv[16], block[16], icode[16], *data = NULL;
+  int error = ak_error_ok;
+
+  for( i = 0; i < 32; i++ ) skey[i] = (ak_uint8)( i*7 + 3 );
+  for( i = 0; i < 16; i++ ) iv[i] = block[i] = (ak_uint8) i;
+  if(( error = ak_bckey_context_set_key( key, skey, sizeof( skey ), ak_true )) != ak_error_ok )
+    return error;
+  if(( data = malloc( data_size )) == NULL ) return ak_error_out_of_memory;
+  memset( data, 0x5a, data_size );
+
+ /* зашифрование одного блока */
+  time = clock();
+  for( i = 0; i < iterations; i++ ) key->encrypt( &key->key, block, block );
+  time = clock() - time;
+  printf(" %s: encrypt %.1f ns per block\n", name,
+                                   1.0e9 * (double) time / ( (double) CLOCKS_PER_SEC * iterations ));
+
+ /* расшифрование одного блока */
+  time = clock();
+  for( i = 0; i < iterations; i++ ) key->decrypt( &key->key, block, block );
+  time = clock() - time;
+  printf(" %s: decrypt %.1f ns per block\n", name,
+                                   1.0e9 * (double) time / ( (double) CLOCKS_PER_SEC * iterations ));
+
+ /* режим простой замены с зацеплением */
+  time = clock();
+  if(( error = ak_bckey_context_encrypt_cbc( key, data, data, data_size,
+                                                              iv, key->bsize )) != ak_error_ok )
+    goto lab_exit;
+  time = clock() - time;
+  printf(" %s: cbc %.2f MB/sec\n", name,
+                   (double) CLOCKS_PER_SEC * data_size / ( 1048576.0 * (double)( time + 1 )));
+
+ /* выработка имитовставки */
+  time = clock();
+  ak_bckey_context_omac( key, data, data_size, icode );
+  time = clock() - time;
+  if(( error = ak_error_get_value()) != ak_error_ok ) goto lab_exit;
+  printf(" %s: omac %.2f MB/sec\n", name,
+                   (double) CLOCKS_PER_SEC * data_size / ( 1048576.0 * (double)( time + 1 )));
+
+  lab_exit:
+   free( data );
+ return error;
+}
@@ -0,0 +1,91 @@
+/* Пример, иллюстрирующий одновременное хеширование большого количества
+   независимых сообщений различной длины.
+   Результат сравнивается с хешированием каждого сообщения по отдельности.
+   Проверка выполняется для каждой реализации функции сжатия (опция streebog_implementation),
+   кроме того, преобразования каждой реализации сравниваются со скалярными.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-hash04.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_hash.h>
+ #include <ak_tools.h>
+
+ #define jobs_count (300)
+ #define data_size (70000)
+
+ int main( void )
+{
+  size_t i;
+  struct hash ctx256, ctx512, prefix;
+  struct hash_job jobs[jobs_count];
+  ak_uint8 *data = NULL, out[jobs_count][64], check[64];
+  int error = ak_error_ok, result = EXIT_FAILURE, impl = 0;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  if(( data = malloc( data_size )) == NULL ) goto lab_exit;
+  for( i = 0; i < data_size; i++ ) data[i] = (ak_uint8)( i*29 + i/251 );
+
+  ak_hash_context_create_streebog256( &ctx256 );
+  ak_hash_context_create_streebog512( &ctx512 );
+ /* контекст, в котором уже обработан первый блок данных */
+  ak_hash_context_create_streebog512( &prefix );
+  prefix.update( &prefix, data, 64 );
+
+  for( impl = 1; impl <= 4; impl++ ) {
+    ak_libakrypt_set_option( "streebog_implementation", impl );
+    ak_hash_init_streebog_tables();
+    printf(" %s implementation: ", ak_hash_get_streebog_implementation( ));
+    if( !ak_hash_test_streebog_implementation( )) {
+      printf("transformations is Wrong\n");
+      goto lab_destroy;
+    }
+
+   /* задания с различными контекстами и длинами (включая нулевую и кратные длине блока) */
+    memset( out, 0, sizeof( out ));
+    for( i = 0; i < jobs_count; i++ ) {
+       jobs[i].ctx = ( i%3 == 0 ) ? &ctx256 : (( i%3 == 1 ) ? &ctx512 : &prefix );
+       jobs[i].in = data + 64;
+       jobs[i].size = ( i%50 == 17 ) ? data_size - 64 : ( i*13 )%257;
+       jobs[i].out = out[i];
+    }
+    if(( error = ak_hash_context_ptr_jobs( jobs, jobs_count )) != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect hashing of jobs" );
+      goto lab_destroy;
+    }
+
+    for( i = 0; i < jobs_count; i++ ) {
+       if( jobs[i].ctx == &prefix )
+         ak_hash_context_ptr( &ctx512, data, jobs[i].size + 64, check );
+        else ak_hash_context_ptr( jobs[i].ctx, jobs[i].in, jobs[i].size, check );
+       if( memcmp( out[i], check, jobs[i].ctx->hsize ) != 0 ) {
+         printf(" job %u (%u bytes) is Wrong\n", (unsigned int) i, (unsigned int) jobs[i].size );
+         goto lab_destroy;
+       }
+    }
+    printf("transformations and %u hash jobs is Ok\n", (unsigned int) jobs_count );
+  }
+
+ /* задание без контекста функции хеширования не может быть выполнено */
+  jobs[0].ctx = NULL;
+  if( ak_hash_context_ptr_jobs( jobs, jobs_count ) == ak_error_ok ) goto lab_destroy;
+  ak_error_set_value( ak_error_ok );
+  result = EXIT_SUCCESS;
+
+  lab_destroy:
+   ak_libakrypt_set_option( "streebog_implementation", 0 );
+   ak_hash_init_streebog_tables();
+   ak_hash_context_destroy( &prefix );
+   ak_hash_context_destroy( &ctx512 );
+   ak_hash_context_destroy( &ctx256 );
+
+  lab_exit:
+   if( data != NULL ) free( data );
+   ak_libakrypt_destroy();
+ return result;
+}
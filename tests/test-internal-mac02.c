@@ -0,0 +1,72 @@
+/* Пример, иллюстрирующий повторное использование начальных состояний функции хеширования
+   в алгоритме HMAC: после смены ключа имитовставка должна совпадать с имитовставкой,
+   вычисленной во вновь созданном контексте.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-mac02.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_hmac.h>
+
+/* вычисление имитовставки во вновь созданном контексте */
+ int test_fresh_hmac( const ak_pointer , const size_t , const ak_uint8 *, const size_t , ak_uint8 * );
+
+ int main( void )
+{
+  size_t i, j;
+  struct hmac hctx;
+  ak_uint8 key[100], data[300], out[64], check[64];
+  int error = ak_error_ok, result = EXIT_FAILURE;
+  const size_t key_sizes[4] = { 32, 64, 16, 100 }; /* последний ключ длиннее блока */
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  for( i = 0; i < sizeof( key ); i++ ) key[i] = (ak_uint8)( i*17 + 5 );
+  for( i = 0; i < sizeof( data ); i++ ) data[i] = (ak_uint8)( i*3 + 11 );
+  if(( error = ak_hmac_context_create_streebog512( &hctx )) != ak_error_ok ) goto lab_exit;
+
+ /* меняем ключ и для каждого ключа вычисляем имитовставку от сообщений разной длины */
+  for( i = 0; i < 4; i++ ) {
+     key[0] = (ak_uint8) i;
+     if(( error = ak_hmac_context_set_key( &hctx, key, key_sizes[i], ak_true )) != ak_error_ok )
+       goto lab_destroy;
+     for( j = 0; j < sizeof( data ); j += 37 ) {
+        ak_hmac_context_ptr( &hctx, data, j, out );
+        if(( error = test_fresh_hmac( key, key_sizes[i], data, j, check )) != ak_error_ok )
+          goto lab_destroy;
+        if( memcmp( out, check, 64 ) != 0 ) {
+          printf(" hmac with key %u and data length %u is Wrong\n",
+                                                              (unsigned int) i, (unsigned int) j );
+          goto lab_destroy;
+        }
+     }
+  }
+  printf(" hmac after key changes is Ok\n");
+  result = EXIT_SUCCESS;
+
+  lab_destroy:
+   ak_hmac_context_destroy( &hctx );
+
+  lab_exit:
+   ak_libakrypt_destroy();
+ return result;
+}
+
+ int test_fresh_hmac( const ak_pointer key, const size_t key_size,
+                                           const ak_uint8 *data, const size_t size, ak_uint8 *out )
+{
+  struct hmac hctx;
+  int error = ak_error_ok;
+
+  if(( error = ak_hmac_context_create_streebog512( &hctx )) != ak_error_ok ) return error;
+  if(( error = ak_hmac_context_set_key( &hctx, key, key_size, ak_true )) == ak_error_ok ) {
+    ak_hmac_context_ptr( &hctx, (ak_pointer) data, size, out );
+    error = ak_error_get_value();
+  }
+  ak_hmac_context_destroy( &hctx );
+ return error;
+}
@@ -0,0 +1,126 @@
+/* Пример, иллюстрирующий выработку ключевых векторов произвольной длины по алгоритму PBKDF2,
+   а также пакетную выработку ключевых векторов для нескольких пар (пароль, соль).
+   Результаты сравниваются с вычислением блоков T_i непосредственно с помощью алгоритма HMAC.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-mac03.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_hmac.h>
+ #include <ak_tools.h>
+
+ #define jobs_count (11)
+ #define iterations (50)
+
+/* вычисление ключевого вектора: последние dklen байт T_1 при dklen <= 64,
+   иначе - первые dklen байт строки T_1||...||T_l */
+ int test_pbkdf2( const ak_uint8 *, const size_t , const ak_uint8 *, const size_t ,
+                                                                const size_t , ak_uint8 * );
+ int main( void )
+{
+  size_t i, j;
+  struct pbkdf2_job jobs[jobs_count];
+  ak_uint8 pass[jobs_count][16], salt[jobs_count][40], out[jobs_count][200], check[200];
+  const size_t lengths[6] = { 32, 64, 65, 100, 128, 200 };
+  int error = ak_error_ok, result = EXIT_FAILURE;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  for( i = 0; i < jobs_count; i++ )
+     for( j = 0; j < 40; j++ ) {
+        if( j < 16 ) pass[i][j] = (ak_uint8)( 'a' + ( i*7 + j )%26 );
+        salt[i][j] = (ak_uint8)( i*13 + j*5 );
+     }
+
+ /* выработка ключевых векторов различной длины, в том числе несколькими потоками */
+  for( j = 0; j < 2; j++ ) {
+     ak_libakrypt_set_option( "pbkdf2_threads_count", j ? 3 : 1 );
+     for( i = 0; i < 6; i++ ) {
+        memset( out[0], 0, 200 );
+        if(( error = ak_hmac_context_pbkdf2_streebog512( pass[0], 8, salt[0], 16,
+                                              iterations, lengths[i], out[0] )) != ak_error_ok )
+          goto lab_exit;
+        if(( error = test_pbkdf2( pass[0], 8, salt[0], 16, lengths[i], check )) != ak_error_ok )
+          goto lab_exit;
+        if( memcmp( out[0], check, lengths[i] ) != 0 ) {
+          printf(" pbkdf2 with %u bytes output is Wrong\n", (unsigned int) lengths[i] );
+          goto lab_exit;
+        }
+     }
+  }
+  printf(" pbkdf2 with long outputs is Ok\n");
+
+ /* пакетная выработка, одно из заданий содержит ошибку */
+  memset( out, 0, sizeof( out ));
+  for( i = 0; i < jobs_count; i++ ) {
+     jobs[i].pass = pass[i];
+     jobs[i].pass_size = 4 + i;
+     jobs[i].salt = salt[i];
+     jobs[i].salt_size = ( i*11 )%40; /* в том числе пустая соль */
+     jobs[i].out = out[i];
+  }
+  jobs[5].pass = NULL;
+  if( ak_hmac_context_pbkdf2_streebog512_jobs( jobs, jobs_count,
+                                                        iterations, 100 ) != ak_error_null_pointer )
+    goto lab_exit;
+  ak_error_set_value( ak_error_ok );
+
+  for( i = 0; i < jobs_count; i++ ) {
+     if( i == 5 ) {
+       if( jobs[i].error != ak_error_null_pointer ) goto lab_exit;
+       continue;
+     }
+     if( jobs[i].error != ak_error_ok ) goto lab_exit;
+     if(( error = ak_hmac_context_pbkdf2_streebog512( pass[i], jobs[i].pass_size,
+                            salt[i], jobs[i].salt_size, iterations, 100, check )) != ak_error_ok )
+       goto lab_exit;
+     if( memcmp( out[i], check, 100 ) != 0 ) {
+       printf(" pbkdf2 job %u is Wrong\n", (unsigned int) i );
+       goto lab_exit;
+     }
+  }
+  printf(" %u pbkdf2 jobs is Ok\n", (unsigned int) jobs_count );
+  result = EXIT_SUCCESS;
+
+  lab_exit:
+   ak_libakrypt_destroy();
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test_pbkdf2( const ak_uint8 *pass, const size_t pass_size, const ak_uint8 *salt,
+                               const size_t salt_size, const size_t dklen, ak_uint8 *out )
+{
+  struct hmac hctx;
+  size_t i, j, k, l = ( dklen + 63 )/64;
+  ak_uint8 data[64], u[64], t[256];
+  int error = ak_error_ok;
+
+  if(( error = ak_hmac_context_create_streebog512( &hctx )) != ak_error_ok ) return error;
+  if(( error = ak_hmac_context_set_key( &hctx, (ak_pointer) pass,
+                                                         pass_size, ak_true )) != ak_error_ok ) {
+    ak_hmac_context_destroy( &hctx );
+    return error;
+  }
+  for( i = 1; i <= l; i++ ) {
+    /* U_1 = hmac( P, S||INT(i) ) */
+     memcpy( data, salt, salt_size );
+     data[salt_size] = 0; data[salt_size+1] = 0; data[salt_size+2] = 0;
+     data[salt_size+3] = (ak_uint8) i;
+     ak_hmac_context_ptr( &hctx, data, salt_size + 4, u );
+     memcpy( t + 64*( i-1 ), u, 64 );
+     for( j = 1; j < iterations; j++ ) {
+        ak_hmac_context_ptr( &hctx, u, 64, u );
+        for( k = 0; k < 64; k++ ) t[64*( i-1 )+k] ^= u[k];
+     }
+  }
+  if( l == 1 ) memcpy( out, t + 64 - dklen, dklen );
+    else memcpy( out, t, dklen );
+  error = ak_error_get_value();
+  ak_hmac_context_destroy( &hctx );
+ return error;
+}
@@ -0,0 +1,124 @@
+/* Пример, иллюстрирующий пакетную обработку данных в режиме MGM.
+   Результат зашифрования (и имитовставка) больших фрагментов данных за один вызов функции
+   сравнивается с результатом поблочной обработки тех же данных.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-mgm05.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_mgm.h>
+
+ #define data_size (16*200 + 11)
+ #define adata_size (16*70 + 3)
+
+/* проверка одного алгоритма блочного шифрования */
+ int test_mgm( ak_bckey, ak_bckey );
+/* поблочное вычисление */
+ int test_mgm_blockwise( ak_bckey, ak_bckey , ak_uint8 *, ak_uint8 *, ak_uint8 *, ak_uint8 * );
+
+ static ak_uint8 iv[16] = {
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ int main( void )
+{
+  struct bckey ekey, akey;
+  int error = ak_error_ok;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  if(( error = ak_bckey_context_create_kuznechik( &ekey )) != ak_error_ok ) goto lab_exit;
+  if(( error = ak_bckey_context_create_kuznechik( &akey )) == ak_error_ok ) {
+    error = test_mgm( &ekey, &akey );
+    ak_bckey_context_destroy( &akey );
+  }
+  ak_bckey_context_destroy( &ekey );
+  if( error != ak_error_ok ) goto lab_exit;
+
+  if(( error = ak_bckey_context_create_magma( &ekey )) != ak_error_ok ) goto lab_exit;
+  if(( error = ak_bckey_context_create_magma( &akey )) == ak_error_ok ) {
+    error = test_mgm( &ekey, &akey );
+    ak_bckey_context_destroy( &akey );
+  }
+  ak_bckey_context_destroy( &ekey );
+
+  lab_exit:
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}
+
+ int test_mgm( ak_bckey ekey, ak_bckey akey )
+{
+  size_t i;
+  int error = ak_error_ok;
+  ak_uint8 skey[32], in[data_size], out[data_size], check[data_size], adata[adata_size];
+  ak_uint8 icode[16], icode2[16];
+
+  for( i = 0; i < sizeof( skey ); i++ ) skey[i] = (ak_uint8)( i*17 + 3 );
+  for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( i*13 + 7 );
+  for( i = 0; i < sizeof( adata ); i++ ) adata[i] = (ak_uint8)( i*5 + 1 );
+  if(( error = ak_bckey_context_set_key( ekey, skey, sizeof( skey ), ak_true )) != ak_error_ok )
+    return error;
+  skey[0] ^= 0x5a;
+  if(( error = ak_bckey_context_set_key( akey, skey, sizeof( skey ), ak_true )) != ak_error_ok )
+    return error;
+
+ /* зашифрование за один вызов */
+  ak_bckey_context_encrypt_mgm( ekey, akey, adata, sizeof( adata ), in, out, sizeof( in ),
+                                                         iv, ekey->bsize, icode, ekey->bsize );
+  if(( error = ak_error_get_value()) != ak_error_ok ) return error;
+
+ /* поблочное зашифрование */
+  if(( error = test_mgm_blockwise( ekey, akey, adata, in, check, icode2 )) != ak_error_ok )
+    return error;
+  if( memcmp( out, check, sizeof( in )) != 0 ) {
+    printf(" %s: mgm encryption is Wrong\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  if( memcmp( icode, icode2, ekey->bsize ) != 0 ) {
+    printf(" %s: mgm integrity code is Wrong\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+
+ /* расшифрование на месте с проверкой имитовставки */
+  if( ak_bckey_context_decrypt_mgm( ekey, akey, adata, sizeof( adata ), check, check,
+                               sizeof( in ), iv, ekey->bsize, icode, ekey->bsize ) != ak_true ) {
+    printf(" %s: mgm decryption is Wrong\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  if( memcmp( in, check, sizeof( in )) != 0 ) {
+    printf(" %s: mgm decrypted data is Wrong\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  printf(" %s: mgm is Ok\n", ekey->key.oid->name );
+
+ return ak_error_ok;
+}
+
+ int test_mgm_blockwise( ak_bckey ekey, ak_bckey akey,
+                               ak_uint8 *adata, ak_uint8 *in, ak_uint8 *out, ak_uint8 *icode )
+{
+  size_t i, bs = ekey->bsize;
+  struct mgm_ctx mgm;
+  int error = ak_error_ok;
+
+  if(( error = ak_mgm_context_authentication_clean( &mgm, akey, iv, bs )) != ak_error_ok )
+    return error;
+  for( i = 0; i < adata_size; i += bs )
+     if(( error = ak_mgm_context_authentication_update( &mgm, akey,
+                                     adata + i, ak_min( bs, adata_size - i ))) != ak_error_ok )
+       return error;
+  if(( error = ak_mgm_context_encryption_clean( &mgm, ekey, iv, bs )) != ak_error_ok )
+    return error;
+  for( i = 0; i < data_size; i += bs )
+     if(( error = ak_mgm_context_encryption_update( &mgm, ekey, akey,
+                                   in + i, out + i, ak_min( bs, data_size - i ))) != ak_error_ok )
+       return error;
+  ak_mgm_context_authentication_finalize( &mgm, akey, icode, bs );
+
+ return ak_error_get_value();
+}
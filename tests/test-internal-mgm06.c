@@ -0,0 +1,129 @@
+/* Пример, иллюстрирующий зашифрование в режиме MGM данных,
+   расположенных в нескольких несмежных фрагментах.
+   Результат сравнивается с зашифрованием тех же данных, расположенных в одной области памяти.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-mgm06.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_mgm.h>
+
+ #define data_size (531)
+ #define adata_size (77)
+
+/* проверка одного алгоритма блочного шифрования */
+ int test_segments( ak_bckey, ak_bckey );
+/* разбиение области памяти на фрагменты заданных длин */
+ size_t split( ak_uint8 *, size_t , const size_t *, struct segment * );
+
+ static ak_uint8 iv[16] = {
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ int main( void )
+{
+  struct bckey ekey, akey;
+  int error = ak_error_ok;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  if(( error = ak_bckey_context_create_kuznechik( &ekey )) != ak_error_ok ) goto lab_exit;
+  if(( error = ak_bckey_context_create_kuznechik( &akey )) == ak_error_ok ) {
+    error = test_segments( &ekey, &akey );
+    ak_bckey_context_destroy( &akey );
+  }
+  ak_bckey_context_destroy( &ekey );
+  if( error != ak_error_ok ) goto lab_exit;
+
+  if(( error = ak_bckey_context_create_magma( &ekey )) != ak_error_ok ) goto lab_exit;
+  if(( error = ak_bckey_context_create_magma( &akey )) == ak_error_ok ) {
+    error = test_segments( &ekey, &akey );
+    ak_bckey_context_destroy( &akey );
+  }
+  ak_bckey_context_destroy( &ekey );
+
+  lab_exit:
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}
+
+ size_t split( ak_uint8 *data, size_t size, const size_t *lengths, struct segment *seg )
+{
+  size_t i = 0;
+
+  for( i = 0; size > 0; i++ ) {
+     seg[i].data = data;
+     seg[i].size = ak_min( size, lengths[i] );
+     data += seg[i].size; size -= seg[i].size;
+  }
+ return i;
+}
+
+ int test_segments( ak_bckey ekey, ak_bckey akey )
+{
+  size_t i, acount, icount, ocount;
+  int error = ak_error_ok;
+  ak_uint8 skey[32], in[data_size], out[data_size], check[data_size], adata[adata_size];
+  ak_uint8 icode[16], icode2[16];
+  struct segment aseg[32], iseg[32], oseg[32];
+  const size_t alen[] = { 3, 0, 16, 5, 21, 40 };
+  const size_t ilen[] = { 1, 7, 9, 64, 0, 33, 100, 3, 16, 48, 250 };
+  const size_t olen[] = { 20, 13, 128, 1, 2, 200, 170 };
+
+  for( i = 0; i < sizeof( skey ); i++ ) skey[i] = (ak_uint8)( i*17 + 3 );
+  for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( i*13 + 7 );
+  for( i = 0; i < sizeof( adata ); i++ ) adata[i] = (ak_uint8)( i*5 + 1 );
+  if(( error = ak_bckey_context_set_key( ekey, skey, sizeof( skey ), ak_true )) != ak_error_ok )
+    return error;
+  skey[0] ^= 0x5a;
+  if(( error = ak_bckey_context_set_key( akey, skey, sizeof( skey ), ak_true )) != ak_error_ok )
+    return error;
+
+ /* зашифрование данных, расположенных в одной области памяти */
+  ak_bckey_context_encrypt_mgm( ekey, akey, adata, sizeof( adata ), in, out, sizeof( in ),
+                                                         iv, ekey->bsize, icode, ekey->bsize );
+  if(( error = ak_error_get_value()) != ak_error_ok ) return error;
+
+ /* зашифрование фрагментов с несовпадающими границами */
+  memset( check, 0, sizeof( check ));
+  acount = split( adata, sizeof( adata ), alen, aseg );
+  icount = split( in, sizeof( in ), ilen, iseg );
+  ocount = split( check, sizeof( check ), olen, oseg );
+  ak_bckey_context_encrypt_mgm_segments( ekey, akey, aseg, acount, iseg, icount,
+                                     oseg, ocount, iv, ekey->bsize, icode2, ekey->bsize );
+  if(( error = ak_error_get_value()) != ak_error_ok ) return error;
+  if( memcmp( out, check, sizeof( in )) != 0 ) {
+    printf(" %s: mgm encryption of segments is Wrong\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  if( memcmp( icode, icode2, ekey->bsize ) != 0 ) {
+    printf(" %s: mgm integrity code of segments is Wrong\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+
+ /* расшифрование на месте */
+  if( ak_bckey_context_decrypt_mgm_segments( ekey, akey, aseg, acount, oseg, ocount,
+                            oseg, ocount, iv, ekey->bsize, icode, ekey->bsize ) != ak_true ) {
+    printf(" %s: mgm decryption of segments is Wrong\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  if( memcmp( in, check, sizeof( in )) != 0 ) {
+    printf(" %s: mgm decrypted segments is Wrong\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+
+ /* изменение ассоциированных данных должно обнаруживаться */
+  adata[adata_size-1] ^= 0x01;
+  if( ak_bckey_context_decrypt_mgm_segments( ekey, akey, aseg, acount, iseg, icount,
+                              oseg, ocount, iv, ekey->bsize, icode, ekey->bsize ) != ak_false ) {
+    printf(" %s: mgm modified segments is not detected\n", ekey->key.oid->name );
+    return ak_error_not_equal_data;
+  }
+  printf(" %s: mgm segments is Ok\n", ekey->key.oid->name );
+
+ return ak_error_ok;
+}
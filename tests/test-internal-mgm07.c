@@ -0,0 +1,100 @@
+/* Пример, иллюстрирующий пакетное зашифрование в режиме MGM
+   большого количества независимых коротких сообщений.
+   Результат сравнивается с зашифрованием каждого сообщения по отдельности.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-mgm07.c
+*/
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdlib.h>
+ #include <ak_mgm.h>
+
+ #define jobs_count (150)
+ #define max_size (4200)
+
+/* проверка для одной пары алгоритмов блочного шифрования */
+ int test_jobs( ak_bckey , ak_bckey , ak_bckey );
+
+ int main( void )
+{
+  struct bckey ekey, akey, ekey2;
+  int error = ak_error_ok;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+
+  if(( error = ak_bckey_context_create_kuznechik( &ekey )) != ak_error_ok ) goto lab_exit;
+  ak_bckey_context_create_kuznechik( &akey );
+  ak_bckey_context_create_kuznechik( &ekey2 );
+  error = test_jobs( &ekey, &akey, &ekey2 );
+  ak_bckey_context_destroy( &ekey2 );
+  ak_bckey_context_destroy( &akey );
+  ak_bckey_context_destroy( &ekey );
+  if( error != ak_error_ok ) goto lab_exit;
+
+  if(( error = ak_bckey_context_create_magma( &ekey )) != ak_error_ok ) goto lab_exit;
+  ak_bckey_context_create_magma( &akey );
+  ak_bckey_context_create_magma( &ekey2 );
+  error = test_jobs( &ekey, &akey, &ekey2 );
+  ak_bckey_context_destroy( &ekey2 );
+  ak_bckey_context_destroy( &akey );
+  ak_bckey_context_destroy( &ekey );
+
+  lab_exit:
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}
+
+ int test_jobs( ak_bckey ekey, ak_bckey akey, ak_bckey ekey2 )
+{
+  size_t i, j;
+  int error = ak_error_ok;
+  ak_uint8 skey[32], iv[jobs_count][16], icode[jobs_count][16], check[16];
+  static ak_uint8 in[max_size], out[jobs_count][max_size], out2[max_size];
+  static struct mgm_job jobs[jobs_count];
+
+  for( i = 0; i < sizeof( skey ); i++ ) skey[i] = (ak_uint8)( i*17 + 3 );
+  for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( i*13 + 7 );
+  ak_bckey_context_set_key( ekey, skey, sizeof( skey ), ak_true );
+  skey[0] ^= 0x5a;
+  ak_bckey_context_set_key( akey, skey, sizeof( skey ), ak_true );
+  skey[1] ^= 0x5a;
+  ak_bckey_context_set_key( ekey2, skey, sizeof( skey ), ak_true );
+
+ /* задания разной длины; часть заданий использует другой ключ шифрования,
+    некоторые сообщения настолько длинные, что обрабатываются отдельно */
+  for( i = 0; i < jobs_count; i++ ) {
+     for( j = 0; j < 16; j++ ) iv[i][j] = (ak_uint8)( i*31 + j );
+     jobs[i].encryptionKey = (( i%37 ) == 36 ) ? ekey2 : ekey;
+     jobs[i].authenticationKey = akey;
+     jobs[i].iv = iv[i];
+     jobs[i].iv_size = ekey->bsize - ((( i%5 ) == 4 ) ? 3 : 0 );
+     jobs[i].adata = in + 5;
+     jobs[i].adata_size = ( i*7 )%41;
+     jobs[i].in = in;
+     jobs[i].out = out[i];
+     jobs[i].size = (( i%50 ) == 49 ) ? max_size : ( i*29 )%530;
+     jobs[i].icode = icode[i];
+     jobs[i].icode_size = ekey->bsize - ( i%3 );
+  }
+  if(( error = ak_bckey_context_encrypt_mgm_jobs( jobs, jobs_count )) != ak_error_ok ) return error;
+
+ /* сравниваем с зашифрованием каждого сообщения по отдельности */
+  for( i = 0; i < jobs_count; i++ ) {
+     ak_bckey_context_encrypt_mgm( jobs[i].encryptionKey, jobs[i].authenticationKey,
+                 jobs[i].adata, jobs[i].adata_size, jobs[i].in, out2, jobs[i].size,
+                                    jobs[i].iv, jobs[i].iv_size, check, jobs[i].icode_size );
+     if(( error = ak_error_get_value()) != ak_error_ok ) return error;
+     if(( jobs[i].error != ak_error_ok ) || ( memcmp( out2, out[i], jobs[i].size ) != 0 ) ||
+        ( memcmp( check, icode[i], jobs[i].icode_size ) != 0 )) {
+       printf(" %s: mgm job %u is Wrong\n", ekey->key.oid->name, (unsigned int) i );
+       return ak_error_not_equal_data;
+     }
+  }
+  printf(" %s: mgm jobs is Ok\n", ekey->key.oid->name );
+
+ return ak_error_ok;
+}
@@ -0,0 +1,418 @@
+/*
+ * Пример, иллюстрирующий затраты времени и памяти при записи и считывании
+ * контейнеров PKCS 15 различного размера.
+ *
+ * Время выполнения функций write_keys_to_container() и read_keys_from_container()
+ * (для контейнеров, содержащих не более 255 ключей) разделяется на выработку ключа KEK (алгоритм PBKDF2), кодирование/декодирование ASN.1 и
+ * зашифрование/расшифрование ключей (остаток). Дополнительно подсчитывается количество
+ * выделений динамической памяти. Для контейнеров любого размера измеряется
+ * время потоковой записи и чтения (container_writer_put_key(), container_reader_next_key()).
+ *
+ * Результаты выводятся в формате CSV:
+ *   keys,operation,phase,seconds,allocations,bytes
+ * где seconds и allocations приведены в расчете на одно выполнение операции.
+ *
+ * Запуск: test-internal-pkcs-15-bench [максимальное_количество_ключей]
+ */
+
+#ifdef __linux__
+ #ifndef _POSIX_C_SOURCE
+   #define _POSIX_C_SOURCE 200112L
+ #endif
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libakrypt.h>
+#include <ak_tools.h>
+#include <ak_bckey.h>
+#include <pkcs_15_cryptographic_token/ak_pkcs_15_token_manager.h>
+
+/* максимальное количество ключей, которое может быть записано функцией write_keys_to_container();
+   потоковые функции записи и чтения количество ключей не ограничивают */
+ #define BENCH_MAX_KEYS 255
+
+/* ----------------------------------------------------------------------------------------------- */
+/* подсчет выделений памяти выполняется подменой функций стандартной библиотеки;
+   при сборке с санитайзером адресов подмена невозможна и счетчики остаются нулевыми */
+ static size_t allocations = 0;
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+ extern void *__libc_malloc(size_t);
+ extern void *__libc_calloc(size_t, size_t);
+ extern void *__libc_realloc(void *, size_t);
+ extern void __libc_free(void *);
+
+ void *malloc(size_t size)
+{
+  __sync_fetch_and_add(&allocations, 1);
+  return __libc_malloc(size);
+}
+
+ void *calloc(size_t nmemb, size_t size)
+{
+  __sync_fetch_and_add(&allocations, 1);
+  return __libc_calloc(nmemb, size);
+}
+
+ void *realloc(void *ptr, size_t size)
+{
+  __sync_fetch_and_add(&allocations, 1);
+  return __libc_realloc(ptr, size);
+}
+
+ void free(void *ptr)
+{
+  __libc_free(ptr);
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ char password[] = "123";
+ date start_date = {2019, 5, 21, 0, 0, 0};
+ date end_date = {2020, 5, 21, 23, 59, 59};
+
+/* накопленные значения для одной фазы */
+ struct measure {
+   double seconds;
+   size_t allocations;
+ };
+
+ int gen_random_key(struct extended_key *p_kc_key, char *label);
+ void free_random_key(struct extended_key *p_kc_key);
+ void free_read_key(struct extended_key *p_key);
+ void free_read_keys(struct extended_key **pp_keys, ak_uint8 num_of_keys);
+ int bench_container(size_t count);
+ int bench_stream(size_t count, struct extended_key **pp_keys, size_t reps);
+
+/* ----------------------------------------------------------------------------------------------- */
+ static double now( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+ return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void start( double *t, size_t *a )
+{
+  *a = allocations;
+  *t = now();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void stop( struct measure *m, double t, size_t a )
+{
+  m->seconds += now() - t;
+  m->allocations += allocations - a;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void print( size_t count, const char *operation, const char *phase, double seconds,
+                                                      double allocs, size_t reps, size_t bytes )
+{
+  if( seconds < 0 ) seconds = 0;
+  if( allocs < 0 ) allocs = 0;
+  printf("%u,%s,%s,%.9f,%.1f,%u\n", (unsigned int)count, operation, phase,
+                      seconds / (double)reps, allocs / (double)reps, (unsigned int)bytes );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( int argc, char *argv[] )
+{
+  size_t i, max_count = 10000;
+  size_t counts[] = { 1, 10, 100, 255, 1000, 10000 };
+
+  if( argc > 1 ) max_count = (size_t) strtoul( argv[1], NULL, 10 );
+
+ /* Инициализируем библиотеку */
+  if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+
+ /* замеры выполняются в одном потоке */
+  ak_libakrypt_set_option( "pkcs_15_threads_count", 1 );
+  ak_libakrypt_set_option( "pkcs_15_kek_cache_ttl", 0 );
+
+  printf("keys,operation,phase,seconds,allocations,bytes\n");
+  for( i = 0; i < sizeof( counts )/sizeof( counts[0] ); i++ ) {
+     if( counts[i] > max_count ) break;
+     if( bench_container( counts[i] ) != ak_error_ok ) {
+       ak_libakrypt_destroy();
+       return EXIT_FAILURE;
+     }
+  }
+
+ /* Деинициализируем библиотеку */
+  return ak_libakrypt_destroy();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int bench_container( size_t count )
+{
+  size_t i, a, r, reps, der_size = 0, enc_size = 0;
+  int error = ak_error_ok;
+  double t;
+  char (*labels)[16] = NULL;
+  ak_byte *p_der = NULL, *p_enc = NULL, salt[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  struct extended_key *p_keys = NULL, **pp_keys = NULL, **pp_read = NULL;
+  struct key_description **pp_descs = NULL;
+  ak_uint8 num_of_read = 0;
+  s_pkcs_15_token token;
+  struct bckey kek;
+  struct measure write_total, read_total, pbkdf2, encode, decode, list;
+
+  memset( &write_total, 0, sizeof( struct measure ));
+  memset( &read_total, 0, sizeof( struct measure ));
+  memset( &pbkdf2, 0, sizeof( struct measure ));
+  memset( &encode, 0, sizeof( struct measure ));
+  memset( &decode, 0, sizeof( struct measure ));
+  memset( &list, 0, sizeof( struct measure ));
+
+ /* количество повторов подбирается так, чтобы малые контейнеры измерялись с разумной точностью */
+  reps = 1 + 100/count;
+
+  labels = calloc( count, sizeof( *labels ));
+  p_keys = calloc( count, sizeof( struct extended_key ));
+  pp_keys = calloc( count, sizeof( struct extended_key * ));
+  if( labels == NULL || p_keys == NULL || pp_keys == NULL ) {
+    error = ak_error_message( ak_error_out_of_memory, __func__, "can't allocate keys" );
+    goto exit;
+  }
+  for( i = 0; i < count; i++ ) {
+     sprintf( labels[i], "key %05u", (unsigned int)i );
+     if(( error = gen_random_key( &p_keys[i], labels[i] )) != ak_error_ok ) goto exit;
+     pp_keys[i] = &p_keys[i];
+  }
+
+ /* потоковая запись и чтение выполняются для контейнеров любого размера */
+  if(( error = bench_stream( count, pp_keys, reps )) != ak_error_ok ) goto exit;
+  if( count > BENCH_MAX_KEYS ) goto exit;
+
+  for( r = 0; r < reps; r++ ) {
+    /* запись контейнера целиком */
+     free( p_der ); p_der = NULL;
+     start( &t, &a );
+     error = write_keys_to_container( pp_keys, (ak_uint8)count, password, strlen( password ),
+                                                                             &p_der, &der_size );
+     stop( &write_total, t, a );
+     if( error != ak_error_ok ) {
+       ak_error_message( error, __func__, "can't write container" );
+       goto exit;
+     }
+
+    /* считывание контейнера целиком */
+     start( &t, &a );
+     error = read_keys_from_container( (ak_byte *)password, strlen( password ), p_der, der_size,
+                                                                       &pp_read, &num_of_read );
+     stop( &read_total, t, a );
+     if( error != ak_error_ok || num_of_read != count ) {
+       error = ak_error_message( ak_error_not_equal_data, __func__, "can't read container" );
+       goto exit;
+     }
+     free_read_keys( pp_read, num_of_read );
+     pp_read = NULL;
+
+    /* выработка ключа KEK с теми же параметрами, что используются при записи */
+     ak_bckey_context_create_kuznechik( &kek );
+     start( &t, &a );
+     error = ak_bckey_context_set_key_from_password( &kek, password, strlen( password ),
+                                                                          salt, sizeof( salt ));
+     stop( &pbkdf2, t, a );
+     ak_bckey_context_destroy( &kek );
+     if( error != ak_error_ok ) {
+       ak_error_message( error, __func__, "can't derive key from password" );
+       goto exit;
+     }
+
+    /* декодирование ASN.1 без расшифрования ключей */
+     memset( &token, 0, sizeof( s_pkcs_15_token ));
+     start( &t, &a );
+     error = pkcs_15_parse_token( p_der, der_size, &token );
+     stop( &decode, t, a );
+     if( error != ak_error_ok ) {
+       ak_error_message( error, __func__, "can't decode container" );
+       free_pkcs_15_token( &token );
+       goto exit;
+     }
+
+    /* кодирование ASN.1 того же набора объектов */
+     start( &t, &a );
+     error = pkcs_15_generate_token( &token, &p_enc, &enc_size );
+     stop( &encode, t, a );
+     free_pkcs_15_token( &token );
+     free( p_enc ); p_enc = NULL;
+     if( error != ak_error_ok ) {
+       ak_error_message( error, __func__, "can't encode container" );
+       goto exit;
+     }
+
+    /* получение списка ключей без расшифрования */
+     start( &t, &a );
+     error = list_keys_in_container( p_der, der_size, &pp_descs, &num_of_read );
+     stop( &list, t, a );
+     if( error != ak_error_ok ) {
+       ak_error_message( error, __func__, "can't list container" );
+       goto exit;
+     }
+     free_key_descriptions( pp_descs, num_of_read );
+     pp_descs = NULL;
+  }
+
+ /* время зашифрования и расшифрования ключей вычисляется как остаток */
+  print( count, "write", "total", write_total.seconds, (double)write_total.allocations, reps, der_size );
+  print( count, "write", "pbkdf2", pbkdf2.seconds, (double)pbkdf2.allocations, reps, der_size );
+  print( count, "write", "asn_encode", encode.seconds, (double)encode.allocations, reps, der_size );
+  print( count, "write", "wrap", write_total.seconds - pbkdf2.seconds - encode.seconds,
+     (double)write_total.allocations - (double)pbkdf2.allocations - (double)encode.allocations,
+                                                                                 reps, der_size );
+  print( count, "read", "total", read_total.seconds, (double)read_total.allocations, reps, der_size );
+  print( count, "read", "pbkdf2", pbkdf2.seconds, (double)pbkdf2.allocations, reps, der_size );
+  print( count, "read", "asn_decode", decode.seconds, (double)decode.allocations, reps, der_size );
+  print( count, "read", "unwrap", read_total.seconds - pbkdf2.seconds - decode.seconds,
+      (double)read_total.allocations - (double)pbkdf2.allocations - (double)decode.allocations,
+                                                                                 reps, der_size );
+  print( count, "list", "total", list.seconds, (double)list.allocations, reps, der_size );
+
+ exit:
+  free( p_der );
+  if( p_keys != NULL )
+    for( i = 0; i < count; i++ )
+       if( p_keys[i].key.sec_key != NULL ) free_random_key( &p_keys[i] );
+  free( p_keys );
+  free( pp_keys );
+  free( labels );
+  return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int bench_stream( size_t count, struct extended_key **pp_keys, size_t reps )
+{
+  FILE *fp;
+  double t;
+  size_t i, a, r, size = 0;
+  int fd, error = ak_error_ok;
+  struct extended_key *p_key = NULL;
+  struct container_writer writer;
+  struct container_reader reader;
+  struct measure write_total, read_total;
+
+  memset( &write_total, 0, sizeof( struct measure ));
+  memset( &read_total, 0, sizeof( struct measure ));
+  if(( fp = tmpfile()) == NULL )
+    return ak_error_message( ak_error_open_file, __func__, "can't create temporary file" );
+  fd = fileno( fp );
+
+  for( r = 0; r < reps; r++ ) {
+     if( lseek( fd, 0, SEEK_SET ) < 0 || ftruncate( fd, 0 ) != 0 ) {
+       error = ak_error_message( ak_error_write_data, __func__, "can't truncate temporary file" );
+       goto exit;
+     }
+
+    /* потоковая запись */
+     start( &t, &a );
+     if(( error = container_writer_open( &writer, fd, password, strlen( password ))) == ak_error_ok ) {
+       for( i = 0; i < count && error == ak_error_ok; i++ )
+          error = container_writer_put_key( &writer, pp_keys[i] );
+       if( error == ak_error_ok ) error = container_writer_close( &writer );
+        else container_writer_close( &writer );
+     }
+     stop( &write_total, t, a );
+     if( error != ak_error_ok ) {
+       ak_error_message( error, __func__, "can't stream container" );
+       goto exit;
+     }
+     size = (size_t) lseek( fd, 0, SEEK_CUR );
+
+    /* потоковое чтение */
+     lseek( fd, 0, SEEK_SET );
+     start( &t, &a );
+     i = 0;
+     if(( error = container_reader_open( &reader, fd, (ak_byte *)password, strlen( password ))) == ak_error_ok ) {
+       while(( error = container_reader_next_key( &reader, &p_key )) == ak_error_ok && p_key != NULL ) {
+          free_read_key( p_key );
+          i++;
+       }
+       container_reader_close( &reader );
+     }
+     stop( &read_total, t, a );
+     if( error != ak_error_ok || i != count ) {
+       error = ak_error_message( ak_error_not_equal_data, __func__, "can't read streamed container" );
+       goto exit;
+     }
+  }
+
+  print( count, "stream_write", "total", write_total.seconds, (double)write_total.allocations, reps, size );
+  print( count, "stream_read", "total", read_total.seconds, (double)read_total.allocations, reps, size );
+
+ exit:
+  fclose( fp );
+  return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int gen_random_key( struct extended_key *p_kc_key, char *label )
+{
+  int error;
+  ak_bckey p_random_libakrypt_key;
+
+  memset( p_kc_key, 0, sizeof( struct extended_key ));
+  if(( p_random_libakrypt_key = calloc( 1, sizeof( struct bckey ))) == NULL )
+    return ak_error_null_pointer;
+
+  if(( error = ak_bckey_context_create_magma( p_random_libakrypt_key )) != ak_error_ok ) {
+    free( p_random_libakrypt_key );
+    return ak_error_message( error, __func__, "can't create bckey context" );
+  }
+  if(( error = ak_bckey_context_set_key_random( p_random_libakrypt_key,
+                           &ak_libakrypt_get_context_manager()->key_generator )) != ak_error_ok ) {
+    ak_bckey_context_destroy( p_random_libakrypt_key );
+    free( p_random_libakrypt_key );
+    return ak_error_message( error, __func__, "can't create random kc_secret_key" );
+  }
+
+  p_kc_key->key.sec_key = p_random_libakrypt_key;
+  p_kc_key->key_type = SEC_KEY;
+  p_kc_key->label = label;
+  p_kc_key->flags = ENCRYPT | DECRYPT;
+  memcpy( p_kc_key->start_date, start_date, sizeof( date ));
+  memcpy( p_kc_key->end_date, end_date, sizeof( date ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ void free_random_key( struct extended_key *p_kc_key )
+{
+  ak_bckey_context_destroy( p_kc_key->key.sec_key );
+  free( p_kc_key->key.sec_key );
+  p_kc_key->key.sec_key = NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ void free_read_key( struct extended_key *p_key )
+{
+  if( p_key == NULL ) return;
+  if( p_key->key.sec_key != NULL ) {
+    ak_bckey_context_destroy( p_key->key.sec_key );
+    free( p_key->key.sec_key );
+  }
+  free( p_key->label );
+  free( p_key );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ void free_read_keys( struct extended_key **pp_keys, ak_uint8 num_of_keys )
+{
+  ak_uint8 i;
+
+  if( pp_keys == NULL ) return;
+  for( i = 0; i < num_of_keys; i++ ) free_read_key( pp_keys[i] );
+  free( pp_keys );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                  test-internal-pkcs-15-bench.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -6,12 +6,24 @@
  * алгоритма Магма.
  */
 
+#ifdef __linux__
+ #ifndef _POSIX_C_SOURCE
+   #define _POSIX_C_SOURCE 200112L
+ #endif
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+ #include <fcntl.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
 
 #include <libakrypt.h>
 #include <ak_bckey.h>
+#include <ak_tools.h>
 #include <pkcs_15_cryptographic_token/ak_pkcs_15_token_manager.h>
 
 char password[] = "123";
@@ -20,8 +32,14 @@ date start_date = {2019, 5, 21, 0, 0, 0};
 date end_date = {2020, 5, 21, 23, 59, 59};
 key_usage_flags_t flags = ENCRYPT | DECRYPT;
 
-void print_container_info(struct extended_key** pp_keys, uint8_t num_of_keys);
+void print_container_info(struct extended_key** pp_keys, ak_uint8 num_of_keys);
+int check_lazy_reading(struct extended_key** pp_keys, ak_uint8 num_of_keys, ak_byte* p_container_der, size_t container_der_size);
+int check_incremental_update(ak_uint8 num_of_keys, ak_byte* p_container_der, size_t container_der_size);
+int compare_key_by_id(struct extended_key* p_orig, ak_byte* p_container_der, size_t container_der_size);
 int gen_random_key(struct extended_key *p_kc_key, char *label, date sd, date ed, key_usage_flags_t flags);
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+int check_streaming(size_t num_of_keys);
+#endif
 
 int main()
 {
@@ -39,6 +57,9 @@ int main()
         return ak_libakrypt_destroy();
     }
 
+    /* Обрабатываем объекты контейнера несколькими потоками независимо от количества процессоров */
+    ak_libakrypt_set_option("pkcs_15_threads_count", 4);
+
     /* Добавляем ключ в массив объектов */
     for(i = 0; i < sizeof(pp_kc_keys) / sizeof(pp_kc_keys[i]); i++)
     {
@@ -72,13 +93,54 @@ int main()
     /* Выводим оинформацию о содержимом контейнера */
     print_container_info(pp_kc_keys_from_container, num_of_keys);
 
+    /* Проверяем получение списка ключей и считывание отдельного ключа по идентификатору */
+    if((error = check_lazy_reading(pp_kc_keys, sizeof(pp_kc_keys) / sizeof(pp_kc_keys[0]), p_container_der, container_der_size)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "wrong lazy reading of container");
+        ak_libakrypt_destroy();
+        return EXIT_FAILURE;
+    }
+
+    /* Повторяем считывание с включенным кэшем ключей KEK: все обращения, кроме первого,
+       используют ключ из кэша без выполнения алгоритма PBKDF2 */
+    ak_libakrypt_set_option("pkcs_15_kek_cache_ttl", 60);
+    for(i = 0; i < 2; i++)
+    {
+        if((error = check_lazy_reading(pp_kc_keys, sizeof(pp_kc_keys) / sizeof(pp_kc_keys[0]), p_container_der, container_der_size)) != ak_error_ok)
+        {
+            ak_error_message(error, __func__, "wrong reading of container with kek cache");
+            ak_libakrypt_destroy();
+            return EXIT_FAILURE;
+        }
+    }
+    pkcs_15_kek_cache_purge();
+    ak_libakrypt_set_option("pkcs_15_kek_cache_ttl", 0);
+
+    /* Проверяем добавление, замену и удаление отдельного ключа */
+    if((error = check_incremental_update(sizeof(pp_kc_keys) / sizeof(pp_kc_keys[0]), p_container_der, container_der_size)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "wrong incremental update of container");
+        ak_libakrypt_destroy();
+        return EXIT_FAILURE;
+    }
+
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+    /* Проверяем потоковую запись и чтение контейнера, содержащего более 255 ключей */
+    if((error = check_streaming(300)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "wrong streaming of container");
+        ak_libakrypt_destroy();
+        return EXIT_FAILURE;
+    }
+#endif
+
     /* Деинициализируем библиотеку */
     return ak_libakrypt_destroy();
 }
 
-void print_container_info(struct extended_key** pp_keys, uint8_t num_of_keys)
+void print_container_info(struct extended_key** pp_keys, ak_uint8 num_of_keys)
 {
-    uint8_t i, j;
+    ak_uint8 i, j;
     struct extended_key* p_key;
 
     for(i = 0; i < num_of_keys; i++)
@@ -118,6 +180,250 @@ void print_container_info(struct extended_key** pp_keys, uint8_t num_of_keys)
     }
 }
 
+int check_lazy_reading(struct extended_key** pp_keys, ak_uint8 num_of_keys, ak_byte* p_container_der, size_t container_der_size)
+{
+    int error;
+    ak_uint8 i, j;
+    ak_byte block[8] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+    ak_byte out_expected[8], out_actual[8];
+    ak_byte unknown_id[4] = { 0x00, 0x00, 0x00, 0x00 };
+    struct key_description** pp_descs;
+    ak_uint8 num_of_descs;
+    struct extended_key* p_key;
+
+    /* Получаем список ключей без выработки ключа KEK */
+    pp_descs = NULL;
+    num_of_descs = 0;
+    if((error = list_keys_in_container(p_container_der, container_der_size, &pp_descs, &num_of_descs)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't list keys in container");
+
+    if(num_of_descs != num_of_keys)
+        return ak_error_message(ak_error_not_equal_data, __func__, "wrong number of listed keys");
+
+    for(i = 0; i < num_of_descs; i++)
+    {
+        if(!pp_descs[i]->label || strcmp((char*)pp_descs[i]->label, key_label) != 0 || pp_descs[i]->flags != flags)
+            return ak_error_message(ak_error_not_equal_data, __func__, "wrong listed key attributes");
+
+        for(j = 0; j < 6; j++)
+        {
+            if(pp_descs[i]->start_date[j] != start_date[j] || pp_descs[i]->end_date[j] != end_date[j])
+                return ak_error_message(ak_error_not_equal_data, __func__, "wrong listed key validity period");
+        }
+
+        /* Ищем исходный ключ с тем же идентификатором */
+        for(j = 0; j < num_of_keys; j++)
+        {
+            if(pp_keys[j]->key.sec_key->key.number.size == pp_descs[i]->id_size &&
+               !memcmp(pp_keys[j]->key.sec_key->key.number.data, pp_descs[i]->id, pp_descs[i]->id_size))
+                break;
+        }
+        if(j == num_of_keys)
+            return ak_error_message(ak_error_not_equal_data, __func__, "listed key id not found");
+
+        /* Считываем только этот ключ и сравниваем результаты зашифрования */
+        p_key = NULL;
+        if((error = read_key_from_container_by_id((ak_byte*)password, strlen(password), p_container_der, container_der_size,
+                                                  pp_descs[i]->id, pp_descs[i]->id_size, &p_key)) != ak_error_ok)
+            return ak_error_message(error, __func__, "can't read key by id");
+
+        ak_bckey_context_encrypt_ecb(pp_keys[j]->key.sec_key, block, out_expected, sizeof(block));
+        ak_bckey_context_encrypt_ecb(p_key->key.sec_key, block, out_actual, sizeof(block));
+        if(memcmp(out_expected, out_actual, sizeof(block)) != 0)
+            return ak_error_message(ak_error_not_equal_data, __func__, "key read by id differs from original");
+
+        ak_bckey_context_destroy(p_key->key.sec_key);
+        free(p_key->key.sec_key);
+        free(p_key->label);
+        free(p_key);
+    }
+
+    free_key_descriptions(pp_descs, num_of_descs);
+    free(pp_descs);
+
+    /* Ключ с несуществующим идентификатором не должен быть найден */
+    p_key = NULL;
+    if(read_key_from_container_by_id((ak_byte*)password, strlen(password), p_container_der, container_der_size,
+                                     unknown_id, sizeof(unknown_id), &p_key) != ak_error_undefined_value || p_key)
+        return ak_error_message(ak_error_invalid_value, __func__, "key with unknown id was found");
+    ak_error_set_value(ak_error_ok);
+
+    printf("Lazy listing and reading by id: Ok\n");
+    return ak_error_ok;
+}
+
+int compare_key_by_id(struct extended_key* p_orig, ak_byte* p_container_der, size_t container_der_size)
+{
+    int error;
+    ak_byte block[8] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+    ak_byte out_expected[8], out_actual[8];
+    struct extended_key* p_key;
+
+    p_key = NULL;
+    if((error = read_key_from_container_by_id((ak_byte*)password, strlen(password), p_container_der, container_der_size,
+                                              p_orig->key.sec_key->key.number.data, p_orig->key.sec_key->key.number.size, &p_key)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't read key by id");
+
+    ak_bckey_context_encrypt_ecb(p_orig->key.sec_key, block, out_expected, sizeof(block));
+    ak_bckey_context_encrypt_ecb(p_key->key.sec_key, block, out_actual, sizeof(block));
+    error = memcmp(out_expected, out_actual, sizeof(block)) ? ak_error_not_equal_data : ak_error_ok;
+
+    ak_bckey_context_destroy(p_key->key.sec_key);
+    free(p_key->key.sec_key);
+    free(p_key->label);
+    free(p_key);
+
+    return error;
+}
+
+int check_incremental_update(ak_uint8 num_of_keys, ak_byte* p_container_der, size_t container_der_size)
+{
+    int error;
+    struct extended_key added_key, replacing_key;
+    struct key_description** pp_descs;
+    ak_uint8 num_of_descs;
+    ak_byte *p_added_der, *p_replaced_der, *p_removed_der, *p_dummy_der;
+    size_t added_der_size, replaced_der_size, removed_der_size, dummy_der_size;
+
+    p_added_der = p_replaced_der = p_removed_der = p_dummy_der = NULL;
+    gen_random_key(&added_key, key_label, start_date, end_date, flags);
+    gen_random_key(&replacing_key, key_label, start_date, end_date, flags);
+
+    /* Добавляем ключ в существующий контейнер */
+    if((error = add_key_to_container((ak_byte*)password, strlen(password), p_container_der, container_der_size,
+                                     &added_key, &p_added_der, &added_der_size)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't add key to container");
+
+    pp_descs = NULL;
+    num_of_descs = 0;
+    if((error = list_keys_in_container(p_added_der, added_der_size, &pp_descs, &num_of_descs)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't list keys in container");
+    free_key_descriptions(pp_descs, num_of_descs);
+    free(pp_descs);
+    if(num_of_descs != num_of_keys + 1)
+        return ak_error_message(ak_error_not_equal_data, __func__, "wrong number of keys after adding");
+
+    if((error = compare_key_by_id(&added_key, p_added_der, added_der_size)) != ak_error_ok)
+        return ak_error_message(error, __func__, "added key differs from original");
+
+    /* Повторное добавление ключа с тем же идентификатором запрещено */
+    if(add_key_to_container((ak_byte*)password, strlen(password), p_added_der, added_der_size,
+                            &added_key, &p_dummy_der, &dummy_der_size) != ak_error_invalid_value)
+        return ak_error_message(ak_error_invalid_value, __func__, "key with duplicate id was added");
+    ak_error_set_value(ak_error_ok);
+
+    /* Заменяем добавленный ключ другим значением с тем же идентификатором */
+    memcpy(replacing_key.key.sec_key->key.number.data, added_key.key.sec_key->key.number.data,
+           added_key.key.sec_key->key.number.size);
+    if((error = replace_key_in_container((ak_byte*)password, strlen(password), p_added_der, added_der_size,
+                                         &replacing_key, &p_replaced_der, &replaced_der_size)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't replace key in container");
+
+    if((error = compare_key_by_id(&replacing_key, p_replaced_der, replaced_der_size)) != ak_error_ok)
+        return ak_error_message(error, __func__, "replaced key differs from original");
+
+    /* Удаляем ключ; остальные объекты не перекодировались, поэтому контейнер совпадает с исходным */
+    if((error = remove_key_from_container(p_replaced_der, replaced_der_size, added_key.key.sec_key->key.number.data,
+                                          added_key.key.sec_key->key.number.size, &p_removed_der, &removed_der_size)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't remove key from container");
+
+    if(removed_der_size != container_der_size || memcmp(p_removed_der, p_container_der, container_der_size) != 0)
+        return ak_error_message(ak_error_not_equal_data, __func__, "container differs from original after removing key");
+
+    ak_bckey_context_destroy(added_key.key.sec_key);
+    free(added_key.key.sec_key);
+    ak_bckey_context_destroy(replacing_key.key.sec_key);
+    free(replacing_key.key.sec_key);
+    free(p_added_der);
+    free(p_replaced_der);
+    free(p_removed_der);
+
+    printf("Incremental adding, replacing and removing of key: Ok\n");
+    return ak_error_ok;
+}
+
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+int check_streaming(size_t num_of_keys)
+{
+    int fd, error;
+    size_t i, size;
+    ak_byte block[8] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+    ak_byte out[8], *p_expected, *p_der;
+    struct extended_key key, *p_key;
+    struct container_writer writer;
+    struct container_reader reader;
+    s_pkcs_15_token token;
+    s_pkcs_15_token_layout layout;
+
+    if((fd = open("test-pkcs-15-stream.p15", O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR)) < 0)
+        return ak_error_message(ak_error_open_file, __func__, "can't create container file");
+    if((p_expected = malloc(num_of_keys * sizeof(out))) == NULL)
+        return ak_error_out_of_memory;
+
+    /* Ключи вырабатываются и записываются по одному; сохраняется только результат зашифрования блока */
+    if((error = container_writer_open(&writer, fd, password, strlen(password))) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't start writing of container");
+    for(i = 0; i < num_of_keys; i++)
+    {
+        gen_random_key(&key, key_label, start_date, end_date, flags);
+        ak_bckey_context_encrypt_ecb(key.key.sec_key, block, p_expected + i * sizeof(out), sizeof(out));
+        error = container_writer_put_key(&writer, &key);
+        ak_bckey_context_destroy(key.key.sec_key);
+        free(key.key.sec_key);
+        if(error != ak_error_ok)
+            return ak_error_message(error, __func__, "can't write key to container");
+    }
+    if((error = container_writer_close(&writer)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't finish writing of container");
+
+    /* Проверяем, что записана корректная DER последовательность без лишних данных */
+    size = (size_t) lseek(fd, 0, SEEK_END);
+    if((p_der = malloc(size)) == NULL)
+        return ak_error_out_of_memory;
+    lseek(fd, 0, SEEK_SET);
+    if(read(fd, p_der, size) != (ssize_t) size)
+        return ak_error_message(ak_error_read_data, __func__, "can't read container file");
+
+    memset(&token, 0, sizeof(token));
+    error = pkcs_15_get_token_layout(p_der, size, &token, NULL, 0, &layout);
+    free_pkcs_15_token(&token);
+    free(p_der);
+    if(error != ak_error_ok || layout.m_body_end != size || layout.m_obj_count != num_of_keys)
+        return ak_error_message(ak_error_not_equal_data, __func__, "wrong layout of streamed container");
+
+    /* Считываем ключи по одному */
+    lseek(fd, 0, SEEK_SET);
+    if((error = container_reader_open(&reader, fd, (ak_byte*)password, strlen(password))) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't start reading of container");
+    for(i = 0; ; i++)
+    {
+        if((error = container_reader_next_key(&reader, &p_key)) != ak_error_ok)
+            return ak_error_message(error, __func__, "can't read key from container");
+        if(p_key == NULL)
+            break;
+
+        ak_bckey_context_encrypt_ecb(p_key->key.sec_key, block, out, sizeof(out));
+        error = (i < num_of_keys && !memcmp(out, p_expected + i * sizeof(out), sizeof(out))) ? ak_error_ok : ak_error_not_equal_data;
+        ak_bckey_context_destroy(p_key->key.sec_key);
+        free(p_key->key.sec_key);
+        free(p_key->label);
+        free(p_key);
+        if(error != ak_error_ok)
+            return ak_error_message(error, __func__, "streamed key differs from original");
+    }
+    container_reader_close(&reader);
+    close(fd);
+    free(p_expected);
+    remove("test-pkcs-15-stream.p15");
+
+    if(i != num_of_keys)
+        return ak_error_message(ak_error_not_equal_data, __func__, "wrong number of streamed keys");
+
+    printf("Streaming of %u keys: Ok\n", (unsigned int)num_of_keys);
+    return ak_error_ok;
+}
+#endif
+
 int gen_random_key(struct extended_key *p_kc_key, char *label, date sd, date ed, key_usage_flags_t flags)
 {
     int error;
@@ -0,0 +1,245 @@
+/*
+ * Цель данного примера - продемонстрировать работу с хранилищем,
+ * объединяющим несколько контейнеров PKCS 15 в одном каталоге.
+ * Поиск ключа выполняется по индексу хранилища, при этом
+ * считывается и расшифровывается только один объект.
+ */
+
+#ifdef __linux__
+ #ifndef _POSIX_C_SOURCE
+   #define _POSIX_C_SOURCE 200112L
+ #endif
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <libakrypt.h>
+#include <ak_bckey.h>
+#include <pkcs_15_cryptographic_token/ak_pkcs_15_keystore.h>
+
+#define KEYSTORE_PATH "test-pkcs-15-keystore"
+#define KEYS_PER_CONTAINER 3
+
+char password[] = "123";
+date start_date = {2019, 5, 21, 0, 0, 0};
+date end_date = {2020, 5, 21, 23, 59, 59};
+
+int gen_random_key(struct extended_key *p_kc_key, char *label);
+void free_random_key(struct extended_key *p_kc_key);
+int check_key(struct keystore *p_ks, struct extended_key *p_orig);
+
+int main()
+{
+    int error;
+    size_t i;
+    char labels[3 * KEYS_PER_CONTAINER][16];
+    struct extended_key keys[3 * KEYS_PER_CONTAINER];
+    struct extended_key *pp_keys[KEYS_PER_CONTAINER];
+    struct keystore ks, ks2;
+    struct keystore_entry entry;
+
+    /* Инициализируем библиотеку */
+    if (ak_libakrypt_create(ak_function_log_stderr) != ak_true)
+    {
+        return ak_libakrypt_destroy();
+    }
+
+    /* Создаем пустой каталог хранилища */
+    mkdir(KEYSTORE_PATH, S_IRWXU);
+    remove(KEYSTORE_PATH "/" PKCS_15_KEYSTORE_INDEX_NAME);
+    remove(KEYSTORE_PATH "/first.p15");
+    remove(KEYSTORE_PATH "/second.p15");
+    remove(KEYSTORE_PATH "/third.p15");
+
+    for(i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+    {
+        sprintf(labels[i], "key %02u", (unsigned int)i);
+        gen_random_key(&keys[i], labels[i]);
+    }
+
+    /* Записываем два контейнера */
+    if((error = keystore_open(&ks, KEYSTORE_PATH)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "can't open keystore");
+        ak_libakrypt_destroy();
+        return EXIT_FAILURE;
+    }
+
+    for(i = 0; i < KEYS_PER_CONTAINER; i++) pp_keys[i] = &keys[i];
+    if((error = keystore_write_container(&ks, "first.p15", pp_keys, KEYS_PER_CONTAINER, password, strlen(password))) != ak_error_ok)
+        goto fail;
+
+    for(i = 0; i < KEYS_PER_CONTAINER; i++) pp_keys[i] = &keys[KEYS_PER_CONTAINER + i];
+    if((error = keystore_write_container(&ks, "second.p15", pp_keys, KEYS_PER_CONTAINER, password, strlen(password))) != ak_error_ok)
+        goto fail;
+    keystore_close(&ks);
+
+    /* Открываем хранилище повторно и ищем все ключи по индексу */
+    if((error = keystore_open(&ks, KEYSTORE_PATH)) != ak_error_ok)
+    {
+        ak_error_message(error, __func__, "can't reopen keystore");
+        ak_libakrypt_destroy();
+        return EXIT_FAILURE;
+    }
+
+    if(ks.count != 2 * KEYS_PER_CONTAINER)
+    {
+        error = ak_error_message(ak_error_not_equal_data, __func__, "wrong number of keystore entries");
+        goto fail;
+    }
+
+    for(i = 0; i < 2 * KEYS_PER_CONTAINER; i++)
+    {
+        if((error = check_key(&ks, &keys[i])) != ak_error_ok)
+            goto fail;
+
+        if((error = keystore_find_by_label(&ks, labels[i], &entry)) != ak_error_ok || strcmp(entry.file, i < KEYS_PER_CONTAINER ? "first.p15" : "second.p15") != 0)
+        {
+            error = ak_error_message(ak_error_not_equal_data, __func__, "wrong search by label");
+            goto fail;
+        }
+    }
+
+    /* Идентификаторы ключей должны быть уникальны в пределах хранилища */
+    pp_keys[0] = &keys[0];
+    if(keystore_write_container(&ks, "third.p15", pp_keys, 1, password, strlen(password)) != ak_error_invalid_value)
+    {
+        error = ak_error_message(ak_error_invalid_value, __func__, "key with duplicate id was added to keystore");
+        goto fail;
+    }
+    ak_error_set_value(ak_error_ok);
+
+    /* Перезаписываем первый контейнер: прежние ключи должны исчезнуть из индекса */
+    for(i = 0; i < KEYS_PER_CONTAINER; i++) pp_keys[i] = &keys[2 * KEYS_PER_CONTAINER + i];
+    if((error = keystore_write_container(&ks, "first.p15", pp_keys, KEYS_PER_CONTAINER, password, strlen(password))) != ak_error_ok)
+        goto fail;
+
+    for(i = 0; i < KEYS_PER_CONTAINER; i++)
+    {
+        if(keystore_find_by_id(&ks, keys[i].key.sec_key->key.number.data, keys[i].key.sec_key->key.number.size, &entry) != ak_error_undefined_value)
+        {
+            error = ak_error_message(ak_error_invalid_value, __func__, "replaced key was found in keystore");
+            goto fail;
+        }
+        if((error = check_key(&ks, &keys[2 * KEYS_PER_CONTAINER + i])) != ak_error_ok)
+            goto fail;
+    }
+
+    /* Удаляем второй контейнер */
+    if((error = keystore_remove_container(&ks, "second.p15")) != ak_error_ok)
+        goto fail;
+
+    if(ks.count != KEYS_PER_CONTAINER || keystore_find_by_label(&ks, labels[KEYS_PER_CONTAINER], &entry) != ak_error_undefined_value)
+    {
+        error = ak_error_message(ak_error_not_equal_data, __func__, "removed container is still in keystore");
+        goto fail;
+    }
+
+    /* Два дескриптора одного хранилища: изменения, сделанные через один из них,
+       не должны теряться при записи через другой, загрузивший индекс раньше */
+    if((error = keystore_open(&ks2, KEYSTORE_PATH)) != ak_error_ok)
+        goto fail;
+    for(i = 0; i < KEYS_PER_CONTAINER; i++) pp_keys[i] = &keys[KEYS_PER_CONTAINER + i];
+    if((error = keystore_write_container(&ks, "second.p15", pp_keys, KEYS_PER_CONTAINER, password, strlen(password))) != ak_error_ok)
+        goto fail2;
+    for(i = 0; i < KEYS_PER_CONTAINER; i++) pp_keys[i] = &keys[i];
+    if((error = keystore_write_container(&ks2, "third.p15", pp_keys, KEYS_PER_CONTAINER, password, strlen(password))) != ak_error_ok)
+        goto fail2;
+    if(ks2.count != 3 * KEYS_PER_CONTAINER)
+    {
+        error = ak_error_message(ak_error_not_equal_data, __func__, "keystore entries written through another handle are lost");
+        goto fail2;
+    }
+    for(i = 0; i < 3 * KEYS_PER_CONTAINER; i++)
+        if((error = check_key(&ks2, &keys[i])) != ak_error_ok)
+            goto fail2;
+
+    /* Проверка уникальности идентификаторов также выполняется по актуальному индексу */
+    if(keystore_write_container(&ks, "fourth.p15", pp_keys, 1, password, strlen(password)) != ak_error_invalid_value)
+    {
+        error = ak_error_message(ak_error_invalid_value, __func__, "key with duplicate id was added through stale handle");
+        goto fail2;
+    }
+    ak_error_set_value(ak_error_ok);
+    keystore_close(&ks2);
+
+    keystore_close(&ks);
+    for(i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+        free_random_key(&keys[i]);
+
+    printf("Keystore index: Ok\n");
+
+    /* Деинициализируем библиотеку */
+    return ak_libakrypt_destroy();
+
+fail2:
+    keystore_close(&ks2);
+fail:
+    ak_error_message(error, __func__, "wrong keystore processing");
+    keystore_close(&ks);
+    ak_libakrypt_destroy();
+    return EXIT_FAILURE;
+}
+
+int check_key(struct keystore *p_ks, struct extended_key *p_orig)
+{
+    int error;
+    ak_byte block[8] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+    ak_byte out_expected[8], out_actual[8];
+    struct extended_key* p_key;
+
+    p_key = NULL;
+    if((error = keystore_read_key_by_id(p_ks, password, strlen(password), p_orig->key.sec_key->key.number.data,
+                                        p_orig->key.sec_key->key.number.size, &p_key)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't read key from keystore");
+
+    ak_bckey_context_encrypt_ecb(p_orig->key.sec_key, block, out_expected, sizeof(block));
+    ak_bckey_context_encrypt_ecb(p_key->key.sec_key, block, out_actual, sizeof(block));
+    error = memcmp(out_expected, out_actual, sizeof(block)) ? ak_error_not_equal_data : ak_error_ok;
+    if(p_key->label == NULL || strcmp((char*)p_key->label, (char*)p_orig->label) != 0)
+        error = ak_error_not_equal_data;
+
+    ak_bckey_context_destroy(p_key->key.sec_key);
+    free(p_key->key.sec_key);
+    free(p_key->label);
+    free(p_key);
+
+    if(error != ak_error_ok)
+        return ak_error_message(error, __func__, "key read from keystore differs from original");
+
+    return ak_error_ok;
+}
+
+int gen_random_key(struct extended_key *p_kc_key, char *label)
+{
+    int error;
+    ak_bckey p_random_libakrypt_key;
+
+    memset(p_kc_key, 0, sizeof(struct extended_key));
+    if((p_random_libakrypt_key = calloc(1, sizeof(struct bckey))) == NULL)
+        return ak_error_null_pointer;
+
+    if((error = ak_bckey_context_create_magma(p_random_libakrypt_key)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't create bckey context");
+
+    if((error = ak_bckey_context_set_key_random(p_random_libakrypt_key, &ak_libakrypt_get_context_manager()->key_generator)) != ak_error_ok)
+        return ak_error_message(error, __func__, "can't create random kc_secret_key");
+
+    p_kc_key->key.sec_key = p_random_libakrypt_key;
+    p_kc_key->key_type = SEC_KEY;
+    p_kc_key->label = label;
+    p_kc_key->flags = ENCRYPT | DECRYPT;
+    memcpy(p_kc_key->start_date, start_date, sizeof(date));
+    memcpy(p_kc_key->end_date, end_date, sizeof(date));
+
+    return ak_error_ok;
+}
+
+void free_random_key(struct extended_key *p_kc_key)
+{
+    ak_bckey_context_destroy(p_kc_key->key.sec_key);
+    free(p_kc_key->key.sec_key);
+}
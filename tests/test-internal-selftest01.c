@@ -0,0 +1,49 @@
+/* Пример, иллюстрирующий однократное выполнение контрольных примеров
+   при первом использовании алгоритмов.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-selftest01.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <ak_tools.h>
+ #include <ak_bckey.h>
+ #include <ak_hash.h>
+
+ int main( void )
+{
+  struct bckey key;
+  struct hash ctx;
+  int error = ak_error_ok;
+  ak_int64 id = 0;
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+  ak_libakrypt_set_option( "self_test_mode", 1 );
+
+ /* создание контекстов приводит к выполнению контрольных примеров */
+  if(( error = ak_bckey_context_create_kuznechik( &key )) != ak_error_ok ) goto lab_exit;
+  ak_bckey_context_destroy( &key );
+  if(( error = ak_hash_context_create_streebog256( &ctx )) != ak_error_ok ) goto lab_exit;
+  ak_hash_context_destroy( &ctx );
+
+ /* повторные обращения не выполняют примеры заново */
+  for( id = 0; id < ak_self_test_count; id++ )
+     if(( error = ak_libakrypt_self_test(( ak_self_test_t ) id )) != ak_error_ok ) {
+       printf(" self test %u is Wrong\n", (unsigned int) id );
+       goto lab_exit;
+     }
+  for( id = 0; id < ak_self_test_count; id++ )
+     if(( error = ak_libakrypt_self_test(( ak_self_test_t ) id )) != ak_error_ok ) goto lab_exit;
+  printf(" self tests is Ok\n");
+
+ /* неверный идентификатор */
+  if( ak_libakrypt_self_test( ak_self_test_count ) == ak_error_ok ) error = ak_error_undefined_value;
+   else error = ak_error_ok;
+
+  lab_exit:
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}
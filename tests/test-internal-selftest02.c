@@ -0,0 +1,80 @@
+/* Пример, иллюстрирующий выполнение контрольных примеров в фоновом потоке
+   (значение опции self_test_mode равно 2) одновременно с использованием алгоритмов.
+   Файл настроек с указанным значением опции формируется при сборке библиотеки,
+   а переменная окружения HOME устанавливается при запуске теста.
+   Во время выполнения примеров отдельный поток постоянно устанавливает код ошибки;
+   это не должно влиять ни на результаты примеров, ни на код ошибки основного потока.
+   Используются неэкспортируемые функции библиотеки.
+
+   test-internal-selftest02.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <ak_tools.h>
+ #include <ak_bckey.h>
+ #include <ak_hash.h>
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+
+ static volatile int done = 0;
+
+/* поток, постоянно устанавливающий код ошибки */
+ static void *noise( void *arg )
+{
+  (void)arg;
+  while( !done ) ak_error_set_value( ak_error_wrong_length );
+ return NULL;
+}
+#endif
+
+ int main( void )
+{
+  struct bckey key;
+  struct hash ctx;
+  int error = ak_error_ok;
+  ak_int64 id = 0, i = 0;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_t thread;
+  bool_t started = ak_false;
+#endif
+
+ /* инициализируем библиотеку, фоновый поток запускается при создании */
+  if( !ak_libakrypt_create( ak_function_log_stderr ))
+    return ak_libakrypt_destroy();
+  if( ak_libakrypt_get_option( "self_test_mode" ) != 2 ) {
+    printf(" self_test_mode option is not equal to 2\n");
+    error = ak_error_undefined_value;
+    goto lab_exit;
+  }
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if( pthread_create( &thread, NULL, noise, NULL ) == 0 ) started = ak_true;
+#endif
+
+ /* создаем контексты, пока контрольные примеры выполняются в фоновом потоке */
+  for( i = 0; i < 8; i++ ) {
+     if(( error = ak_hash_context_create_streebog256( &ctx )) != ak_error_ok ) goto lab_exit;
+     ak_hash_context_destroy( &ctx );
+     if(( error = ak_bckey_context_create_kuznechik( &key )) != ak_error_ok ) goto lab_exit;
+     ak_bckey_context_destroy( &key );
+     if(( error = ak_bckey_context_create_magma( &key )) != ak_error_ok ) goto lab_exit;
+     ak_bckey_context_destroy( &key );
+  }
+
+ /* все примеры выполнены успешно, код ошибки не изменен фоновым потоком */
+  for( id = 0; id < ak_self_test_count; id++ )
+     if(( error = ak_libakrypt_self_test(( ak_self_test_t ) id )) != ak_error_ok ) {
+       printf(" self test %u is Wrong\n", (unsigned int) id );
+       goto lab_exit;
+     }
+  if(( error = ak_error_get_value()) != ak_error_ok ) goto lab_exit;
+  printf(" background self tests is Ok\n");
+
+  lab_exit:
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+   done = 1;
+   if( started ) pthread_join( thread, NULL );
+#endif
+   ak_libakrypt_destroy();
+   if( error == ak_error_ok ) return EXIT_SUCCESS;
+ return EXIT_FAILURE;
+}